@@ -0,0 +1,86 @@
+/*
+Counts heap allocations of the whole program, see alloc_count.h for how to link it.
+*/
+
+#include "alloc_count.h"
+
+
+//The real allocator, renamed by --wrap
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t count, size_t size);
+void * __real_realloc(void *memory, size_t size);
+void __real_free(void *memory);
+
+//Allocator calls made since the program started
+static volatile AllocCount counts;
+
+
+// Function prototypes for the wrapped allocator
+/////////////////////////////////////////////////////////////////////
+
+void * __wrap_malloc(size_t size);
+void * __wrap_calloc(size_t count, size_t size);
+void * __wrap_realloc(void *memory, size_t size);
+void __wrap_free(void *memory);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the allocation counter
+/////////////////////////////////////////////////////////////////////
+
+//Returns the allocator calls made since the program started
+AllocCount alloc_count_snapshot() {
+
+    AllocCount snapshot = {counts.allocations, counts.frees, counts.bytes};
+    return snapshot;
+}
+
+//Returns the allocator calls made between two snapshots
+AllocCount alloc_count_since(AllocCount earlier) {
+
+    AllocCount now = alloc_count_snapshot();
+    AllocCount difference = {now.allocations - earlier.allocations, now.frees - earlier.frees, now.bytes - earlier.bytes};
+    return difference;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the wrapped allocator
+/////////////////////////////////////////////////////////////////////
+
+//Counts a malloc call
+void * __wrap_malloc(size_t size) {
+
+    counts.allocations++;
+    counts.bytes += size;
+    return __real_malloc(size);
+}
+
+//Counts a calloc call
+void * __wrap_calloc(size_t count, size_t size) {
+
+    counts.allocations++;
+    counts.bytes += count * size;
+    return __real_calloc(count, size);
+}
+
+//Counts a realloc call as one allocation of the new size
+void * __wrap_realloc(void *memory, size_t size) {
+
+    counts.allocations++;
+    counts.bytes += size;
+    return __real_realloc(memory, size);
+}
+
+//Counts a free call
+void __wrap_free(void *memory) {
+
+    if (memory != NULL) {
+        counts.frees++;
+    }
+    __real_free(memory);
+}
+
+/////////////////////////////////////////////////////////////////////
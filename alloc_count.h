@@ -0,0 +1,43 @@
+/*
+Counts heap allocations of the whole program.
+
+alloc_count.c wraps malloc, calloc, realloc and free with the GNU linker option
+  -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+so every call, including those made inside the C library, goes through the counters
+before reaching the real allocator. The same option works for the board build and on a
+Linux host. Only link alloc_count.c together with that option.
+
+The game should not allocate at all once it is running; comparing two snapshots taken a
+turn apart shows if anything does.
+*/
+
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <stddef.h>
+
+
+//AllocCount holds the allocator calls made since the program started
+typedef struct AllocCount
+{
+    //Calls to malloc, calloc and realloc, and calls to free with a non NULL pointer
+    unsigned int allocations;
+    unsigned int frees;
+
+    //Bytes requested by the allocations
+    size_t bytes;
+} AllocCount;
+
+
+// Function prototypes for the allocation counter
+/////////////////////////////////////////////////////////////////////
+
+//Returns the allocator calls made since the program started
+AllocCount alloc_count_snapshot();
+
+//Returns the allocator calls made between two snapshots
+AllocCount alloc_count_since(AllocCount earlier);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
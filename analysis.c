@@ -0,0 +1,175 @@
+/*
+Shows the best moves of the side to move while a player picks one.
+*/
+
+#include <stddef.h>
+
+#include "analysis.h"
+#include "scheduler.h"
+#include "timer.h"
+
+
+// Function prototypes for analysis helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if the search is still on the position of the game
+static bool is_same_position(const Analysis *analysis);
+
+//Starts searching the position of the game, with no hints shown
+static void start_search(Analysis *analysis);
+
+//Shows the first moves of the best lines found, if they are not the ones shown already
+static void show_lines(Analysis *analysis);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the analysis
+/////////////////////////////////////////////////////////////////////
+
+//Sets up the analysis of a game, the lines option gives the number of moves shown
+void analysis_init(Analysis *analysis, Game *game, const SearchOptions *options) {
+
+    search_init(&analysis->search, options);
+    analysis->game = game;
+    analysis->searching = false;
+    analysis->longestStep = 0;
+    analysis->settled = false;
+    analysis->hintCount = 0;
+    analysis->updates = 0;
+    analysis->searches = 0;
+}
+
+//Adds the analysis task to the scheduler, after the game's tasks so it sees the input of the tick
+void analysis_add_task(Analysis *analysis) {
+    scheduler_add_task("analysis", analysis_task, analysis, ANALYSIS_TASK_BUDGET_US);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the scheduler task
+/////////////////////////////////////////////////////////////////////
+
+//Searches the position while the switch is on and a player is to move, and shows the best moves
+//Returns true until the search has gone as deep as it may
+bool analysis_task(void *context, unsigned int deadline) {
+
+    Analysis *analysis = context;
+    Game *game = analysis->game;
+
+    //Turning the switch off takes the hints away, the search starts over once it is back on
+    if ((game->switches & ANALYSIS_SWITCH) == 0) {
+        if (analysis->hintCount > 0) {
+            analysis->hintCount = 0;
+            game_set_hints(game, NULL, 0);
+        }
+        analysis->searching = false;
+        return false;
+    }
+
+    //The position only changes on a player's turn once the move is played, engines think for themselves
+    if (game->state != GAME_SELECTING && game->state != GAME_MOVING) {
+        return false;
+    }
+
+    if (!analysis->searching || !is_same_position(analysis)) {
+        start_search(analysis);
+    }
+    if (analysis->search.finished || analysis->settled) {
+        return false;
+    }
+
+    int depth = analysis->search.completedDepth;
+    unsigned int start = timer_microseconds();
+    search_step(&analysis->search, deadline);
+    unsigned int elapsed = timer_microseconds() - start;
+    if (elapsed > analysis->longestStep) {
+        analysis->longestStep = elapsed;
+    }
+
+    //Until depth 1 is done the search only holds a placeholder line, the first move generated
+    if (analysis->search.completedDepth > 0) {
+        show_lines(analysis);
+    }
+
+    //Each finished depth decides if the next one is still short enough to search
+    if (analysis->search.completedDepth > depth) {
+        analysis->settled = analysis->longestStep * ANALYSIS_DEPTH_GROWTH > ANALYSIS_MAX_STEP_US;
+        analysis->longestStep = 0;
+    }
+
+    return !analysis->search.finished && !analysis->settled;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for analysis helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if the search is still on the position of the game
+static bool is_same_position(const Analysis *analysis) {
+
+    const Game *game = analysis->game;
+    if (analysis->search.currentTurn != game->currentTurn) {
+        return false;
+    }
+
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if (analysis->search.board[yCoord][xCoord] != game->board[yCoord][xCoord]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//Starts searching the position of the game, with no hints shown
+//A new turn already cleared the game's hints, the analysis only forgets its own
+static void start_search(Analysis *analysis) {
+
+    Game *game = analysis->game;
+    SearchLimits limits = {ANALYSIS_MAX_DEPTH, 0, 0};
+
+    search_start(&analysis->search, game->board, game->currentTurn, &limits);
+    analysis->searching = true;
+    analysis->longestStep = 0;
+    analysis->settled = false;
+    analysis->hintCount = 0;
+    analysis->searches++;
+}
+
+//Shows the first moves of the best lines found, if they are not the ones shown already
+//The lines only change when a depth finishes, so the board is redrawn at most once a depth
+static void show_lines(Analysis *analysis) {
+
+    const Search *search = &analysis->search;
+    bool changed = search->lineCount != analysis->hintCount;
+
+    GameMove hints[SEARCH_MAX_LINES];
+    for (int line = 0; line < search->lineCount; line++) {
+
+        Move move = search->lines[line].pv[0];
+        GameMove hint = {MOVE_X(move.start), MOVE_Y(move.start), MOVE_X(move.end), MOVE_Y(move.end)};
+        hints[line] = hint;
+
+        const GameMove *shown = &analysis->hints[line];
+        changed = changed || line >= analysis->hintCount || shown->xCoordStart != hint.xCoordStart || shown->yCoordStart != hint.yCoordStart
+            || shown->xCoordEnd != hint.xCoordEnd || shown->yCoordEnd != hint.yCoordEnd;
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    for (int line = 0; line < search->lineCount; line++) {
+        analysis->hints[line] = hints[line];
+    }
+    analysis->hintCount = search->lineCount;
+    analysis->updates++;
+    game_set_hints(analysis->game, hints, analysis->hintCount);
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,94 @@
+/*
+Shows the best moves of the side to move while a player picks one.
+
+With the analysis switch on, a multi-line search (search.h, the lines option) runs on the
+position whenever a player is to move, and its best moves are shown on the board as hints
+(game_set_hints): the piece to move outlined and its square highlighted. The search runs
+as its own scheduler task, a few root moves per tick, so the switches and the drawing go
+on as usual while it deepens. Every depth starts from the lines of the last one, and the
+hints are only touched when the moves of the best lines change, so a depth that confirms
+what is shown costs the board no drawing at all.
+
+A root move is never cut short, so a tick of the task lasts at least as long as the
+slowest root move of its depth, and each depth takes several times longer than the last.
+The search therefore stops deepening once the next depth would hold the other tasks up
+for more than ANALYSIS_MAX_STEP_US, or at ANALYSIS_MAX_DEPTH, and the task is idle until
+the position changes. How deep that is depends on the core it runs on. On a turn an
+engine plays the analysis waits.
+*/
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <stdbool.h>
+
+#include "game.h"
+#include "search.h"
+
+
+// Switch 7 turns the analysis on
+#define ANALYSIS_SWITCH 0x80
+
+// Moves shown, at most SEARCH_MAX_LINES
+// Building with -DANALYSIS_LINES=<n> shows another number of moves
+#ifndef ANALYSIS_LINES
+#define ANALYSIS_LINES 3
+#endif
+
+// Deepest depth searched, as deep as the engine goes
+#define ANALYSIS_MAX_DEPTH 6
+
+// Longest a tick of the analysis may be expected to take, in microseconds, the input waits for it
+// A depth is expected to make the longest tick ANALYSIS_DEPTH_GROWTH times longer than the last one did
+#define ANALYSIS_MAX_STEP_US   50000
+#define ANALYSIS_DEPTH_GROWTH  6
+
+// Time the analysis task may use per tick, in microseconds
+#define ANALYSIS_TASK_BUDGET_US 4000
+
+
+//Analysis holds the search of the position on the board and the hints it shows
+typedef struct Analysis
+{
+    Search search;
+    Game *game;
+
+    //Set while the search belongs to the position on the board, the search's board is back at its root between steps
+    bool searching;
+
+    //Longest tick of the depth being searched, in microseconds, and set once the next depth would take too long
+    unsigned int longestStep;
+    bool settled;
+
+    //Moves shown as hints, the first move of each best line
+    GameMove hints[SEARCH_MAX_LINES];
+    int hintCount;
+
+    //Times the hints changed, and the searches started
+    int updates;
+    int searches;
+} Analysis;
+
+
+// Function prototypes for the analysis
+/////////////////////////////////////////////////////////////////////
+
+//Sets up the analysis of a game, the lines option gives the number of moves shown
+void analysis_init(Analysis *analysis, Game *game, const SearchOptions *options);
+
+//Adds the analysis task to the scheduler, after the game's tasks so it sees the input of the tick
+void analysis_add_task(Analysis *analysis);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for the scheduler task, context is the Analysis
+/////////////////////////////////////////////////////////////////////
+
+//Searches the position while the switch is on and a player is to move, and shows the best moves
+//Returns true until the search has gone as deep as it may
+bool analysis_task(void *context, unsigned int deadline);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
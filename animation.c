@@ -0,0 +1,467 @@
+/*
+Frame scheduler for drawing the board with sliding piece animations.
+*/
+
+#include <stddef.h>
+
+#include "animation.h"
+#include "draw.h"
+#include "framebuffer.h"
+#include "timer.h"
+
+
+//SlidingPiece holds the state of the piece animation
+typedef struct SlidingPiece
+{
+    //Determines if a piece is sliding
+    bool active;
+
+    //Determines if the first frame of the animation was drawn, the animation time starts there
+    bool started;
+    unsigned int startTime;
+
+    //Piece that is moving and piece that stays drawn on the end square until it lands
+    PackedSquare piece;
+    PackedSquare capturedPiece;
+
+    //End square of the move
+    int xCoordEnd;
+    int yCoordEnd;
+
+    //Pixel coordinates of the start and end squares
+    int xPixelStart;
+    int yPixelStart;
+    int xPixelEnd;
+    int yPixelEnd;
+} SlidingPiece;
+
+
+//DisplayedSquare holds everything that decides how a square is drawn: its piece and its look
+typedef struct DisplayedSquare
+{
+    PackedSquare piece;
+    RenderSquare look;
+} DisplayedSquare;
+
+
+//BufferState holds what was drawn into one of the two pixel buffers
+typedef struct BufferState
+{
+    //Address of the pixel buffer this state belongs to
+    short int *address;
+
+    //Squares as they were last drawn into the buffer
+    DisplayedSquare drawnSquares[BOARD_SIZE][BOARD_SIZE];
+
+    //Determines if drawnSquares holds what is in the buffer
+    bool squareValid[BOARD_SIZE][BOARD_SIZE];
+
+    //Set when the state is taken for a buffer, until the animation has drawn a frame into it
+    bool redrawn;
+
+    //Position of the sliding piece drawn into the buffer
+    bool spriteDrawn;
+    int xSpritePixel;
+    int ySpritePixel;
+} BufferState;
+
+
+static SlidingPiece slidingPiece;
+static BufferState bufferStates[2];
+
+static FrameHistogram renderHistogram;
+static FrameHistogram intervalHistogram;
+
+//Time of the previous buffer swap and if a piece was sliding at that point
+static unsigned int lastSwapTime = 0;
+static bool lastFrameAnimated = false;
+
+//State of the last frame drawn: if a piece was sliding, if squares did not fit in the budget
+//and if it is still waiting for vsync to be presented
+static bool frameAnimated = false;
+static bool frameSquaresLeft = false;
+static bool swapPending = false;
+
+//Squares drawn for the last frame and if its buffer had been drawn into outside the animation
+static bool frameRepainted[BOARD_SIZE][BOARD_SIZE];
+static bool frameRedrawn = false;
+
+//Last frame on screen
+static PresentedFrame presentedFrame;
+
+
+// Function prototypes for animation helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the state of the buffer that is drawn into next
+static BufferState * get_back_buffer_state();
+
+//Returns the square as it should be on screen this frame
+static DisplayedSquare get_displayed_square(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render, int xCoord, int yCoord);
+
+//Checks if two squares would be drawn the same way
+static bool is_same_square(DisplayedSquare first, DisplayedSquare second);
+
+//Marks the squares covered by a piece drawn with its left top corner at (x,y)
+static void mark_squares_under(bool marked[BOARD_SIZE][BOARD_SIZE], int xPixelCoord, int yPixelCoord);
+
+//Draws a square and its piece and remembers it in the buffer state
+static void repaint_square(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render, BufferState *buffer, int xCoord, int yCoord);
+
+//Checks if a buffer shows anything that differs from the board
+static bool is_buffer_stale(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render, BufferState *buffer);
+
+//Adds a frame time to a histogram
+static void record_frame_time(FrameHistogram *histogram, unsigned int microseconds);
+
+//Draws the next frame into the back buffer without presenting it
+static void render_frame(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render);
+
+//Records the time of a buffer swap once the frame is on screen
+static void frame_presented();
+
+//Checks if more frames are needed, once the last frame is presented
+static bool needs_more_frames(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the animation scheduler
+/////////////////////////////////////////////////////////////////////
+
+//Starts sliding the piece at the start square to the end square
+//Must be called before the move is made on the board, a captured piece stays visible until the moving piece lands on it
+void animation_start_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd) {
+
+    slidingPiece.active  = true;
+    slidingPiece.started = false;
+
+    slidingPiece.piece         = board[yCoordStart][xCoordStart];
+    slidingPiece.capturedPiece = board[yCoordEnd][xCoordEnd];
+
+    slidingPiece.xCoordEnd = xCoordEnd;
+    slidingPiece.yCoordEnd = yCoordEnd;
+
+    slidingPiece.xPixelStart = x_to_pixel(xCoordStart);
+    slidingPiece.yPixelStart = y_to_pixel(yCoordStart);
+    slidingPiece.xPixelEnd   = x_to_pixel(xCoordEnd);
+    slidingPiece.yPixelEnd   = y_to_pixel(yCoordEnd);
+}
+
+//Returns true while a piece is sliding
+bool animation_is_active() {
+    return slidingPiece.active;
+}
+
+//Draws one frame of the board and presents it
+//Returns true while more frames are needed to finish the animation or to bring both buffers up to date
+bool animation_draw_frame(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render) {
+
+    //A frame started by animation_update has to be on screen before the next one is drawn
+    if (swapPending) {
+        while (!framebuffer_swap_done());
+        frame_presented();
+    }
+
+    render_frame(board, render);
+
+    //Presents the frame
+    wait_for_vsync();
+    frame_presented();
+
+    return needs_more_frames(board, render);
+}
+
+//Draws the next frame if the previous one is on screen, never waits for vsync
+//Returns true while more frames are needed, false once the board is up to date in both buffers
+bool animation_update(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render) {
+
+    //The back buffer can not be drawn into until the last frame is on screen
+    if (swapPending) {
+        if (!framebuffer_swap_done()) {
+            return true;
+        }
+        frame_presented();
+    }
+
+    if (!needs_more_frames(board, render)) {
+        return false;
+    }
+
+    render_frame(board, render);
+    framebuffer_begin_swap();
+    swapPending = true;
+
+    return true;
+}
+
+//Forgets what was drawn in the pixel buffers, so the next frames repaint every square
+void animation_invalidate() {
+
+    for (int index = 0; index < 2; index++) {
+        bufferStates[index].address = NULL;
+        bufferStates[index].spriteDrawn = false;
+        for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+            for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+                bufferStates[index].squareValid[yCoord][xCoord] = false;
+            }
+        }
+    }
+}
+
+//Returns the last frame put on screen
+const PresentedFrame * animation_presented_frame() {
+    return &presentedFrame;
+}
+
+//Returns the histogram of the time spent drawing each frame
+const FrameHistogram * animation_render_histogram() {
+    return &renderHistogram;
+}
+
+//Returns the histogram of the time between two frames while a piece is sliding
+const FrameHistogram * animation_interval_histogram() {
+    return &intervalHistogram;
+}
+
+//Clears both histograms
+void animation_reset_histograms() {
+
+    FrameHistogram empty = {{0}, 0, 0};
+    renderHistogram = empty;
+    intervalHistogram = empty;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for animation helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the state of the buffer that is drawn into next
+static BufferState * get_back_buffer_state() {
+
+    short int *backBuffer = framebuffer_back_buffer();
+
+    for (int index = 0; index < 2; index++) {
+        if (bufferStates[index].address == backBuffer) {
+            return &bufferStates[index];
+        }
+    }
+
+    //First frame drawn into this buffer, take the state that does not belong to the front buffer
+    short int *frontBuffer = framebuffer_front_buffer();
+    BufferState *buffer = bufferStates[0].address != frontBuffer ? &bufferStates[0] : &bufferStates[1];
+
+    buffer->address = backBuffer;
+    buffer->spriteDrawn = false;
+    buffer->redrawn = true;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            buffer->squareValid[yCoord][xCoord] = false;
+        }
+    }
+
+    return buffer;
+}
+
+//Returns the square as it should be on screen this frame
+static DisplayedSquare get_displayed_square(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render, int xCoord, int yCoord) {
+
+    DisplayedSquare square;
+    square.piece = board[yCoord][xCoord];
+    square.look = render->squares[yCoord][xCoord];
+
+    //The end square keeps showing the captured piece (or nothing) until the sliding piece lands
+    if (slidingPiece.active && xCoord == slidingPiece.xCoordEnd && yCoord == slidingPiece.yCoordEnd) {
+        square.piece = slidingPiece.capturedPiece;
+    }
+
+    return square;
+}
+
+//Checks if two squares would be drawn the same way
+static bool is_same_square(DisplayedSquare first, DisplayedSquare second) {
+
+    //An empty square always packs to the same byte, so the pieces compare as they are
+    return first.piece == second.piece
+        && first.look.colour == second.look.colour
+        && first.look.highlighted == second.look.highlighted
+        && first.look.outlined == second.look.outlined;
+}
+
+//Marks the squares covered by a piece drawn with its left top corner at (x,y)
+static void mark_squares_under(bool marked[BOARD_SIZE][BOARD_SIZE], int xPixelCoord, int yPixelCoord) {
+
+    int xFirst = xPixelCoord / SQUARE_SIZE;
+    int yFirst = yPixelCoord / SQUARE_SIZE;
+    int xLast  = (xPixelCoord + SQUARE_SIZE - 1) / SQUARE_SIZE;
+    int yLast  = (yPixelCoord + SQUARE_SIZE - 1) / SQUARE_SIZE;
+
+    for (int yCoord = yFirst; yCoord <= yLast && yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = xFirst; xCoord <= xLast && xCoord < BOARD_SIZE; xCoord++) {
+            marked[yCoord][xCoord] = true;
+        }
+    }
+}
+
+//Draws a square and its piece and remembers it in the buffer state
+static void repaint_square(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render, BufferState *buffer, int xCoord, int yCoord) {
+
+    DisplayedSquare square = get_displayed_square(board, render, xCoord, yCoord);
+
+    draw_square(square.look, xCoord, yCoord);
+    draw_piece(unpack_piece(square.piece), xCoord, yCoord);
+
+    buffer->drawnSquares[yCoord][xCoord] = square;
+    buffer->squareValid[yCoord][xCoord] = true;
+    frameRepainted[yCoord][xCoord] = true;
+}
+
+//Checks if a buffer shows anything that differs from the board
+static bool is_buffer_stale(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render, BufferState *buffer) {
+
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if (!buffer->squareValid[yCoord][xCoord] || !is_same_square(buffer->drawnSquares[yCoord][xCoord], get_displayed_square(board, render, xCoord, yCoord))) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+//Adds a frame time to a histogram
+static void record_frame_time(FrameHistogram *histogram, unsigned int microseconds) {
+
+    unsigned int bucket = microseconds / 1000;
+    if (bucket >= FRAME_HISTOGRAM_BUCKETS) {
+        bucket = FRAME_HISTOGRAM_BUCKETS - 1;
+    }
+
+    histogram->buckets[bucket]++;
+    histogram->frames++;
+    if (microseconds > histogram->maxMicroseconds) {
+        histogram->maxMicroseconds = microseconds;
+    }
+}
+
+//Draws the next frame into the back buffer without presenting it
+static void render_frame(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render) {
+
+    unsigned int frameStart = timer_microseconds();
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            frameRepainted[yCoord][xCoord] = false;
+        }
+    }
+
+    BufferState *buffer = get_back_buffer_state();
+    bool animated = slidingPiece.active;
+    frameRedrawn = buffer->redrawn;
+    buffer->redrawn = false;
+
+    //Works out where the sliding piece is, the position depends on time and not on the frame count
+    //so a slow frame does not slow the piece down
+    bool spriteVisible = false;
+    int xSpritePixel = 0;
+    int ySpritePixel = 0;
+    if (slidingPiece.active) {
+
+        if (!slidingPiece.started) {
+            slidingPiece.started = true;
+            slidingPiece.startTime = frameStart;
+        }
+
+        int elapsed = (int) (frameStart - slidingPiece.startTime);
+        if (elapsed >= ANIMATION_DURATION_US) {
+            slidingPiece.active = false;
+        } else {
+            spriteVisible = true;
+            xSpritePixel = slidingPiece.xPixelStart + (slidingPiece.xPixelEnd - slidingPiece.xPixelStart) * elapsed / ANIMATION_DURATION_US;
+            ySpritePixel = slidingPiece.yPixelStart + (slidingPiece.yPixelEnd - slidingPiece.yPixelStart) * elapsed / ANIMATION_DURATION_US;
+        }
+    }
+
+    //Squares under the piece where it was last drawn in this buffer and where it is drawn now
+    //are always repainted, regardless of the budget
+    bool underSprite[BOARD_SIZE][BOARD_SIZE] = {{false}};
+    if (buffer->spriteDrawn) {
+        mark_squares_under(underSprite, buffer->xSpritePixel, buffer->ySpritePixel);
+    }
+    if (spriteVisible) {
+        mark_squares_under(underSprite, xSpritePixel, ySpritePixel);
+    }
+
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if (underSprite[yCoord][xCoord]) {
+                repaint_square(board, render, buffer, xCoord, yCoord);
+            }
+        }
+    }
+
+    //Repaints the other squares that changed until the budget is used up
+    bool squaresLeft = false;
+    for (int yCoord = 0; yCoord < BOARD_SIZE && !squaresLeft; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+
+            if (buffer->squareValid[yCoord][xCoord] && is_same_square(buffer->drawnSquares[yCoord][xCoord], get_displayed_square(board, render, xCoord, yCoord))) {
+                continue;
+            }
+
+            if (timer_microseconds() - frameStart >= FRAME_RENDER_BUDGET_US) {
+                squaresLeft = true;
+                break;
+            }
+
+            repaint_square(board, render, buffer, xCoord, yCoord);
+        }
+    }
+
+    //The sliding piece is drawn last so it is on top of every square
+    if (spriteVisible) {
+        draw_piece_at_pixel(unpack_piece(slidingPiece.piece), xSpritePixel, ySpritePixel);
+    }
+    buffer->spriteDrawn  = spriteVisible;
+    buffer->xSpritePixel = xSpritePixel;
+    buffer->ySpritePixel = ySpritePixel;
+
+    record_frame_time(&renderHistogram, timer_microseconds() - frameStart);
+
+    frameAnimated = animated;
+    frameSquaresLeft = squaresLeft;
+}
+
+//Records the time of a buffer swap once the frame is on screen
+static void frame_presented() {
+
+    unsigned int swapTime = timer_microseconds();
+    if (frameAnimated && lastFrameAnimated) {
+        record_frame_time(&intervalHistogram, swapTime - lastSwapTime);
+    }
+    lastSwapTime = swapTime;
+    lastFrameAnimated = frameAnimated;
+    swapPending = false;
+
+    presentedFrame.number++;
+    presentedFrame.microseconds = swapTime;
+    presentedFrame.pixels = framebuffer_front_buffer();
+    presentedFrame.redrawn = frameRedrawn;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            presentedFrame.repainted[yCoord][xCoord] = frameRepainted[yCoord][xCoord];
+        }
+    }
+}
+
+//Checks if more frames are needed, once the last frame is presented
+static bool needs_more_frames(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render) {
+
+    //The buffer drawn next still shows what was there two frames ago
+    BufferState *nextBuffer = get_back_buffer_state();
+    return slidingPiece.active || frameSquaresLeft || nextBuffer->spriteDrawn || is_buffer_stale(board, render, nextBuffer);
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,104 @@
+/*
+Frame scheduler for drawing the board with sliding piece animations.
+
+Instead of repainting the whole board every frame, animation_draw_frame keeps a copy of
+what was drawn into each of the two pixel buffers and only repaints the squares that
+changed, plus the squares under the moving piece in its previous and current position.
+Repainting is limited to a fixed time budget per frame; squares that do not fit are left
+for the next frame, the squares under the moving piece always come first.
+
+Frame times are collected in histograms so the frame rate can be checked on the board.
+The last frame presented is described by animation_presented_frame, down to the squares
+drawn for it, so the frame stream (stream.h) only has to look at those.
+*/
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "chess.h"
+
+
+// Time a piece takes to slide to its destination
+#define ANIMATION_DURATION_US 200000
+
+// Time per frame at 60 Hz and the part of it that may be spent repainting squares
+// The rest of the frame is left for input handling and the game logic
+#define FRAME_PERIOD_US       16667
+#define FRAME_RENDER_BUDGET_US 8000
+
+// Frame time histograms use 1 ms buckets, the last bucket collects everything longer
+#define FRAME_HISTOGRAM_BUCKETS 34
+
+
+//FrameHistogram holds the distribution of a frame time
+typedef struct FrameHistogram
+{
+    //Number of frames per 1 ms bucket
+    int buckets[FRAME_HISTOGRAM_BUCKETS];
+
+    //Number of frames recorded
+    int frames;
+
+    //Longest frame time recorded, in microseconds
+    unsigned int maxMicroseconds;
+} FrameHistogram;
+
+
+//PresentedFrame describes the last frame animation_draw_frame or animation_update put on screen
+typedef struct PresentedFrame
+{
+    //Counts the frames presented since start up, 0 before the first one
+    unsigned int number;
+
+    //Time the frame went on screen, a timer_microseconds value
+    unsigned int microseconds;
+
+    //Pixel buffer holding the frame, it is not drawn into again before the next frame is presented
+    const short int *pixels;
+
+    //Squares drawn into the buffer for this frame, everything else is as the buffer showed it two frames ago
+    bool repainted[BOARD_SIZE][BOARD_SIZE];
+
+    //Set when the buffer was drawn into outside the animation since it was last presented (see
+    //animation_invalidate), then any pixel may have changed
+    bool redrawn;
+} PresentedFrame;
+
+
+// Function prototypes for the animation scheduler
+/////////////////////////////////////////////////////////////////////
+
+//Starts sliding the piece at the start square to the end square
+//Must be called before the move is made on the board, a captured piece stays visible until the moving piece lands on it
+void animation_start_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Returns true while a piece is sliding
+bool animation_is_active();
+
+//Draws one frame of the board and presents it
+//Returns true while more frames are needed to finish the animation or to bring both buffers up to date
+bool animation_draw_frame(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render);
+
+//Draws the next frame if the previous one is on screen, never waits for vsync
+//Returns true while more frames are needed, false once the board is up to date in both buffers
+bool animation_update(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render);
+
+//Forgets what was drawn in the pixel buffers, so the next frames repaint every square
+//Must be called after drawing into the pixel buffers without animation_draw_frame, e.g. with draw_board
+void animation_invalidate();
+
+//Returns the last frame put on screen
+const PresentedFrame * animation_presented_frame();
+
+//Returns the histogram of the time spent drawing each frame
+const FrameHistogram * animation_render_histogram();
+
+//Returns the histogram of the time between two frames while a piece is sliding
+const FrameHistogram * animation_interval_histogram();
+
+//Clears both histograms
+void animation_reset_histograms();
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
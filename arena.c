@@ -0,0 +1,45 @@
+/*
+Bump allocator over a fixed block of memory.
+*/
+
+#include "arena.h"
+
+
+// Function definitions for the arena
+/////////////////////////////////////////////////////////////////////
+
+//Hands out memory from the block of size bytes
+void arena_init(Arena *arena, void *memory, size_t size) {
+
+    arena->memory = memory;
+    arena->size = size;
+    arena->used = 0;
+    arena->peak = 0;
+}
+
+//Returns size bytes of uninitialized memory
+//Returns NULL if the arena does not have that much left
+void * arena_alloc(Arena *arena, size_t size) {
+
+    //Round up so the next allocation is aligned as well
+    size_t alignedSize = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+
+    if (alignedSize > arena->size - arena->used) {
+        return NULL;
+    }
+
+    void *memory = arena->memory + arena->used;
+    arena->used += alignedSize;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+
+    return memory;
+}
+
+//Gives back everything allocated since arena_init
+void arena_reset(Arena *arena) {
+    arena->used = 0;
+}
+
+/////////////////////////////////////////////////////////////////////
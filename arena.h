@@ -0,0 +1,47 @@
+/*
+Bump allocator over a fixed block of memory.
+
+Memory is handed out by moving a pointer forward and is given back all at once with
+arena_reset, so there is no fragmentation and nothing to free. The game keeps one arena
+per turn for the scratch memory an engine needs while it thinks, which replaces heap
+allocations that would fragment the small bare-metal heap over a long session.
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+
+// Every allocation is aligned to this many bytes
+#define ARENA_ALIGNMENT 8
+
+
+//Arena holds a block of memory and how much of it is in use
+typedef struct Arena
+{
+    unsigned char *memory;
+    size_t size;
+    size_t used;
+
+    //Largest amount in use since arena_init, to size the block
+    size_t peak;
+} Arena;
+
+
+// Function prototypes for the arena
+/////////////////////////////////////////////////////////////////////
+
+//Hands out memory from the block of size bytes
+void arena_init(Arena *arena, void *memory, size_t size);
+
+//Returns size bytes of uninitialized memory
+//Returns NULL if the arena does not have that much left
+void * arena_alloc(Arena *arena, size_t size);
+
+//Gives back everything allocated since arena_init
+void arena_reset(Arena *arena);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
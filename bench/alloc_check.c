@@ -0,0 +1,122 @@
+/*
+Checks that playing a game does not allocate from the heap.
+
+Plays a scripted game through the same scheduler tasks the board runs, with the host
+input, framebuffer and timer backends, and counts allocator calls per turn with the
+wrapped allocator in alloc_count.c. Set up (the first turn) may allocate, every later
+turn must not; the program exits with status 1 if one does.
+
+Build: gcc -O2 -I. bench/alloc_check.c alloc_count.c game.c scheduler.c arena.c chess.c draw.c raster.c text_overlay.c animation.c framebuffer_host.c timer_host.c input.c input_host.c leds_host.c record.c fen.c -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free -o alloc_check
+*/
+
+#include <stdio.h>
+
+#include "alloc_count.h"
+#include "animation.h"
+#include "draw.h"
+#include "game.h"
+#include "input.h"
+#include "scheduler.h"
+#include "text_overlay.h"
+#include "timer.h"
+
+
+// Most turns the check records
+#define MAX_TURNS 64
+
+
+//Scholar's mate, each square is picked on switches 0-5 and confirmed with KEY0
+static const char *MOVES[] = {"e2e4", "e7e5", "f1c4", "b8c6", "d1h5", "g8f6", "h5f7"};
+static const int MOVE_COUNT = sizeof(MOVES) / sizeof(MOVES[0]);
+
+
+//Returns the switch value that picks a square given as file and rank, e.g. "e2"
+static int square_switches(const char *square) {
+
+    int xCoord = square[0] - 'a';
+    int rank = square[1] - '1';
+    return xCoord | (rank << 3);
+}
+
+int main(void) {
+
+    static Game game;
+    static AllocCount turnCounts[MAX_TURNS];
+    int turns = 0;
+
+    //The script goes through a temporary file, the host input reads it like stdin
+    FILE *script = tmpfile();
+    if (script == NULL) {
+        perror("tmpfile");
+        return 1;
+    }
+    for (int move = 0; move < MOVE_COUNT; move++) {
+        fprintf(script, "sw %d\nkey 1\nsw %d\nkey 1\n", square_switches(MOVES[move]), square_switches(MOVES[move] + 2));
+    }
+    fflush(script);
+    rewind(script);
+    input_host_set_source(script);
+
+    timer_init();
+    input_init();
+    set_pixel_buffer_addresses();
+    text_overlay_init();
+    game_init(&game);
+
+    scheduler_init();
+    scheduler_add_task("input", game_input_task, &game, 1000);
+    scheduler_add_task("logic", game_logic_task, &game, 4000);
+    scheduler_add_task("render", game_render_task, &game, FRAME_RENDER_BUDGET_US + 1000);
+
+    //A turn starts whenever the game goes back to waiting for a piece
+    AllocCount turnStart = alloc_count_snapshot();
+    GameState lastState = game.state;
+
+    while (true) {
+
+        bool busy = scheduler_tick();
+
+        bool turnEnded = game.state != lastState && (game.state == GAME_SELECTING || game.state == GAME_OVER);
+        if (turnEnded && turns < MAX_TURNS) {
+            turnCounts[turns++] = alloc_count_since(turnStart);
+            turnStart = alloc_count_snapshot();
+        }
+        lastState = game.state;
+
+        if (busy) {
+            continue;
+        }
+        if (game.state == GAME_OVER) {
+            break;
+        }
+
+        InputEvent event;
+        if (!input_wait_event(&event)) {
+            break;
+        }
+        game_handle_input(&game, event);
+    }
+
+    //Nothing is printed during the game, stdout buffers are allocated on first use
+    int failures = 0;
+    for (int turn = 0; turn < turns; turn++) {
+        printf("turn %2d: %u allocations, %u frees, %lu bytes\n", turn + 1, turnCounts[turn].allocations, turnCounts[turn].frees, (unsigned long) turnCounts[turn].bytes);
+        if (turn > 0 && turnCounts[turn].allocations != 0) {
+            failures++;
+        }
+    }
+
+    printf("%d turns, game %s, peak turn arena use %lu bytes\n", turns, game.state == GAME_OVER ? "over" : "not finished", (unsigned long) game.turnArena.peak);
+
+    if (game.state != GAME_OVER) {
+        printf("FAIL: the scripted game did not finish\n");
+        return 1;
+    }
+    if (failures > 0) {
+        printf("FAIL: %d turns allocated from the heap\n", failures);
+        return 1;
+    }
+
+    printf("OK: no heap allocations after the first turn\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+Frame time histograms for the sliding piece animations.
+
+Plays a short opening on the host framebuffer backend, animating every move, and prints
+the render time and frame interval histograms collected by the animation scheduler.
+The host backend does not wait for vsync, so each frame sleeps until the next 60 Hz
+frame boundary to pace the run like the board.
+
+Build: gcc -O2 -I. bench/animation_profile.c animation.c chess.c draw.c raster.c framebuffer_host.c timer_host.c -o animation_profile
+*/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "animation.h"
+#include "chess.h"
+#include "draw.h"
+#include "framebuffer.h"
+#include "timer.h"
+
+
+//Opening played during the run, as start and end squares (x, y) on the board array
+static const int OPENING[][4] = {
+    {4, 6, 4, 4}, {4, 1, 4, 3}, {6, 7, 5, 5}, {1, 0, 2, 2},
+    {5, 7, 1, 3}, {0, 1, 0, 2}, {1, 3, 2, 2}, {3, 1, 2, 2},
+};
+static const int OPENING_LENGTH = sizeof(OPENING) / sizeof(OPENING[0]);
+
+
+//Sleeps until the next 60 Hz frame boundary
+static void wait_for_frame_boundary() {
+
+    unsigned int now = timer_microseconds();
+    unsigned int remaining = FRAME_PERIOD_US - now % FRAME_PERIOD_US;
+
+    struct timespec delay = { 0, (long) remaining * 1000 };
+    nanosleep(&delay, NULL);
+}
+
+//Prints the non empty buckets of a histogram
+static void print_histogram(const char *title, const FrameHistogram *histogram) {
+
+    printf("%s: %d frames, max %.2f ms\n", title, histogram->frames, histogram->maxMicroseconds / 1000.0);
+
+    for (int bucket = 0; bucket < FRAME_HISTOGRAM_BUCKETS; bucket++) {
+        if (histogram->buckets[bucket] == 0) {
+            continue;
+        }
+
+        if (bucket == FRAME_HISTOGRAM_BUCKETS - 1) {
+            printf("  >=%2d ms %6d\n", bucket, histogram->buckets[bucket]);
+        } else {
+            printf("  %2d-%2d ms %6d\n", bucket, bucket + 1, histogram->buckets[bucket]);
+        }
+    }
+}
+
+int main(void) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    RenderBoard render;
+    init_board(board);
+    init_render_board(&render);
+
+    timer_init();
+    set_pixel_buffer_addresses();
+
+    //Bring both buffers up to date before measuring
+    while (animation_draw_frame(board, &render)) {
+        wait_for_frame_boundary();
+    }
+    animation_reset_histograms();
+
+    for (int move = 0; move < OPENING_LENGTH; move++) {
+
+        const int *squares = OPENING[move];
+        animation_start_move(board, squares[0], squares[1], squares[2], squares[3]);
+        move_piece(board, squares[0], squares[1], squares[2], squares[3]);
+
+        while (animation_draw_frame(board, &render)) {
+            wait_for_frame_boundary();
+        }
+    }
+
+    printf("%d moves animated, %d frames presented\n\n", OPENING_LENGTH, framebuffer_frame_count());
+    print_histogram("render time", animation_render_histogram());
+    printf("\n");
+    print_histogram("frame interval while sliding", animation_interval_histogram());
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+Size of a position and what copying it costs the rules.
+
+is_valid_move tests every move on a copy of the board and is_checkmate works on one, so
+the size of a position is paid on every legality check. Plays random games to collect
+positions, then reports the bytes of a position and of its RenderBoard, and times
+copy_board, is_valid_move over every start and end square of the side to move's pieces,
+and is_checkmate.
+
+Build: gcc -O2 -I. bench/board_copy.c movegen.c chess.c -o board_copy
+Usage: board_copy [-p positions] [-n repeats] [-r seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chess.h"
+#include "movegen.h"
+
+
+// Positions collected when not given
+#define DEFAULT_POSITIONS 1024
+
+// Repeats of the whole set when not given
+#define DEFAULT_REPEATS 20
+
+// Longest random game a position is taken from
+#define MAX_GAME_PLIES 120
+
+
+//A position and the side to move
+typedef struct BenchPosition
+{
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+} BenchPosition;
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Fills positions from random games, every one with at least one move
+static void collect_positions(BenchPosition *positions, int count) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn = WHITE_PIECE;
+    int plies = MAX_GAME_PLIES;
+    Move moves[MAX_MOVES];
+
+    for (int index = 0; index < count; ) {
+
+        if (plies == MAX_GAME_PLIES) {
+            init_board(board);
+            currentTurn = WHITE_PIECE;
+            plies = 0;
+        }
+
+        int moveCount = generate_moves(board, currentTurn, moves);
+        if (moveCount == 0) {
+            plies = MAX_GAME_PLIES;
+            continue;
+        }
+
+        copy_board(board, positions[index].board);
+        positions[index].currentTurn = currentTurn;
+        index++;
+
+        make_move(board, moves[rand() % moveCount]);
+        switch_turns(&currentTurn);
+        plies++;
+    }
+}
+
+int main(int argc, char **argv) {
+
+    int positionCount = DEFAULT_POSITIONS;
+    int repeats = DEFAULT_REPEATS;
+    unsigned int seed = 1;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-p") == 0 && argument + 1 < argc) {
+            positionCount = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-n") == 0 && argument + 1 < argc) {
+            repeats = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-r") == 0 && argument + 1 < argc) {
+            seed = (unsigned int) atoi(argv[++argument]);
+        } else {
+            positionCount = 0;
+            break;
+        }
+    }
+    if (positionCount < 1 || repeats < 1) {
+        fprintf(stderr, "usage: board_copy [-p positions] [-n repeats] [-r seed]\n");
+        return 2;
+    }
+
+    srand(seed);
+    BenchPosition *positions = malloc(positionCount * sizeof(BenchPosition));
+    if (positions == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    collect_positions(positions, positionCount);
+
+    printf("position     %4d bytes (%d per square)\n", (int) sizeof(positions[0].board), (int) sizeof(PackedSquare));
+    printf("RenderBoard  %4d bytes, drawn with the position but never copied by the rules\n\n", (int) sizeof(RenderBoard));
+
+    volatile int sink = 0;
+    PackedSquare copy[BOARD_SIZE][BOARD_SIZE];
+
+    //Copies, many per position so the timer overhead does not count
+    long copies = 0;
+    double start = now_seconds();
+    for (int repeat = 0; repeat < repeats * 100; repeat++) {
+        for (int index = 0; index < positionCount; index++) {
+            copy_board(positions[index].board, copy);
+            sink += copy[index % BOARD_SIZE][repeat % BOARD_SIZE];
+            copies++;
+        }
+    }
+    double copySeconds = now_seconds() - start;
+
+    //Every start square of the side to move and every end square, as highlight_valid_moves asks
+    long checks = 0;
+    start = now_seconds();
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int index = 0; index < positionCount; index++) {
+            BenchPosition *position = &positions[index];
+            for (int startSquare = 0; startSquare < BOARD_SIZE * BOARD_SIZE; startSquare++) {
+                PackedSquare square = position->board[MOVE_Y(startSquare)][MOVE_X(startSquare)];
+                if (PACKED_PIECE_ID(square) == EMPTY_SQUARE || PACKED_COLOUR(square) != position->currentTurn) {
+                    continue;
+                }
+                for (int endSquare = 0; endSquare < BOARD_SIZE * BOARD_SIZE; endSquare++) {
+                    sink += is_valid_move(position->board, MOVE_X(startSquare), MOVE_Y(startSquare), MOVE_X(endSquare), MOVE_Y(endSquare), position->currentTurn);
+                    checks++;
+                }
+            }
+        }
+    }
+    double checkSeconds = now_seconds() - start;
+
+    long mates = 0;
+    start = now_seconds();
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int index = 0; index < positionCount; index++) {
+            sink += is_checkmate(positions[index].board, positions[index].currentTurn);
+            mates++;
+        }
+    }
+    double mateSeconds = now_seconds() - start;
+
+    printf("copy_board     %10.1f ns\n", copySeconds * 1e9 / copies);
+    printf("is_valid_move  %10.1f ns\n", checkSeconds * 1e9 / checks);
+    printf("is_checkmate   %10.1f ns\n", mateSeconds * 1e9 / mates);
+
+    free(positions);
+    return 0;
+}
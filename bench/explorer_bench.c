@@ -0,0 +1,293 @@
+/*
+Explorer file lookups: checks a file against the games it was built from and times them.
+
+Replays the first games of a PGN file with the rules of the board (san.c) and looks up
+every position they reach in an explorer file mapped into memory (explorer_host.c). The
+move each game played must be among the moves found, with at least one game. The games
+of the moves from the starting position are shown beside the games in the file: about as
+many for games that start there, a few more as a game can come back to it (Nf3 Nf6 Ng1
+Ng8). Then every position looked up, and as many random keys that are not in the file,
+are looked up again and timed one by one.
+
+Build: gcc -O2 -I. bench/explorer_bench.c explorer.c explorer_host.c pgn.c san.c fen.c chess.c -o explorer_bench
+Usage: explorer_bench [-n games] [-p plies] [-r repeats] explorer.db games.pgn
+  -n  games of the PGN file replayed, 1000 by default
+  -p  plies of every game looked up, 40 by default, no more than the file was built with
+  -r  times every key is looked up again for the timing, 20 by default
+*/
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chess.h"
+#include "explorer.h"
+#include "fen.h"
+#include "pgn.h"
+#include "san.h"
+
+
+// Most positions the benchmark looks up
+#define MAX_SAMPLES (1 << 18)
+
+// Defaults of the options
+#define DEFAULT_GAMES 1000
+#define DEFAULT_PLIES 40
+#define DEFAULT_REPEATS 20
+
+// Moves a timed lookup asks for, as many as the lines beside the board show
+#define SHOWN_MOVES 4
+
+
+//Sample holds a position reached in a game and the move played from it
+typedef struct Sample
+{
+    uint64_t key;
+    Move move;
+} Sample;
+
+
+//Lookup times of a set of keys
+typedef struct LookupTimes
+{
+    long long lookups;
+    long long found;
+    double totalSeconds;
+    double maxSeconds;
+} LookupTimes;
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Adds the positions of a game and the moves played from them to the samples, up to plies of them
+//Returns false if the game has a position or move the rules do not allow, the positions before it are kept
+static bool sample_game(PgnReader *reader, const PgnGame *game, int plies, Sample *samples, int *sampleCount) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn = WHITE_PIECE;
+    bool valid = true;
+
+    //A game may start from a set up position, the tag is copied to terminate it
+    PgnSlice fenTag;
+    FenState state;
+    char fen[FEN_MAX_SIZE * 2];
+    if (pgn_tag(game, "FEN", &fenTag) && fenTag.length < (int) sizeof(fen)) {
+        memcpy(fen, fenTag.text, fenTag.length);
+        fen[fenTag.length] = '\0';
+        valid = fen_load(fen, board, &state);
+        currentTurn = state.currentTurn;
+    } else {
+        init_board(board);
+    }
+
+    uint64_t key = explorer_key(board, currentTurn);
+    int ply = 0;
+    PgnSlice text;
+    while (pgn_next_move(reader, &text)) {
+
+        //The rest of the moves are only read past, to reach the next game
+        if (!valid || ply >= plies || *sampleCount >= MAX_SAMPLES) {
+            continue;
+        }
+
+        SanMove move;
+        if (san_resolve(board, currentTurn, text.text, text.length, &move) != SAN_OK) {
+            valid = false;
+            continue;
+        }
+
+        Sample *sample = &samples[(*sampleCount)++];
+        sample->key = key;
+        sample->move.start = MOVE_SQUARE(move.xCoordStart, move.yCoordStart);
+        sample->move.end = MOVE_SQUARE(move.xCoordEnd, move.yCoordEnd);
+
+        key = explorer_key_after(key, board, sample->move);
+        move_piece(board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd);
+        switch_turns(&currentTurn);
+        ply++;
+    }
+    return valid;
+}
+
+//Checks that the move of every sample is found in the explorer with at least one game
+//Returns the number of samples whose move is missing
+static int check_samples(const Explorer *explorer, const Sample *samples, int sampleCount) {
+
+    static ExplorerMove moves[MAX_MOVES];
+    int missing = 0;
+
+    for (int index = 0; index < sampleCount; index++) {
+
+        int count = explorer_lookup(explorer, samples[index].key, moves, MAX_MOVES);
+        bool found = false;
+        for (int move = 0; move < count && !found; move++) {
+            found = moves[move].move.start == samples[index].move.start && moves[move].move.end == samples[index].move.end
+                && moves[move].games > 0;
+        }
+
+        if (!found) {
+            if (missing < 5) {
+                printf("  missing: sample %d, key %016llx, move %c%c%c%c\n", index, (unsigned long long) samples[index].key,
+                    'a' + MOVE_X(samples[index].move.start), '8' - MOVE_Y(samples[index].move.start),
+                    'a' + MOVE_X(samples[index].move.end), '8' - MOVE_Y(samples[index].move.end));
+            }
+            missing++;
+        }
+    }
+    return missing;
+}
+
+//Looks up every key repeats times, timing each lookup
+static LookupTimes time_lookups(const Explorer *explorer, const uint64_t *keys, int keyCount, int repeats) {
+
+    ExplorerMove moves[SHOWN_MOVES];
+    LookupTimes times = {0, 0, 0, 0};
+
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int index = 0; index < keyCount; index++) {
+
+            double start = now_seconds();
+            int count = explorer_lookup(explorer, keys[index], moves, SHOWN_MOVES);
+            double elapsed = now_seconds() - start;
+
+            times.lookups++;
+            times.found += count > 0;
+            times.totalSeconds += elapsed;
+            times.maxSeconds = elapsed > times.maxSeconds ? elapsed : times.maxSeconds;
+        }
+    }
+    return times;
+}
+
+//Prints the lookup times of a set of keys
+static void print_times(const char *name, const LookupTimes *times) {
+
+    double average = times->lookups > 0 ? times->totalSeconds / times->lookups : 0;
+    printf("%-8s %10lld %10lld %10.2f %10.2f %12.0f\n", name, times->lookups, times->found, average * 1e6, times->maxSeconds * 1e6,
+        average > 0 ? 1 / average : 0);
+}
+
+int main(int argc, char **argv) {
+
+    int gameLimit = DEFAULT_GAMES;
+    int plies = DEFAULT_PLIES;
+    int repeats = DEFAULT_REPEATS;
+    const char *explorerPath = NULL;
+    const char *pgnPath = NULL;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-n") == 0 && argument + 1 < argc) {
+            gameLimit = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-p") == 0 && argument + 1 < argc) {
+            plies = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-r") == 0 && argument + 1 < argc) {
+            repeats = atoi(argv[++argument]);
+        } else if (argv[argument][0] != '-' && explorerPath == NULL) {
+            explorerPath = argv[argument];
+        } else if (argv[argument][0] != '-' && pgnPath == NULL) {
+            pgnPath = argv[argument];
+        } else {
+            explorerPath = NULL;
+            break;
+        }
+    }
+    if (explorerPath == NULL || pgnPath == NULL) {
+        fprintf(stderr, "usage: explorer_bench [-n games] [-p plies] [-r repeats] explorer.db games.pgn\n");
+        return 2;
+    }
+    if (repeats < 1) repeats = 1;
+
+    static Explorer explorer;
+    if (!explorer_host_map(&explorer, explorerPath)) {
+        fprintf(stderr, "%s: not an explorer file\n", explorerPath);
+        return 2;
+    }
+    const ExplorerHeader *header = &explorer.header;
+    printf("%s: %llu positions, %llu moves, %llu games, %u blocks, %zu bytes\n", explorerPath,
+        (unsigned long long) header->positionCount, (unsigned long long) header->recordCount,
+        (unsigned long long) header->gameCount, header->blockCount, explorer.size);
+
+    int file = open(pgnPath, O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) < 0) {
+        perror(pgnPath);
+        return 2;
+    }
+
+    //An empty file can not be mapped and holds no games
+    size_t size = (size_t) status.st_size;
+    const char *text = "";
+    if (size > 0) {
+        text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (text == MAP_FAILED) {
+            perror(pgnPath);
+            return 2;
+        }
+    }
+    close(file);
+
+    //Positions of the first games
+    static Sample samples[MAX_SAMPLES];
+    int sampleCount = 0;
+    int games = 0;
+    int invalidGames = 0;
+
+    PgnReader reader;
+    pgn_reader_init(&reader, text, text + size);
+    const PgnGame *game;
+    while (games < gameLimit && (game = pgn_next_game(&reader)) != NULL) {
+        invalidGames += !sample_game(&reader, game, plies, samples, &sampleCount);
+        games++;
+    }
+    printf("%s: %d games, %d stopped at a move the rules do not allow, %d positions\n", pgnPath, games, invalidGames, sampleCount);
+
+    //Every move played must be in the file
+    int missing = check_samples(&explorer, samples, sampleCount);
+    printf("moves found: %d of %d\n", sampleCount - missing, sampleCount);
+
+    //Games that start there all count once, games that come back to it count again
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    init_board(board);
+    static ExplorerMove moves[MAX_MOVES];
+    int count = explorer_lookup(&explorer, explorer_key(board, WHITE_PIECE), moves, MAX_MOVES);
+    unsigned long long startGames = 0;
+    for (int move = 0; move < count; move++) {
+        startGames += moves[move].games;
+    }
+    printf("games from the starting position: %llu, games in the file: %llu\n", startGames, (unsigned long long) header->gameCount);
+
+    //Keys in the file, then random keys that are almost surely not in it
+    static uint64_t keys[MAX_SAMPLES];
+    for (int index = 0; index < sampleCount; index++) {
+        keys[index] = samples[index].key;
+    }
+    LookupTimes present = time_lookups(&explorer, keys, sampleCount, repeats);
+
+    uint64_t random = 0x2545f4914f6cdd1dull;
+    for (int index = 0; index < sampleCount; index++) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        keys[index] = random;
+    }
+    LookupTimes absent = time_lookups(&explorer, keys, sampleCount, repeats);
+
+    printf("\n%-8s %10s %10s %10s %10s %12s\n", "keys", "lookups", "found", "avg us", "max us", "lookups/s");
+    print_times("present", &present);
+    print_times("absent", &absent);
+
+    explorer_host_unmap(&explorer);
+    return missing > 0 ? 1 : 0;
+}
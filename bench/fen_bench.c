@@ -0,0 +1,142 @@
+/*
+FEN load and write throughput.
+
+Loads every position into a board, writes it back and checks the text comes out the
+same, then times both directions. Positions come from an EPD or FEN file with one
+position per line, or from a built in set. A built in set of malformed strings must all
+be rejected.
+
+Build: gcc -O2 -I. bench/fen_bench.c fen.c chess.c -o fen_bench
+Usage: fen_bench [-n repeats] [positions.epd]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chess.h"
+#include "fen.h"
+
+
+// Most positions read from a file
+#define MAX_POSITIONS 4096
+
+// Repeats of the whole set when not given
+#define DEFAULT_REPEATS 2000
+
+
+//Built in positions, all with every field so they write back the same
+static const char *BUILT_IN_POSITIONS[] = {
+    FEN_INITIAL_POSITION,
+    "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+static const int BUILT_IN_COUNT = sizeof(BUILT_IN_POSITIONS) / sizeof(BUILT_IN_POSITIONS[0]);
+
+//Built in strings that are not a FEN and must not load
+static const char *MALFORMED_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR wx KQkq - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w -x - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3x 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0x 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1x",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 99999999999 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 2147483648",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN w KQkq - 0 1",
+};
+static const int MALFORMED_COUNT = sizeof(MALFORMED_POSITIONS) / sizeof(MALFORMED_POSITIONS[0]);
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+
+    static char fileText[MAX_POSITIONS][FEN_MAX_SIZE * 2];
+    static const char *positions[MAX_POSITIONS];
+    int positionCount = 0;
+    int repeats = DEFAULT_REPEATS;
+    const char *path = NULL;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-n") == 0 && argument + 1 < argc) {
+            repeats = atoi(argv[++argument]);
+        } else {
+            path = argv[argument];
+        }
+    }
+
+    if (path != NULL) {
+        FILE *file = fopen(path, "r");
+        if (file == NULL) {
+            perror(path);
+            return 1;
+        }
+        while (positionCount < MAX_POSITIONS && fgets(fileText[positionCount], sizeof(fileText[0]), file) != NULL) {
+            positions[positionCount] = fileText[positionCount];
+            positionCount++;
+        }
+        fclose(file);
+    } else {
+        for (int index = 0; index < BUILT_IN_COUNT; index++) {
+            positions[positionCount++] = BUILT_IN_POSITIONS[index];
+        }
+    }
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    FenState state;
+    char text[FEN_MAX_SIZE];
+
+    //Every position must load, and the built in ones must write back unchanged
+    int failures = 0;
+    for (int index = 0; index < positionCount; index++) {
+        if (!fen_load(positions[index], board, &state)) {
+            printf("does not load: %s\n", positions[index]);
+            failures++;
+        } else if (path == NULL && (fen_write(board, &state, text, sizeof(text)) < 0 || strcmp(text, positions[index]) != 0)) {
+            printf("writes back as %s\n          not %s\n", text, positions[index]);
+            failures++;
+        }
+    }
+    for (int index = 0; index < MALFORMED_COUNT; index++) {
+        if (fen_load(MALFORMED_POSITIONS[index], board, &state)) {
+            printf("loads but is not a FEN: %s\n", MALFORMED_POSITIONS[index]);
+            failures++;
+        }
+    }
+
+    double start = now_seconds();
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int index = 0; index < positionCount; index++) {
+            fen_load(positions[index], board, &state);
+        }
+    }
+    double loadSeconds = now_seconds() - start;
+
+    start = now_seconds();
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int index = 0; index < positionCount; index++) {
+            fen_write(board, &state, text, sizeof(text));
+        }
+    }
+    double writeSeconds = now_seconds() - start;
+
+    long operations = (long) positionCount * repeats;
+    printf("%d positions and %d malformed strings, %d failed\n", positionCount, MALFORMED_COUNT, failures);
+    printf("load:  %10.0f positions/s, %.3f us each\n", operations / loadSeconds, loadSeconds * 1e6 / operations);
+    printf("write: %10.0f positions/s, %.3f us each\n", operations / writeSeconds, writeSeconds * 1e6 / operations);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+/*
+Frame time profiler for the board renderer.
+
+Draws frames with the host framebuffer backend and reports how the time of each frame
+splits between draw_squares, draw_pieces and the buffer swap. Every frame moves the
+selection outline and highlights the moves of the selected piece, the same work the
+game does while a player is choosing a move, and a short opening is played along the
+way so the piece layout changes.
+
+Build: gcc -O2 -I. bench/frame_profile.c chess.c draw.c raster.c framebuffer_host.c timer_host.c -o frame_profile
+Usage: frame_profile [frames] [last_frame.ppm]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "chess.h"
+#include "draw.h"
+#include "framebuffer.h"
+
+
+//Opening played during the run, as start and end squares (x, y) on the board array
+static const int OPENING[][4] = {
+    {4, 6, 4, 4}, {4, 1, 4, 3}, {6, 7, 5, 5}, {1, 0, 2, 2},
+    {5, 7, 2, 4}, {6, 0, 5, 2}, {3, 6, 3, 5}, {5, 0, 2, 3},
+};
+static const int OPENING_LENGTH = sizeof(OPENING) / sizeof(OPENING[0]);
+
+//Phases of a frame that are timed separately
+typedef enum FramePhase
+{
+    PHASE_SQUARES,
+    PHASE_PIECES,
+    PHASE_SWAP,
+    PHASE_COUNT
+} FramePhase;
+
+static const char *PHASE_NAMES[PHASE_COUNT] = { "draw_squares", "draw_pieces", "wait_for_vsync" };
+
+//Running statistics of one phase in nanoseconds
+typedef struct PhaseStats
+{
+    long long total;
+    long long min;
+    long long max;
+} PhaseStats;
+
+
+//Returns a monotonic timestamp in nanoseconds
+static long long now_nanoseconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (long long) time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+//Adds one sample to the statistics of a phase
+static void record_phase(PhaseStats *stats, long long elapsed) {
+
+    stats->total += elapsed;
+    if (elapsed < stats->min) stats->min = elapsed;
+    if (elapsed > stats->max) stats->max = elapsed;
+}
+
+//Sets the outline and highlights the way get_move does while a square is hovered
+static void prepare_frame(PackedSquare board[BOARD_SIZE][BOARD_SIZE], RenderBoard *render, int frame, int currentTurn) {
+
+    int square = frame % (BOARD_SIZE * BOARD_SIZE);
+    int xCoord = square % BOARD_SIZE;
+    int yCoord = square / BOARD_SIZE;
+
+    init_outlines(render);
+    init_highlights(render);
+    render->squares[yCoord][xCoord].outlined = true;
+
+    if (PACKED_PIECE_ID(board[yCoord][xCoord]) != EMPTY_SQUARE && PACKED_COLOUR(board[yCoord][xCoord]) == currentTurn) {
+        highlight_valid_moves(board, render, xCoord, yCoord, currentTurn);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    const char *ppmPath = argc > 2 ? argv[2] : NULL;
+
+    if (frames <= 0) {
+        fprintf(stderr, "usage: %s [frames] [last_frame.ppm]\n", argv[0]);
+        return 1;
+    }
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    RenderBoard render;
+    init_board(board);
+    init_render_board(&render);
+    set_pixel_buffer_addresses();
+
+    PhaseStats stats[PHASE_COUNT];
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        stats[phase].total = 0;
+        stats[phase].min = -1ULL >> 1;
+        stats[phase].max = 0;
+    }
+    PhaseStats frameStats = { 0, -1ULL >> 1, 0 };
+
+    int currentTurn = WHITE_PIECE;
+    int movesPlayed = 0;
+    int framesPerMove = frames / (OPENING_LENGTH + 1) + 1;
+
+    for (int frame = 0; frame < frames; frame++) {
+
+        //Play the next opening move every few frames
+        if (frame > 0 && frame % framesPerMove == 0 && movesPlayed < OPENING_LENGTH) {
+            const int *move = OPENING[movesPlayed++];
+            move_piece(board, move[0], move[1], move[2], move[3]);
+            switch_turns(&currentTurn);
+        }
+
+        prepare_frame(board, &render, frame, currentTurn);
+
+        //Same sequence of calls as draw_board, timed phase by phase
+        long long start = now_nanoseconds();
+        draw_squares(&render);
+        long long squaresDone = now_nanoseconds();
+        draw_pieces(board);
+        long long piecesDone = now_nanoseconds();
+        wait_for_vsync();
+        long long swapDone = now_nanoseconds();
+
+        record_phase(&stats[PHASE_SQUARES], squaresDone - start);
+        record_phase(&stats[PHASE_PIECES], piecesDone - squaresDone);
+        record_phase(&stats[PHASE_SWAP], swapDone - piecesDone);
+        record_phase(&frameStats, swapDone - start);
+    }
+
+    printf("%d frames, %d moves played\n\n", framebuffer_frame_count() - 1, movesPlayed);
+    printf("%-16s %10s %10s %10s %8s\n", "phase", "avg us", "min us", "max us", "share");
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        printf("%-16s %10.2f %10.2f %10.2f %7.1f%%\n", PHASE_NAMES[phase],
+               stats[phase].total / 1e3 / frames, stats[phase].min / 1e3, stats[phase].max / 1e3,
+               100.0 * stats[phase].total / frameStats.total);
+    }
+    printf("%-16s %10.2f %10.2f %10.2f %7.1f%%\n", "frame",
+           frameStats.total / 1e3 / frames, frameStats.min / 1e3, frameStats.max / 1e3, 100.0);
+    printf("\n%.0f frames/s\n", frames / (frameStats.total / 1e9));
+
+    if (ppmPath != NULL && !framebuffer_write_ppm(ppmPath)) {
+        fprintf(stderr, "could not write %s\n", ppmPath);
+        return 1;
+    }
+
+    return 0;
+}
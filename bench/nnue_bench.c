@@ -0,0 +1,252 @@
+/*
+Network evaluation throughput per kernel flavour, and agreement between the flavours.
+
+Plays random games to collect positions, then for every kernel flavour this build and
+processor can run (see nnue_kernel) times the three things the search asks of the network:
+scoring a position from its accumulator, updating the accumulator for a move, and
+summing it again from the whole board. eval.c is timed alongside for comparison.
+
+Every flavour must give the same accumulators and scores as plain C, bit for bit, and an
+accumulator updated move by move must equal one summed from the board after the move.
+The default network has random weights over the whole int16 range, so accumulators wrap
+around and clip at both ends; a network file can be given instead.
+
+Build: gcc -O2 -I. bench/nnue_bench.c nnue.c nnue_host.c movegen.c eval.c chess.c -o nnue_bench
+Usage: nnue_bench [-p positions] [-n repeats] [-r seed] [network.nnue]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chess.h"
+#include "eval.h"
+#include "movegen.h"
+#include "nnue.h"
+
+
+// Positions collected when not given
+#define DEFAULT_POSITIONS 4096
+
+// Repeats of the whole set when not given
+#define DEFAULT_REPEATS 200
+
+// Longest random game a position is taken from
+#define MAX_GAME_PLIES 120
+
+
+//A position, the side to move and a move to update its accumulator with
+typedef struct BenchPosition
+{
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+    Move move;
+} BenchPosition;
+
+
+//The network is too big for the stack
+static NnueNetwork network;
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Returns a random int16, every value as likely
+static int16_t random_int16() {
+    return (int16_t) (rand() & 0xffff);
+}
+
+//Fills the network with random weights over the whole int16 range
+static void make_random_network() {
+
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        network.featureBias[index] = random_int16();
+    }
+    for (int feature = 0; feature < NNUE_FEATURES; feature++) {
+        for (int index = 0; index < NNUE_HIDDEN; index++) {
+            network.featureWeights[feature][index] = random_int16();
+        }
+    }
+    for (int index = 0; index < NNUE_HIDDEN * 2; index++) {
+        network.outputWeights[index] = random_int16();
+    }
+    network.outputBias = rand() % 2001 - 1000;
+}
+
+//Fills positions from random games, every one with at least one move
+static void collect_positions(BenchPosition *positions, int count) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn = WHITE_PIECE;
+    int plies = MAX_GAME_PLIES;
+    Move moves[MAX_MOVES];
+
+    for (int index = 0; index < count; ) {
+
+        if (plies == MAX_GAME_PLIES) {
+            init_board(board);
+            currentTurn = WHITE_PIECE;
+            plies = 0;
+        }
+
+        int moveCount = generate_moves(board, currentTurn, moves);
+        if (moveCount == 0) {
+            plies = MAX_GAME_PLIES;
+            continue;
+        }
+
+        BenchPosition *position = &positions[index++];
+        copy_board(board, position->board);
+        position->currentTurn = currentTurn;
+        position->move = moves[rand() % moveCount];
+
+        make_move(board, position->move);
+        switch_turns(&currentTurn);
+        plies++;
+    }
+}
+
+int main(int argc, char **argv) {
+
+    int positionCount = DEFAULT_POSITIONS;
+    int repeats = DEFAULT_REPEATS;
+    unsigned int seed = 1;
+    const char *path = NULL;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-p") == 0 && argument + 1 < argc) {
+            positionCount = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-n") == 0 && argument + 1 < argc) {
+            repeats = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-r") == 0 && argument + 1 < argc) {
+            seed = (unsigned int) atoi(argv[++argument]);
+        } else {
+            path = argv[argument];
+        }
+    }
+    if (positionCount < 1 || repeats < 1) {
+        fprintf(stderr, "usage: nnue_bench [-p positions] [-n repeats] [-r seed] [network.nnue]\n");
+        return 2;
+    }
+
+    srand(seed);
+    if (path != NULL) {
+        if (!nnue_host_load(&network, path)) {
+            fprintf(stderr, "%s: not a network\n", path);
+            return 1;
+        }
+    } else {
+        make_random_network();
+    }
+
+    BenchPosition *positions = malloc(positionCount * sizeof(BenchPosition));
+    NnueAccumulator *before = malloc(positionCount * sizeof(NnueAccumulator));
+    NnueAccumulator *after = malloc(positionCount * sizeof(NnueAccumulator));
+    int *scores = malloc(positionCount * sizeof(int));
+    if (positions == NULL || before == NULL || after == NULL || scores == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    collect_positions(positions, positionCount);
+
+    //Plain C gives the answers every flavour must match: the accumulators before and after
+    //each position's move, both summed from the board, and the score
+    network.kernels = nnue_kernel(0);
+    for (int index = 0; index < positionCount; index++) {
+        BenchPosition *position = &positions[index];
+        nnue_refresh(&network, position->board, &before[index]);
+        scores[index] = nnue_evaluate(&network, &before[index], position->currentTurn);
+
+        MoveUndo undo = make_move(position->board, position->move);
+        nnue_refresh(&network, position->board, &after[index]);
+        unmake_move(position->board, position->move, undo);
+    }
+
+    long operations = (long) positionCount * repeats;
+    volatile int sink = 0;
+    printf("%d positions, %d repeats, %s network\n\n", positionCount, repeats, path != NULL ? path : "random");
+    printf("kernel        evals/s   updates/s  refreshes/s  evals vs scalar  bit-exact\n");
+
+    //eval.c has no accumulator, only its scoring compares
+    double start = now_seconds();
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int index = 0; index < positionCount; index++) {
+            sink += evaluate(positions[index].board, positions[index].currentTurn);
+        }
+    }
+    printf("%-8s %12.0f %11s %12s %16s %10s\n", "eval.c", operations / (now_seconds() - start), "-", "-", "-", "-");
+
+    double scalarEvaluateSeconds = 0;
+    int failures = 0;
+    for (int kernel = 0; kernel < nnue_kernel_count(); kernel++) {
+
+        network.kernels = nnue_kernel(kernel);
+        NnueAccumulator accumulator;
+        NnueAccumulator next;
+
+        //Agreement with plain C, and of updates with summing the board again
+        int mismatches = 0;
+        for (int index = 0; index < positionCount; index++) {
+            BenchPosition *position = &positions[index];
+            nnue_refresh(&network, position->board, &accumulator);
+            nnue_update(&network, &accumulator, &next, position->board, position->move);
+            if (memcmp(&accumulator, &before[index], sizeof(accumulator)) != 0
+                || memcmp(&next, &after[index], sizeof(next)) != 0
+                || nnue_evaluate(&network, &accumulator, position->currentTurn) != scores[index]) {
+                mismatches++;
+            }
+        }
+        failures += mismatches;
+
+        start = now_seconds();
+        for (int repeat = 0; repeat < repeats; repeat++) {
+            for (int index = 0; index < positionCount; index++) {
+                sink += nnue_evaluate(&network, &before[index], positions[index].currentTurn);
+            }
+        }
+        double evaluateSeconds = now_seconds() - start;
+        if (kernel == 0) {
+            scalarEvaluateSeconds = evaluateSeconds;
+        }
+
+        start = now_seconds();
+        for (int repeat = 0; repeat < repeats; repeat++) {
+            for (int index = 0; index < positionCount; index++) {
+                nnue_update(&network, &before[index], &next, positions[index].board, positions[index].move);
+                sink += next.values[0][0];
+            }
+        }
+        double updateSeconds = now_seconds() - start;
+
+        //Summing the board is far slower, a tenth of the repeats is enough
+        int refreshRepeats = repeats / 10 > 0 ? repeats / 10 : 1;
+        start = now_seconds();
+        for (int repeat = 0; repeat < refreshRepeats; repeat++) {
+            for (int index = 0; index < positionCount; index++) {
+                nnue_refresh(&network, positions[index].board, &accumulator);
+                sink += accumulator.values[0][0];
+            }
+        }
+        double refreshSeconds = now_seconds() - start;
+
+        char speedup[16];
+        snprintf(speedup, sizeof(speedup), "%.2fx", scalarEvaluateSeconds / evaluateSeconds);
+        printf("%-8s %12.0f %11.0f %12.0f %16s %10s\n", network.kernels->name, operations / evaluateSeconds, operations / updateSeconds,
+               (double) positionCount * refreshRepeats / refreshSeconds, speedup, mismatches == 0 ? "yes" : "NO");
+        if (mismatches > 0) {
+            printf("         %d of %d positions differ from plain C\n", mismatches, positionCount);
+        }
+    }
+
+    free(positions);
+    free(before);
+    free(after);
+    free(scores);
+    return failures > 0 ? 1 : 0;
+}
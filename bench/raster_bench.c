@@ -0,0 +1,145 @@
+/*
+Pixel throughput benchmark for the integer rasterizer.
+
+Runs on the host against an in-memory buffer laid out like the DE1-SoC pixel
+buffer (512 pixel stride, 320x240 visible) and reports megapixels per second
+for every primitive. The pow() based disc the game used to draw is included
+as a baseline.
+
+Build: gcc -O2 -I. bench/raster_bench.c raster.c -lm -o raster_bench
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "raster.h"
+
+
+#define BUFFER_STRIDE 512
+#define BUFFER_ROWS   256
+
+static short int pixelBuffer[BUFFER_STRIDE * BUFFER_ROWS];
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Counts the pixels a primitive touched by drawing it once into a cleared buffer
+static long count_pixels(const RasterTarget *target) {
+
+    long count = 0;
+    for (int yCoord = 0; yCoord < target->height; yCoord++) {
+        for (int xCoord = 0; xCoord < target->width; xCoord++) {
+            if (target->pixels[yCoord * target->stride + xCoord] != 0) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+//Clears the visible part of the buffer
+static void clear_target(const RasterTarget *target) {
+    raster_fill_rect(target, 0, 0, target->width, target->height, 0);
+}
+
+//Reference disc from the original game, three pow() calls per pixel of the bounding box
+static void legacy_pow_circle(const RasterTarget *target, int xPixelCoord, int yPixelCoord, int radius, short int colour) {
+
+    for (int xCoord = xPixelCoord - radius; xCoord < xPixelCoord + radius; xCoord++) {
+        for (int yCoord = yPixelCoord - radius; yCoord < yPixelCoord + radius; yCoord++) {
+            if (pow(xCoord - xPixelCoord, 2) + pow(yCoord - yPixelCoord, 2) <= pow(radius, 2)) {
+                target->pixels[yCoord * target->stride + xCoord] = colour;
+            }
+        }
+    }
+}
+
+typedef enum Primitive
+{
+    PRIMITIVE_RECT,
+    PRIMITIVE_CIRCLE,
+    PRIMITIVE_DISC,
+    PRIMITIVE_LINE,
+    PRIMITIVE_POLYGON,
+    PRIMITIVE_LEGACY_DISC,
+    PRIMITIVE_COUNT
+} Primitive;
+
+static const char *PRIMITIVE_NAMES[PRIMITIVE_COUNT] = {
+    "rect 30x30", "circle r=12", "disc r=12", "line 300px", "polygon quad", "legacy pow disc r=12"
+};
+
+//Draws one instance of a primitive, shifted by iteration so the work is not hoisted
+static void draw_primitive(const RasterTarget *target, Primitive primitive, int iteration) {
+
+    short int colour = (short int) (iteration | 1);
+    int shift = iteration & 7;
+
+    int xCoords[4] = { 100 + shift, 140 + shift, 120 + shift, 90 + shift };
+    int yCoords[4] = { 60, 80, 140, 110 };
+
+    switch (primitive) {
+        case PRIMITIVE_RECT:
+            raster_fill_rect(target, 30 + shift, 30, 30, 30, colour);
+            break;
+        case PRIMITIVE_CIRCLE:
+            raster_circle(target, 100 + shift, 100, 12, colour);
+            break;
+        case PRIMITIVE_DISC:
+            raster_fill_circle(target, 100 + shift, 100, 12, colour);
+            break;
+        case PRIMITIVE_LINE:
+            raster_line(target, 10, 10 + shift, 310, 200, colour);
+            break;
+        case PRIMITIVE_POLYGON:
+            raster_fill_convex_polygon(target, xCoords, yCoords, 4, colour);
+            break;
+        case PRIMITIVE_LEGACY_DISC:
+            legacy_pow_circle(target, 100 + shift, 100, 12, colour);
+            break;
+        default:
+            break;
+    }
+}
+
+int main(void) {
+
+    RasterTarget target = { pixelBuffer, BUFFER_STRIDE, 320, 240 };
+    const double MIN_SECONDS = 0.25;
+
+    printf("%-22s %12s %12s %14s\n", "primitive", "px/call", "ns/call", "Mpixel/s");
+
+    for (int primitive = 0; primitive < PRIMITIVE_COUNT; primitive++) {
+
+        //Measure the pixel count of a single call
+        clear_target(&target);
+        draw_primitive(&target, (Primitive) primitive, 0);
+        long pixelsPerCall = count_pixels(&target);
+
+        //Double the iteration count until the run is long enough to time
+        long iterations = 64;
+        double elapsed = 0;
+        while (1) {
+            double start = now_seconds();
+            for (long iteration = 0; iteration < iterations; iteration++) {
+                draw_primitive(&target, (Primitive) primitive, (int) iteration);
+            }
+            elapsed = now_seconds() - start;
+            if (elapsed >= MIN_SECONDS) break;
+            iterations *= 2;
+        }
+
+        double nsPerCall = elapsed * 1e9 / iterations;
+        double megapixels = (double) pixelsPerCall * iterations / elapsed / 1e6;
+        printf("%-22s %12ld %12.1f %14.1f\n", PRIMITIVE_NAMES[primitive], pixelsPerCall, nsPerCall, megapixels);
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+Rules engine throughput from replaying game records as fast as possible.
+
+Every move of a record is checked with is_valid_move, played with move_piece and
+followed by the game over and check tests the game makes at the start of each turn,
+so the moves per second reflect the rules work of real games rather than of a
+synthetic position. Records saved by the board or by tools/sim can be given as
+arguments; without any, two built in games are replayed.
+
+Build: gcc -O2 -I. bench/replay_bench.c record.c record_host.c chess.c -o replay_bench
+Usage: replay_bench [-n repeats] [game.rec ...]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chess.h"
+#include "record.h"
+
+
+// Most records the benchmark replays
+#define MAX_RECORDS 64
+
+// Repeats of every record when not given
+#define DEFAULT_REPEATS 200
+
+
+//Built in games in coordinate notation
+static const char *BUILT_IN_GAMES[] = {
+    //Scholar's mate
+    "e2e4 e7e5 f1c4 b8c6 d1h5 g8f6 h5f7",
+
+    //120 plies of random legal moves, long enough to spend most of its time in the middle game
+    "b2b3 b7b6 f2f4 h7h5 e2e4 e7e5 d2d4 d8g5 d1h5 f8d6 c1d2 g8h6 d2a5 d6f8 g1f3 c8b7 h2h4 h6g4 h4g5 d7d5 "
+    "h1g1 f8c5 e1d2 e8d7 c2c3 h8f8 f3h2 b6a5 f1d3 c7c6 g1d1 g4f2 a2a4 b8a6 c3c4 f8e8 d1e1 c5d6 h5f3 d7e6 "
+    "h2f1 f2g4 d2e2 b7c8 b1c3 e6d7 d3c2 d6b8 f1g3 b8c7 f3g4 d7d8 g4f3 d8e7 e1b1 f7f5 c2d3 g7g6 e4f5 g6f5 "
+    "c4c5 a6b8 e2f1 c8d7 d3e2 e8f8 f3h5 c7d8 b1b2 d8c7 h5f3 e5f4 f3e4 e7f7 f1f2 c7d6 a1b1 d6e7 b1d1 e7c5 "
+    "f2e3 b8a6 e4b1 a8b8 d1g1 b8b5 g1c1 f4g3 e3f3 c5d4 c1e1 a6c5 b2c2 d7e6 e2f1 d4h8 c2a2 h8d4 c3d5 e6d7 "
+    "b1d3 f8e8 a2d2 c5a6 d2d1 b5c5 d5c7 d4f2 d3b5 e8a8 e1e6 d7e8 d1d5 c5b5 b3b4 a8c8 g5g6 f7g7 f3f4 f2g1",
+};
+static const int BUILT_IN_GAME_COUNT = sizeof(BUILT_IN_GAMES) / sizeof(BUILT_IN_GAMES[0]);
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Fills a record from moves in coordinate notation, e.g. "e2e4 e7e5"
+//Rank 1 is the bottom row of the board, yCoord 7
+static void record_from_text(GameRecord *record, const char *moves) {
+
+    record_init(record, false);
+
+    for (const char *move = moves; strlen(move) >= 4; move += 4) {
+        while (*move == ' ') move++;
+        record_add_move(record, move[0] - 'a', '8' - move[1], move[2] - 'a', '8' - move[3], 0);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    static GameRecord records[MAX_RECORDS];
+    static const char *names[MAX_RECORDS];
+    int recordCount = 0;
+    int repeats = DEFAULT_REPEATS;
+
+    for (int argument = 1; argument < argc && recordCount < MAX_RECORDS; argument++) {
+        if (strcmp(argv[argument], "-n") == 0 && argument + 1 < argc) {
+            repeats = atoi(argv[++argument]);
+        } else if (record_host_load(&records[recordCount], argv[argument])) {
+            names[recordCount++] = argv[argument];
+        } else {
+            fprintf(stderr, "%s: not a game record\n", argv[argument]);
+            return 1;
+        }
+    }
+
+    if (recordCount == 0) {
+        for (int game = 0; game < BUILT_IN_GAME_COUNT; game++) {
+            record_from_text(&records[recordCount], BUILT_IN_GAMES[game]);
+            names[recordCount++] = game == 0 ? "scholar's mate" : "random game";
+        }
+    }
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    long totalMoves = 0;
+    double totalSeconds = 0;
+
+    printf("%-24s %7s %10s %12s %10s\n", "record", "moves", "replayed", "moves/s", "us/move");
+
+    for (int index = 0; index < recordCount; index++) {
+
+        //Replays once to check the record before timing it
+        int played = record_replay(&records[index], board);
+
+        double start = now_seconds();
+        for (int repeat = 0; repeat < repeats; repeat++) {
+            record_replay(&records[index], board);
+        }
+        double elapsed = now_seconds() - start;
+
+        long moves = (long) played * repeats;
+        totalMoves += moves;
+        totalSeconds += elapsed;
+
+        printf("%-24s %7d %10d %12.0f %10.2f\n", names[index], record_move_count(&records[index]), played,
+            moves / elapsed, elapsed * 1e6 / moves);
+    }
+
+    printf("total: %ld moves in %.3f s, %.0f moves/s\n", totalMoves, totalSeconds, totalMoves / totalSeconds);
+    return 0;
+}
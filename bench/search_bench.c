@@ -0,0 +1,206 @@
+/*
+Time to depth of the search with each selective part on and off.
+
+Searches every position of a fixed suite to the same depth with the selective parts of
+the search (null move, reductions, futility, reverse futility, check extensions) all off,
+each one on by itself, all on, and all on but one, and reports the nodes and time each
+set of options took. Every search starts from empty tables so the runs do not depend on
+each other.
+
+A selective search reaching a depth sooner is only worth it if it still finds the moves,
+so the moves chosen are compared with the full width search at the same depth as a quick
+check. What it does to the games is measured with tournament on the same suite:
+  tournament -o bench/positions.epd -t 100 -A <options> -B <options>
+
+Build: gcc -O2 -I. bench/search_bench.c search.c movegen.c eval.c nnue.c fen.c chess.c timer_host.c -o search_bench
+Usage: search_bench [-d depth] [positions.epd]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chess.h"
+#include "fen.h"
+#include "search.h"
+#include "timer.h"
+
+
+// Most positions read from the suite
+#define MAX_POSITIONS 1024
+
+// Depth searched when not given
+#define DEFAULT_DEPTH 6
+
+// The selective parts of the search, as named in SearchOptions
+#define SELECTIVE_PARTS 5
+
+
+//A position of the suite
+typedef struct Position
+{
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+} Position;
+
+//What one set of options found on the whole suite
+typedef struct Result
+{
+    char name[48];
+    long long nodes;
+    double microseconds;
+    Move bestMoves[MAX_POSITIONS];
+} Result;
+
+
+static const char *PART_NAMES[SELECTIVE_PARTS] = {"null move", "reductions", "futility", "reverse futility", "check extensions"};
+
+static Position positions[MAX_POSITIONS];
+static int positionCount = 0;
+static Search search;
+
+
+//Returns a monotonic timestamp in microseconds
+static double now_microseconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1e6 + time.tv_nsec / 1e3;
+}
+
+//Turns the selective parts on or off, one bit each in the order of PART_NAMES
+static void set_parts(SearchOptions *options, int parts) {
+
+    search_options_init(options);
+    options->nullMove = (parts & 1) != 0;
+    options->reductions = (parts & 2) != 0;
+    options->futility = (parts & 4) != 0;
+    options->reverseFutility = (parts & 8) != 0;
+    options->checkExtensions = (parts & 16) != 0;
+}
+
+//Reads the suite, one FEN per line, blank lines and lines starting with # are skipped
+//Returns false if the file can not be read or holds a line that is not a position
+static bool load_positions(const char *path) {
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != NULL && positionCount < MAX_POSITIONS) {
+
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+
+        FenState state;
+        Position *position = &positions[positionCount];
+        if (!fen_load(line, position->board, &state)) {
+            fprintf(stderr, "%s:%d: not a FEN\n", path, lineNumber);
+            fclose(file);
+            return false;
+        }
+        position->currentTurn = state.currentTurn;
+        positionCount++;
+    }
+
+    fclose(file);
+    return positionCount > 0;
+}
+
+//Searches every position to depth with the options, keeping the nodes, time and moves
+static void run(Result *result, const SearchOptions *options, int depth) {
+
+    SearchLimits limits = {depth, 0, 0};
+    result->nodes = 0;
+    result->microseconds = 0;
+
+    for (int index = 0; index < positionCount; index++) {
+
+        search_init(&search, options);
+        double start = now_microseconds();
+        search_start(&search, positions[index].board, positions[index].currentTurn, &limits);
+        search_run(&search);
+        result->microseconds += now_microseconds() - start;
+
+        result->nodes += search.stats.nodes;
+        result->bestMoves[index] = search.bestMove;
+    }
+}
+
+//Prints a result next to the full width search
+static void print_result(const Result *result, const Result *fullWidth) {
+
+    int sameMoves = 0;
+    for (int index = 0; index < positionCount; index++) {
+        sameMoves += result->bestMoves[index].start == fullWidth->bestMoves[index].start
+            && result->bestMoves[index].end == fullWidth->bestMoves[index].end;
+    }
+
+    printf("%-34s %12lld %10.1f %8.2fx %6d/%d\n", result->name, result->nodes, result->microseconds / 1000,
+        fullWidth->microseconds / result->microseconds, sameMoves, positionCount);
+}
+
+int main(int argc, char **argv) {
+
+    int depth = DEFAULT_DEPTH;
+    const char *path = "bench/positions.epd";
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-d") == 0 && argument + 1 < argc) {
+            depth = atoi(argv[++argument]);
+        } else if (argv[argument][0] != '-') {
+            path = argv[argument];
+        } else {
+            depth = 0;
+        }
+    }
+    if (depth < 1 || depth >= SEARCH_MAX_DEPTH) {
+        fprintf(stderr, "usage: search_bench [-d depth] [positions.epd]\n");
+        return 2;
+    }
+    if (!load_positions(path)) {
+        return 2;
+    }
+
+    timer_init();
+    printf("%d positions from %s searched to depth %d\n\n", positionCount, path, depth);
+    printf("%-34s %12s %10s %9s %8s\n", "options", "nodes", "ms", "speedup", "moves");
+
+    static Result fullWidth;
+    static Result result;
+    SearchOptions options;
+    int allParts = (1 << SELECTIVE_PARTS) - 1;
+
+    set_parts(&options, 0);
+    strcpy(fullWidth.name, "none");
+    run(&fullWidth, &options, depth);
+    print_result(&fullWidth, &fullWidth);
+
+    for (int part = 0; part < SELECTIVE_PARTS; part++) {
+        set_parts(&options, 1 << part);
+        snprintf(result.name, sizeof(result.name), "%s only", PART_NAMES[part]);
+        run(&result, &options, depth);
+        print_result(&result, &fullWidth);
+    }
+
+    set_parts(&options, allParts);
+    strcpy(result.name, "all");
+    run(&result, &options, depth);
+    print_result(&result, &fullWidth);
+
+    for (int part = 0; part < SELECTIVE_PARTS; part++) {
+        set_parts(&options, allParts & ~(1 << part));
+        snprintf(result.name, sizeof(result.name), "all but %s", PART_NAMES[part]);
+        run(&result, &options, depth);
+        print_result(&result, &fullWidth);
+    }
+
+    return 0;
+}
@@ -0,0 +1,518 @@
+/*
+Requests per second and latency of the game server as the number of games grows.
+
+Connects to a running server (tools/server.c) and, for every game count asked for, starts
+that many games and plays random legal moves in all of them at once for a few seconds.
+The games are shared out over the connections, and every connection keeps a window of
+requests in flight, each for a different game. A game that is over is ended and a new
+one started in its place, so the server keeps the same number of games throughout. The
+client keeps its own copy of every position to pick the moves, and checks the number of
+legal moves the server reports after every move against its own.
+
+Reports requests per second and the median, 99th percentile and longest time from
+writing a request to reading its reply, per game count. The client is one thread; on a
+machine with few cores it competes with the server for them.
+
+Build: gcc -O2 -pthread -I. bench/server_bench.c referee.c arena.c movegen.c chess.c -o server_bench
+Usage: server_bench [-c connections] [-w window] [-t seconds] [-g games,games,...] [-r seed] path | host:port
+*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "referee.h"
+
+
+// Connections when not given
+#define DEFAULT_CONNECTIONS 8
+
+// Requests in flight per connection when not given
+#define DEFAULT_WINDOW 16
+
+// Seconds every game count is played for when not given
+#define DEFAULT_SECONDS 3
+
+// Most connections, requests in flight per connection and game counts
+#define MAX_CONNECTIONS 256
+#define MAX_WINDOW 256
+#define MAX_GAME_COUNTS 16
+
+
+//What a game waits for next
+typedef enum ClientGameStep
+{
+    CLIENT_START,
+    CLIENT_PLAY,
+    CLIENT_END
+} ClientGameStep;
+
+
+//ClientGame holds the client's copy of one game
+typedef struct ClientGame
+{
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+    uint32_t id;
+    ClientGameStep step;
+
+    //The move in flight, applied when the server accepts it
+    Move move;
+} ClientGame;
+
+
+//InFlight holds a request waiting for its reply
+typedef struct InFlight
+{
+    int game;
+    int type;
+    double sent;
+} InFlight;
+
+
+//ClientConnection holds a socket, its games and its requests in flight
+typedef struct ClientConnection
+{
+    int fd;
+
+    //Games without a request in flight, oldest first
+    int *ready;
+    int readyStart;
+    int readyCount;
+    int gameCount;
+
+    //Requests in flight, in the order they were written
+    InFlight *inFlight;
+    int inFlightStart;
+    int inFlightCount;
+
+    unsigned char input[REFEREE_MESSAGE_SIZE * 64];
+    int inputUsed;
+} ClientConnection;
+
+
+//Results of one game count
+typedef struct RoundResult
+{
+    long requests;
+    long moves;
+    long gamesFinished;
+    long disagreements;
+    double seconds;
+
+    //Latency of every request, in microseconds
+    float *latencies;
+    long latencyCount;
+    long latencyCapacity;
+} RoundResult;
+
+
+static ClientGame *games;
+static ClientConnection connections[MAX_CONNECTIONS];
+static int connectionCount = DEFAULT_CONNECTIONS;
+static int window = DEFAULT_WINDOW;
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Connects to a Unix socket path, or to TCP for host:port
+//Returns the socket, or -1 with the reason printed
+static int connect_server(const char *address) {
+
+    const char *colon = strrchr(address, ':');
+    if (colon == NULL) {
+
+        struct sockaddr_un unixAddress;
+        if (strlen(address) >= sizeof(unixAddress.sun_path)) {
+            fprintf(stderr, "%s: socket path too long\n", address);
+            return -1;
+        }
+        memset(&unixAddress, 0, sizeof(unixAddress));
+        unixAddress.sun_family = AF_UNIX;
+        strcpy(unixAddress.sun_path, address);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || connect(fd, (struct sockaddr *) &unixAddress, sizeof(unixAddress)) != 0) {
+            perror(address);
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+        return fd;
+    }
+
+    char host[256];
+    int hostLength = (int) (colon - address);
+    if (hostLength == 0 || hostLength >= (int) sizeof(host)) {
+        fprintf(stderr, "%s: bad host name\n", address);
+        return -1;
+    }
+    memcpy(host, address, hostLength);
+    host[hostLength] = '\0';
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *addresses;
+    int error = getaddrinfo(host, colon + 1, &hints, &addresses);
+    if (error != 0) {
+        fprintf(stderr, "%s: %s\n", address, gai_strerror(error));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *candidate = addresses; candidate != NULL && fd < 0; candidate = candidate->ai_next) {
+        fd = socket(candidate->ai_family, candidate->ai_socktype | SOCK_CLOEXEC, candidate->ai_protocol);
+        if (fd >= 0 && connect(fd, candidate->ai_addr, candidate->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (fd < 0) {
+        perror(address);
+        return -1;
+    }
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+//Writes every byte, the window keeps it small enough that the server never has to wait for us
+//Returns false if the server is gone
+static bool write_all(int fd, const unsigned char *bytes, int length) {
+
+    while (length > 0) {
+        ssize_t written = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        length -= (int) written;
+    }
+    return true;
+}
+
+//Adds a game to the back of a connection's ready games
+static void push_ready(ClientConnection *connection, int game) {
+    connection->ready[(connection->readyStart + connection->readyCount++) % connection->gameCount] = game;
+}
+
+//Writes requests for ready games until the window is full
+//sending is false once the round is over, then only games that are over are ended
+//Returns false if the server is gone
+static bool send_requests(ClientConnection *connection, bool sending) {
+
+    unsigned char bytes[REFEREE_MESSAGE_SIZE * MAX_WINDOW];
+    int length = 0;
+    int waiting = connection->readyCount;
+    Move moves[MAX_MOVES];
+
+    for (; waiting > 0 && connection->inFlightCount < window; waiting--) {
+
+        int index = connection->ready[connection->readyStart];
+        connection->readyStart = (connection->readyStart + 1) % connection->gameCount;
+        connection->readyCount--;
+
+        ClientGame *game = &games[index];
+        RefereeRequest request = {0, 0, 0, game->id};
+        if (!sending && game->step != CLIENT_END) {
+            push_ready(connection, index);
+            continue;
+        }
+
+        if (game->step == CLIENT_START) {
+            request.type = REFEREE_NEW_GAME;
+        } else if (game->step == CLIENT_END) {
+            request.type = REFEREE_END_GAME;
+        } else {
+            //A game the server still calls open with no move here counts as a disagreement already
+            int moveCount = generate_moves(game->board, game->currentTurn, moves);
+            game->move = moveCount > 0 ? moves[rand() % moveCount] : (Move) {0, 0};
+            request.type = REFEREE_MOVE;
+            request.start = game->move.start;
+            request.end = game->move.end;
+        }
+        referee_write_request(&request, bytes + length);
+        length += REFEREE_MESSAGE_SIZE;
+
+        InFlight *slot = &connection->inFlight[(connection->inFlightStart + connection->inFlightCount++) % window];
+        slot->game = index;
+        slot->type = request.type;
+    }
+
+    //Every request of a batch leaves at once, they are timed from then
+    double sent = now_seconds();
+    for (int batch = connection->inFlightCount - length / REFEREE_MESSAGE_SIZE; batch < connection->inFlightCount; batch++) {
+        connection->inFlight[(connection->inFlightStart + batch) % window].sent = sent;
+    }
+    return length == 0 || write_all(connection->fd, bytes, length);
+}
+
+//Adds a latency to a round's results
+static void record_latency(RoundResult *result, double seconds) {
+
+    if (result->latencyCount == result->latencyCapacity) {
+        result->latencyCapacity = result->latencyCapacity > 0 ? result->latencyCapacity * 2 : 65536;
+        result->latencies = realloc(result->latencies, result->latencyCapacity * sizeof(float));
+    }
+    result->latencies[result->latencyCount++] = (float) (seconds * 1e6);
+}
+
+//Applies one reply to the game of the oldest request in flight
+static void apply_reply(ClientConnection *connection, const unsigned char bytes[REFEREE_MESSAGE_SIZE], RoundResult *result, double received) {
+
+    InFlight request = connection->inFlight[connection->inFlightStart];
+    connection->inFlightStart = (connection->inFlightStart + 1) % window;
+    connection->inFlightCount--;
+
+    RefereeReply reply = referee_read_reply(bytes);
+    ClientGame *game = &games[request.game];
+    result->requests++;
+    record_latency(result, received - request.sent);
+
+    if (request.type == REFEREE_NEW_GAME) {
+        if (reply.status == REFEREE_OK) {
+            game->id = reply.game;
+            init_board(game->board);
+            game->currentTurn = WHITE_PIECE;
+            game->step = CLIENT_PLAY;
+        }
+    } else if (request.type == REFEREE_END_GAME) {
+        game->step = CLIENT_START;
+    } else {
+        Move moves[MAX_MOVES];
+        if (reply.status == REFEREE_OK) {
+            make_move(game->board, game->move);
+            switch_turns(&game->currentTurn);
+            result->moves++;
+        }
+        if (reply.status != REFEREE_OK || generate_moves(game->board, game->currentTurn, moves) != reply.moveCount ||
+            reply.currentTurn != game->currentTurn) {
+            result->disagreements++;
+        }
+        if (reply.status != REFEREE_OK || referee_is_over(reply.state)) {
+            game->step = CLIENT_END;
+            result->gamesFinished += reply.status == REFEREE_OK;
+        }
+    }
+
+    push_ready(connection, request.game);
+}
+
+//Reads every reply waiting on a connection
+//Returns false if the server is gone
+static bool read_replies(ClientConnection *connection, RoundResult *result) {
+
+    ssize_t received = recv(connection->fd, connection->input + connection->inputUsed,
+                            sizeof(connection->input) - connection->inputUsed, MSG_DONTWAIT);
+    if (received <= 0) {
+        return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+    }
+    connection->inputUsed += (int) received;
+
+    double now = now_seconds();
+    int offset = 0;
+    for (; connection->inputUsed - offset >= REFEREE_MESSAGE_SIZE; offset += REFEREE_MESSAGE_SIZE) {
+        apply_reply(connection, connection->input + offset, result, now);
+    }
+    memmove(connection->input, connection->input + offset, connection->inputUsed - offset);
+    connection->inputUsed -= offset;
+    return true;
+}
+
+//Waits for replies on every connection and sends the next requests, until the deadline
+//With sending false, only games that are over are ended and the requests in flight drained
+//Returns false if the server is gone
+static bool run_until(double deadline, bool sending, RoundResult *result) {
+
+    struct pollfd polls[MAX_CONNECTIONS];
+
+    while (true) {
+        bool busy = false;
+        for (int index = 0; index < connectionCount; index++) {
+            if (!send_requests(&connections[index], sending)) {
+                return false;
+            }
+            busy |= connections[index].inFlightCount > 0;
+            polls[index].fd = connections[index].fd;
+            polls[index].events = POLLIN;
+        }
+
+        if (!busy || (sending && now_seconds() >= deadline)) {
+            return true;
+        }
+
+        if (poll(polls, connectionCount, 1000) < 0 && errno != EINTR) {
+            return false;
+        }
+        for (int index = 0; index < connectionCount; index++) {
+            if ((polls[index].revents & (POLLIN | POLLHUP | POLLERR)) && !read_replies(&connections[index], result)) {
+                return false;
+            }
+        }
+    }
+}
+
+//Compares two latencies for qsort
+static int compare_latencies(const void *first, const void *second) {
+
+    float a = *(const float *) first;
+    float b = *(const float *) second;
+    return (a > b) - (a < b);
+}
+
+//Plays gameCount games at once for some seconds
+//Returns false if the server is gone
+static bool run_round(int gameCount, double seconds, RoundResult *result) {
+
+    memset(result, 0, sizeof(*result));
+    for (int index = 0; index < gameCount; index++) {
+        games[index].step = CLIENT_START;
+    }
+
+    //Games are dealt out to the connections in turn
+    for (int index = 0; index < connectionCount; index++) {
+        ClientConnection *connection = &connections[index];
+        connection->gameCount = gameCount / connectionCount + (index < gameCount % connectionCount);
+        connection->readyStart = 0;
+        connection->readyCount = 0;
+        connection->inFlightStart = 0;
+        connection->inFlightCount = 0;
+    }
+    for (int index = 0; index < gameCount; index++) {
+        push_ready(&connections[index % connectionCount], index);
+    }
+
+    //Every game is started, and the warm up is not counted
+    RoundResult warmUp;
+    memset(&warmUp, 0, sizeof(warmUp));
+    if (!run_until(now_seconds() + 0.5, true, &warmUp)) {
+        return false;
+    }
+    free(warmUp.latencies);
+
+    double start = now_seconds();
+    bool connected = run_until(start + seconds, true, result);
+    result->seconds = now_seconds() - start;
+
+    //The requests in flight are answered, then every game still held is ended,
+    //so the next round starts with an empty server
+    RoundResult cleanUp;
+    memset(&cleanUp, 0, sizeof(cleanUp));
+    connected = connected && run_until(0, false, &cleanUp);
+    for (int index = 0; index < gameCount; index++) {
+        if (games[index].step == CLIENT_PLAY) {
+            games[index].step = CLIENT_END;
+        }
+    }
+    connected = connected && run_until(0, false, &cleanUp);
+    free(cleanUp.latencies);
+    return connected;
+}
+
+int main(int argc, char **argv) {
+
+    double seconds = DEFAULT_SECONDS;
+    int gameCounts[MAX_GAME_COUNTS] = {16, 256, 4096};
+    int gameCountCount = 3;
+    unsigned int seed = 1;
+    const char *address = NULL;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-c") == 0 && argument + 1 < argc) {
+            connectionCount = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-w") == 0 && argument + 1 < argc) {
+            window = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-t") == 0 && argument + 1 < argc) {
+            seconds = atof(argv[++argument]);
+        } else if (strcmp(argv[argument], "-r") == 0 && argument + 1 < argc) {
+            seed = (unsigned int) atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-g") == 0 && argument + 1 < argc) {
+            char *list = argv[++argument];
+            gameCountCount = 0;
+            for (char *token = strtok(list, ","); token != NULL && gameCountCount < MAX_GAME_COUNTS; token = strtok(NULL, ",")) {
+                gameCounts[gameCountCount++] = atoi(token);
+            }
+        } else if (address == NULL && argv[argument][0] != '-') {
+            address = argv[argument];
+        } else {
+            address = NULL;
+            break;
+        }
+    }
+
+    int mostGames = 0;
+    for (int index = 0; index < gameCountCount; index++) {
+        mostGames = gameCounts[index] > mostGames ? gameCounts[index] : mostGames;
+        if (gameCounts[index] < 1) {
+            address = NULL;
+        }
+    }
+    if (address == NULL || connectionCount < 1 || connectionCount > MAX_CONNECTIONS || window < 1 || window > MAX_WINDOW ||
+        seconds <= 0 || gameCountCount == 0) {
+        fprintf(stderr, "usage: server_bench [-c connections] [-w window] [-t seconds] [-g games,games,...] [-r seed] path | host:port\n");
+        return 2;
+    }
+
+    srand(seed);
+    games = malloc(mostGames * sizeof(ClientGame));
+    for (int index = 0; index < connectionCount; index++) {
+        connections[index].fd = connect_server(address);
+        connections[index].ready = malloc(mostGames * sizeof(int));
+        connections[index].inFlight = malloc(window * sizeof(InFlight));
+        connections[index].inputUsed = 0;
+        if (connections[index].fd < 0 || games == NULL || connections[index].ready == NULL || connections[index].inFlight == NULL) {
+            return 1;
+        }
+    }
+
+    printf("%d connections, %d requests in flight on each\n\n", connectionCount, window);
+    printf("   games   requests/s      moves/s   games/s    p50 us    p99 us    max us  disagreements\n");
+
+    for (int index = 0; index < gameCountCount; index++) {
+        RoundResult result;
+        if (!run_round(gameCounts[index], seconds, &result)) {
+            fprintf(stderr, "server closed the connection\n");
+            return 1;
+        }
+
+        qsort(result.latencies, result.latencyCount, sizeof(float), compare_latencies);
+        float p50 = result.latencyCount > 0 ? result.latencies[result.latencyCount / 2] : 0;
+        float p99 = result.latencyCount > 0 ? result.latencies[result.latencyCount * 99 / 100] : 0;
+        float longest = result.latencyCount > 0 ? result.latencies[result.latencyCount - 1] : 0;
+
+        printf("%8d %12.0f %12.0f %9.0f %9.1f %9.1f %9.1f  %ld\n", gameCounts[index], result.requests / result.seconds,
+               result.moves / result.seconds, result.gamesFinished / result.seconds, p50, p99, longest, result.disagreements);
+        fflush(stdout);
+        free(result.latencies);
+    }
+
+    for (int index = 0; index < connectionCount; index++) {
+        close(connections[index].fd);
+    }
+    return 0;
+}
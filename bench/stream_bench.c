@@ -0,0 +1,277 @@
+/*
+Size and encoding time of the frame stream, and a check that it rebuilds every frame.
+
+Plays a short opening on the host framebuffer backend with the clock moved to every
+vsync, as the board runs: each move highlights the squares the piece can go to, slides
+the piece and clears the highlights, all through the animation scheduler. Every frame
+presented is encoded by stream_show_frame, decoded again and compared with the frame on
+screen. A second encoder compares every tile of every frame, to show what looking only
+at the squares the animation repainted saves. Then frames whose tiles end in a few colours
+of their own, with none to two pixels of a run after them, are encoded and decoded the same
+way, so the copies the encoder writes end at or just before the end of a tile.
+
+Reports the bytes per frame and per move and the encoding time per frame of both encoders. The A9
+runs the same code several times slower than a desktop core, and its pixel buffers are
+uncached, so the part that scales with the tiles read matters most there.
+
+Build: gcc -O2 -I. bench/stream_bench.c stream.c stream_host.c animation.c chess.c draw.c raster.c framebuffer_host.c timer_host.c -o stream_bench
+Usage: stream_bench [-n repeats]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "animation.h"
+#include "chess.h"
+#include "draw.h"
+#include "framebuffer.h"
+#include "stream.h"
+#include "timer.h"
+
+
+// Most frames measured
+#define MAX_FRAMES 65536
+
+// Longest copy and longest run the tile end frames close their tiles with
+#define TILE_END_COPIES 4
+#define TILE_END_RUNS 2
+
+
+//Opening played during the run, as start and end squares (x, y) on the board array
+static const int OPENING[][4] = {
+    {4, 6, 4, 4}, {4, 1, 4, 3}, {6, 7, 5, 5}, {1, 0, 2, 2},
+    {5, 7, 1, 3}, {0, 1, 0, 2}, {1, 3, 2, 2}, {3, 1, 2, 2},
+};
+static const int OPENING_LENGTH = sizeof(OPENING) / sizeof(OPENING[0]);
+
+
+//Bytes and encoding time of every frame, for one encoder
+typedef struct EncoderRun
+{
+    const char *name;
+    StreamEncoder encoder;
+    unsigned long lastBytes;
+    int sizes[MAX_FRAMES];
+    double microseconds[MAX_FRAMES];
+    int frames;
+} EncoderRun;
+
+
+static StreamDecoder decoder;
+static EncoderRun repainted = {.name = "repainted squares"};
+static EncoderRun everyTile = {.name = "every tile"};
+static int mismatches = 0;
+
+
+//Returns a monotonic timestamp in microseconds
+static double now_microseconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1e6 + time.tv_nsec / 1e3;
+}
+
+//Orders sizes for qsort
+static int compare_ints(const void *first, const void *second) {
+    return *(const int *) first - *(const int *) second;
+}
+
+//Orders times for qsort
+static int compare_doubles(const void *first, const void *second) {
+
+    double difference = *(const double *) first - *(const double *) second;
+    return (difference > 0) - (difference < 0);
+}
+
+//Encodes the frame on screen, the way the game does or comparing every tile, and keeps its size and time
+//Returns the bytes written, the stream header in front of the first frame included
+static int encode(EncoderRun *run, const PresentedFrame *frame, bool hinted) {
+
+    PresentedFrame copy = *frame;
+    if (!hinted) {
+        copy.redrawn = true;
+    }
+
+    double start = now_microseconds();
+    stream_show_frame(&run->encoder, &copy);
+    double elapsed = now_microseconds() - start;
+
+    int size = (int) (run->encoder.bytes - run->lastBytes);
+    run->lastBytes = run->encoder.bytes;
+    if (run->frames < MAX_FRAMES) {
+        run->sizes[run->frames] = size;
+        run->microseconds[run->frames] = elapsed;
+        run->frames++;
+    }
+    return size;
+}
+
+//Encodes and decodes the frame just presented, checking it against the screen
+static void stream_frame() {
+
+    const PresentedFrame *frame = animation_presented_frame();
+    int size = encode(&repainted, frame, true);
+    encode(&everyTile, frame, false);
+
+    if (size > 0) {
+        const unsigned char *bytes = repainted.encoder.output;
+        if (repainted.encoder.lastHadHeader) {
+            bytes += STREAM_HEADER_SIZE;
+            size -= STREAM_HEADER_SIZE;
+        }
+        if (!stream_decode_frame(&decoder, bytes + 4, size - 4)) {
+            mismatches++;
+            return;
+        }
+    }
+
+    const short int *screen = framebuffer_front_buffer();
+    for (int yCoord = 0; yCoord < FRAMEBUFFER_HEIGHT; yCoord++) {
+        if (memcmp(decoder.pixels[yCoord], screen + yCoord * FRAMEBUFFER_STRIDE, FRAMEBUFFER_WIDTH * sizeof(short int)) != 0) {
+            mismatches++;
+            return;
+        }
+    }
+}
+
+//Encodes frames whose every tile is one colour but for its last pixels, a copy of copied pixels
+//followed by a run of runLength pixels, and checks that they decode to the same pixels
+//Returns the number of frames the stream did not rebuild
+static int check_tile_ends() {
+
+    static short int pixels[FRAMEBUFFER_HEIGHT * FRAMEBUFFER_STRIDE];
+    static StreamEncoder encoder;
+    static StreamDecoder tileDecoder;
+    stream_encoder_init(&encoder);
+    stream_decoder_init(&tileDecoder);
+
+    int failures = 0;
+    int frame = 0;
+    for (int copied = 1; copied <= TILE_END_COPIES; copied++) {
+        for (int runLength = 0; runLength <= TILE_END_RUNS; runLength++) {
+
+            //Every tile is the same, the background changes from frame to frame so none is skipped
+            short int background = (short int) (0x0821 * (frame + 1));
+            for (int yCoord = 0; yCoord < FRAMEBUFFER_HEIGHT; yCoord++) {
+                for (int xCoord = 0; xCoord < FRAMEBUFFER_WIDTH; xCoord++) {
+
+                    int fromEnd = STREAM_TILE_SIZE * STREAM_TILE_SIZE - 1
+                        - ((yCoord % STREAM_TILE_SIZE) * STREAM_TILE_SIZE + xCoord % STREAM_TILE_SIZE);
+                    short int colour = background;
+                    if (fromEnd < runLength) {
+                        colour = (short int) (0x7000 + frame);
+                    } else if (fromEnd < runLength + copied) {
+                        colour = (short int) (0x1000 + 0x0101 * (fromEnd - runLength) + frame);
+                    }
+                    pixels[yCoord * FRAMEBUFFER_STRIDE + xCoord] = colour;
+                }
+            }
+
+            int size = stream_encode_frame(&encoder, pixels, NULL, (unsigned int) frame);
+            const unsigned char *bytes = encoder.output;
+            if (encoder.lastHadHeader) {
+                bytes += STREAM_HEADER_SIZE;
+                size -= STREAM_HEADER_SIZE;
+            }
+            bool rebuilt = size > 4 && stream_decode_frame(&tileDecoder, bytes + 4, size - 4);
+            for (int yCoord = 0; yCoord < FRAMEBUFFER_HEIGHT && rebuilt; yCoord++) {
+                rebuilt = memcmp(tileDecoder.pixels[yCoord], &pixels[yCoord * FRAMEBUFFER_STRIDE], FRAMEBUFFER_WIDTH * sizeof(short int)) == 0;
+            }
+            failures += !rebuilt;
+            frame++;
+        }
+    }
+
+    printf("tile ends: %d frames, %d the stream did not rebuild\n", frame, failures);
+    return failures;
+}
+
+//Draws frames until the board is up to date in both buffers, streaming every one
+static void draw_frames(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render) {
+
+    bool more;
+    do {
+        more = animation_draw_frame(board, render);
+        stream_frame();
+    } while (more);
+}
+
+//Prints the bytes and times of one encoder, the first frame is the keyframe and is left out
+static void print_run(EncoderRun *run, int moves) {
+
+    int count = run->frames - 1;
+    long totalBytes = 0;
+    double totalMicroseconds = 0;
+    int sent = 0;
+    for (int index = 1; index < run->frames; index++) {
+        totalBytes += run->sizes[index];
+        totalMicroseconds += run->microseconds[index];
+        sent += run->sizes[index] > 0;
+    }
+
+    qsort(run->sizes + 1, count, sizeof(int), compare_ints);
+    qsort(run->microseconds + 1, count, sizeof(double), compare_doubles);
+
+    printf("%s: keyframe %d bytes, then %d of %d frames sent, %.0f bytes per move\n", run->name, run->sizes[0], sent, count,
+        (double) totalBytes / moves);
+    printf("  bytes per frame  avg %7.1f  p50 %6d  p95 %6d  max %6d\n", (double) totalBytes / count,
+        run->sizes[1 + count / 2], run->sizes[1 + count * 95 / 100], run->sizes[count]);
+    printf("  encode us        avg %7.2f  p50 %6.2f  p99 %6.2f  max %6.2f\n", totalMicroseconds / count,
+        run->microseconds[1 + count / 2], run->microseconds[1 + count * 99 / 100], run->microseconds[count]);
+}
+
+int main(int argc, char **argv) {
+
+    int repeats = 1;
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        repeats = atoi(argv[2]);
+    }
+    if ((argc != 1 && argc != 3) || repeats < 1) {
+        fprintf(stderr, "usage: stream_bench [-n repeats]\n");
+        return 2;
+    }
+
+    //Frames come at every vsync of the simulated clock, as on the board
+    timer_init();
+    timer_host_set_simulated(true);
+    framebuffer_host_set_vsync(true);
+    set_pixel_buffer_addresses();
+
+    stream_encoder_init(&repainted.encoder);
+    stream_encoder_init(&everyTile.encoder);
+    stream_decoder_init(&decoder);
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    RenderBoard render;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+
+        init_board(board);
+        init_render_board(&render);
+        draw_frames(board, &render);
+
+        int currentTurn = WHITE_PIECE;
+        for (int move = 0; move < OPENING_LENGTH; move++) {
+
+            const int *squares = OPENING[move];
+            highlight_valid_moves(board, &render, squares[0], squares[1], currentTurn);
+            draw_frames(board, &render);
+
+            init_highlights(&render);
+            animation_start_move(board, squares[0], squares[1], squares[2], squares[3]);
+            move_piece(board, squares[0], squares[1], squares[2], squares[3]);
+            draw_frames(board, &render);
+            switch_turns(&currentTurn);
+        }
+    }
+
+    printf("%d moves, %d frames, %d frames the stream did not rebuild\n\n", OPENING_LENGTH * repeats, repainted.frames, mismatches);
+    print_run(&repainted, OPENING_LENGTH * repeats);
+    print_run(&everyTile, OPENING_LENGTH * repeats);
+
+    printf("\n");
+    mismatches += check_tile_ends();
+
+    return mismatches == 0 ? 0 : 1;
+}
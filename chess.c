@@ -0,0 +1,555 @@
+/*
+Game state and rules for the chess game.
+*/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "chess.h"
+#include "geometry.h"
+#include "profile.h"
+
+
+// Function definitions for the chess game
+/////////////////////////////////////////////////////////////////////
+
+//Initializes the chess board to default state
+void init_board(PackedSquare board[BOARD_SIZE][BOARD_SIZE]) {
+
+    //Initialize pieces
+    init_pieces(board);
+
+    //Initialize empty squares
+    init_empty_squares(board);
+
+}
+
+//Initializes the drawn state of the chess board, with nothing highlighted or outlined
+void init_render_board(RenderBoard *render) {
+
+    //Initialize colour of each square
+    init_colours(render);
+
+    //Initialize highlights
+    init_highlights(render);
+
+    //Initialize outlines
+    init_outlines(render);
+
+}
+
+//Initializes highlights
+void init_highlights(RenderBoard *render) {
+    
+    //Loops through the board and sets all highlights to false
+    for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            render->squares[yCoord][xCoord].highlighted = false;
+        }
+    }
+}
+
+//Initializes colours of the chess grid
+void init_colours(RenderBoard *render){
+
+    //Loops through all squares and sets the colour of the square
+    //Colour of the square is in a checkerboard pattern
+    for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if((xCoord + yCoord) % 2 == 0) {
+                render->squares[yCoord][xCoord].colour = WHITE_SQUARE_COLOUR;
+            }
+            else {
+                render->squares[yCoord][xCoord].colour = BLACK_SQUARE_COLOUR;
+            }
+        }
+    }
+}
+
+//Initializes piece types in board
+void init_pieces(PackedSquare board[BOARD_SIZE][BOARD_SIZE]) {
+    
+    //Initializes backrank pieces for white
+    init_backrank(board, WHITE_PIECE, BOARD_SIZE-1);
+
+    //Initializes frontrank pieces for white
+    init_frontrank(board, WHITE_PIECE, BOARD_SIZE-2);
+
+    //Initializes backrank pieces for black
+    init_backrank(board, BLACK_PIECE, 0);
+
+    //Initializes frontrank pieces for black
+    init_frontrank(board, BLACK_PIECE, 1);
+
+}
+
+//Initializes empty squares in board
+void init_empty_squares(PackedSquare board[BOARD_SIZE][BOARD_SIZE]) {
+
+    //Sets constants for the empty squares
+    const int EMPTY_SPACE_BEGIN = 2;
+    const int EMPTY_SPACE_END = BOARD_SIZE - 3;
+
+    //Loops through the empty squares in the board
+    //Sets the piece type to EMPTY_SQUARE and piece color to EMPTY_PIECE
+    for(int yCoord = EMPTY_SPACE_BEGIN; yCoord <= EMPTY_SPACE_END; yCoord++) {
+        for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            board[yCoord][xCoord] = PACKED_EMPTY;
+        }
+    } 
+}
+
+//Initializes outlines of the chess grid
+void init_outlines(RenderBoard *render) {
+
+    //Loops through every square and sets the outline to false
+    for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            render->squares[yCoord][xCoord].outlined = false;
+        }
+    }
+
+}
+
+//Initializes backrank pieces given the board, colour and yCoord
+void init_backrank(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int colour, int yCoord) {
+    
+    //Manually set pieces to starting position with corresponding colour
+    //Set up rook
+    board[yCoord][0] = PACK_PIECE(ROOK, colour);
+
+    //Set up knight
+    board[yCoord][1] = PACK_PIECE(KNIGHT, colour);
+
+    //Set up bishop
+    board[yCoord][2] = PACK_PIECE(BISHOP, colour);
+
+    //Set up queen
+    board[yCoord][3] = PACK_PIECE(QUEEN, colour);
+
+    //Set up king
+    board[yCoord][4] = PACK_PIECE(KING, colour);
+
+    //Set up bishop
+    board[yCoord][5] = PACK_PIECE(BISHOP, colour);
+
+    //Set up knight
+    board[yCoord][6] = PACK_PIECE(KNIGHT, colour);
+
+    //Set up rook
+    board[yCoord][7] = PACK_PIECE(ROOK, colour);
+}
+
+//Initializes frontrank pieces given the board, colour and yCoord
+void init_frontrank(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int colour, int yCoord) {
+    
+    //Loops through row at yCoord and set pieces to pawns of the correspending colour
+    for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+        board[yCoord][xCoord] = PACK_PIECE(PAWN, colour);
+    }
+}
+
+//highlights valid moves for a piece at square xCoord, yCoord
+void highlight_valid_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], RenderBoard *render, int xStartingCoord, int yStartingCoord, int currentTurn) {
+
+    //Loops through board and set grid highlight to true based on if the move is valid
+    for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if(is_valid_move(board, xStartingCoord, yStartingCoord, xCoord, yCoord, currentTurn)) {
+                render->squares[yCoord][xCoord].highlighted = true;
+            }
+        }
+    }
+}
+
+//Checks if a move is valid
+bool is_valid_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, int currentTurn) {
+
+    PROFILE_SCOPE(PROFILE_IS_VALID_MOVE);
+
+    //Checks if the king would be in check after the move
+
+    //Create temporary board to test the move
+    PackedSquare tempBoard[BOARD_SIZE][BOARD_SIZE];
+    copy_board(board, tempBoard);
+
+    //Move the piece in the starting square to the ending square
+    tempBoard[yCoordEnd][xCoordEnd] = tempBoard[yCoordStart][xCoordStart];
+
+    //Set the piece in the starting square to empty
+    tempBoard[yCoordStart][xCoordStart] = PACKED_EMPTY;
+
+    //Check if the king would be in check after the move
+    if(is_in_check(tempBoard, currentTurn)) {
+        return false;
+    }
+
+    //Checks if the move is a valid move without check
+    return is_valid_move_without_check(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd, currentTurn);
+}
+
+//Checks if a move is valid without check
+bool is_valid_move_without_check(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, int currentTurn) {
+
+    //Checks if the move is in the board
+    if(xCoordEnd < 0 || xCoordEnd > BOARD_SIZE-1 || yCoordEnd < 0 || yCoordEnd > BOARD_SIZE-1) {
+        return false;
+    }
+
+    //Checks if starting square is empty
+    if(PACKED_PIECE_ID(board[yCoordStart][xCoordStart]) == EMPTY_SQUARE) {
+        return false;
+    }
+
+    //Checks if ending square has piece of the same colour as the piece in the starting square
+    if(PACKED_COLOUR(board[yCoordStart][xCoordStart]) == PACKED_COLOUR(board[yCoordEnd][xCoordEnd])) {
+        return false;
+    }
+
+    //Checks if the piece in the starting square is of the same colour as currentTurn
+    if(PACKED_COLOUR(board[yCoordStart][xCoordStart]) != currentTurn) {
+        return false;
+    }
+
+    //Checks if the move is valid according to the piece type at starting square
+    switch(PACKED_PIECE_ID(board[yCoordStart][xCoordStart])) {
+        case PAWN:
+            return is_valid_pawn_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd, currentTurn);
+        case ROOK:
+            return is_valid_rook_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd);
+        case KNIGHT:
+            return is_valid_knight_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd);
+        case BISHOP:
+            return is_valid_bishop_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd);
+        case QUEEN:
+            return is_valid_queen_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd);
+        case KING:
+            return is_valid_king_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd);
+        default:
+            return false;
+    }
+}
+
+//Checks if it is a valid pawn move
+bool is_valid_pawn_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, int currentTurn){
+
+    //The tables are indexed by the colour of the pawn
+    int pieceColour = PACKED_COLOUR(board[yCoordStart][xCoordStart]);
+    if(pieceColour != WHITE_PIECE && pieceColour != BLACK_PIECE) {
+        return false;
+    }
+
+    int startSquare = SQUARE_INDEX(xCoordStart, yCoordStart);
+    int endSquare = SQUARE_INDEX(xCoordEnd, yCoordEnd);
+
+    //Checks pawn move is moving diagonally forward and capturing a piece
+    if(PACKED_PIECE_ID(board[yCoordEnd][xCoordEnd]) != EMPTY_SQUARE) {
+        return TARGETS_HOLD(PAWN_CAPTURE_TARGETS[pieceColour][startSquare], endSquare);
+    }
+
+    //Checks pawn move is moving forward, or two squares from its starting location
+    if(!TARGETS_HOLD(PAWN_PUSH_TARGETS[pieceColour][startSquare], endSquare)) {
+        return false;
+    }
+
+    //Checks the square passed over by a move of two squares is free
+    if(yCoordEnd - yCoordStart == 2 || yCoordEnd - yCoordStart == -2) {
+        return PACKED_PIECE_ID(board[(yCoordStart + yCoordEnd) / 2][xCoordEnd]) == EMPTY_SQUARE;
+    }
+
+    return true;
+}
+
+//Checks if it is a valid knight move
+bool is_valid_knight_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd){
+
+    //Checks if the end square is one of the knight's jumps
+    return TARGETS_HOLD(KNIGHT_TARGETS[SQUARE_INDEX(xCoordStart, yCoordStart)], SQUARE_INDEX(xCoordEnd, yCoordEnd));
+}
+
+//Checks if it is a valid bishop move
+bool is_valid_bishop_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd){
+
+    int xDistance = xCoordEnd - xCoordStart;
+    int yDistance = yCoordEnd - yCoordStart;
+
+    //Checks if the move is a valid bishop move
+    if(xDistance != yDistance && xDistance != -yDistance) {
+        return false;
+    }
+
+    //Checks if the path of the bishop is clear, one diagonal step at a time
+    int xStep = xDistance > 0 ? 1 : -1;
+    int yStep = yDistance > 0 ? 1 : -1;
+    int xCoord = xCoordStart + xStep;
+    int yCoord = yCoordStart + yStep;
+    for(int distance = 1; distance < xDistance * xStep; distance++) {
+        if(PACKED_PIECE_ID(board[yCoord][xCoord]) != EMPTY_SQUARE) {
+            return false;
+        }
+        xCoord += xStep;
+        yCoord += yStep;
+    }
+
+    return true;
+}
+
+//Checks if it is a valid rook move
+bool is_valid_rook_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd){
+
+    //Checks if the move is a valid rook move
+    if(xCoordStart != xCoordEnd && yCoordStart != yCoordEnd) {
+        return false;
+    }
+
+    //Checks if the path of the rook is clear, one step along its file or rank at a time
+    int xStep = (xCoordEnd > xCoordStart) - (xCoordEnd < xCoordStart);
+    int yStep = (yCoordEnd > yCoordStart) - (yCoordEnd < yCoordStart);
+    int xCoord = xCoordStart + xStep;
+    int yCoord = yCoordStart + yStep;
+    while(xCoord != xCoordEnd || yCoord != yCoordEnd) {
+        if(PACKED_PIECE_ID(board[yCoord][xCoord]) != EMPTY_SQUARE) {
+            return false;
+        }
+        xCoord += xStep;
+        yCoord += yStep;
+    }
+
+    return true;
+}
+
+//Checks if it is a valid queen move
+bool is_valid_queen_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd){
+
+    //Checks if the move is both a valid bishop and a valid rook move
+    if(is_valid_bishop_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd) || is_valid_rook_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd)) {
+        return true;
+    }
+
+    return false;
+}
+
+//Checks if it is a valid king move
+bool is_valid_king_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd){
+
+    //Checks if the end square is next to the king, or the square it is on as it always was
+    //(is_valid_move_without_check turns down a move to the piece's own square before this)
+    return (xCoordStart == xCoordEnd && yCoordStart == yCoordEnd)
+        || TARGETS_HOLD(KING_TARGETS[SQUARE_INDEX(xCoordStart, yCoordStart)], SQUARE_INDEX(xCoordEnd, yCoordEnd));
+}
+
+//Checks if a piece has valid moves
+bool has_valid_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int currentTurn) {
+
+    //For the piece in xCoord, yCoord, check if it has any valid moves using function is_valid_move
+    for(int xCoordEnd = 0; xCoordEnd < BOARD_SIZE; xCoordEnd++) {
+        for(int yCoordEnd = 0; yCoordEnd < BOARD_SIZE; yCoordEnd++) {
+            if(is_valid_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd, currentTurn)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+//Checks if king is in check
+bool is_in_check(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int pieceColour) {
+
+    PROFILE_SCOPE(PROFILE_IS_IN_CHECK);
+    
+    //Find king position
+    SquareCoord kingPosition = get_king_position(board, pieceColour);
+
+    //Check if king is in check
+    for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+        for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+            if(PACKED_PIECE_ID(board[yCoord][xCoord]) != EMPTY_SQUARE && PACKED_PIECE_ID(board[yCoord][xCoord]) != KING && PACKED_PIECE_ID(board[yCoord][xCoord]) != pieceColour) {
+                if(is_valid_move_without_check(board, xCoord, yCoord, kingPosition.xCoord, kingPosition.yCoord, !pieceColour)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+//Checks if square is empty
+bool is_empty_square(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoord, int yCoord) {
+
+    //Checks if the square is empty
+    if(PACKED_PIECE_ID(board[yCoord][xCoord]) == EMPTY_SQUARE) {
+        return true;
+    }
+    
+    return false;
+
+}
+
+//Move a piece from one square to another
+void move_piece(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd) {
+
+    //Move the piece at starting location to end location
+    board[yCoordEnd][xCoordEnd] = board[yCoordStart][xCoordStart];
+
+    //Set the piece at the starting location to empty, which empties its colour too
+    board[yCoordStart][xCoordStart] = PACKED_EMPTY;
+
+}
+
+//Switches turns
+void switch_turns(int * currentTurn) {
+
+    //Switch turns
+    if(*currentTurn == WHITE_PIECE) {
+        *currentTurn = BLACK_PIECE;
+    } else {
+        *currentTurn = WHITE_PIECE;
+    }
+
+}
+
+//Determines if the game is over
+bool is_game_over(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn) {
+
+    if(is_stalemate(board, currentTurn)) return true;
+
+    if(is_checkmate(board, currentTurn)) return true;
+
+    return false;
+}
+
+//Determines the winner of the game
+int get_winner(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn) {
+
+    //Check if game is in checkmate
+    if(is_checkmate(board, currentTurn)) {
+        return !currentTurn;
+    }
+
+    //Check if game is in stalemate
+    if(is_stalemate(board, currentTurn)) {
+        return STALEMATE;
+    }
+
+    return 1;
+}
+
+//Checks if game ended in stalemate
+bool is_stalemate(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn) {
+
+    //Check if king is in not in check
+    if(is_in_check(board, !currentTurn)) return false;
+
+    //iterate through every piece and see if it has valid moves
+    for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+        for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+            if(PACKED_PIECE_ID(board[yCoord][xCoord]) != EMPTY_SQUARE && PACKED_COLOUR(board[yCoord][xCoord]) == currentTurn) {
+                if(has_valid_moves(board, xCoord, yCoord, currentTurn)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+
+    return true;
+}
+
+//Checks if the game is in checkmate
+bool is_checkmate(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn) {
+
+    PROFILE_SCOPE(PROFILE_IS_CHECKMATE);
+
+    //Check if king is not in check
+    if(!is_in_check(board, currentTurn)) return false;
+
+    //Check if any move can prevent checkmate
+
+    //Create a copy of the board
+    PackedSquare boardCopy[BOARD_SIZE][BOARD_SIZE];
+    copy_board(board, boardCopy);
+
+    //Iterate through every piece
+    //Iterate through every possible move
+    //Check if move is valid and would get the king out of check
+    for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+        for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+            if(PACKED_PIECE_ID(board[yCoord][xCoord]) != EMPTY_SQUARE && PACKED_COLOUR(board[yCoord][xCoord]) == currentTurn) {
+                for(int xCoordEnd = 0; xCoordEnd < BOARD_SIZE; xCoordEnd++) {
+                    for(int yCoordEnd = 0; yCoordEnd < BOARD_SIZE; yCoordEnd++) {
+                        if(is_valid_move(board, xCoord, yCoord, xCoordEnd, yCoordEnd, currentTurn)) {
+
+                            //Save piece in end location
+                            PackedSquare tempPiece = boardCopy[yCoordEnd][xCoordEnd];
+
+                            move_piece(boardCopy, xCoord, yCoord, xCoordEnd, yCoordEnd);
+                            if(!is_in_check(boardCopy, currentTurn)) {
+                                return false;
+                            }
+                            move_piece(boardCopy, xCoordEnd, yCoordEnd, xCoord, yCoord);
+                            boardCopy[yCoordEnd][xCoordEnd] = tempPiece;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for helper functions
+/////////////////////////////////////////////////////////////////////
+
+//Copy board to another board
+void copy_board(PackedSquare board[BOARD_SIZE][BOARD_SIZE], PackedSquare copyBoard[BOARD_SIZE][BOARD_SIZE]) {
+
+    //Copy board, one byte per square
+    memcpy(copyBoard, board, BOARD_SIZE * BOARD_SIZE * sizeof(PackedSquare));
+}
+
+//Gets the piece on a packed square
+Piece unpack_piece(PackedSquare square) {
+
+    Piece piece;
+    piece.colour = (short int) PACKED_COLOUR(square);
+    piece.piece_ID = PACKED_PIECE_ID(square);
+    return piece;
+}
+
+//Gets the packed square holding a piece
+PackedSquare pack_piece(Piece piece) {
+
+    //An empty square is always packed as empty, whatever colour it was left with
+    if(piece.piece_ID == EMPTY_SQUARE) {
+        return PACKED_EMPTY;
+    }
+    return PACK_PIECE(piece.piece_ID, piece.colour);
+}
+
+//Gets king position
+//Returns (-1,-1) if there is no king of that colour on the board
+SquareCoord get_king_position(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int pieceColour) {
+
+    //Loop through the board to find the king
+    for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if(PACKED_PIECE_ID(board[yCoord][xCoord]) == KING && PACKED_COLOUR(board[yCoord][xCoord]) == pieceColour) {
+                SquareCoord kingPosition = {xCoord, yCoord};
+                return kingPosition;
+            }
+        }
+    }
+
+    SquareCoord noKing = {-1, -1};
+    return noKing;
+
+}
+
+/////////////////////////////////////////////////////////////////////
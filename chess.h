@@ -0,0 +1,206 @@
+/*
+Game state and rules for the chess game.
+
+The board is represented by an 8 by 8 2D array of bytes, one PackedSquare per square holding
+the piece type and the color of the piece. How the squares are drawn (their colour and if they
+are highlighted or outlined) is kept apart in a RenderBoard, which the rules never read, so
+copying a position for the rules moves 64 bytes instead of 64 structs.
+Nothing in here touches the DE1-SoC devices, so the rules can also be built on a host machine.
+*/
+
+#ifndef CHESS_H
+#define CHESS_H
+
+#include <stdbool.h>
+
+
+// Defines the ids for the pieces
+typedef int PieceIdx;
+#define EMPTY_SQUARE 0
+#define PAWN 1
+#define KNIGHT 2
+#define BISHOP 3
+#define ROOK 4
+#define QUEEN 5
+#define KING 6
+
+
+// Number of rows and columns of the chess board
+// A macro so it can size arrays that are not local to a function
+#define BOARD_SIZE 8
+
+
+// Global constants for the chess board
+static const int WHITE_PIECE           = 1;
+static const int BLACK_PIECE           = 0;
+static const int WHITE_SQUARE_COLOUR   =0xeeeed2;
+static const int BLACK_SQUARE_COLOUR   =0x769656;
+static const int EMPTY_PIECE           =-1;
+static const int STALEMATE             =-1;
+
+
+//Piece struct holds information about a piece
+//The board keeps pieces packed (see PackedSquare), they are unpacked to be drawn
+typedef struct Piece
+{
+
+    //Colour of the piece
+    short int colour;
+
+    //ID of the piece (Determines which piece it is or if it is empty)
+    PieceIdx piece_ID;
+} Piece;
+
+
+//SquareCoord struct holds the x and y indexes of a square of the chess board
+//Returned by value so finding a square never allocates
+typedef struct SquareCoord
+{
+    int xCoord;
+    int yCoord;
+} SquareCoord;
+
+
+//PackedSquare holds the piece on a square of the chess board in one byte
+//The piece ID is in the low bits and the colour of the piece plus one above them,
+//so an empty square is 0 and reads back as EMPTY_SQUARE with the colour EMPTY_PIECE
+typedef unsigned char PackedSquare;
+
+// Packing and unpacking a PackedSquare, without a call so the rules can use them on every square
+#define PACKED_EMPTY 0
+#define PACKED_COLOUR_SHIFT 3
+#define PACKED_PIECE_MASK ((1 << PACKED_COLOUR_SHIFT) - 1)
+#define PACK_PIECE(pieceId, colour) ((PackedSquare) ((pieceId) | ((colour) + 1) << PACKED_COLOUR_SHIFT))
+#define PACKED_PIECE_ID(square) ((PieceIdx) ((square) & PACKED_PIECE_MASK))
+#define PACKED_COLOUR(square) ((int) ((square) >> PACKED_COLOUR_SHIFT) - 1)
+
+
+//RenderSquare holds how a square on the chess board is drawn
+typedef struct RenderSquare
+{
+    //colour of the square
+    int colour;
+
+    //Determines if square should be highlighted when drawn
+    //Highlighted squares are used to show where a piece can move
+    bool highlighted;
+
+    //Determines if square should be outlined when drawn
+    //Outlined squares are used to show current selected square
+    bool outlined;
+} RenderSquare;
+
+
+//RenderBoard holds the presentation state of the chess board, drawn along with the pieces of a position
+typedef struct RenderBoard
+{
+    RenderSquare squares[BOARD_SIZE][BOARD_SIZE];
+} RenderBoard;
+
+
+// Function prototypes for the chess game
+/////////////////////////////////////////////////////////////////////
+
+//Initializes the chess board to default state
+void init_board(PackedSquare board[BOARD_SIZE][BOARD_SIZE]);
+
+//Initializes the drawn state of the chess board, with nothing highlighted or outlined
+void init_render_board(RenderBoard *render);
+
+//Initializes highlights
+void init_highlights(RenderBoard *render);
+
+//Initializes colours of the chess grid
+void init_colours(RenderBoard *render);
+
+//Initializes piece types in board
+void init_pieces(PackedSquare board[BOARD_SIZE][BOARD_SIZE]);
+
+//Initializes empty squares in board
+void init_empty_squares(PackedSquare board[BOARD_SIZE][BOARD_SIZE]);
+
+//Initializes outlines of the chess grid
+void init_outlines(RenderBoard *render);
+
+//Initializes backrank pieces given the board, colour and yCoord
+void init_backrank(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int colour, int yCoord);
+
+//Initializes frontrank pieces given the board, colour and yCoord
+void init_frontrank(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int colour, int yCoord);
+
+//highlights valid moves for a piece at square xCoord, yCoord
+void highlight_valid_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], RenderBoard *render, int xCoord, int yCoord, int currentTurn);
+
+//Checks if a move is valid
+bool is_valid_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, int currentTurn);
+
+//Checks if a move is valid without check
+bool is_valid_move_without_check(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, int currentTurn);
+
+//Checks if it is a valid pawn move
+bool is_valid_pawn_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, int currentTurn);
+
+//Checks if it is a valid knight move
+bool is_valid_knight_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Checks if it is a valid bishop move
+bool is_valid_bishop_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Checks if it is a valid rook move
+bool is_valid_rook_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Checks if it is a valid queen move
+bool is_valid_queen_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Checks if it is a valid king move
+bool is_valid_king_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Checks if a piece has valid moves
+bool has_valid_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoord, int yCoord, int currentTurn);
+
+//Checks if king is in check
+bool is_in_check(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int pieceColour);
+
+//Checks if square is empty
+bool is_empty_square(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoord, int yCoord);
+
+//Move a piece from one square to another
+void move_piece(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Switches turns
+void switch_turns(int * currentTurn);
+
+//Determines if the game is over
+bool is_game_over(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn);
+
+//Determines the winner of the game
+int get_winner(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn);
+
+//Checks if game ended in stalemate
+bool is_stalemate(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn);
+
+//Checks if the game is in checkmate
+bool is_checkmate(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for helper functions
+/////////////////////////////////////////////////////////////////////
+
+//Copy board to another board
+void copy_board(PackedSquare board[BOARD_SIZE][BOARD_SIZE], PackedSquare copyBoard[BOARD_SIZE][BOARD_SIZE]);
+
+//Gets the piece on a packed square
+Piece unpack_piece(PackedSquare square);
+
+//Gets the packed square holding a piece
+PackedSquare pack_piece(Piece piece);
+
+//Gets king position
+//Returns (-1,-1) if there is no king of that colour on the board
+SquareCoord get_king_position(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int pieceColour);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
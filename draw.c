@@ -0,0 +1,331 @@
+/*
+VGA rendering of the chess board.
+*/
+
+#include "draw.h"
+#include "framebuffer.h"
+#include "profile.h"
+
+
+// Function definitions for drawing to the VGA display
+/////////////////////////////////////////////////////////////////////
+
+//Plots a single pixel at the given coordinates with the given color
+void plot_pixel(int x, int y, short int line_color)
+{
+    framebuffer_back_buffer()[y * FRAMEBUFFER_STRIDE + x] = line_color;
+}
+
+//Clears the screen with the colour black
+void clear_screen()
+{
+    //Fill every row of the back buffer with zero (black)
+    draw_rectangle_primitive(0, 0, RESOLUTION_X, RESOLUTION_Y, BLACK);
+}
+
+//Set pixel buffer addresses
+void set_pixel_buffer_addresses(){
+
+    //Point the front and back buffers at their memory
+    framebuffer_init();
+
+    //Reset screen to black on the back buffer and show it
+    clear_screen();
+    wait_for_vsync();
+
+    //Clear screen on the new back buffer
+    clear_screen();
+
+}
+
+//Draws the chess board in its current state, the pieces of the position over the squares as render has them
+void draw_board(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render){
+
+    PROFILE_SCOPE(PROFILE_DRAW_BOARD);
+	
+    //Draws outline of the chess board
+    draw_squares(render);
+
+    //Draws the pieces on the chess board
+    draw_pieces(board);
+
+    //Swaps the front and back buffers
+    wait_for_vsync();
+}
+
+//Draws background outline of the chess board
+void draw_squares(const RenderBoard *render) {
+
+    PROFILE_SCOPE(PROFILE_DRAW_SQUARES);
+    
+    //Loops through each square on the chess board and draws the square
+    for(int yCoord = 0; yCoord < BOARD_SIZE; yCoord++){
+        for(int xCoord = 0; xCoord < BOARD_SIZE; xCoord++){
+            draw_square(render->squares[yCoord][xCoord], xCoord, yCoord);
+        }
+    }
+}
+
+//Synchronizes the double buffering of the VGA display
+void wait_for_vsync(){
+
+    PROFILE_SCOPE(PROFILE_WAIT_FOR_VSYNC);
+
+    //Presents the back buffer, drawing continues on the old front buffer
+    framebuffer_swap();
+}
+
+//Draws all pieces on the chess board
+void draw_pieces(PackedSquare board[BOARD_SIZE][BOARD_SIZE]) {
+
+    PROFILE_SCOPE(PROFILE_DRAW_PIECES);
+    
+    //Loops through chess board and draws all pieces
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            draw_piece(unpack_piece(board[yCoord][xCoord]), xCoord, yCoord);
+        }
+    }
+}
+
+//Draws a single piece on the chess board
+void draw_piece(Piece piece, int xCoord, int yCoord) {
+
+    //Convert xCoord and yCoord to pixel coordinates
+    draw_piece_at_pixel(piece, x_to_pixel(xCoord), y_to_pixel(yCoord));
+}
+
+//Draws a single piece in the square with the left top corner at (x,y)
+void draw_piece_at_pixel(Piece piece, int xPixelCoord, int yPixelCoord) {
+    
+    //if there is no piece, do nothing
+    if (piece.piece_ID == EMPTY_SQUARE) {
+        return;
+    }
+
+    //Determines colour of piece
+    short int colour;
+    if (piece.colour == WHITE_PIECE) {
+        colour = WHITE;
+    } else {
+        colour = BLACK;
+    }
+
+
+
+    //Checks to see which piece to draw and draws it
+    if (piece.piece_ID == PAWN) {
+        draw_pawn(colour, xPixelCoord, yPixelCoord);
+    }
+    else if (piece.piece_ID == ROOK) {
+        draw_rook(colour, xPixelCoord, yPixelCoord);
+    }
+    else if (piece.piece_ID == KNIGHT) {
+        draw_knight(colour, xPixelCoord, yPixelCoord);
+    }
+    else if (piece.piece_ID == BISHOP) {
+        draw_bishop(colour, xPixelCoord, yPixelCoord);
+    }
+    else if (piece.piece_ID == QUEEN) {
+        draw_queen(colour, xPixelCoord, yPixelCoord);
+    }
+    else if (piece.piece_ID == KING) {
+        draw_king(colour, xPixelCoord, yPixelCoord);
+    }
+}
+
+//Draws a single square on the chess board
+void draw_square(RenderSquare square, int xCoord, int yCoord) {
+
+    //The square is always on screen, so it is filled from its offset into the buffer without clipping
+    RasterTarget target = get_raster_target();
+    int offset = SQUARE_FRAMEBUFFER_OFFSET[SQUARE_INDEX(xCoord, yCoord)];
+
+    //Draws the background of the square in black if it's not outlined and in magenta if it is
+    if (square.outlined == 0) 
+        raster_fill_block(&target, offset, SQUARE_SIZE, SQUARE_SIZE, BLACK);
+    else 
+        raster_fill_block(&target, offset, SQUARE_SIZE, SQUARE_SIZE, MAGENTA);
+
+
+
+    //Draws the square foreground with it's colour depending on the highlighted status
+    int innerOffset = offset + SQUARE_BORDER_SIZE * FRAMEBUFFER_STRIDE + SQUARE_BORDER_SIZE;
+    int innerSize = SQUARE_SIZE - SQUARE_BORDER_SIZE*2;
+    if (square.highlighted == 0) 
+        raster_fill_block(&target, innerOffset, innerSize, innerSize, square.colour);
+    else 
+        raster_fill_block(&target, innerOffset, innerSize, innerSize, YELLOW);
+}
+
+//Draws a pawn in the square with the left top corner at (x,y)
+void draw_pawn(int pieceColour, int xPixelCoord, int yPixelCoord) {
+
+    //Offset the piece from the corner of the square
+    int startingPixelCoordX = xPixelCoord + PIECE_PIXEL_OFFSET_X[PAWN];
+    int startingPixelCoordY = yPixelCoord + PIECE_PIXEL_OFFSET_Y[PAWN];
+
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY, 4,2, pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-2, startingPixelCoordY+2, 8,4, pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+6, 4,4, pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-2, startingPixelCoordY+10, 8,4, pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-6, startingPixelCoordY+14, 16,4, pieceColour);
+
+}
+
+//Draws a knight in the square with the left top corner at (x,y)
+void draw_knight(int pieceColour, int xPixelCoord, int yPixelCoord) {
+
+    //Offset the piece from the corner of the square
+    int startingPixelCoordX = xPixelCoord + PIECE_PIXEL_OFFSET_X[KNIGHT];
+    int startingPixelCoordY = yPixelCoord + PIECE_PIXEL_OFFSET_Y[KNIGHT];
+
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY, 2,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+5, startingPixelCoordY, 2,1,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+1, 10,1,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-1, startingPixelCoordY+2, 11,1,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-1, startingPixelCoordY+3, 7,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+8, startingPixelCoordY+3, 4,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-1, startingPixelCoordY+4, 7,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+8, startingPixelCoordY+4, 5,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-1, startingPixelCoordY+5, 15,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+6, 15,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+7, 15,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+14, startingPixelCoordY+8, 3,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+14, startingPixelCoordY+9, 3,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-1, startingPixelCoordY+8, 15,2,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+1, startingPixelCoordY+10, 15,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+11, 10,3,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+1, startingPixelCoordY+14, 11,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+15, 13,1,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-1, startingPixelCoordY+16, 14,3,pieceColour);
+}
+
+//Draws a bishop in the square with the left top corner at (x,y)
+void draw_bishop(int pieceColour, int xPixelCoord, int yPixelCoord) {
+
+    //Offset the piece from the corner of the square
+    int startingPixelCoordX = xPixelCoord + PIECE_PIXEL_OFFSET_X[BISHOP];
+    int startingPixelCoordY = yPixelCoord + PIECE_PIXEL_OFFSET_Y[BISHOP];
+
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY, 4,2,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-2, startingPixelCoordY+2, 8,3, pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-6, startingPixelCoordY+6, 16,4,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-2, startingPixelCoordY+10, 8,3,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+14, 4,2,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-6, startingPixelCoordY+16, 16,3,pieceColour);
+}
+
+//Draws a rook in the square with the left top corner at (x,y)
+void draw_rook(int pieceColour, int xPixelCoord, int yPixelCoord) {
+
+    //Offset the piece from the corner of the square
+    int startingPixelCoordX = xPixelCoord + PIECE_PIXEL_OFFSET_X[ROOK];
+    int startingPixelCoordY = yPixelCoord + PIECE_PIXEL_OFFSET_Y[ROOK];
+
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY, 3,3,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+6, startingPixelCoordY, 3,3,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+12, startingPixelCoordY, 3,3,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+3, 15,3,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX+3, startingPixelCoordY+6,9,9,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+15, 15,3,pieceColour);
+	
+}
+
+//Draws a queen in the square with the left top corner at (x,y)
+void draw_queen(int pieceColour, int xPixelCoord, int yPixelCoord) {
+
+    //Offset the piece from the corner of the square
+    int startingPixelCoordX = xPixelCoord + PIECE_PIXEL_OFFSET_X[QUEEN];
+    int startingPixelCoordY = yPixelCoord + PIECE_PIXEL_OFFSET_Y[QUEEN];
+
+    draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY, 4,2,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-4, startingPixelCoordY, 2,2,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX+6, startingPixelCoordY, 2,2,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-3, startingPixelCoordY+2, 10,1,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-2, startingPixelCoordY+3, 8,2,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+5, 4,2,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+7, 4,6,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-2, startingPixelCoordY+13, 8,2,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-3, startingPixelCoordY+15, 10,2,pieceColour);
+    draw_rectangle_primitive(startingPixelCoordX-4, startingPixelCoordY+17, 12,2,pieceColour);
+
+}
+
+//Draws a king in the square with the left top corner at (x,y)
+void draw_king(int pieceColour, int xPixelCoord, int yPixelCoord) {
+
+    //Offset the piece from the corner of the square
+    int startingPixelCoordX = xPixelCoord + PIECE_PIXEL_OFFSET_X[KING];
+    int startingPixelCoordY = yPixelCoord + PIECE_PIXEL_OFFSET_Y[KING];
+
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY, 4,2,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-2, startingPixelCoordY+2, 8,3,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+5, 4,2,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-3, startingPixelCoordY+7, 10,4,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-1, startingPixelCoordY+11, 6,2,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX, startingPixelCoordY+13, 4,6,pieceColour);
+	draw_rectangle_primitive(startingPixelCoordX-3, startingPixelCoordY+19, 10,4,pieceColour);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for drawing primitives to the VGA display
+/////////////////////////////////////////////////////////////////////
+
+//Draws a square with the left top corner at (x,y) with size (size) and colour (colour)
+void draw_square_primitive(int xPixelCoord, int yPixelCoord, int size, short int colour) {
+
+    //draws rectangle with width equal to height of length size
+    draw_rectangle_primitive(xPixelCoord, yPixelCoord, size, size, colour);
+
+}
+
+//Draws a rectangle with the left top corner at (x,y) with size (width,height) and colour (colour)
+void draw_rectangle_primitive(int xPixelCoord, int yPixelCoord, int width, int height, short int colour) {
+
+    //Fills the rectangle one row span at a time
+    RasterTarget target = get_raster_target();
+    raster_fill_rect(&target, xPixelCoord, yPixelCoord, width, height, colour);
+}
+
+//Draws a circle with the center at (x,y) with radius (radius) and colour (colour)
+void draw_circle_primitive(int xPixelCoord, int yPixelCoord, int radius, short int colour) {
+
+    //Fills the disc with integer midpoint spans
+    RasterTarget target = get_raster_target();
+    raster_fill_circle(&target, xPixelCoord, yPixelCoord, radius, colour);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for helper functions
+/////////////////////////////////////////////////////////////////////
+
+//convert x index to x pixel coordinate
+//pixel index will map to the top left most pixel of the square
+int x_to_pixel(int xCoord){
+    return SQUARE_PIXEL_X[xCoord];
+}
+
+//convert y index to y pixel coordinate
+//pixel index will map to the top left most pixel of the square
+int y_to_pixel(int yCoord){
+    return SQUARE_PIXEL_Y[yCoord];
+}
+
+//Gets the rasterizer target for the current back buffer
+RasterTarget get_raster_target() {
+
+    RasterTarget target;
+    target.pixels = framebuffer_back_buffer();
+    target.stride = FRAMEBUFFER_STRIDE;
+    target.width  = RESOLUTION_X;
+    target.height = RESOLUTION_Y;
+
+    return target;
+}
+
+/////////////////////////////////////////////////////////////////////
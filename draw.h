@@ -0,0 +1,122 @@
+/*
+VGA rendering of the chess board.
+
+All drawing goes to the back buffer of the active framebuffer backend (see framebuffer.h).
+*/
+
+#ifndef DRAW_H
+#define DRAW_H
+
+#include "chess.h"
+#include "geometry.h"
+#include "raster.h"
+
+
+// VGA colors
+static const int WHITE_SOFT            =0xeeeed2;
+static const int WHITE                 =0xffff;
+static const int BLACK                 =0x0000;
+static const int YELLOW                =0xFFE0;
+static const int RED                   =0xF800;
+static const int GREEN                 =0x769656;
+static const int BLUE                  =0x001F;
+static const int CYAN                  =0x07FF;
+static const int MAGENTA               =0xF81F;
+static const int GREY                  =0xC618;
+static const int PINK                  =0xFC18;
+static const int ORANGE                =0xFC00;
+
+
+// Resolution for the DE1-SoC VGA display
+static const int RESOLUTION_X          =320;
+static const int RESOLUTION_Y          =240;
+
+
+// Size of the drawn chess board squares is in geometry.h, with the tables built from it
+
+
+// Function prototypes for drawing to the VGA display
+/////////////////////////////////////////////////////////////////////
+
+//Plots a single pixel at the given coordinates with the given color
+void plot_pixel(int x, int y, short int line_colour);
+
+//Clears the screen with the colour black
+void clear_screen();
+
+//Set pixel buffer addresses
+void set_pixel_buffer_addresses();
+
+//Draws the chess board in its current state, the pieces of the position over the squares as render has them
+void draw_board(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const RenderBoard *render);
+
+//Draws background outline of the chess board
+void draw_squares(const RenderBoard *render);
+
+//Synchronizes the double buffering of the VGA display
+void wait_for_vsync();
+
+//Draws all pieces on the chess board
+void draw_pieces(PackedSquare board[BOARD_SIZE][BOARD_SIZE]);
+
+//Draws a single piece on the chess board
+void draw_piece(Piece piece, int xCoord, int yCoord);
+
+//Draws a single piece in the square with the left top corner at (x,y)
+//Used for pieces that are not aligned to a square, such as a piece sliding to its destination
+void draw_piece_at_pixel(Piece piece, int xPixelCoord, int yPixelCoord);
+
+//Draws a single square on the chess board
+void draw_square(RenderSquare square, int xCoord, int yCoord);
+
+//Draws a pawn in the square with the left top corner at (x,y)
+void draw_pawn(int pieceColour, int xPixelCoord, int yPixelCoord);
+
+//Draws a knight in the square with the left top corner at (x,y)
+void draw_knight(int pieceColour, int xPixelCoord, int yPixelCoord);
+
+//Draws a bishop in the square with the left top corner at (x,y)
+void draw_bishop(int pieceColour, int xPixelCoord, int yPixelCoord);
+
+//Draws a rook in the square with the left top corner at (x,y)
+void draw_rook(int pieceColour, int xPixelCoord, int yPixelCoord);
+
+//Draws a queen in the square with the left top corner at (x,y)
+void draw_queen(int pieceColour, int xPixelCoord, int yPixelCoord);
+
+//Draws a king in the square with the left top corner at (x,y)
+void draw_king(int pieceColour, int xPixelCoord, int yPixelCoord);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for drawing primitives to the VGA display
+/////////////////////////////////////////////////////////////////////
+
+//Draws a square with the left top corner at (x,y) with size (size) and colour (colour)
+void draw_square_primitive(int xPixelCoord, int yPixelCoord, int size, short int colour);
+
+//Draws a rectangle with the left top corner at (x,y) with size (width,height) and colour (colour)
+void draw_rectangle_primitive(int xPixelCoord, int yPixelCoord, int width, int height, short int colour);
+
+//Draws a circle with the center at (x,y) with radius (radius) and colour (colour)
+void draw_circle_primitive(int xPixelCoord, int yPixelCoord, int radius, short int colour);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for helper functions
+/////////////////////////////////////////////////////////////////////
+
+//convert x index to x pixel coordinate
+int x_to_pixel(int xCoord);
+
+//convert y index to y pixel coordinate
+int y_to_pixel(int yCoord);
+
+//Gets the rasterizer target for the current back buffer
+RasterTarget get_raster_target();
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
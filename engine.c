@@ -0,0 +1,86 @@
+/*
+Lets the search play a side of the game.
+*/
+
+#include "engine.h"
+#include "search_stats.h"
+#include "text_overlay.h"
+
+
+// Function prototypes for the search engine
+/////////////////////////////////////////////////////////////////////
+
+//Starts searching the position, the search keeps its own copy of the board
+static void engine_start(void *context, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Arena *arena);
+
+//Searches until the deadline, returns the best move once the search has finished
+static bool engine_think(void *context, unsigned int deadline, GameMove *move);
+
+//Shows the deepest finished depth in the engine information lines of the text strip
+static void show_stats(Engine *engine);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the engine
+/////////////////////////////////////////////////////////////////////
+
+//Sets up an engine that searches every move to the limits
+void engine_init(Engine *engine, const SearchOptions *options, const SearchLimits *limits) {
+
+    search_init(&engine->search, options);
+    engine->limits = *limits;
+
+    engine->engine.start = engine_start;
+    engine->engine.think = engine_think;
+    engine->engine.context = engine;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the search engine
+/////////////////////////////////////////////////////////////////////
+
+//Starts searching the position, the search keeps its own copy of the board
+static void engine_start(void *context, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Arena *arena) {
+
+    Engine *engine = context;
+    (void) arena;
+
+    search_start(&engine->search, board, currentTurn, &engine->limits);
+    engine->shownDepth = 0;
+    show_stats(engine);
+}
+
+//Searches until the deadline, returns the best move once the search has finished
+static bool engine_think(void *context, unsigned int deadline, GameMove *move) {
+
+    Engine *engine = context;
+    bool finished = search_step(&engine->search, deadline);
+    if (engine->search.completedDepth > engine->shownDepth) {
+        engine->shownDepth = engine->search.completedDepth;
+        show_stats(engine);
+    }
+    if (!finished) {
+        return false;
+    }
+
+    //With no moves at all the game is already over, the empty move is never played
+    Move best = engine->search.bestMove;
+    GameMove chosen = {MOVE_X(best.start), MOVE_Y(best.start), MOVE_X(best.end), MOVE_Y(best.end)};
+    *move = chosen;
+    return true;
+}
+
+//Shows the deepest finished depth in the engine information lines of the text strip
+static void show_stats(Engine *engine) {
+
+    for (int line = 0; line < SEARCH_STATS_BRIEF_LINES && line < TEXT_OVERLAY_INFO_LINES; line++) {
+        char text[SEARCH_STATS_BRIEF_WIDTH + 1];
+        search_stats_format_brief(&engine->search, line, text, sizeof(text));
+        text_overlay_set_info(line, text);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,47 @@
+/*
+Lets the search play a side of the game.
+
+The engine is a GameEngine (see game.h) around a Search: it starts a search when its turn
+starts and searches a few root moves on every tick of the game logic task, so the board
+keeps drawing and reading input while the computer thinks. The same search runs in the
+host tools, so what they measure is what the board plays.
+
+While it thinks, the engine information lines of the text strip show the deepest depth
+it has finished: score, nodes, branching factor and first move cutoffs, and the moves it
+expects (search_stats.h). They are only written when a depth finishes.
+*/
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "game.h"
+#include "search.h"
+
+
+// Default limits of a move on the board
+// Depth is capped too so a single root move stays short enough for one logic tick
+#define ENGINE_MOVE_MILLISECONDS 3000
+#define ENGINE_MAX_DEPTH         6
+
+
+//Engine holds a search and the limits of every move it plays
+typedef struct Engine
+{
+    Search search;
+    SearchLimits limits;
+    GameEngine engine;
+
+    //Deepest depth shown in the text strip
+    int shownDepth;
+} Engine;
+
+
+// Function prototypes for the engine
+/////////////////////////////////////////////////////////////////////
+
+//Sets up an engine that searches every move to the limits
+void engine_init(Engine *engine, const SearchOptions *options, const SearchLimits *limits);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
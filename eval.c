@@ -0,0 +1,42 @@
+/*
+Position evaluation for the engine.
+*/
+
+#include "eval.h"
+#include "eval_params.h"
+
+
+// Function definitions for evaluation
+/////////////////////////////////////////////////////////////////////
+
+//Returns the score of the position for the side to move, in centipawns
+int evaluate(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn) {
+
+    int whiteScore = 0;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+
+            PackedSquare square = board[yCoord][xCoord];
+            PieceIdx pieceId = PACKED_PIECE_ID(square);
+            if (pieceId == EMPTY_SQUARE) {
+                continue;
+            }
+
+            //Black reads the table upside down
+            if (PACKED_COLOUR(square) == WHITE_PIECE) {
+                whiteScore += PIECE_VALUES[pieceId] + SQUARE_BONUS[pieceId][yCoord * BOARD_SIZE + xCoord];
+            } else {
+                whiteScore -= PIECE_VALUES[pieceId] + SQUARE_BONUS[pieceId][(BOARD_SIZE - 1 - yCoord) * BOARD_SIZE + xCoord];
+            }
+        }
+    }
+
+    return currentTurn == WHITE_PIECE ? whiteScore : -whiteScore;
+}
+
+//Returns the material value of a piece, in centipawns
+int piece_value(PieceIdx piece) {
+    return PIECE_VALUES[piece];
+}
+
+/////////////////////////////////////////////////////////////////////
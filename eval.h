@@ -0,0 +1,28 @@
+/*
+Position evaluation for the engine.
+
+A position is scored in centipawns from the point of view of the side to move: the
+material of each side plus a bonus for every piece from a table of its squares, which
+pulls knights and bishops to the centre, pawns up the board and the king behind them.
+The tables are written for white, yCoord 0 being the far rank, and read upside down for
+black. They live in eval_params.h, which tools/tune.c writes from a file of positions.
+*/
+
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "chess.h"
+
+
+// Function prototypes for evaluation
+/////////////////////////////////////////////////////////////////////
+
+//Returns the score of the position for the side to move, in centipawns
+int evaluate(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn);
+
+//Returns the material value of a piece, in centipawns
+int piece_value(PieceIdx piece);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,321 @@
+/*
+Opening explorer: the moves played from a position in an archive of games, and how the
+games went.
+*/
+
+#include <string.h>
+
+#include "explorer.h"
+
+
+// File signature
+static const unsigned char EXPLORER_MAGIC[3] = {'C', 'H', 'X'};
+
+// Key of white to move, the pieces are mixed into it
+#define WHITE_TO_MOVE_KEY 0x9e3779b97f4a7c15ull
+
+
+// Function prototypes for explorer helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the random number of a piece on a square, the packed square picks the piece and colour
+static uint64_t piece_key(int square, PackedSquare piece);
+
+//Reads little endian numbers of 32 and 64 bits
+static uint32_t read_uint32(const unsigned char *bytes);
+static uint64_t read_uint64(const unsigned char *bytes);
+
+//Writes little endian numbers of 32 and 64 bits
+static void write_uint32(unsigned char *bytes, uint32_t value);
+static void write_uint64(unsigned char *bytes, uint64_t value);
+
+//Reads a variable length integer at *next, no further than end, and moves *next past it
+//Returns false if it runs past end or is longer than 64 bits take
+static bool read_varint(const unsigned char **next, const unsigned char *end, uint64_t *value);
+
+//Writes a variable length integer, 7 bits a byte with the high bit set on all but the last
+//Returns the number of bytes written, at most 10
+static int write_varint(unsigned char *bytes, uint64_t value);
+
+//Finds the block that holds the key if any block does, the last one starting at or below it
+//Returns -1 if the key is below the first block
+static int find_block(const Explorer *explorer, uint64_t key);
+
+//Sorts moves by the number of games, most first
+static void sort_moves(ExplorerMove *moves, int count);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the explorer
+/////////////////////////////////////////////////////////////////////
+
+//Returns the key of a position with the side to move
+uint64_t explorer_key(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn) {
+
+    uint64_t key = currentTurn == WHITE_PIECE ? WHITE_TO_MOVE_KEY : 0;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if (board[yCoord][xCoord] != PACKED_EMPTY) {
+                key ^= piece_key(MOVE_SQUARE(xCoord, yCoord), board[yCoord][xCoord]);
+            }
+        }
+    }
+    return key;
+}
+
+//Returns the key of the position after a move, from the key before it, which turns the turn over
+//Call it before the move is made, the board tells which piece moves and which is taken
+uint64_t explorer_key_after(uint64_t key, PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move) {
+
+    PackedSquare piece = board[MOVE_Y(move.start)][MOVE_X(move.start)];
+    PackedSquare taken = board[MOVE_Y(move.end)][MOVE_X(move.end)];
+
+    key ^= WHITE_TO_MOVE_KEY ^ piece_key(move.start, piece) ^ piece_key(move.end, piece);
+    if (taken != PACKED_EMPTY) {
+        key ^= piece_key(move.end, taken);
+    }
+    return key;
+}
+
+//Starts reading an explorer file from its bytes, which must stay in place while it is read
+//Returns false if the bytes are not an explorer file of this version
+bool explorer_open(Explorer *explorer, const unsigned char *bytes, size_t size) {
+
+    if (size < EXPLORER_HEADER_SIZE || memcmp(bytes, EXPLORER_MAGIC, sizeof(EXPLORER_MAGIC)) != 0 || bytes[3] != EXPLORER_VERSION) {
+        return false;
+    }
+
+    ExplorerHeader *header = &explorer->header;
+    header->blockCount = read_uint32(&bytes[4]);
+    header->positionCount = read_uint64(&bytes[8]);
+    header->recordCount = read_uint64(&bytes[16]);
+    header->gameCount = read_uint64(&bytes[24]);
+    header->indexOffset = read_uint64(&bytes[32]);
+
+    //The index ends the file, every block lies between the header and the index
+    if (header->indexOffset < EXPLORER_HEADER_SIZE || header->indexOffset > size
+        || (size - header->indexOffset) / EXPLORER_INDEX_ENTRY_SIZE != header->blockCount
+        || (size - header->indexOffset) % EXPLORER_INDEX_ENTRY_SIZE != 0) {
+        return false;
+    }
+    for (uint32_t block = 0; block < header->blockCount; block++) {
+        uint64_t offset = read_uint64(&bytes[header->indexOffset + (uint64_t) block * EXPLORER_INDEX_ENTRY_SIZE + 8]);
+        uint64_t previous = block > 0 ? read_uint64(&bytes[header->indexOffset + (uint64_t) (block - 1) * EXPLORER_INDEX_ENTRY_SIZE + 8]) : 0;
+        if (offset < EXPLORER_HEADER_SIZE || offset > header->indexOffset || offset < previous) {
+            return false;
+        }
+    }
+
+    explorer->bytes = bytes;
+    explorer->size = size;
+    return true;
+}
+
+//Finds the moves played from the position with a key, at most maxMoves of them, most played first
+//Returns the number of moves found, 0 if the position is not in the file
+int explorer_lookup(const Explorer *explorer, uint64_t key, ExplorerMove *moves, int maxMoves) {
+
+    int block = find_block(explorer, key);
+    if (block < 0) {
+        return 0;
+    }
+
+    const unsigned char *entry = &explorer->bytes[explorer->header.indexOffset + (uint64_t) block * EXPLORER_INDEX_ENTRY_SIZE];
+    const unsigned char *next = &explorer->bytes[read_uint64(&entry[8])];
+    const unsigned char *end = block + 1 < (int) explorer->header.blockCount
+        ? &explorer->bytes[read_uint64(&entry[EXPLORER_INDEX_ENTRY_SIZE + 8])] : &explorer->bytes[explorer->header.indexOffset];
+
+    //Every move of the position is kept so the most played can be picked, a position has at most MAX_MOVES
+    ExplorerMove found[MAX_MOVES];
+    int count = 0;
+
+    uint64_t recordKey = read_uint64(entry);
+    while (next < end && count < MAX_MOVES) {
+
+        uint64_t difference;
+        uint64_t counts[4];
+        if (!read_varint(&next, end, &difference) || end - next < 2) {
+            break;
+        }
+        recordKey += difference;
+        if (recordKey > key) {
+            break;
+        }
+
+        Move move = {next[0], next[1]};
+        next += 2;
+
+        bool read = true;
+        for (int index = 0; index < 4; index++) {
+            read = read && read_varint(&next, end, &counts[index]);
+        }
+        if (!read) {
+            break;
+        }
+
+        if (recordKey == key) {
+            ExplorerMove *played = &found[count++];
+            played->move = move;
+            played->games = (uint32_t) counts[0];
+            played->whiteWins = (uint32_t) counts[1];
+            played->draws = (uint32_t) counts[2];
+            played->blackWins = (uint32_t) counts[3];
+        }
+    }
+
+    sort_moves(found, count);
+    if (count > maxMoves) {
+        count = maxMoves;
+    }
+    memcpy(moves, found, count * sizeof(ExplorerMove));
+    return count;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for writing explorer files
+/////////////////////////////////////////////////////////////////////
+
+//Writes the header into bytes, which holds EXPLORER_HEADER_SIZE
+void explorer_write_header(unsigned char *bytes, const ExplorerHeader *header) {
+
+    memcpy(bytes, EXPLORER_MAGIC, sizeof(EXPLORER_MAGIC));
+    bytes[3] = EXPLORER_VERSION;
+    write_uint32(&bytes[4], header->blockCount);
+    write_uint64(&bytes[8], header->positionCount);
+    write_uint64(&bytes[16], header->recordCount);
+    write_uint64(&bytes[24], header->gameCount);
+    write_uint64(&bytes[32], header->indexOffset);
+}
+
+//Writes an index entry into bytes, which holds EXPLORER_INDEX_ENTRY_SIZE
+void explorer_write_index_entry(unsigned char *bytes, uint64_t firstKey, uint64_t offset) {
+
+    write_uint64(&bytes[0], firstKey);
+    write_uint64(&bytes[8], offset);
+}
+
+//Writes a record into bytes, which holds EXPLORER_MAX_RECORD_SIZE
+//Returns the number of bytes written
+int explorer_write_record(unsigned char *bytes, uint64_t previousKey, uint64_t key, const ExplorerMove *move) {
+
+    int length = write_varint(bytes, key - previousKey);
+    bytes[length++] = move->move.start;
+    bytes[length++] = move->move.end;
+    length += write_varint(&bytes[length], move->games);
+    length += write_varint(&bytes[length], move->whiteWins);
+    length += write_varint(&bytes[length], move->draws);
+    length += write_varint(&bytes[length], move->blackWins);
+    return length;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for explorer helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the random number of a piece on a square, the packed square picks the piece and colour
+//The finalizer of splitmix64 turns the square and piece into 64 well mixed bits
+static uint64_t piece_key(int square, PackedSquare piece) {
+
+    uint64_t value = ((uint64_t) square << 8 | piece) * WHITE_TO_MOVE_KEY;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+//Reads a little endian number of 32 bits
+static uint32_t read_uint32(const unsigned char *bytes) {
+    return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+//Reads a little endian number of 64 bits
+static uint64_t read_uint64(const unsigned char *bytes) {
+    return (uint64_t) read_uint32(bytes) | (uint64_t) read_uint32(&bytes[4]) << 32;
+}
+
+//Writes a little endian number of 32 bits
+static void write_uint32(unsigned char *bytes, uint32_t value) {
+
+    for (int index = 0; index < 4; index++) {
+        bytes[index] = (unsigned char) (value >> (8 * index));
+    }
+}
+
+//Writes a little endian number of 64 bits
+static void write_uint64(unsigned char *bytes, uint64_t value) {
+
+    write_uint32(bytes, (uint32_t) value);
+    write_uint32(&bytes[4], (uint32_t) (value >> 32));
+}
+
+//Reads a variable length integer at *next, no further than end, and moves *next past it
+//Returns false if it runs past end or is longer than 64 bits take
+static bool read_varint(const unsigned char **next, const unsigned char *end, uint64_t *value) {
+
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && *next < end; shift += 7) {
+
+        unsigned char byte = *(*next)++;
+        result |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+//Writes a variable length integer, 7 bits a byte with the high bit set on all but the last
+//Returns the number of bytes written, at most 10
+static int write_varint(unsigned char *bytes, uint64_t value) {
+
+    int length = 0;
+    while (value >= 0x80) {
+        bytes[length++] = (unsigned char) (value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (unsigned char) value;
+    return length;
+}
+
+//Finds the block that holds the key if any block does, the last one starting at or below it
+//Returns -1 if the key is below the first block
+static int find_block(const Explorer *explorer, uint64_t key) {
+
+    const unsigned char *index = &explorer->bytes[explorer->header.indexOffset];
+    int low = 0;
+    int high = (int) explorer->header.blockCount - 1;
+    int found = -1;
+
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+        if (read_uint64(&index[(uint64_t) middle * EXPLORER_INDEX_ENTRY_SIZE]) <= key) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return found;
+}
+
+//Sorts moves by the number of games, most first
+//A position has few moves, insertion sort is enough
+static void sort_moves(ExplorerMove *moves, int count) {
+
+    for (int index = 1; index < count; index++) {
+        ExplorerMove move = moves[index];
+        int place = index;
+        while (place > 0 && moves[place - 1].games < move.games) {
+            moves[place] = moves[place - 1];
+            place--;
+        }
+        moves[place] = move;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,139 @@
+/*
+Opening explorer: the moves played from a position in an archive of games, and how the
+games went.
+
+An explorer file maps a position to every move played from it with the number of games
+that played it and how many of those white won, drew and black won. tools/explorer_build.c
+writes one from PGN files. The file is made to be read in place, from a file mapped into
+memory (explorer_host.c) or any other bytes, with nothing to load:
+
+  header   40 bytes  'C' 'H' 'X' EXPLORER_VERSION, block count (32 bits),
+                     positions, records, games (64 bits each), offset of the index (64 bits)
+  blocks             records sorted by position key then move, every move of a position in
+                     the same block, about EXPLORER_BLOCK_SIZE bytes each
+  index              16 bytes per block: key of its first record, offset of the block
+
+Every number is little endian. A record is a position key, a move and its four counts,
+compressed within its block: the key as the difference from the record before it (0 for
+the first record of a block and for the other moves of the same position) and the counts
+as variable length integers, 7 bits a byte. Most positions of an archive are reached by
+one game alone, so most records are a new key: records take about 12 bytes where their
+fields take 26, and a few bytes when they follow another move of the same position.
+
+A lookup searches the index for the one block that can hold the key and reads that block
+alone, so it touches the index and a few kilobytes of the file.
+
+The key of a position is a 64 bit Zobrist hash of its pieces and the side to move. Its
+random numbers are made from the square and piece by a mixing function rather than kept
+in a table, so the board and every tool agree on them without sharing one. A move changes
+the key by the squares it touches alone (explorer_key_after), as a game is replayed.
+*/
+
+#ifndef EXPLORER_H
+#define EXPLORER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chess.h"
+#include "movegen.h"
+
+
+// Version of the file format
+#define EXPLORER_VERSION 1
+
+// Bytes of the header and of an index entry
+#define EXPLORER_HEADER_SIZE 40
+#define EXPLORER_INDEX_ENTRY_SIZE 16
+
+// Size a block is closed at, a position whose moves take more gets a block of its own that size or larger
+#define EXPLORER_BLOCK_SIZE 4096
+
+// Most bytes a record can take
+#define EXPLORER_MAX_RECORD_SIZE (10 + 2 + 4 * 5)
+
+
+//ExplorerMove holds a move played from a position and how the games that played it ended
+//Games with no result are counted in games alone
+typedef struct ExplorerMove
+{
+    Move move;
+    uint32_t games;
+    uint32_t whiteWins;
+    uint32_t draws;
+    uint32_t blackWins;
+} ExplorerMove;
+
+
+//ExplorerHeader holds the totals of an explorer file and where its index is
+typedef struct ExplorerHeader
+{
+    uint32_t blockCount;
+    uint64_t positionCount;
+    uint64_t recordCount;
+    uint64_t gameCount;
+    uint64_t indexOffset;
+} ExplorerHeader;
+
+
+//Explorer holds an explorer file being read in place
+typedef struct Explorer
+{
+    const unsigned char *bytes;
+    size_t size;
+    ExplorerHeader header;
+} Explorer;
+
+
+// Function prototypes for the explorer
+/////////////////////////////////////////////////////////////////////
+
+//Returns the key of a position with the side to move
+uint64_t explorer_key(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn);
+
+//Returns the key of the position after a move, from the key before it, which turns the turn over
+//Call it before the move is made, the board tells which piece moves and which is taken
+uint64_t explorer_key_after(uint64_t key, PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move);
+
+//Starts reading an explorer file from its bytes, which must stay in place while it is read
+//Returns false if the bytes are not an explorer file of this version
+bool explorer_open(Explorer *explorer, const unsigned char *bytes, size_t size);
+
+//Finds the moves played from the position with a key, at most maxMoves of them, most played first
+//Returns the number of moves found, 0 if the position is not in the file
+int explorer_lookup(const Explorer *explorer, uint64_t key, ExplorerMove *moves, int maxMoves);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for writing explorer files
+/////////////////////////////////////////////////////////////////////
+
+//Writes the header into bytes, which holds EXPLORER_HEADER_SIZE
+void explorer_write_header(unsigned char *bytes, const ExplorerHeader *header);
+
+//Writes an index entry into bytes, which holds EXPLORER_INDEX_ENTRY_SIZE
+void explorer_write_index_entry(unsigned char *bytes, uint64_t firstKey, uint64_t offset);
+
+//Writes a record into bytes, which holds EXPLORER_MAX_RECORD_SIZE, previousKey is the key of the
+//record before it in the block, or its own key for the first record of a block
+//Returns the number of bytes written
+int explorer_write_record(unsigned char *bytes, uint64_t previousKey, uint64_t key, const ExplorerMove *move);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host backend (explorer_host.c)
+/////////////////////////////////////////////////////////////////////
+
+//Maps an explorer file into memory and starts reading it
+//Returns false if the file can not be mapped or is not an explorer file
+bool explorer_host_map(Explorer *explorer, const char *path);
+
+//Unmaps a file mapped with explorer_host_map
+void explorer_host_unmap(Explorer *explorer);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,53 @@
+/*
+Maps explorer files into memory on a Linux host.
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "explorer.h"
+
+
+// Function definitions only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Maps an explorer file into memory and starts reading it
+//Returns false if the file can not be mapped or is not an explorer file
+bool explorer_host_map(Explorer *explorer, const char *path) {
+
+    int file = open(path, O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) < 0 || status.st_size < EXPLORER_HEADER_SIZE) {
+        if (file >= 0) {
+            close(file);
+        }
+        return false;
+    }
+
+    //The mapping keeps the file open, lookups jump to one block each so read ahead only wastes the page cache
+    size_t size = (size_t) status.st_size;
+    void *bytes = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (bytes == MAP_FAILED) {
+        return false;
+    }
+    madvise(bytes, size, MADV_RANDOM);
+
+    if (!explorer_open(explorer, bytes, size)) {
+        munmap(bytes, size);
+        return false;
+    }
+    return true;
+}
+
+//Unmaps a file mapped with explorer_host_map
+void explorer_host_unmap(Explorer *explorer) {
+
+    munmap((void *) explorer->bytes, explorer->size);
+    explorer->bytes = NULL;
+    explorer->size = 0;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,296 @@
+/*
+Forsyth-Edwards Notation (FEN) for setting up and saving positions.
+*/
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fen.h"
+
+
+//Letters of the pieces indexed by piece ID, white pieces are upper case
+static const char PIECE_LETTERS[] = " pnbrqk";
+
+//Castling letters in the order FEN writes them, with their rights
+static const char CASTLING_LETTERS[] = "KQkq";
+static const int CASTLING_RIGHTS[] = {FEN_CASTLE_WHITE_KING, FEN_CASTLE_WHITE_QUEEN, FEN_CASTLE_BLACK_KING, FEN_CASTLE_BLACK_QUEEN};
+
+
+// Function prototypes for FEN helpers
+/////////////////////////////////////////////////////////////////////
+
+//Reads the piece placement field into board
+//Returns a pointer past the field, or NULL if it is not 8 ranks of 8 squares
+static const char * read_placement(const char *text, PackedSquare board[BOARD_SIZE][BOARD_SIZE]);
+
+//Reads a non negative number
+//Returns a pointer past it, or NULL if there is no number or it does not fit in an int
+static const char * read_number(const char *text, int *number);
+
+//Skips the spaces between fields
+//Returns true if there is another field
+static bool next_field(const char **text);
+
+//Checks if a field ends here, at a space or the end of the line
+static bool field_ends(const char *text);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for FEN
+/////////////////////////////////////////////////////////////////////
+
+//Sets up the board and state from a FEN string
+//Returns false, leaving board and state unchanged, if the string is not a valid FEN
+bool fen_load(const char *fen, PackedSquare board[BOARD_SIZE][BOARD_SIZE], FenState *state) {
+
+    //Parsed into copies so a bad string changes nothing
+    PackedSquare parsedBoard[BOARD_SIZE][BOARD_SIZE];
+    FenState parsedState;
+
+    const char *text = read_placement(fen, parsedBoard);
+    if (text == NULL || !next_field(&text)) {
+        return false;
+    }
+
+    //Side to move
+    if (*text == 'w') {
+        fen_state_init(&parsedState, WHITE_PIECE);
+    } else if (*text == 'b') {
+        fen_state_init(&parsedState, BLACK_PIECE);
+    } else {
+        return false;
+    }
+    text++;
+    if (!field_ends(text)) {
+        return false;
+    }
+
+    //Castling rights
+    if (next_field(&text)) {
+        if (*text == '-') {
+            text++;
+            if (!field_ends(text)) {
+                return false;
+            }
+        } else {
+            for (; *text != ' ' && *text != '\0' && *text != '\n' && *text != '\r'; text++) {
+                const char *letter = strchr(CASTLING_LETTERS, *text);
+                if (letter == NULL) {
+                    return false;
+                }
+                parsedState.castling |= CASTLING_RIGHTS[letter - CASTLING_LETTERS];
+            }
+        }
+    }
+
+    //En passant square
+    if (next_field(&text)) {
+        if (*text == '-') {
+            text++;
+        } else if (text[0] >= 'a' && text[0] <= 'h' && text[1] >= '1' && text[1] <= '8') {
+            parsedState.enPassant.xCoord = text[0] - 'a';
+            parsedState.enPassant.yCoord = '8' - text[1];
+            text += 2;
+        } else {
+            return false;
+        }
+        if (!field_ends(text)) {
+            return false;
+        }
+    }
+
+    //Move counters, EPD operations start with a letter, take their place in EPD lines and are ignored
+    const char *counters = text;
+    if (next_field(&counters) && *counters >= '0' && *counters <= '9') {
+        text = read_number(counters, &parsedState.halfmoveClock);
+        if (text == NULL || !field_ends(text)) {
+            return false;
+        }
+        if (next_field(&text)) {
+            text = read_number(text, &parsedState.fullmoveNumber);
+            if (text == NULL || !field_ends(text)) {
+                return false;
+            }
+        }
+    }
+
+    copy_board(parsedBoard, board);
+    if (state != NULL) {
+        *state = parsedState;
+    }
+    return true;
+}
+
+//Writes the board and state as a FEN string into text, which holds size characters
+//Returns the length of the string, or -1 if it does not fit
+int fen_write(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const FenState *state, char *text, int size) {
+
+    char fen[FEN_MAX_SIZE];
+    int length = 0;
+
+    //Pieces, counting runs of empty squares
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+
+        int emptySquares = 0;
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+
+            PackedSquare square = board[yCoord][xCoord];
+            if (PACKED_PIECE_ID(square) == EMPTY_SQUARE) {
+                emptySquares++;
+                continue;
+            }
+
+            if (emptySquares > 0) {
+                fen[length++] = (char) ('0' + emptySquares);
+                emptySquares = 0;
+            }
+
+            char letter = PIECE_LETTERS[PACKED_PIECE_ID(square)];
+            fen[length++] = PACKED_COLOUR(square) == WHITE_PIECE ? (char) (letter - 'a' + 'A') : letter;
+        }
+
+        if (emptySquares > 0) {
+            fen[length++] = (char) ('0' + emptySquares);
+        }
+        if (yCoord < BOARD_SIZE - 1) {
+            fen[length++] = '/';
+        }
+    }
+
+    //Side to move
+    fen[length++] = ' ';
+    fen[length++] = state->currentTurn == WHITE_PIECE ? 'w' : 'b';
+
+    //Castling rights
+    fen[length++] = ' ';
+    if (state->castling == 0) {
+        fen[length++] = '-';
+    }
+    for (int right = 0; right < 4; right++) {
+        if (state->castling & CASTLING_RIGHTS[right]) {
+            fen[length++] = CASTLING_LETTERS[right];
+        }
+    }
+
+    //En passant square
+    fen[length++] = ' ';
+    if (state->enPassant.xCoord < 0) {
+        fen[length++] = '-';
+    } else {
+        fen[length++] = (char) ('a' + state->enPassant.xCoord);
+        fen[length++] = (char) ('8' - state->enPassant.yCoord);
+    }
+
+    //Move counters
+    length += snprintf(&fen[length], sizeof(fen) - length, " %d %d", state->halfmoveClock, state->fullmoveNumber);
+
+    if (length >= size || length >= (int) sizeof(fen)) {
+        return -1;
+    }
+
+    memcpy(text, fen, length + 1);
+    return length;
+}
+
+//Sets up a state with no castling rights or en passant square at the first move
+void fen_state_init(FenState *state, int currentTurn) {
+
+    state->currentTurn = currentTurn;
+    state->castling = 0;
+    state->enPassant.xCoord = -1;
+    state->enPassant.yCoord = -1;
+    state->halfmoveClock = 0;
+    state->fullmoveNumber = 1;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for FEN helpers
+/////////////////////////////////////////////////////////////////////
+
+//Reads the piece placement field into board
+//Returns a pointer past the field, or NULL if it is not 8 ranks of 8 squares
+static const char * read_placement(const char *text, PackedSquare board[BOARD_SIZE][BOARD_SIZE]) {
+
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+
+        //Ranks after the first start with a slash
+        if (yCoord > 0 && *text++ != '/') {
+            return NULL;
+        }
+
+        int xCoord = 0;
+        while (xCoord < BOARD_SIZE) {
+
+            char letter = *text++;
+
+            //A digit is a run of empty squares
+            if (letter >= '1' && letter <= '8') {
+                int run = letter - '0';
+                if (xCoord + run > BOARD_SIZE) {
+                    return NULL;
+                }
+                for (; run > 0; run--, xCoord++) {
+                    board[yCoord][xCoord] = PACKED_EMPTY;
+                }
+                continue;
+            }
+
+            //Upper case letters are white pieces
+            bool white = letter >= 'A' && letter <= 'Z';
+            const char *pieceLetter = letter != ' ' && letter != '\0' ? strchr(PIECE_LETTERS + 1, white ? letter - 'A' + 'a' : letter) : NULL;
+            if (pieceLetter == NULL) {
+                return NULL;
+            }
+
+            board[yCoord][xCoord] = PACK_PIECE((PieceIdx) (pieceLetter - PIECE_LETTERS), white ? WHITE_PIECE : BLACK_PIECE);
+            xCoord++;
+        }
+    }
+
+    return text;
+}
+
+//Reads a non negative number
+//Returns a pointer past it, or NULL if there is no number or it does not fit in an int
+static const char * read_number(const char *text, int *number) {
+
+    if (*text < '0' || *text > '9') {
+        return NULL;
+    }
+
+    int value = 0;
+    for (; *text >= '0' && *text <= '9'; text++) {
+        int digit = *text - '0';
+        if (value > (INT_MAX - digit) / 10) {
+            return NULL;
+        }
+        value = value * 10 + digit;
+    }
+
+    *number = value;
+    return text;
+}
+
+//Skips the spaces between fields
+//Returns true if there is another field
+static bool next_field(const char **text) {
+
+    if (**text != ' ') {
+        return false;
+    }
+    while (**text == ' ') {
+        (*text)++;
+    }
+    return **text != '\0' && **text != '\n' && **text != '\r';
+}
+
+//Checks if a field ends here, at a space or the end of the line
+static bool field_ends(const char *text) {
+    return *text == ' ' || *text == '\0' || *text == '\n' || *text == '\r';
+}
+
+/////////////////////////////////////////////////////////////////////
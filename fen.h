@@ -0,0 +1,72 @@
+/*
+Forsyth-Edwards Notation (FEN) for setting up and saving positions.
+
+A FEN string holds the pieces rank by rank from rank 8 (yCoord 0) down to rank 1, the side
+to move, castling rights, the en passant square and the move counters, for example
+  rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1
+The rules do not castle or capture en passant yet, so those fields and the counters are
+only read into a FenState and written back unchanged. Everything after the side to move
+may be left out, and EPD operations in place of the move counters are ignored, so EPD
+lines load as well.
+
+Loading writes straight into the board and never allocates, so positions can be loaded
+as fast as benchmarks and tests need them.
+*/
+
+#ifndef FEN_H
+#define FEN_H
+
+#include <stdbool.h>
+
+#include "chess.h"
+
+
+// The initial position
+#define FEN_INITIAL_POSITION "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+// Size of a buffer that holds any position fen_write produces, with its terminator
+#define FEN_MAX_SIZE 96
+
+// Castling rights
+#define FEN_CASTLE_WHITE_KING  0x1
+#define FEN_CASTLE_WHITE_QUEEN 0x2
+#define FEN_CASTLE_BLACK_KING  0x4
+#define FEN_CASTLE_BLACK_QUEEN 0x8
+
+
+//FenState holds the fields of a FEN string besides the pieces
+typedef struct FenState
+{
+    //WHITE_PIECE or BLACK_PIECE
+    int currentTurn;
+
+    //FEN_CASTLE_* bits
+    int castling;
+
+    //Square a pawn can be taken on en passant, (-1,-1) for none
+    SquareCoord enPassant;
+
+    //Moves since the last capture or pawn move, and the number of the move, starting at 1
+    int halfmoveClock;
+    int fullmoveNumber;
+} FenState;
+
+
+// Function prototypes for FEN
+/////////////////////////////////////////////////////////////////////
+
+//Sets up the board and state from a FEN string
+//state may be NULL if only the pieces are wanted
+//Returns false, leaving board and state unchanged, if the string is not a valid FEN
+bool fen_load(const char *fen, PackedSquare board[BOARD_SIZE][BOARD_SIZE], FenState *state);
+
+//Writes the board and state as a FEN string into text, which holds size characters
+//Returns the length of the string, or -1 if it does not fit
+int fen_write(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const FenState *state, char *text, int size);
+
+//Sets up a state with no castling rights or en passant square at the first move
+void fen_state_init(FenState *state, int currentTurn);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
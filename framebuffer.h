@@ -0,0 +1,82 @@
+/*
+Framebuffer backend used by the drawing code.
+
+Besides the pixel buffer the backend also owns the character buffer, which the VGA
+controller mixes over the pixels.
+
+The VGA pixel buffer is double buffered: drawing always goes to the back buffer and
+framebuffer_swap presents it. There are two implementations of this interface, link
+exactly one of them:
+  framebuffer_mmio.c  - DE1-SoC pixel buffer controller
+  framebuffer_host.c  - in-memory buffers for running the renderer on a Linux host
+*/
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdbool.h>
+
+
+// Memory layout of a pixel buffer, rows are 1024 bytes apart
+#define FRAMEBUFFER_STRIDE 512
+#define FRAMEBUFFER_WIDTH  320
+#define FRAMEBUFFER_HEIGHT 240
+
+// Size of the character buffer, each character covers 4 by 4 pixels
+#define CHARBUFFER_WIDTH  80
+#define CHARBUFFER_HEIGHT 60
+
+// Time between two vsyncs of the 60 Hz VGA output
+#define FRAMEBUFFER_VSYNC_PERIOD_US 16667
+
+
+// Function prototypes for the framebuffer backend
+/////////////////////////////////////////////////////////////////////
+
+//Points the front and back buffers at their memory
+//The back buffer is current when this returns
+void framebuffer_init();
+
+//Returns the address of the back buffer that the drawing functions write to
+short int * framebuffer_back_buffer();
+
+//Returns the address of the buffer currently shown on the display
+short int * framebuffer_front_buffer();
+
+//Swaps the front and back buffers and waits for the swap to happen on vsync
+void framebuffer_swap();
+
+//Starts swapping the front and back buffers, the swap happens on the next vsync
+void framebuffer_begin_swap();
+
+//Checks if the swap started by framebuffer_begin_swap has happened
+//The back buffer only changes once this has returned true
+bool framebuffer_swap_done();
+
+//Writes a character to the character buffer at column, row
+void framebuffer_put_char(int column, int row, char character);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Returns the number of swaps since framebuffer_init
+int framebuffer_frame_count();
+
+//Writes the front buffer to a binary PPM file
+//Returns false if the file could not be written
+bool framebuffer_write_ppm(const char *path);
+
+//Returns the character at column, row of the character buffer
+char framebuffer_char_at(int column, int row);
+
+//Makes swaps wait for the next emulated 60 Hz vsync of the timer clock, like the board
+//On simulated time (timer_host_set_simulated) the clock is moved forward to the vsync instead of waiting
+//Without it, which is the default, swaps complete immediately
+void framebuffer_host_set_vsync(bool vsync);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,159 @@
+/*
+In-memory framebuffer backend for running the renderer on a Linux host.
+
+Emulates the two pixel buffers of the DE1-SoC and the front/back swap, so frames can be
+timed and written out as PPM images without the board.
+*/
+
+#include <stdio.h>
+
+#include "framebuffer.h"
+#include "timer.h"
+
+
+//Memory for the two emulated pixel buffers
+static short int firstBuffer[FRAMEBUFFER_STRIDE * FRAMEBUFFER_HEIGHT];
+static short int secondBuffer[FRAMEBUFFER_STRIDE * FRAMEBUFFER_HEIGHT];
+
+//Buffer registers of the emulated pixel buffer controller
+static short int *frontBuffer = firstBuffer;
+static short int *backBuffer  = secondBuffer;
+
+//Memory for the emulated character buffer
+static char characters[CHARBUFFER_HEIGHT][CHARBUFFER_WIDTH];
+
+//Number of swaps since framebuffer_init
+static int frameCount = 0;
+
+//Emulated vsync: if swaps wait for it, and the time a started swap happens
+static bool vsyncEnabled = false;
+static bool swapPending = false;
+static unsigned int swapTime = 0;
+
+
+// Function definitions for the framebuffer backend
+/////////////////////////////////////////////////////////////////////
+
+//Points the front and back buffers at their memory
+//The back buffer is current when this returns
+void framebuffer_init() {
+
+    frontBuffer = firstBuffer;
+    backBuffer  = secondBuffer;
+    frameCount  = 0;
+    swapPending = false;
+}
+
+//Returns the address of the back buffer that the drawing functions write to
+short int * framebuffer_back_buffer() {
+    return backBuffer;
+}
+
+//Returns the address of the buffer currently shown on the display
+short int * framebuffer_front_buffer() {
+    return frontBuffer;
+}
+
+//Swaps the front and back buffers
+//Without the emulated vsync the swap completes immediately
+void framebuffer_swap() {
+
+    framebuffer_begin_swap();
+    while (!framebuffer_swap_done());
+}
+
+//Starts swapping the front and back buffers
+void framebuffer_begin_swap() {
+
+    swapPending = true;
+
+    //The swap happens on the next 60 Hz boundary of the clock
+    unsigned int now = timer_microseconds();
+    swapTime = vsyncEnabled ? (now / FRAMEBUFFER_VSYNC_PERIOD_US + 1) * FRAMEBUFFER_VSYNC_PERIOD_US : now;
+}
+
+//Checks if the swap started by framebuffer_begin_swap has happened
+bool framebuffer_swap_done() {
+
+    if (!swapPending) {
+        return true;
+    }
+
+    //Simulated time does not pass by itself, waiting for the vsync moves it there
+    unsigned int now = timer_microseconds();
+    if (timer_host_is_simulated() && (int) (swapTime - now) > 0) {
+        timer_host_advance(swapTime - now);
+        now = swapTime;
+    }
+
+    if ((int) (now - swapTime) < 0) {
+        return false;
+    }
+
+    short int *presented = backBuffer;
+    backBuffer  = frontBuffer;
+    frontBuffer = presented;
+
+    frameCount++;
+    swapPending = false;
+    return true;
+}
+
+//Writes a character to the character buffer at column, row
+void framebuffer_put_char(int column, int row, char character) {
+    characters[row][column] = character;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Returns the number of swaps since framebuffer_init
+int framebuffer_frame_count() {
+    return frameCount;
+}
+
+//Writes the front buffer to a binary PPM file
+//Returns false if the file could not be written
+bool framebuffer_write_ppm(const char *path) {
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+
+    //Expand every RGB565 pixel to 8 bits per channel
+    unsigned char row[FRAMEBUFFER_WIDTH * 3];
+    for (int yCoord = 0; yCoord < FRAMEBUFFER_HEIGHT; yCoord++) {
+        for (int xCoord = 0; xCoord < FRAMEBUFFER_WIDTH; xCoord++) {
+            unsigned short pixel = (unsigned short) frontBuffer[yCoord * FRAMEBUFFER_STRIDE + xCoord];
+            int red   = (pixel >> 11) & 0x1F;
+            int green = (pixel >> 5) & 0x3F;
+            int blue  = pixel & 0x1F;
+            row[xCoord * 3 + 0] = (unsigned char) ((red << 3) | (red >> 2));
+            row[xCoord * 3 + 1] = (unsigned char) ((green << 2) | (green >> 4));
+            row[xCoord * 3 + 2] = (unsigned char) ((blue << 3) | (blue >> 2));
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+
+    bool written = !ferror(file);
+    fclose(file);
+    return written;
+}
+
+//Returns the character at column, row of the character buffer
+char framebuffer_char_at(int column, int row) {
+    return characters[row][column];
+}
+
+//Makes swaps wait for the next emulated 60 Hz vsync of the timer clock
+void framebuffer_host_set_vsync(bool vsync) {
+    vsyncEnabled = vsync;
+}
+
+/////////////////////////////////////////////////////////////////////
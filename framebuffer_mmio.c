@@ -0,0 +1,88 @@
+/*
+Framebuffer backend for the DE1-SoC pixel buffer controller.
+
+The front buffer lives in the FPGA on-chip memory and the back buffer in SDRAM.
+*/
+
+#include "framebuffer.h"
+
+
+// DE1-SOC pixel and character buffer memory and controller base address
+int  SDRAM_BASE            = 0xC0000000;
+int  FPGA_ONCHIP_BASE      = 0xC8000000;
+int  FPGA_CHAR_BASE        = 0xC9000000;
+int* PIXEL_BUF_CTRL_BASE   = (int*)0xFF203020;
+int* CHAR_BUF_CTRL_BASE    = (int*)0xFF203030;
+
+
+// location of the pixel buffer in SDRAM
+volatile int  pixel_buffer_start;
+volatile int *pixel_ctrl_ptr = (int*)0xFF203020;
+
+
+// Function definitions for the framebuffer backend
+/////////////////////////////////////////////////////////////////////
+
+//Points the front and back buffers at their memory
+//The back buffer is current when this returns
+void framebuffer_init() {
+
+    //Set front pixel buffer to start of FPGA On-chip memory
+    *(pixel_ctrl_ptr + 1) = FPGA_ONCHIP_BASE;
+
+    //Swap the front/back buffers, to set the front buffer location
+    framebuffer_swap();
+
+    //Set back pixel buffer to start of SDRAM memory
+    *(pixel_ctrl_ptr + 1) = SDRAM_BASE;
+    pixel_buffer_start = *(pixel_ctrl_ptr + 1);
+}
+
+//Returns the address of the back buffer that the drawing functions write to
+short int * framebuffer_back_buffer() {
+    return (short int *) pixel_buffer_start;
+}
+
+//Returns the address of the buffer currently shown on the display
+short int * framebuffer_front_buffer() {
+    return (short int *) *pixel_ctrl_ptr;
+}
+
+//Swaps the front and back buffers and waits for the swap to happen on vsync
+void framebuffer_swap() {
+
+    framebuffer_begin_swap();
+
+    //poll for the status bit
+    while (!framebuffer_swap_done());
+}
+
+//Starts swapping the front and back buffers, the swap happens on the next vsync
+void framebuffer_begin_swap() {
+
+    //launches the swap process
+	*pixel_ctrl_ptr = 1; //sets the S bit to 1
+}
+
+//Checks if the swap started by framebuffer_begin_swap has happened
+//The back buffer only changes once this has returned true
+bool framebuffer_swap_done() {
+
+    //The S bit of the status register stays set until the swap happened
+    int status = *(pixel_ctrl_ptr + 3); //OxFF20302C
+    if ((status & 0x01) != 0) {
+        return false;
+    }
+
+    //The old front buffer is now the back buffer
+    pixel_buffer_start = *(pixel_ctrl_ptr + 1);
+    return true;
+}
+
+//Writes a character to the character buffer at column, row
+//Rows of the character buffer are 128 bytes apart
+void framebuffer_put_char(int column, int row, char character) {
+    *(volatile char *)(FPGA_CHAR_BASE + (row << 7) + column) = character;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,472 @@
+/*
+Game flow as a state machine that never blocks.
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "game.h"
+#include "text_overlay.h"
+#include "animation.h"
+#include "scheduler.h"
+#include "leds.h"
+#include "timer.h"
+
+
+// Function prototypes for game helpers
+/////////////////////////////////////////////////////////////////////
+
+//Starts the turn of the side to move, or ends the game if it has no moves left
+static void begin_turn(Game *game);
+
+//Makes a move and starts sliding the piece, the turn ends once it has landed
+static void play_move(Game *game, GameMove move);
+
+//Outlines the square picked on the switches, and while moving highlights where the selected piece can go
+//While selecting the hints are shown with it
+static void show_cursor(Game *game, int xCoord, int yCoord);
+
+//Checks if a game starts from the initial position with white to play its first move
+static bool is_initial_start(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const FenState *state);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for the LEDs and HEX displays
+/////////////////////////////////////////////////////////////////////
+
+//Displays the winner of the game
+static void display_winner(int winner);
+
+//Shows the state of the game on the LEDs
+static void display_state(GameState state);
+
+//Displays 1 in the HEX display
+static void display_white();
+
+//Displays -1 in the HEX display
+static void display_black();
+
+//Displays 0 in the HEX display
+static void display_draw();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the game
+/////////////////////////////////////////////////////////////////////
+
+//Sets up a new game from GAME_START_FEN, the initial position unless the build bakes in another
+void game_init(Game *game) {
+    game_init_fen(game, GAME_START_FEN);
+}
+
+//Sets up a new game from a position given as a FEN string
+//Returns false, setting up the initial position instead, if the string is not a valid FEN
+bool game_init_fen(Game *game, const char *fen) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    FenState state;
+    bool loaded = fen_load(fen, board, &state);
+    if (!loaded) {
+        init_board(board);
+        fen_state_init(&state, WHITE_PIECE);
+    }
+
+    game_init_position(game, board, &state);
+    return loaded;
+}
+
+//Sets up a new game from a position, the board is copied
+void game_init_position(Game *game, PackedSquare board[BOARD_SIZE][BOARD_SIZE], const FenState *state) {
+
+    copy_board(board, game->board);
+    init_render_board(&game->render);
+
+    game->currentTurn = state->currentTurn;
+    text_overlay_start_moves(state->currentTurn, state->fullmoveNumber);
+    game->switches = input_switches();
+    game->xCoordSelected = 0;
+    game->yCoordSelected = 0;
+    game->engines[WHITE_PIECE] = NULL;
+    game->engines[BLACK_PIECE] = NULL;
+    game->viewer = NULL;
+    game->hintCount = 0;
+    game->winner = STALEMATE;
+    game->startMicroseconds = timer_microseconds();
+    arena_init(&game->turnArena, game->turnMemory, sizeof(game->turnMemory));
+
+    //Only a game from another position needs it in its record to be played back
+    record_init(&game->record, true);
+    if (!is_initial_start(game->board, state)) {
+        record_set_start(&game->record, game->board, state->currentTurn, state->fullmoveNumber);
+    }
+
+    begin_turn(game);
+}
+
+//Lets an engine play a colour, NULL gives the colour back to the player
+//If that colour is waiting for the player, the engine takes over the turn right away
+void game_set_engine(Game *game, int colour, const GameEngine *engine) {
+
+    game->engines[colour] = engine;
+
+    bool playerTurn = game->state == GAME_SELECTING || game->state == GAME_MOVING;
+    if (engine != NULL && playerTurn && colour == game->currentTurn) {
+        begin_turn(game);
+    }
+}
+
+//Shows every frame from now on to a viewer, NULL for none
+void game_set_viewer(Game *game, const GameViewer *viewer) {
+    game->viewer = viewer;
+}
+
+//Shows moves as hints while the player picks a piece this turn, at most GAME_MAX_HINTS, a count of 0 clears them
+void game_set_hints(Game *game, const GameMove *moves, int count) {
+
+    game->hintCount = count < GAME_MAX_HINTS ? count : GAME_MAX_HINTS;
+    for (int hint = 0; hint < game->hintCount; hint++) {
+        game->hints[hint] = moves[hint];
+    }
+
+    //The board only changes now if the player is picking a piece, otherwise the hints show once they are
+    if (game->state == GAME_SELECTING) {
+        show_cursor(game, game->switches & 0x00000007, 7-((game->switches & 0x00000038) >> 3));
+    }
+}
+
+//Handles one switch or key event
+void game_handle_input(Game *game, InputEvent event) {
+
+    //Events are handled in order, so the switches are taken from the event and not read now
+    if (event.type == INPUT_SWITCHES) {
+        game->switches = event.value;
+    }
+
+    //Input only matters while the player is picking squares
+    if (game->state != GAME_SELECTING && game->state != GAME_MOVING) {
+        return;
+    }
+
+    //Switches 0-2 give the column and 3-5 the row, counted from the bottom of the board
+    int switches = game->switches;
+    int xCoord = switches & 0x00000007;
+    int yCoord = 7-((switches & 0x00000038) >> 3);
+
+    //Switch 9 confirms the square, a KEY0 press does the same
+    bool confirmed = (switches & INPUT_CONFIRM_SWITCH) != 0
+        || (event.type == INPUT_KEY_PRESS && (event.value & INPUT_CONFIRM_KEY) != 0);
+
+    if (!confirmed) {
+        show_cursor(game, xCoord, yCoord);
+        return;
+    }
+
+    if (game->state == GAME_SELECTING) {
+
+        //Check if the piece selected is valid
+        if (!is_empty_square(game->board, xCoord, yCoord) && PACKED_COLOUR(game->board[yCoord][xCoord]) == game->currentTurn && has_valid_moves(game->board, xCoord, yCoord, game->currentTurn)) {
+            game->xCoordSelected = xCoord;
+            game->yCoordSelected = yCoord;
+            game->state = GAME_MOVING;
+            show_cursor(game, xCoord, yCoord);
+        }
+        return;
+    }
+
+    //Check if the square selected is a valid move for the selected piece
+    if (is_valid_move(game->board, game->xCoordSelected, game->yCoordSelected, xCoord, yCoord, game->currentTurn)) {
+        GameMove move = {game->xCoordSelected, game->yCoordSelected, xCoord, yCoord};
+        play_move(game, move);
+    }
+}
+
+//Moves the game on without input: finishes a turn once the piece has landed and lets the engine think
+//Returns true while there is more to do, false if the game waits for input
+bool game_update(Game *game, unsigned int deadline) {
+
+    if (game->state == GAME_ANIMATING) {
+
+        //The turn ends once the piece has landed on its square
+        if (animation_is_active()) {
+            return true;
+        }
+
+        switch_turns(&game->currentTurn);
+        begin_turn(game);
+        return game->state == GAME_THINKING;
+    }
+
+    if (game->state == GAME_THINKING) {
+
+        const GameEngine *engine = game->engines[game->currentTurn];
+        GameMove move;
+
+        if (!engine->think(engine->context, deadline, &move)) {
+            return true;
+        }
+
+        //A move the rules do not allow hands the turn to the player instead of breaking the board,
+        //who starts from wherever the switches are as on any turn
+        if (!is_valid_move(game->board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd, game->currentTurn)) {
+            game->state = GAME_SELECTING;
+            show_cursor(game, game->switches & 0x00000007, 7-((game->switches & 0x00000038) >> 3));
+            return false;
+        }
+
+        play_move(game, move);
+        return true;
+    }
+
+    return false;
+}
+
+//Adds the input, logic and render tasks for the game to the scheduler
+//Rendering runs last so a tick shows what the input and the logic changed
+void game_add_tasks(Game *game) {
+
+    scheduler_add_task("input", game_input_task, game, GAME_INPUT_TASK_BUDGET_US);
+    scheduler_add_task("logic", game_logic_task, game, GAME_LOGIC_TASK_BUDGET_US);
+    scheduler_add_task("render", game_render_task, game, GAME_RENDER_TASK_BUDGET_US);
+}
+
+//Runs the scheduler until the game is over and the last move has finished sliding, then shows the winner
+//Returns false if the input ended first, which only happens on the host
+bool game_run(Game *game) {
+
+    while (true) {
+
+        bool busy = scheduler_tick();
+
+        //Shows on the LEDs if a piece or a square is being picked
+        display_state(game->state);
+
+        if (busy) {
+            continue;
+        }
+
+        if (game->state == GAME_OVER) {
+            break;
+        }
+
+        //Nothing to do until the player touches the switches or keys, sleep until then
+        InputEvent event;
+        if (!input_wait_event(&event)) {
+            return false;
+        }
+        game_handle_input(game, event);
+    }
+
+    //Displays the winner of the game
+    display_winner(game->winner);
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the scheduler tasks
+/////////////////////////////////////////////////////////////////////
+
+//Handles queued input events until the queue is empty or the deadline passed
+//Nothing is handled while a piece is sliding, the events are left for the next turn
+bool game_input_task(void *context, unsigned int deadline) {
+
+    Game *game = context;
+    InputEvent event;
+
+    //Events that arrive while a piece is sliding stay queued and are handled once it has landed
+    while (game->state != GAME_ANIMATING && input_poll_event(&event)) {
+        game_handle_input(game, event);
+
+        //Events left in the queue are handled on the next tick
+        if (scheduler_deadline_passed(deadline)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//Draws the next frame and the text overlay, and shows the last frame presented to the viewer
+//The frame itself keeps to FRAME_RENDER_BUDGET_US, so the deadline is not checked here
+bool game_render_task(void *context, unsigned int deadline) {
+
+    Game *game = context;
+    (void) deadline;
+
+    text_overlay_update();
+    bool drawing = animation_update(game->board, &game->render);
+
+    //The viewer gets the frame right after it is presented, before the next one is drawn into its buffer
+    bool showing = game->viewer != NULL && game->viewer->show(game->viewer->context, animation_presented_frame());
+
+    return drawing || showing;
+}
+
+//Runs game_update
+bool game_logic_task(void *context, unsigned int deadline) {
+    return game_update(context, deadline);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for game helpers
+/////////////////////////////////////////////////////////////////////
+
+//Starts the turn of the side to move, or ends the game if it has no moves left
+static void begin_turn(Game *game) {
+
+    //Everything the last turn allocated is given back at once, and the hints were for the last position
+    arena_reset(&game->turnArena);
+    game->hintCount = 0;
+
+    init_outlines(&game->render);
+    init_highlights(&game->render);
+
+    if (is_game_over(game->board, game->currentTurn)) {
+
+        game->winner = get_winner(game->board, game->currentTurn);
+        game->state = GAME_OVER;
+        record_set_result(&game->record, game->winner);
+
+        //Shows the result next to the board
+        if     (game->winner == WHITE_PIECE) text_overlay_set_status("White wins by mate");
+        else if(game->winner == BLACK_PIECE) text_overlay_set_status("Black wins by mate");
+        else                                 text_overlay_set_status("Stalemate");
+        return;
+    }
+
+    //Shows the side to move and if it is in check next to the board
+    text_overlay_set_turn(game->currentTurn);
+    text_overlay_set_status(is_in_check(game->board, game->currentTurn) ? "Check" : "");
+
+    const GameEngine *engine = game->engines[game->currentTurn];
+    if (engine != NULL) {
+        game->state = GAME_THINKING;
+        engine->start(engine->context, game->board, game->currentTurn, &game->turnArena);
+        return;
+    }
+
+    //The player starts from wherever the switches are
+    game->state = GAME_SELECTING;
+    show_cursor(game, game->switches & 0x00000007, 7-((game->switches & 0x00000038) >> 3));
+}
+
+//Makes a move and starts sliding the piece, the turn ends once it has landed
+static void play_move(Game *game, GameMove move) {
+
+    init_outlines(&game->render);
+    init_highlights(&game->render);
+
+    //Add the move to the move list next to the board
+    text_overlay_add_move(game->board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd);
+
+    //Slide the piece to its destination over the next frames
+    animation_start_move(game->board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd);
+
+    //Move piece
+    move_piece(game->board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd);
+
+    //Append it to the record of the game, with the time it was confirmed
+    unsigned int milliseconds = (timer_microseconds() - game->startMicroseconds) / 1000;
+    record_add_move(&game->record, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd, milliseconds);
+
+    game->state = GAME_ANIMATING;
+}
+
+//Outlines the square picked on the switches, and while moving highlights where the selected piece can go
+//While selecting the hints are shown with it
+static void show_cursor(Game *game, int xCoord, int yCoord) {
+
+    //Reset outline and highlights of grid squares
+    init_outlines(&game->render);
+    init_highlights(&game->render);
+
+    //Set the outline of the selected square to true
+    game->render.squares[yCoord][xCoord].outlined = true;
+
+    //Each hint outlines the piece to move and highlights where it goes
+    if (game->state != GAME_MOVING) {
+        for (int hint = 0; hint < game->hintCount; hint++) {
+            GameMove move = game->hints[hint];
+            game->render.squares[move.yCoordStart][move.xCoordStart].outlined = true;
+            game->render.squares[move.yCoordEnd][move.xCoordEnd].highlighted = true;
+        }
+        return;
+    }
+
+    //Loops through all the squares in the board and set highlighted to true if move is legal
+    for(int xCoordEnd = 0; xCoordEnd < BOARD_SIZE; xCoordEnd++) {
+        for(int yCoordEnd = 0; yCoordEnd < BOARD_SIZE; yCoordEnd++) {
+            if(is_valid_move(game->board, game->xCoordSelected, game->yCoordSelected, xCoordEnd, yCoordEnd, game->currentTurn)) {
+                game->render.squares[yCoordEnd][xCoordEnd].highlighted = true;
+            }
+        }
+    }
+}
+
+//Checks if a game starts from the initial position with white to play its first move
+static bool is_initial_start(PackedSquare board[BOARD_SIZE][BOARD_SIZE], const FenState *state) {
+
+    PackedSquare initial[BOARD_SIZE][BOARD_SIZE];
+    init_board(initial);
+    return state->currentTurn == WHITE_PIECE && state->fullmoveNumber == 1 && memcmp(board, initial, sizeof(initial)) == 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the LEDs and HEX displays
+/////////////////////////////////////////////////////////////////////
+
+//Displays the winner of the game
+static void display_winner(int winner) {
+    
+    if     (winner == WHITE_PIECE) display_white();
+    else if(winner == BLACK_PIECE) display_black();
+    else if(winner == STALEMATE)   display_draw();
+
+}
+
+//Shows the state of the game on the LEDs
+//LED 0 is on while the player is selecting a piece, LED 1 while the player is selecting a move
+static void display_state(GameState state) {
+
+    if     (state == GAME_SELECTING) leds_write(LEDS_RED, 1);
+    else if(state == GAME_MOVING)    leds_write(LEDS_RED, 2);
+    else if(state != GAME_OVER)      leds_write(LEDS_RED, 0);
+
+}
+
+//Displays 2 in the HEX display
+//Lights up left hand side of LEDS
+static void display_white() {
+
+    leds_write(LEDS_HEX_LOW, 0x6);
+    leds_write(LEDS_RED, 0x1F);
+
+}
+
+//Displays -1 in the HEX display
+//Lights up right hand side of LEDS
+static void display_black() {
+
+    leds_write(LEDS_HEX_LOW, 0x4006);
+    leds_write(LEDS_RED, 0x3E0);
+
+}
+
+//Displays 0 in the HEX display
+//Lights up both sides of LEDS
+static void display_draw() {
+
+    leds_write(LEDS_HEX_LOW, 0x3F);
+    leds_write(LEDS_RED, 0x3FF);
+
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,197 @@
+/*
+Game flow as a state machine that never blocks.
+
+The game used to wait inside play_turn until a move was confirmed, so nothing else could
+run while a player was thinking. Now every input event, frame and engine step is a short
+call that moves the game from one state to the next:
+
+  GAME_SELECTING  the player picks a piece with the switches
+  GAME_MOVING     the player picks the square to move it to
+  GAME_ANIMATING  the moved piece slides to its square
+  GAME_THINKING   an engine chooses the move for the side to move
+  GAME_OVER       checkmate or stalemate
+
+The game_*_task functions run it on the cooperative scheduler.
+
+While a player picks a piece the board can also show hints, candidate moves suggested
+by the analysis (analysis.h): each one outlines its start square and highlights its end
+square, next to the cursor.
+*/
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+
+#include "chess.h"
+#include "input.h"
+#include "arena.h"
+#include "animation.h"
+#include "record.h"
+#include "fen.h"
+
+
+// Scratch memory an engine can use while it thinks about one move
+#define GAME_TURN_ARENA_SIZE (16 * 1024)
+
+// Position a game starts from, as a FEN string (see fen.h)
+// Building with -DGAME_START_FEN='"<fen>"' bakes another starting position into the program
+#ifndef GAME_START_FEN
+#define GAME_START_FEN FEN_INITIAL_POSITION
+#endif
+
+// Time each scheduler task may use per tick, in microseconds
+// Rendering gets the frame budget plus the text overlay, input events are short
+#define GAME_INPUT_TASK_BUDGET_US  1000
+#define GAME_LOGIC_TASK_BUDGET_US  4000
+#define GAME_RENDER_TASK_BUDGET_US (FRAME_RENDER_BUDGET_US + 1000)
+
+// Most hints shown at once
+#define GAME_MAX_HINTS 8
+
+
+//GameState lists the states of the game
+typedef enum GameState
+{
+    GAME_SELECTING,
+    GAME_MOVING,
+    GAME_ANIMATING,
+    GAME_THINKING,
+    GAME_OVER
+} GameState;
+
+
+//GameMove holds a move from a start square to an end square
+typedef struct GameMove
+{
+    int xCoordStart;
+    int yCoordStart;
+    int xCoordEnd;
+    int yCoordEnd;
+} GameMove;
+
+
+//GameEngine lets the computer play a side, thinking a little on every tick
+typedef struct GameEngine
+{
+    //Starts thinking about the position, the board does not change until a move is returned
+    //arena is empty at the start of every turn, anything allocated from it is gone once the turn ends
+    void (*start)(void *context, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Arena *arena);
+
+    //Thinks until the deadline (a timer_microseconds value)
+    //Returns true once move holds the chosen move
+    bool (*think)(void *context, unsigned int deadline, GameMove *move);
+
+    //Passed to start and think
+    void *context;
+} GameEngine;
+
+
+//GameViewer is shown every frame the game puts on screen, to stream or record what the board shows
+typedef struct GameViewer
+{
+    //Called every render tick with the last frame presented, the same frame comes again until the next one
+    //Returns true while it has work left, e.g. bytes to send
+    bool (*show)(void *context, const PresentedFrame *frame);
+
+    //Passed to show
+    void *context;
+} GameViewer;
+
+
+//Game holds the state of a game
+typedef struct Game
+{
+    //Position the rules and engines play on, and how its squares are drawn
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    RenderBoard render;
+    int currentTurn;
+    GameState state;
+
+    //State of the switches as of the last input event handled
+    int switches;
+
+    //Piece picked while selecting, it is moved once a valid square is picked
+    int xCoordSelected;
+    int yCoordSelected;
+
+    //Engine playing each colour (indexed by WHITE_PIECE and BLACK_PIECE), NULL for a player
+    const GameEngine *engines[2];
+
+    //Moves shown on the board while the player picks a piece, cleared when a turn starts
+    GameMove hints[GAME_MAX_HINTS];
+    int hintCount;
+
+    //Shown every frame, NULL for none
+    const GameViewer *viewer;
+
+    //Winner once the game is over, WHITE_PIECE, BLACK_PIECE or STALEMATE
+    int winner;
+
+    //Every move played from the starting position, with the time it was confirmed counted from timer_microseconds at game_init
+    GameRecord record;
+    unsigned int startMicroseconds;
+
+    //Memory for the turn arena, so thinking about a move never touches the heap
+    Arena turnArena;
+    unsigned char turnMemory[GAME_TURN_ARENA_SIZE] __attribute__((aligned(ARENA_ALIGNMENT)));
+} Game;
+
+
+// Function prototypes for the game
+/////////////////////////////////////////////////////////////////////
+
+//Sets up a new game from GAME_START_FEN, the initial position unless the build bakes in another
+//The text overlay and the input must be initialized first
+void game_init(Game *game);
+
+//Sets up a new game from a position given as a FEN string
+//Returns false, setting up the initial position instead, if the string is not a valid FEN
+bool game_init_fen(Game *game, const char *fen);
+
+//Sets up a new game from a position, the board is copied
+void game_init_position(Game *game, PackedSquare board[BOARD_SIZE][BOARD_SIZE], const FenState *state);
+
+//Lets an engine play a colour, NULL gives the colour back to the player
+//If that colour is waiting for the player, the engine takes over the turn right away
+void game_set_engine(Game *game, int colour, const GameEngine *engine);
+
+//Shows every frame from now on to a viewer, NULL for none
+void game_set_viewer(Game *game, const GameViewer *viewer);
+
+//Shows moves as hints while the player picks a piece this turn, at most GAME_MAX_HINTS, a count of 0 clears them
+void game_set_hints(Game *game, const GameMove *moves, int count);
+
+//Handles one switch or key event
+void game_handle_input(Game *game, InputEvent event);
+
+//Moves the game on without input: finishes a turn once the piece has landed and lets the engine think
+//Returns true while there is more to do, false if the game waits for input
+bool game_update(Game *game, unsigned int deadline);
+
+//Adds the input, logic and render tasks for the game to the scheduler
+void game_add_tasks(Game *game);
+
+//Runs the scheduler until the game is over and the last move has finished sliding, then shows the winner
+//Returns false if the input ended first, which only happens on the host
+bool game_run(Game *game);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for the scheduler tasks, context is the Game
+/////////////////////////////////////////////////////////////////////
+
+//Handles queued input events until the queue is empty or the deadline passed
+//Nothing is handled while a piece is sliding, the events are left for the next turn
+bool game_input_task(void *context, unsigned int deadline);
+
+//Draws the next frame and the text overlay, and shows the last frame presented to the viewer
+bool game_render_task(void *context, unsigned int deadline);
+
+//Runs game_update
+bool game_logic_task(void *context, unsigned int deadline);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,149 @@
+/*
+Board geometry and move tables, filled in by the compiler.
+
+Drawing a square used to multiply its index by SQUARE_SIZE, every piece worked out its
+offset from SQUARE_SIZE and SQUARE_BORDER_SIZE, and the rules found knight and king moves
+with abs(). Here all of it is a constant table built from the size macros with constant
+expressions, so the hot paths only look values up and changing SQUARE_SIZE rebuilds the
+tables at no cost at run time:
+  SQUARE_PIXEL_X/Y           left top pixel of every file and rank
+  SQUARE_FRAMEBUFFER_OFFSET  left top pixel of every square, as an index into the pixel buffer
+  PIECE_PIXEL_OFFSET_X/Y     where each piece's drawing starts, from the corner of its square
+  *_TARGETS                  squares a knight, king or pawn can reach, one bit per square
+  RAY_DIRECTIONS             steps of the sliding pieces
+
+The tables are static so every file that includes this header gets them without another
+file to link, like the constants in chess.h and draw.h; a file that does not use one
+does not keep it.
+
+Squares are numbered yCoord * BOARD_SIZE + xCoord, bit n of a target mask is square n.
+*/
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stdint.h>
+
+#include "chess.h"
+#include "framebuffer.h"
+
+
+// Size of the drawn chess board squares, in pixels
+// Macros so the tables below are constant expressions
+#define SQUARE_SIZE        30
+#define SQUARE_BORDER_SIZE 2
+
+// Number of a square, and its file and rank
+#define SQUARE_INDEX(xCoord, yCoord) ((yCoord) * BOARD_SIZE + (xCoord))
+#define SQUARE_FILE(square) ((square) % BOARD_SIZE)
+#define SQUARE_RANK(square) ((square) / BOARD_SIZE)
+
+// Checks if a target mask holds a square
+#define TARGETS_HOLD(targets, square) (((targets) >> (square)) & 1)
+
+
+//The tables list the squares one by one and hold a bit per square
+_Static_assert(BOARD_SIZE == 8, "the geometry tables are written out for an 8 by 8 board");
+
+//The board is drawn from the left top corner and must fit the screen, squares are filled without clipping
+_Static_assert(BOARD_SIZE * SQUARE_SIZE <= FRAMEBUFFER_WIDTH && BOARD_SIZE * SQUARE_SIZE <= FRAMEBUFFER_HEIGHT,
+    "the board does not fit the screen");
+
+
+// Expands a macro for every file or rank, and for every square
+#define GEOMETRY_FOR_EACH_LINE(m) m(0), m(1), m(2), m(3), m(4), m(5), m(6), m(7)
+#define GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, y) m(y * 8 + 0), m(y * 8 + 1), m(y * 8 + 2), m(y * 8 + 3), \
+                                               m(y * 8 + 4), m(y * 8 + 5), m(y * 8 + 6), m(y * 8 + 7)
+#define GEOMETRY_FOR_EACH_SQUARE(m) \
+    GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 0), GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 1), \
+    GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 2), GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 3), \
+    GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 4), GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 5), \
+    GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 6), GEOMETRY_FOR_EACH_SQUARE_OF_RANK(m, 7)
+
+// Pixel of a file or rank and of a square
+#define GEOMETRY_LINE_PIXEL(line) ((line) * SQUARE_SIZE)
+#define GEOMETRY_SQUARE_OFFSET(square) \
+    (GEOMETRY_LINE_PIXEL(SQUARE_RANK(square)) * FRAMEBUFFER_STRIDE + GEOMETRY_LINE_PIXEL(SQUARE_FILE(square)))
+
+// Bit of the square a step of (dx,dy) away, or no bit if it is off the board
+// The shift is masked so the branch not taken never shifts by a negative amount
+#define GEOMETRY_ON_BOARD(square, dx, dy) \
+    (SQUARE_FILE(square) + (dx) >= 0 && SQUARE_FILE(square) + (dx) < BOARD_SIZE \
+     && SQUARE_RANK(square) + (dy) >= 0 && SQUARE_RANK(square) + (dy) < BOARD_SIZE)
+#define GEOMETRY_STEP(square, dx, dy) \
+    (GEOMETRY_ON_BOARD(square, dx, dy) ? UINT64_C(1) << (((square) + (dy) * BOARD_SIZE + (dx)) & 63) : 0)
+
+#define GEOMETRY_KNIGHT(square) \
+    (GEOMETRY_STEP(square, 1, 2) | GEOMETRY_STEP(square, 2, 1) | GEOMETRY_STEP(square, 2, -1) | GEOMETRY_STEP(square, 1, -2) \
+     | GEOMETRY_STEP(square, -1, -2) | GEOMETRY_STEP(square, -2, -1) | GEOMETRY_STEP(square, -2, 1) | GEOMETRY_STEP(square, -1, 2))
+#define GEOMETRY_KING(square) \
+    (GEOMETRY_STEP(square, 1, 0) | GEOMETRY_STEP(square, 1, 1) | GEOMETRY_STEP(square, 0, 1) | GEOMETRY_STEP(square, -1, 1) \
+     | GEOMETRY_STEP(square, -1, 0) | GEOMETRY_STEP(square, -1, -1) | GEOMETRY_STEP(square, 0, -1) | GEOMETRY_STEP(square, 1, -1))
+
+// White pawns move towards rank index 0 and black pawns away from it, two squares from their starting rank
+#define GEOMETRY_WHITE_CAPTURE(square) (GEOMETRY_STEP(square, -1, -1) | GEOMETRY_STEP(square, 1, -1))
+#define GEOMETRY_BLACK_CAPTURE(square) (GEOMETRY_STEP(square, -1, 1) | GEOMETRY_STEP(square, 1, 1))
+#define GEOMETRY_WHITE_PUSH(square) \
+    (GEOMETRY_STEP(square, 0, -1) | (SQUARE_RANK(square) == BOARD_SIZE - 2 ? GEOMETRY_STEP(square, 0, -2) : 0))
+#define GEOMETRY_BLACK_PUSH(square) \
+    (GEOMETRY_STEP(square, 0, 1) | (SQUARE_RANK(square) == 1 ? GEOMETRY_STEP(square, 0, 2) : 0))
+
+
+// Tables of the board geometry
+/////////////////////////////////////////////////////////////////////
+
+//Left top pixel of every file and rank
+static const short SQUARE_PIXEL_X[BOARD_SIZE] = {GEOMETRY_FOR_EACH_LINE(GEOMETRY_LINE_PIXEL)};
+static const short SQUARE_PIXEL_Y[BOARD_SIZE] = {GEOMETRY_FOR_EACH_LINE(GEOMETRY_LINE_PIXEL)};
+
+//Left top pixel of every square, as an index into a pixel buffer of FRAMEBUFFER_STRIDE pixels a row
+static const int SQUARE_FRAMEBUFFER_OFFSET[BOARD_SIZE * BOARD_SIZE] = {GEOMETRY_FOR_EACH_SQUARE(GEOMETRY_SQUARE_OFFSET)};
+
+//Left top pixel of each piece's drawing from the corner of its square, indexed by PieceIdx
+//The pieces are centred on the square below its border, the king reaches higher
+static const short PIECE_PIXEL_OFFSET_X[KING + 1] = {
+    0,
+    SQUARE_SIZE / 2 - 4,
+    SQUARE_SIZE / 2 - 8,
+    SQUARE_SIZE / 2 - 2,
+    SQUARE_SIZE / 4,
+    SQUARE_SIZE / 2 - 2,
+    SQUARE_SIZE / 2 - 2
+};
+static const short PIECE_PIXEL_OFFSET_Y[KING + 1] = {
+    0,
+    SQUARE_BORDER_SIZE * 3,
+    SQUARE_BORDER_SIZE * 3,
+    SQUARE_BORDER_SIZE * 3,
+    SQUARE_BORDER_SIZE * 3,
+    SQUARE_BORDER_SIZE * 3,
+    SQUARE_BORDER_SIZE * 1
+};
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Tables of the moves
+/////////////////////////////////////////////////////////////////////
+
+//Squares a knight or a king reaches from every square
+static const uint64_t KNIGHT_TARGETS[BOARD_SIZE * BOARD_SIZE] = {GEOMETRY_FOR_EACH_SQUARE(GEOMETRY_KNIGHT)};
+static const uint64_t KING_TARGETS[BOARD_SIZE * BOARD_SIZE] = {GEOMETRY_FOR_EACH_SQUARE(GEOMETRY_KING)};
+
+//Squares a pawn captures on and moves forward to from every square, black (0) then white (1)
+//The pushes include the two square move from the starting rank
+static const uint64_t PAWN_CAPTURE_TARGETS[2][BOARD_SIZE * BOARD_SIZE] = {
+    {GEOMETRY_FOR_EACH_SQUARE(GEOMETRY_BLACK_CAPTURE)},
+    {GEOMETRY_FOR_EACH_SQUARE(GEOMETRY_WHITE_CAPTURE)}
+};
+static const uint64_t PAWN_PUSH_TARGETS[2][BOARD_SIZE * BOARD_SIZE] = {
+    {GEOMETRY_FOR_EACH_SQUARE(GEOMETRY_BLACK_PUSH)},
+    {GEOMETRY_FOR_EACH_SQUARE(GEOMETRY_WHITE_PUSH)}
+};
+
+//Steps of the sliding pieces as x, y pairs, the bishop's four diagonals then the rook's four lines
+static const signed char RAY_DIRECTIONS[8][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}, {1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,75 @@
+/*
+Event queue shared by the input event sources.
+
+The queue is a ring buffer with a single producer (the interrupt handlers) and a single
+consumer (the game loop). Only the producer writes queueHead and only the consumer
+writes queueTail, so no locking is needed on the single core.
+*/
+
+#include "input.h"
+
+
+static volatile InputEvent queue[INPUT_QUEUE_SIZE];
+static volatile unsigned int queueHead = 0;
+static volatile unsigned int queueTail = 0;
+static volatile int droppedEvents = 0;
+
+
+// Function definitions for user input
+/////////////////////////////////////////////////////////////////////
+
+//Returns the number of events lost because the queue was full
+int input_dropped_events() {
+    return droppedEvents;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the event sources
+/////////////////////////////////////////////////////////////////////
+
+//Clears the queue, called by input_init
+void input_clear_queue() {
+
+    queueHead = 0;
+    queueTail = 0;
+    droppedEvents = 0;
+}
+
+//Takes the oldest event from the queue
+//Returns false if the queue is empty
+bool input_pop_event(InputEvent *event) {
+
+    unsigned int tail = queueTail;
+    if (tail == queueHead) {
+        return false;
+    }
+
+    *event = queue[tail % INPUT_QUEUE_SIZE];
+    queueTail = tail + 1;
+    return true;
+}
+
+//Adds an event to the queue, may be called from an interrupt handler
+//The event is dropped if the queue is full
+void input_push_event(InputEventType type, int value, unsigned int time) {
+
+    unsigned int head = queueHead;
+    if (head - queueTail >= INPUT_QUEUE_SIZE) {
+        droppedEvents++;
+        return;
+    }
+
+    queue[head % INPUT_QUEUE_SIZE].type  = type;
+    queue[head % INPUT_QUEUE_SIZE].value = value;
+    queue[head % INPUT_QUEUE_SIZE].time  = time;
+    queueHead = head + 1;
+}
+
+//Checks if the queue has room for another event
+bool input_queue_has_room() {
+    return queueHead - queueTail < INPUT_QUEUE_SIZE;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,104 @@
+/*
+Interrupt driven user input.
+
+Input arrives as events in a fixed size queue that the game loop drains. Two event
+sources exist, link exactly one of them together with input.c:
+  input_mmio.c  - pushbutton KEY and interval timer interrupts through the ARM GIC
+                  on the DE1-SoC, the timer interrupt samples and debounces the switches
+  input_host.c  - text commands read from a file or stdin on a Linux host
+*/
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+
+// Number of events the queue holds, must be a power of two
+#define INPUT_QUEUE_SIZE 16
+
+// Switch 9 confirms the selection of the square, KEY0 does the same
+#define INPUT_CONFIRM_SWITCH 0x200
+#define INPUT_CONFIRM_KEY    0x1
+
+
+//InputEventType lists the kinds of input events
+typedef enum InputEventType
+{
+    //The switches changed, value holds the new state of all switches
+    INPUT_SWITCHES,
+
+    //Pushbuttons were pressed, value holds one bit per pressed KEY
+    INPUT_KEY_PRESS
+} InputEventType;
+
+
+//InputEvent holds one input event
+typedef struct InputEvent
+{
+    InputEventType type;
+    int value;
+
+    //Milliseconds since input_init when the event happened
+    unsigned int time;
+} InputEvent;
+
+
+// Function prototypes for user input
+/////////////////////////////////////////////////////////////////////
+
+//Starts the event source and clears the queue
+void input_init();
+
+//Takes the oldest event from the queue
+//Returns false if the queue is empty
+bool input_poll_event(InputEvent *event);
+
+//Takes the oldest event from the queue, sleeping until there is one
+//Returns false if the event source has ended, which only happens on the host
+bool input_wait_event(InputEvent *event);
+
+//Returns the current (debounced) state of the switches
+int input_switches();
+
+//Returns the number of events lost because the queue was full
+int input_dropped_events();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for the event sources
+/////////////////////////////////////////////////////////////////////
+
+//Clears the queue, called by input_init
+void input_clear_queue();
+
+//Takes the oldest event from the queue
+//Returns false if the queue is empty
+bool input_pop_event(InputEvent *event);
+
+//Adds an event to the queue, may be called from an interrupt handler
+//The event is dropped if the queue is full
+void input_push_event(InputEventType type, int value, unsigned int time);
+
+//Checks if the queue has room for another event
+//A source that can hold events back, like a script, waits for room instead of dropping them
+bool input_queue_has_room();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host event source
+/////////////////////////////////////////////////////////////////////
+
+//Reads commands from file instead of stdin, one per line:
+//  sw <value>    switches changed to value (decimal or 0x hex)
+//  key <mask>    pushbuttons in mask were pressed
+//A command can start with @<milliseconds since input_init> to hold it until then, e.g. "@1500 key 1"
+//Empty lines and lines starting with # are ignored
+void input_host_set_source(FILE *file);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
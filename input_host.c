@@ -0,0 +1,255 @@
+/*
+Input event source for a Linux host.
+
+Reads text commands from stdin (or a file set with input_host_set_source) and turns
+them into the same events the DE1-SoC interrupt handlers produce.
+
+A command can be given a time to form a timeline. It is held back until the clock
+(timer.h) reaches that time; on simulated time, waiting for it moves the clock there.
+*/
+
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "input.h"
+#include "timer.h"
+
+
+//File the commands are read from, stdin unless set otherwise
+static FILE *sourceFile = NULL;
+static bool sourceEnded = false;
+
+//Bytes read from the source that do not form a complete line yet
+//The file descriptor is read directly so polling knows exactly what is buffered
+static char pendingText[256];
+static int pendingLength = 0;
+
+//Last switch state reported
+static int currentSwitches = 0;
+
+//Clock at input_init, event times count from there
+static unsigned int startMicroseconds = 0;
+
+
+// Function prototypes for host input helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the milliseconds since input_init
+static unsigned int get_milliseconds();
+
+//Reads from the source into pendingText, blocking if wait is true
+//Returns false once the source has ended
+static bool read_source(bool wait);
+
+//Pushes the event of every complete line in pendingText, as long as the queue has room
+//and up to the first line whose time has not come yet
+static void parse_commands();
+
+//Checks if the first line in pendingText is held back until a later time
+//Returns true and the time in milliseconds if it is
+static bool next_line_held(unsigned int *time);
+
+//Sleeps until the given milliseconds since input_init, or moves simulated time there
+static void wait_until(unsigned int time);
+
+//Checks if pendingText holds a complete line
+static bool has_complete_line();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for user input
+/////////////////////////////////////////////////////////////////////
+
+//Starts the event source and clears the queue
+void input_init() {
+
+    input_clear_queue();
+    startMicroseconds = timer_microseconds();
+
+    if (sourceFile == NULL) {
+        sourceFile = stdin;
+    }
+    sourceEnded = false;
+    pendingLength = 0;
+    currentSwitches = 0;
+}
+
+//Takes the oldest event from the queue
+//Returns false if the queue is empty
+bool input_poll_event(InputEvent *event) {
+
+    //Never blocks, only what is already available is read
+    //Nothing new is read while complete lines are still waiting for room in the queue
+    if (!sourceEnded && !has_complete_line()) {
+        read_source(false);
+    }
+    parse_commands();
+
+    return input_pop_event(event);
+}
+
+//Takes the oldest event from the queue, sleeping until there is one
+//Returns false if the event source has ended, which only happens on the host
+bool input_wait_event(InputEvent *event) {
+
+    while (!input_pop_event(event)) {
+
+        //The next command is for later, nothing can happen before it
+        unsigned int time;
+        if (next_line_held(&time)) {
+            wait_until(time);
+        }
+
+        if (!has_complete_line()) {
+            if (sourceEnded) {
+                return false;
+            }
+            read_source(true);
+        }
+        parse_commands();
+    }
+
+    return true;
+}
+
+//Returns the current (debounced) state of the switches
+int input_switches() {
+    return currentSwitches;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions only provided by the host event source
+/////////////////////////////////////////////////////////////////////
+
+//Reads commands from file instead of stdin
+void input_host_set_source(FILE *file) {
+
+    sourceFile = file;
+    sourceEnded = false;
+    pendingLength = 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for host input helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the milliseconds since input_init
+static unsigned int get_milliseconds() {
+    return (timer_microseconds() - startMicroseconds) / 1000;
+}
+
+//Reads from the source into pendingText, blocking if wait is true
+//Returns false once the source has ended
+static bool read_source(bool wait) {
+
+    struct pollfd source = { fileno(sourceFile), POLLIN, 0 };
+    if (!wait && poll(&source, 1, 0) <= 0) {
+        return true;
+    }
+
+    //A line longer than the buffer is thrown away
+    if (pendingLength == sizeof(pendingText)) {
+        pendingLength = 0;
+    }
+
+    ssize_t count = read(source.fd, pendingText + pendingLength, sizeof(pendingText) - pendingLength);
+    if (count <= 0) {
+
+        //Finish a last line that has no newline
+        if (pendingLength > 0 && pendingLength < (int) sizeof(pendingText)) {
+            pendingText[pendingLength++] = '\n';
+        }
+
+        sourceEnded = true;
+        return false;
+    }
+
+    pendingLength += (int) count;
+    return true;
+}
+
+//Pushes the event of every complete line in pendingText, as long as the queue has room
+static void parse_commands() {
+
+    char *lineStart = pendingText;
+    char *lineEnd;
+
+    //Lines that do not fit in the queue stay in pendingText, so a script never loses events
+    while (input_queue_has_room() && (lineEnd = memchr(lineStart, '\n', pendingLength - (lineStart - pendingText))) != NULL) {
+
+        //A line starting with @time is held until that many milliseconds after input_init
+        if (*lineStart == '@') {
+            char *command;
+            unsigned int time = (unsigned int) strtoul(lineStart + 1, &command, 10);
+            if ((int) (time - get_milliseconds()) > 0) {
+                break;
+            }
+            lineStart = command;
+        }
+
+        *lineEnd = '\0';
+
+        char command[16];
+        char argument[32];
+        if (sscanf(lineStart, "%15s %31s", command, argument) == 2 && command[0] != '#') {
+            int value = (int) strtol(argument, NULL, 0);
+            if (strcmp(command, "sw") == 0) {
+                currentSwitches = value & 0x3FF;
+                input_push_event(INPUT_SWITCHES, currentSwitches, get_milliseconds());
+            } else if (strcmp(command, "key") == 0) {
+                input_push_event(INPUT_KEY_PRESS, value & 0xF, get_milliseconds());
+            }
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    //Keep the incomplete line for the next read
+    pendingLength -= (int) (lineStart - pendingText);
+    memmove(pendingText, lineStart, pendingLength);
+}
+
+//Checks if pendingText holds a complete line
+static bool has_complete_line() {
+    return memchr(pendingText, '\n', pendingLength) != NULL;
+}
+
+//Checks if the first line in pendingText is held back until a later time
+//Returns true and the time in milliseconds if it is
+static bool next_line_held(unsigned int *time) {
+
+    if (!has_complete_line() || pendingText[0] != '@') {
+        return false;
+    }
+
+    *time = (unsigned int) strtoul(pendingText + 1, NULL, 10);
+    return (int) (*time - get_milliseconds()) > 0;
+}
+
+//Sleeps until the given milliseconds since input_init, or moves simulated time there
+static void wait_until(unsigned int time) {
+
+    unsigned int now = timer_microseconds() - startMicroseconds;
+    unsigned int target = time * 1000;
+    if ((int) (target - now) <= 0) {
+        return;
+    }
+
+    if (timer_host_is_simulated()) {
+        timer_host_advance(target - now);
+        return;
+    }
+
+    struct timespec delay = { (target - now) / 1000000, (long) ((target - now) % 1000000) * 1000 };
+    nanosleep(&delay, NULL);
+}
+
+/////////////////////////////////////////////////////////////////////
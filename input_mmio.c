@@ -0,0 +1,259 @@
+/*
+Interrupt driven input on the DE1-SoC.
+
+The pushbutton KEY parallel port raises an interrupt on every press (edge capture).
+The interval timer raises an interrupt every millisecond; its handler samples the
+slider switches, which cannot interrupt on their own, and reports a change once the
+switches have been stable for a few samples. Both interrupts are routed to the A9
+through the generic interrupt controller (GIC) and push events into the input queue.
+*/
+
+#include "input.h"
+
+
+// DE1-SOC input devices base address
+int* SW_BASE               = (int*)0xFF200040;
+int* KEY_BASE              = (int*)0xFF200050;
+int* TIMER_BASE            = (int*)0xFF202000;
+
+// GIC CPU interface and distributor base address
+#define GIC_CPU_INTERFACE_BASE 0xFFFEC100
+#define GIC_DISTRIBUTOR_BASE   0xFFFED000
+
+// GIC register offsets
+#define ICCICR   0x00
+#define ICCPMR   0x04
+#define ICCIAR   0x0C
+#define ICCEOIR  0x10
+#define ICDDCR   0x000
+#define ICDISER  0x100
+#define ICDIPTR  0x800
+
+// Interrupt IDs of the devices in the DE1-SoC Computer
+#define INTERVAL_TIMER_IRQ 72
+#define KEYS_IRQ           73
+
+// Processor modes and the interrupt disable bit of the CPSR
+#define IRQ_MODE    0x12
+#define SVC_MODE    0x13
+#define INT_DISABLE 0x80
+#define INT_ENABLE  0x00
+
+// Word offsets of the parallel port and interval timer registers
+#define PORT_INTERRUPT_MASK 2
+#define PORT_EDGE_CAPTURE   3
+#define TIMER_STATUS        0
+#define TIMER_CONTROL       1
+#define TIMER_PERIOD_LO     2
+#define TIMER_PERIOD_HI     3
+
+// Interval timer control bits
+#define TIMER_INTERRUPT  0x1
+#define TIMER_CONTINUOUS 0x2
+#define TIMER_START      0x4
+
+// Switch sampling period in 100 MHz timer ticks (1 ms)
+#define SAMPLE_PERIOD_TICKS 100000
+
+// Number of equal samples before a switch change is reported
+#define DEBOUNCE_SAMPLES 5
+
+
+//Milliseconds since input_init, counted by the timer interrupt
+static volatile unsigned int tickCount = 0;
+
+//Reported switch state, and the sample being debounced
+static volatile int stableSwitches = 0;
+static int candidateSwitches = 0;
+static int candidateSamples = 0;
+
+
+// Function prototypes for interrupt setup and handling
+/////////////////////////////////////////////////////////////////////
+
+//Sets the stack pointer used in IRQ mode
+static void set_A9_IRQ_stack();
+
+//Enables a single interrupt in the GIC and sends it to the given CPU
+static void config_interrupt(int interruptId, int cpuTarget);
+
+//Enables the GIC CPU interface and distributor
+static void config_GIC();
+
+//Enables interrupts in the A9 processor
+static void enable_A9_interrupts();
+
+//Handles a pushbutton interrupt
+static void key_isr();
+
+//Handles an interval timer interrupt
+static void interval_timer_isr();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for user input
+/////////////////////////////////////////////////////////////////////
+
+//Starts the event source and clears the queue
+void input_init() {
+
+    volatile int *keys  = KEY_BASE;
+    volatile int *timer = TIMER_BASE;
+
+    input_clear_queue();
+    stableSwitches = candidateSwitches = *SW_BASE;
+    candidateSamples = 0;
+    tickCount = 0;
+
+    set_A9_IRQ_stack();
+
+    //Interrupt on every pushbutton press
+    *(keys + PORT_EDGE_CAPTURE)   = 0xF;
+    *(keys + PORT_INTERRUPT_MASK) = 0xF;
+
+    //Interrupt every millisecond to sample the switches
+    *(timer + TIMER_PERIOD_LO) = SAMPLE_PERIOD_TICKS & 0xFFFF;
+    *(timer + TIMER_PERIOD_HI) = SAMPLE_PERIOD_TICKS >> 16;
+    *(timer + TIMER_CONTROL)   = TIMER_INTERRUPT | TIMER_CONTINUOUS | TIMER_START;
+
+    config_interrupt(INTERVAL_TIMER_IRQ, 1);
+    config_interrupt(KEYS_IRQ, 1);
+    config_GIC();
+
+    enable_A9_interrupts();
+}
+
+//Takes the oldest event from the queue
+//Returns false if the queue is empty
+bool input_poll_event(InputEvent *event) {
+    return input_pop_event(event);
+}
+
+//Takes the oldest event from the queue, sleeping until there is one
+//Returns false if the event source has ended, which only happens on the host
+bool input_wait_event(InputEvent *event) {
+
+    //If an interrupt arrives between the check and the wfi, the next timer interrupt
+    //wakes the core again, so the wait is at most one sample period too long
+    while (!input_pop_event(event)) {
+        __asm__ volatile ("wfi");
+    }
+
+    return true;
+}
+
+//Returns the current (debounced) state of the switches
+int input_switches() {
+    return stableSwitches;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for interrupt setup and handling
+/////////////////////////////////////////////////////////////////////
+
+//Sets the stack pointer used in IRQ mode
+static void set_A9_IRQ_stack() {
+
+    //The IRQ stack starts at the top of the A9 on-chip memory
+    int stack = 0xFFFFFFFF - 7;
+
+    int mode = INT_DISABLE | IRQ_MODE;
+    __asm__ volatile ("msr cpsr, %[ps]" : : [ps] "r" (mode));
+    __asm__ volatile ("mov sp, %[ps]" : : [ps] "r" (stack));
+
+    //Go back to SVC mode before returning
+    mode = INT_DISABLE | SVC_MODE;
+    __asm__ volatile ("msr cpsr, %[ps]" : : [ps] "r" (mode));
+}
+
+//Enables a single interrupt in the GIC and sends it to the given CPU
+static void config_interrupt(int interruptId, int cpuTarget) {
+
+    //Set enable bit in the set-enable register ICDISERn
+    int registerOffset = (interruptId >> 3) & 0xFFFFFFFC;
+    int bit = interruptId & 0x1F;
+    *(volatile int *)(GIC_DISTRIBUTOR_BASE + ICDISER + registerOffset) |= 1 << bit;
+
+    //Set the target CPU in the processor targets register ICDIPTRn, one byte per interrupt
+    *(volatile char *)(GIC_DISTRIBUTOR_BASE + ICDIPTR + interruptId) = (char) cpuTarget;
+}
+
+//Enables the GIC CPU interface and distributor
+static void config_GIC() {
+
+    //Accept interrupts of every priority
+    *(volatile int *)(GIC_CPU_INTERFACE_BASE + ICCPMR) = 0xFFFF;
+
+    //Enable signaling of interrupts to the CPU and forwarding from the distributor
+    *(volatile int *)(GIC_CPU_INTERFACE_BASE + ICCICR) = 1;
+    *(volatile int *)(GIC_DISTRIBUTOR_BASE + ICDDCR) = 1;
+}
+
+//Enables interrupts in the A9 processor
+static void enable_A9_interrupts() {
+
+    int status = SVC_MODE | INT_ENABLE;
+    __asm__ volatile ("msr cpsr, %[ps]" : : [ps] "r" (status));
+}
+
+//Handles a pushbutton interrupt
+static void key_isr() {
+
+    volatile int *keys = KEY_BASE;
+
+    //Read and clear the buttons that were pressed
+    int pressed = *(keys + PORT_EDGE_CAPTURE) & 0xF;
+    *(keys + PORT_EDGE_CAPTURE) = pressed;
+
+    if (pressed != 0) {
+        input_push_event(INPUT_KEY_PRESS, pressed, tickCount);
+    }
+}
+
+//Handles an interval timer interrupt
+static void interval_timer_isr() {
+
+    volatile int *timer = TIMER_BASE;
+
+    //Clear the timeout bit
+    *(timer + TIMER_STATUS) = 0;
+    tickCount++;
+
+    //Report a switch change once the new state has held for a few samples
+    int sample = *SW_BASE & 0x3FF;
+    if (sample != candidateSwitches) {
+        candidateSwitches = sample;
+        candidateSamples = 0;
+    } else if (candidateSwitches != stableSwitches && ++candidateSamples >= DEBOUNCE_SAMPLES) {
+        stableSwitches = candidateSwitches;
+        input_push_event(INPUT_SWITCHES, stableSwitches, tickCount);
+    }
+}
+
+//IRQ exception handler, dispatches on the interrupt ID read from the GIC
+void __attribute__ ((interrupt)) __cs3_isr_irq() {
+
+    int interruptId = *(volatile int *)(GIC_CPU_INTERFACE_BASE + ICCIAR);
+
+    if (interruptId == INTERVAL_TIMER_IRQ) {
+        interval_timer_isr();
+    } else if (interruptId == KEYS_IRQ) {
+        key_isr();
+    }
+
+    //Signal the end of the interrupt
+    *(volatile int *)(GIC_CPU_INTERFACE_BASE + ICCEOIR) = interruptId;
+}
+
+//Other exceptions are not expected, stop in a loop where the debugger can see them
+void __attribute__ ((interrupt)) __cs3_reset() { while (1); }
+void __attribute__ ((interrupt)) __cs3_isr_undef() { while (1); }
+void __attribute__ ((interrupt)) __cs3_isr_swi() { while (1); }
+void __attribute__ ((interrupt)) __cs3_isr_pabort() { while (1); }
+void __attribute__ ((interrupt)) __cs3_isr_dabort() { while (1); }
+void __attribute__ ((interrupt)) __cs3_isr_fiq() { while (1); }
+
+/////////////////////////////////////////////////////////////////////
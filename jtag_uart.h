@@ -0,0 +1,26 @@
+/*
+JTAG UART of the DE1-SoC, the text link to the Monitor Program terminal.
+
+The record, the frame stream and the profiler send their text over it on the board. There
+is no host backend: their host backends write to files and stdout instead.
+*/
+
+#ifndef JTAG_UART_H
+#define JTAG_UART_H
+
+
+// Function prototypes for the JTAG UART
+/////////////////////////////////////////////////////////////////////
+
+//Returns the number of characters the UART can take without waiting
+int jtag_uart_write_space();
+
+//Writes a character, waiting while the UART's buffer is full
+void jtag_uart_write_char(char character);
+
+//Writes text, waiting whenever the UART's buffer is full
+void jtag_uart_write_text(const char *text);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,42 @@
+/*
+JTAG UART on the DE1-SoC.
+*/
+
+#include "jtag_uart.h"
+
+
+// DE1-SOC JTAG UART base address, the data register, the control register follows it
+int* JTAG_UART_BASE        = (int*)0xFF201000;
+
+// Free space in the UART's write buffer, the top half of the control register
+#define JTAG_UART_WRITE_SPACE_SHIFT 16
+
+
+// Function definitions for the JTAG UART
+/////////////////////////////////////////////////////////////////////
+
+//Returns the number of characters the UART can take without waiting
+int jtag_uart_write_space() {
+
+    volatile int *uart = JTAG_UART_BASE;
+    return (int) ((unsigned int) *(uart + 1) >> JTAG_UART_WRITE_SPACE_SHIFT);
+}
+
+//Writes a character, waiting while the UART's buffer is full
+void jtag_uart_write_char(char character) {
+
+    volatile int *uart = JTAG_UART_BASE;
+
+    while (jtag_uart_write_space() == 0);
+    *uart = character;
+}
+
+//Writes text, waiting whenever the UART's buffer is full
+void jtag_uart_write_text(const char *text) {
+
+    for (; *text != '\0'; text++) {
+        jtag_uart_write_char(*text);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
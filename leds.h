@@ -0,0 +1,70 @@
+/*
+Red LEDs and seven segment HEX displays.
+
+Two implementations, link exactly one of them:
+  leds_mmio.c  - DE1-SoC LEDR and HEX parallel ports
+  leds_host.c  - records every change on a Linux host, so a simulated game can be
+                 checked for what it would have shown
+*/
+
+#ifndef LEDS_H
+#define LEDS_H
+
+
+//LedDevice lists the output ports
+typedef enum LedDevice
+{
+    //LEDR9-LEDR0, one bit per LED
+    LEDS_RED,
+
+    //HEX3-HEX0, one byte of segments per display
+    LEDS_HEX_LOW,
+
+    //HEX5-HEX4, one byte of segments per display
+    LEDS_HEX_HIGH
+} LedDevice;
+
+
+// Function prototypes for the LEDs and HEX displays
+/////////////////////////////////////////////////////////////////////
+
+//Writes a value to an output port
+void leds_write(LedDevice device, int value);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+// Number of changes the host log keeps, the oldest are overwritten
+#define LEDS_HOST_LOG_SIZE 256
+
+//LedChange holds a change of an output port
+typedef struct LedChange
+{
+    //timer_microseconds when the value was written
+    unsigned int time;
+    LedDevice device;
+    int value;
+} LedChange;
+
+//Called on every change of an output port, NULL for none
+typedef void (*LedListener)(LedChange change);
+
+//Returns the last value written to an output port
+int leds_host_value(LedDevice device);
+
+//Returns the number of changes recorded, writes of the value a port already has are not changes
+int leds_host_change_count();
+
+//Returns a recorded change, the log keeps the LEDS_HOST_LOG_SIZE most recent ones
+//index counts from the oldest change still kept
+const LedChange * leds_host_change(int index);
+
+//Sets the function called on every change
+void leds_host_set_listener(LedListener listener);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,77 @@
+/*
+LEDs and HEX displays on a Linux host, every change is recorded.
+*/
+
+#include <stddef.h>
+
+#include "leds.h"
+#include "timer.h"
+
+
+// Number of output ports
+#define LED_DEVICE_COUNT 3
+
+
+//Current value of each port
+static int values[LED_DEVICE_COUNT];
+
+//Ring of the most recent changes and the number of changes ever made
+static LedChange changeLog[LEDS_HOST_LOG_SIZE];
+static int changeCount = 0;
+
+static LedListener changeListener = NULL;
+
+
+// Function definitions for the LEDs and HEX displays
+/////////////////////////////////////////////////////////////////////
+
+//Writes a value to an output port, recording it if it changes the port
+void leds_write(LedDevice device, int value) {
+
+    if (values[device] == value) {
+        return;
+    }
+    values[device] = value;
+
+    LedChange change = {timer_microseconds(), device, value};
+    changeLog[changeCount % LEDS_HOST_LOG_SIZE] = change;
+    changeCount++;
+
+    if (changeListener != NULL) {
+        changeListener(change);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Returns the last value written to an output port
+int leds_host_value(LedDevice device) {
+    return values[device];
+}
+
+//Returns the number of changes recorded
+int leds_host_change_count() {
+    return changeCount;
+}
+
+//Returns a recorded change, index counts from the oldest change still kept
+const LedChange * leds_host_change(int index) {
+
+    int kept = changeCount < LEDS_HOST_LOG_SIZE ? changeCount : LEDS_HOST_LOG_SIZE;
+    if (index < 0 || index >= kept) {
+        return NULL;
+    }
+
+    return &changeLog[(changeCount - kept + index) % LEDS_HOST_LOG_SIZE];
+}
+
+//Sets the function called on every change
+void leds_host_set_listener(LedListener listener) {
+    changeListener = listener;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,26 @@
+/*
+LEDs and HEX displays on the DE1-SoC parallel ports.
+*/
+
+#include "leds.h"
+
+
+// DE1-SOC FPGA devices base address
+int* LEDR_BASE             = (int*)0xFF200000;
+int* HEX3_HEX0_BASE        = (int*)0xFF200020;
+int* HEX5_HEX4_BASE        = (int*)0xFF200030;
+
+
+// Function definitions for the LEDs and HEX displays
+/////////////////////////////////////////////////////////////////////
+
+//Writes a value to an output port
+void leds_write(LedDevice device, int value) {
+
+    if     (device == LEDS_RED)      *(volatile int *) LEDR_BASE      = value;
+    else if(device == LEDS_HEX_LOW)  *(volatile int *) HEX3_HEX0_BASE = value;
+    else if(device == LEDS_HEX_HIGH) *(volatile int *) HEX5_HEX4_BASE = value;
+
+}
+
+/////////////////////////////////////////////////////////////////////
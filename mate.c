@@ -0,0 +1,779 @@
+/*
+Forced mate solver.
+*/
+
+#include <string.h>
+
+#include "mate.h"
+#include "timer.h"
+
+
+// Proof or disproof number of a position that is refuted or proven, sums of the others stay below it
+#define MATE_INFINITE 0x3fffffffu
+
+// Multiplier the keys of pieces, the side to move and the plies left are made from
+#define KEY_MULTIPLIER 0x9e3779b97f4a7c15ull
+
+// Slots a key can be kept in, side by side in the table
+#define ENTRY_SLOTS 4
+
+
+//MateNumbers holds the numbers of a position while they are worked out
+typedef struct MateNumbers
+{
+    uint32_t proof;
+    uint32_t disproof;
+    int distance;
+} MateNumbers;
+
+
+// Function prototypes for mate solver helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if a limit or the deadline has been reached, looking at the clock every MATE_CLOCK_NODES nodes
+static bool reached_limit(MateSolver *solver);
+
+//Returns a + b, or MATE_INFINITE if either is, other sums stop just below it
+static uint32_t add_numbers(uint32_t a, uint32_t b);
+
+//Sets numbers to a position proven with the mate distance plies away, or to one refuted
+static void set_proven(MateNumbers *numbers, int distance);
+static void set_refuted(MateNumbers *numbers);
+
+//Checks if a move takes the king, which the rules allow when a pawn attacks a white king
+static bool takes_king(const MateSolver *solver, Move move);
+
+//Makes a move and hands the turn over, and takes it back
+static MoveUndo make_solver_move(MateSolver *solver, Move move);
+static void unmake_solver_move(MateSolver *solver, Move move, MoveUndo undo);
+
+//Writes the moves of the position at ply into moves, and its numbers before any of them is searched
+//Returns true if the position is settled already: mate, no moves, or the last ply without mate
+static bool evaluate_position(MateSolver *solver, int ply, Move *moves, int *count, MateNumbers *numbers);
+
+//Sets up the search of a mate in solver->moves moves
+static void start_iteration(MateSolver *solver);
+
+//Ends the solve with a result
+static void finish(MateSolver *solver, MateResult result);
+
+//Works out the numbers of a node of the tree at ply from its children
+static void update_node(MateSolver *solver, int index, int ply);
+
+//Grows the tree by one position: walks down to the most proving node, expands it and updates its ancestors
+static void grow_tree(MateSolver *solver);
+
+//Follows the proven tree from the root into the line
+static void tree_line(MateSolver *solver);
+
+//Mixes a number into 64 well spread bits, the finalizer of splitmix64
+static uint64_t mix_key(uint64_t value);
+
+//Returns the key of the position on the solver's board with the side to move
+static uint64_t position_key(MateSolver *solver);
+
+//Returns the key of the position after a move, from the key before it, called before the move is made
+static uint64_t key_after_move(MateSolver *solver, uint64_t key, Move move);
+
+//Returns the key of a number of plies left, mixed into a position's key for the table
+static uint64_t plies_left_key(int plies);
+
+//Finds the entry of a key in the table, NULL if it is not there
+static MateEntry * find_entry(MateSolver *solver, uint64_t key);
+
+//Writes the numbers of a key into the table, in place of the entry of its slots that did the least work
+static void store_entry(MateSolver *solver, uint64_t key, const MateNumbers *numbers, long long work);
+
+//Returns the numbers of the position a move from ply leads to, as the table knows them
+static void child_numbers(MateSolver *solver, int ply, Move move, uint64_t childKey, MateNumbers *numbers);
+
+//Searches the position at ply depth first until its numbers reach a threshold, the table keeps what it finds
+static void depth_first(MateSolver *solver, int ply, uint64_t key, uint32_t proofThreshold, uint32_t disproofThreshold,
+    MateNumbers *numbers);
+
+//Returns the numbers of a child, searching it again if the table lost them
+static void settled_child_numbers(MateSolver *solver, int ply, Move move, uint64_t childKey, MateNumbers *numbers);
+
+//Follows the proven positions of the table from the root into the line
+static void table_line(MateSolver *solver);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the mate solver
+/////////////////////////////////////////////////////////////////////
+
+//Starts solving a position for the side to move, the board is copied
+//The positions are kept in all the memory arena has left, which stays in use until the solve is done with
+void mate_start(MateSolver *solver, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, MateMethod method,
+    const MateLimits *limits, Arena *arena) {
+
+    copy_board(board, solver->board);
+    solver->currentTurn = currentTurn;
+    solver->method = method;
+    solver->limits = *limits;
+    if (solver->limits.moves <= 0 || solver->limits.moves > MATE_MAX_MOVES) {
+        solver->limits.moves = MATE_MAX_MOVES;
+    }
+    solver->nodes = NULL;
+    solver->nodeCount = 0;
+    solver->nodeCapacity = 0;
+    solver->entries = NULL;
+    solver->entryMask = 0;
+
+    //The pool or table takes whatever the arena has left, rounded down to what the allocation can align
+    size_t left = arena->size - arena->used;
+    left = left > ARENA_ALIGNMENT ? left - ARENA_ALIGNMENT : 0;
+    if (method == MATE_PROOF_NUMBER) {
+        size_t count = left / sizeof(MateNode);
+        solver->nodeCapacity = count > INT32_MAX ? INT32_MAX : (int) count;
+        solver->nodes = solver->nodeCapacity > 0 ? arena_alloc(arena, solver->nodeCapacity * sizeof(MateNode)) : NULL;
+    } else {
+        size_t count = ENTRY_SLOTS;
+        while (count * 2 * sizeof(MateEntry) <= left && count * 2 <= ((size_t) 1 << 31)) {
+            count *= 2;
+        }
+        if (count * sizeof(MateEntry) <= left) {
+            solver->entries = arena_alloc(arena, count * sizeof(MateEntry));
+            solver->entryMask = (uint32_t) (count - 1);
+            memset(solver->entries, 0, count * sizeof(MateEntry));
+        }
+    }
+    solver->rootKey = position_key(solver);
+
+    //The clock starts once the table is cleared, which takes as long as the memory is large
+    solver->startMicroseconds = timer_microseconds();
+
+    solver->result = MATE_SOLVING;
+    solver->mateIn = 0;
+    solver->lineLength = 0;
+    solver->nodesSearched = 0;
+    solver->expansions = 0;
+    solver->replacements = 0;
+    solver->microseconds = 0;
+    solver->stopped = false;
+    solver->paused = false;
+    solver->finished = false;
+
+    //A side with no moves mates nobody, and nothing can be solved without memory
+    Move moves[MAX_MOVES];
+    if (generate_moves(solver->board, currentTurn, moves) == 0) {
+        finish(solver, MATE_NONE);
+        return;
+    }
+    if (solver->nodes == NULL && solver->entries == NULL) {
+        finish(solver, MATE_UNKNOWN);
+        return;
+    }
+
+    solver->moves = 1;
+    start_iteration(solver);
+}
+
+//Solves until the deadline (a timer_microseconds value) has passed, at least MATE_CLOCK_NODES nodes
+//Returns true once the solve has finished and result holds what it found
+bool mate_step(MateSolver *solver, unsigned int deadline) {
+
+    solver->deadline = deadline;
+    solver->paused = false;
+    solver->nextClock = solver->nodesSearched + MATE_CLOCK_NODES;
+
+    while (!solver->finished) {
+
+        MateNumbers root;
+        if (solver->method == MATE_PROOF_NUMBER) {
+            while (solver->nodes[0].proof != 0 && solver->nodes[0].disproof != 0 && !reached_limit(solver)) {
+                grow_tree(solver);
+            }
+            root.proof = solver->nodes[0].proof;
+            root.disproof = solver->nodes[0].disproof;
+        } else {
+            depth_first(solver, 0, solver->rootKey, MATE_INFINITE, MATE_INFINITE, &root);
+        }
+
+        //A proof at this length is the shortest mate, the lengths before it were all refuted
+        if (root.proof == 0) {
+            solver->mateIn = solver->moves;
+            solver->result = MATE_FOUND;
+            if (solver->method == MATE_PROOF_NUMBER) {
+                tree_line(solver);
+            } else {
+                table_line(solver);
+            }
+            finish(solver, MATE_FOUND);
+        } else if (root.disproof == 0) {
+            if (solver->moves == solver->limits.moves) {
+                solver->mateIn = solver->moves;
+                finish(solver, MATE_NONE);
+            } else {
+                solver->moves++;
+                start_iteration(solver);
+            }
+        } else if (solver->stopped) {
+            solver->mateIn = solver->moves;
+            finish(solver, MATE_UNKNOWN);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Solves until finished or a limit is reached
+void mate_run(MateSolver *solver) {
+    while (!mate_step(solver, timer_microseconds()));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for mate solver helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if a limit or the deadline has been reached, looking at the clock every MATE_CLOCK_NODES nodes
+//Once the root is proven the line is worked out whatever the deadline, only the limits stop it
+static bool reached_limit(MateSolver *solver) {
+
+    if (solver->stopped || solver->paused) {
+        return true;
+    }
+
+    if (solver->limits.nodes > 0 && solver->nodesSearched >= solver->limits.nodes) {
+        solver->stopped = true;
+    } else if (solver->nodesSearched >= solver->nextClock) {
+        solver->nextClock = solver->nodesSearched + MATE_CLOCK_NODES;
+        unsigned int now = timer_microseconds();
+        solver->stopped = solver->limits.milliseconds > 0 && now - solver->startMicroseconds >= solver->limits.milliseconds * 1000u;
+        solver->paused = solver->result == MATE_SOLVING && (int) (now - solver->deadline) >= 0;
+    }
+
+    return solver->stopped || solver->paused;
+}
+
+//Returns a + b, or MATE_INFINITE if either is, other sums stop just below it
+static uint32_t add_numbers(uint32_t a, uint32_t b) {
+
+    if (a >= MATE_INFINITE || b >= MATE_INFINITE) {
+        return MATE_INFINITE;
+    }
+    return a + b < MATE_INFINITE ? a + b : MATE_INFINITE - 1;
+}
+
+//Sets numbers to a position proven with the mate distance plies away
+static void set_proven(MateNumbers *numbers, int distance) {
+
+    numbers->proof = 0;
+    numbers->disproof = MATE_INFINITE;
+    numbers->distance = distance;
+}
+
+//Sets numbers to a position refuted
+static void set_refuted(MateNumbers *numbers) {
+
+    numbers->proof = MATE_INFINITE;
+    numbers->disproof = 0;
+    numbers->distance = 0;
+}
+
+//Checks if a move takes the king, which the rules allow when a pawn attacks a white king
+static bool takes_king(const MateSolver *solver, Move move) {
+    return PACKED_PIECE_ID(solver->board[MOVE_Y(move.end)][MOVE_X(move.end)]) == KING;
+}
+
+//Makes a move and hands the turn over
+static MoveUndo make_solver_move(MateSolver *solver, Move move) {
+
+    MoveUndo undo = make_move(solver->board, move);
+    switch_turns(&solver->currentTurn);
+    return undo;
+}
+
+//Takes back a move made with make_solver_move
+static void unmake_solver_move(MateSolver *solver, Move move, MoveUndo undo) {
+
+    switch_turns(&solver->currentTurn);
+    unmake_move(solver->board, move, undo);
+}
+
+//Writes the moves of the position at ply into moves, and its numbers before any of them is searched
+//Returns true if the position is settled already: mate, no moves, or the last ply without mate
+//Plies alternate from the attacker at the root, and the numbers start from the moves to look at
+static bool evaluate_position(MateSolver *solver, int ply, Move *moves, int *count, MateNumbers *numbers) {
+
+    bool attacker = ply % 2 == 0;
+    *count = 0;
+
+    //The attacker's last move had to mate, one that does not give check is refuted without generating a move
+    if (!attacker && ply == solver->maxPly) {
+        if (!is_in_check(solver->board, solver->currentTurn)) {
+            set_refuted(numbers);
+        } else if (generate_moves(solver->board, solver->currentTurn, moves) == 0) {
+            set_proven(numbers, 0);
+        } else {
+            set_refuted(numbers);
+        }
+        return true;
+    }
+
+    //No moves is mate or stalemate as in is_game_over, only a mated defender counts
+    *count = generate_moves(solver->board, solver->currentTurn, moves);
+    if (*count == 0) {
+        if (!attacker && is_in_check(solver->board, solver->currentTurn)) {
+            set_proven(numbers, 0);
+        } else {
+            set_refuted(numbers);
+        }
+        return true;
+    }
+
+    numbers->proof = attacker ? 1 : (uint32_t) *count;
+    numbers->disproof = attacker ? (uint32_t) *count : 1;
+    numbers->distance = 0;
+    return false;
+}
+
+//Sets up the search of a mate in solver->moves moves
+//The tree starts again from its root, the table keeps its entries as they are keyed by the plies left
+static void start_iteration(MateSolver *solver) {
+
+    solver->maxPly = 2 * solver->moves - 1;
+    if (solver->method != MATE_PROOF_NUMBER) {
+        return;
+    }
+
+    Move moves[MAX_MOVES];
+    int count;
+    MateNumbers numbers;
+    evaluate_position(solver, 0, moves, &count, &numbers);
+
+    MateNode *root = &solver->nodes[0];
+    root->proof = numbers.proof;
+    root->disproof = numbers.disproof;
+    root->firstChild = -1;
+    root->childCount = 0;
+    root->distance = 0;
+    solver->nodeCount = 1;
+}
+
+//Ends the solve with a result
+static void finish(MateSolver *solver, MateResult result) {
+
+    solver->result = result;
+    solver->finished = true;
+    solver->microseconds = timer_microseconds() - solver->startMicroseconds;
+}
+
+//Works out the numbers of a node of the tree at ply from its children
+//The attacker needs one proven move and the defender all of them, a mate is as near as the attacker
+//can make it and as far as the defender can
+static void update_node(MateSolver *solver, int index, int ply) {
+
+    MateNode *node = &solver->nodes[index];
+    const MateNode *children = &solver->nodes[node->firstChild];
+    bool attacker = ply % 2 == 0;
+
+    uint32_t proof = attacker ? MATE_INFINITE : 0;
+    uint32_t disproof = attacker ? 0 : MATE_INFINITE;
+    int distance = attacker ? MATE_MAX_PLIES : 0;
+
+    for (int child = 0; child < node->childCount; child++) {
+        const MateNode *next = &children[child];
+        if (attacker) {
+            proof = next->proof < proof ? next->proof : proof;
+            disproof = add_numbers(disproof, next->disproof);
+            if (next->proof == 0 && next->distance + 1 < distance) {
+                distance = next->distance + 1;
+            }
+        } else {
+            proof = add_numbers(proof, next->proof);
+            disproof = next->disproof < disproof ? next->disproof : disproof;
+            if (next->distance + 1 > distance) {
+                distance = next->distance + 1;
+            }
+        }
+    }
+
+    node->proof = proof;
+    node->disproof = disproof;
+    node->distance = (uint8_t) (proof == 0 ? distance : 0);
+}
+
+//Grows the tree by one position: walks down to the most proving node, expands it and updates its ancestors
+//The most proving node is found by following the child with the smallest proof number where the attacker
+//moves and the smallest disproof number where the defender does
+static void grow_tree(MateSolver *solver) {
+
+    int path[MATE_MAX_PLIES + 1];
+    MoveUndo undos[MATE_MAX_PLIES + 1];
+    int index = 0;
+    int ply = 0;
+
+    while (solver->nodes[index].firstChild >= 0) {
+
+        const MateNode *node = &solver->nodes[index];
+        int best = node->firstChild;
+        for (int child = node->firstChild + 1; child < node->firstChild + node->childCount; child++) {
+            const MateNode *next = &solver->nodes[child];
+            if (ply % 2 == 0 ? next->proof < solver->nodes[best].proof : next->disproof < solver->nodes[best].disproof) {
+                best = child;
+            }
+        }
+
+        path[ply] = index;
+        undos[ply] = make_solver_move(solver, solver->nodes[best].move);
+        ply++;
+        index = best;
+    }
+
+    //Every child is looked at as it is made, so the next walk already knows which of them are settled
+    Move moves[MAX_MOVES];
+    Move replies[MAX_MOVES];
+    int count;
+    MateNumbers numbers;
+    evaluate_position(solver, ply, moves, &count, &numbers);
+
+    if (solver->nodeCount + count > solver->nodeCapacity) {
+        solver->stopped = true;
+    } else {
+        MateNode *children = &solver->nodes[solver->nodeCount];
+        for (int child = 0; child < count; child++) {
+
+            MateNode *next = &children[child];
+            next->move = moves[child];
+            next->firstChild = -1;
+            next->childCount = 0;
+            solver->nodesSearched++;
+
+            int replyCount;
+            if (takes_king(solver, moves[child])) {
+                if (ply % 2 == 0) {
+                    set_proven(&numbers, 0);
+                } else {
+                    set_refuted(&numbers);
+                }
+            } else {
+                MoveUndo undo = make_solver_move(solver, moves[child]);
+                evaluate_position(solver, ply + 1, replies, &replyCount, &numbers);
+                unmake_solver_move(solver, moves[child], undo);
+            }
+            next->proof = numbers.proof;
+            next->disproof = numbers.disproof;
+            next->distance = (uint8_t) numbers.distance;
+        }
+
+        solver->nodes[index].firstChild = solver->nodeCount;
+        solver->nodes[index].childCount = (uint16_t) count;
+        solver->nodeCount += count;
+        solver->expansions++;
+        update_node(solver, index, ply);
+    }
+
+    while (ply > 0) {
+        ply--;
+        unmake_solver_move(solver, solver->nodes[index].move, undos[ply]);
+        index = path[ply];
+        update_node(solver, index, ply);
+    }
+}
+
+//Follows the proven tree from the root into the line
+//The attacker plays its nearest proven mate, the defender the reply that holds out longest
+static void tree_line(MateSolver *solver) {
+
+    int index = 0;
+    int ply = 0;
+    while (solver->nodes[index].firstChild >= 0 && ply < MATE_MAX_PLIES) {
+
+        const MateNode *node = &solver->nodes[index];
+        int best = -1;
+        for (int child = node->firstChild; child < node->firstChild + node->childCount; child++) {
+            const MateNode *next = &solver->nodes[child];
+            if (next->proof != 0) {
+                continue;
+            }
+            if (best < 0 || (ply % 2 == 0 ? next->distance < solver->nodes[best].distance : next->distance > solver->nodes[best].distance)) {
+                best = child;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        solver->line[ply++] = solver->nodes[best].move;
+        index = best;
+    }
+    solver->lineLength = ply;
+}
+
+//Mixes a number into 64 well spread bits, the finalizer of splitmix64
+static uint64_t mix_key(uint64_t value) {
+
+    value *= KEY_MULTIPLIER;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+//Returns the key of the position on the solver's board with the side to move
+static uint64_t position_key(MateSolver *solver) {
+
+    uint64_t key = solver->currentTurn == WHITE_PIECE ? KEY_MULTIPLIER : 0;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if (solver->board[yCoord][xCoord] != PACKED_EMPTY) {
+                key ^= mix_key((uint64_t) MOVE_SQUARE(xCoord, yCoord) << 8 | solver->board[yCoord][xCoord]);
+            }
+        }
+    }
+    return key;
+}
+
+//Returns the key of the position after a move, from the key before it, called before the move is made
+static uint64_t key_after_move(MateSolver *solver, uint64_t key, Move move) {
+
+    PackedSquare piece = solver->board[MOVE_Y(move.start)][MOVE_X(move.start)];
+    PackedSquare taken = solver->board[MOVE_Y(move.end)][MOVE_X(move.end)];
+
+    key ^= KEY_MULTIPLIER ^ mix_key((uint64_t) move.start << 8 | piece) ^ mix_key((uint64_t) move.end << 8 | piece);
+    if (taken != PACKED_EMPTY) {
+        key ^= mix_key((uint64_t) move.end << 8 | taken);
+    }
+    return key;
+}
+
+//Returns the key of a number of plies left, mixed into a position's key for the table
+//A position is proven or refuted for so many plies, so the same position with other plies left is another entry
+static uint64_t plies_left_key(int plies) {
+    return mix_key((uint64_t) (plies + 1) << 16);
+}
+
+//Finds the entry of a key in the table, NULL if it is not there
+//A key has ENTRY_SLOTS slots side by side
+static MateEntry * find_entry(MateSolver *solver, uint64_t key) {
+
+    MateEntry *slots = &solver->entries[key & solver->entryMask & ~(uint32_t) (ENTRY_SLOTS - 1)];
+    for (int slot = 0; slot < ENTRY_SLOTS; slot++) {
+        if (slots[slot].key == key) {
+            return &slots[slot];
+        }
+    }
+    return NULL;
+}
+
+//Writes the numbers of a key into the table, in place of the entry of its slots that did the least work
+static void store_entry(MateSolver *solver, uint64_t key, const MateNumbers *numbers, long long work) {
+
+    MateEntry *entry = find_entry(solver, key);
+    if (entry == NULL) {
+        MateEntry *slots = &solver->entries[key & solver->entryMask & ~(uint32_t) (ENTRY_SLOTS - 1)];
+        entry = &slots[0];
+        for (int slot = 1; slot < ENTRY_SLOTS; slot++) {
+            if (slots[slot].work < entry->work) {
+                entry = &slots[slot];
+            }
+        }
+        solver->replacements += entry->key != 0;
+    }
+
+    entry->key = key;
+    entry->proof = numbers->proof;
+    entry->disproof = numbers->disproof;
+    entry->work = work < UINT32_MAX ? (uint32_t) work : UINT32_MAX;
+    entry->distance = (uint8_t) numbers->distance;
+}
+
+//Returns the numbers of the position a move from ply leads to, as the table knows them
+//A position not in the table starts at 1 and 1
+static void child_numbers(MateSolver *solver, int ply, Move move, uint64_t childKey, MateNumbers *numbers) {
+
+    if (takes_king(solver, move)) {
+        if (ply % 2 == 0) {
+            set_proven(numbers, 0);
+        } else {
+            set_refuted(numbers);
+        }
+        return;
+    }
+
+    const MateEntry *entry = find_entry(solver, childKey ^ plies_left_key(solver->maxPly - ply - 1));
+    if (entry == NULL) {
+        numbers->proof = 1;
+        numbers->disproof = 1;
+        numbers->distance = 0;
+        return;
+    }
+    numbers->proof = entry->proof;
+    numbers->disproof = entry->disproof;
+    numbers->distance = entry->distance;
+}
+
+//Searches the position at ply depth first until its numbers reach a threshold, the table keeps what it finds
+//This is df-pn: a child is searched until its numbers pass what would make another child the most proving
+//one, then its parent looks again, so the search only climbs back when the best line changes
+static void depth_first(MateSolver *solver, int ply, uint64_t key, uint32_t proofThreshold, uint32_t disproofThreshold,
+    MateNumbers *numbers) {
+
+    long long firstNode = solver->nodesSearched++;
+    uint64_t entryKey = key ^ plies_left_key(solver->maxPly - ply);
+
+    Move moves[MAX_MOVES];
+    int count;
+    if (evaluate_position(solver, ply, moves, &count, numbers)) {
+        store_entry(solver, entryKey, numbers, 1);
+        return;
+    }
+
+    uint64_t childKeys[MAX_MOVES];
+    for (int child = 0; child < count; child++) {
+        childKeys[child] = key_after_move(solver, key, moves[child]);
+    }
+
+    bool attacker = ply % 2 == 0;
+    while (true) {
+
+        //The numbers from the children, the most proving child and how far it may go before the second one takes over
+        int best = 0;
+        uint32_t second = MATE_INFINITE;
+        MateNumbers bestNumbers = {MATE_INFINITE, MATE_INFINITE, 0};
+        numbers->proof = attacker ? MATE_INFINITE : 0;
+        numbers->disproof = attacker ? 0 : MATE_INFINITE;
+        numbers->distance = attacker ? MATE_MAX_PLIES : 0;
+
+        for (int child = 0; child < count; child++) {
+
+            MateNumbers next;
+            child_numbers(solver, ply, moves[child], childKeys[child], &next);
+            uint32_t rank = attacker ? next.proof : next.disproof;
+            uint32_t bestRank = attacker ? bestNumbers.proof : bestNumbers.disproof;
+            if (child == 0 || rank < bestRank) {
+                second = child == 0 ? MATE_INFINITE : bestRank;
+                best = child;
+                bestNumbers = next;
+            } else if (rank < second) {
+                second = rank;
+            }
+
+            if (attacker) {
+                numbers->proof = next.proof < numbers->proof ? next.proof : numbers->proof;
+                numbers->disproof = add_numbers(numbers->disproof, next.disproof);
+                if (next.proof == 0 && next.distance + 1 < numbers->distance) {
+                    numbers->distance = next.distance + 1;
+                }
+            } else {
+                numbers->proof = add_numbers(numbers->proof, next.proof);
+                numbers->disproof = next.disproof < numbers->disproof ? next.disproof : numbers->disproof;
+                if (next.distance + 1 > numbers->distance) {
+                    numbers->distance = next.distance + 1;
+                }
+            }
+        }
+        if (numbers->proof != 0) {
+            numbers->distance = 0;
+        }
+
+        if (numbers->proof >= proofThreshold || numbers->disproof >= disproofThreshold || reached_limit(solver)) {
+            break;
+        }
+
+        //The sum of the other children's numbers is kept out of the child's threshold, and the child may pass
+        //the second one by a quarter before its parent looks again, so a small table is not filled by a search
+        //climbing back and forth between two children
+        uint32_t childProofThreshold;
+        uint32_t childDisproofThreshold;
+        uint32_t secondThreshold = add_numbers(second, second / 4 + 1);
+        if (attacker) {
+            childProofThreshold = secondThreshold < proofThreshold ? secondThreshold : proofThreshold;
+            childDisproofThreshold = disproofThreshold - numbers->disproof + bestNumbers.disproof;
+        } else {
+            childDisproofThreshold = secondThreshold < disproofThreshold ? secondThreshold : disproofThreshold;
+            childProofThreshold = proofThreshold - numbers->proof + bestNumbers.proof;
+        }
+
+        MateNumbers childResult;
+        MoveUndo undo = make_solver_move(solver, moves[best]);
+        depth_first(solver, ply + 1, childKeys[best], childProofThreshold, childDisproofThreshold, &childResult);
+        unmake_solver_move(solver, moves[best], undo);
+    }
+
+    store_entry(solver, entryKey, numbers, solver->nodesSearched - firstNode);
+}
+
+//Returns the numbers of a child, searching it again if the table lost them
+static void settled_child_numbers(MateSolver *solver, int ply, Move move, uint64_t childKey, MateNumbers *numbers) {
+
+    child_numbers(solver, ply, move, childKey, numbers);
+    if (numbers->proof == 0 || numbers->disproof == 0) {
+        return;
+    }
+
+    MoveUndo undo = make_solver_move(solver, move);
+    depth_first(solver, ply + 1, childKey, MATE_INFINITE, MATE_INFINITE, numbers);
+    unmake_solver_move(solver, move, undo);
+}
+
+//Follows the proven positions of the table from the root into the line
+//The attacker plays its nearest proven mate, the defender the reply that holds out longest
+//Entries replaced since they were proven are searched again, within the limits
+static void table_line(MateSolver *solver) {
+
+    MoveUndo undos[MATE_MAX_PLIES];
+    uint64_t key = solver->rootKey;
+    int ply = 0;
+    solver->lineLength = 0;
+
+    while (ply < solver->maxPly) {
+
+        Move moves[MAX_MOVES];
+        int count;
+        MateNumbers numbers;
+        if (evaluate_position(solver, ply, moves, &count, &numbers)) {
+            break;
+        }
+
+        int best = -1;
+        int bestDistance = 0;
+        uint64_t bestKey = 0;
+        for (int child = 0; child < count && !solver->stopped; child++) {
+
+            uint64_t childKey = key_after_move(solver, key, moves[child]);
+            MateNumbers next;
+            child_numbers(solver, ply, moves[child], childKey, &next);
+
+            //The attacker takes the nearest mate the table still knows, and only searches if it knows none
+            if (next.proof != 0 && (ply % 2 != 0 || best < 0)) {
+                settled_child_numbers(solver, ply, moves[child], childKey, &next);
+            }
+            if (next.proof != 0) {
+                continue;
+            }
+            if (best < 0 || (ply % 2 == 0 ? next.distance < bestDistance : next.distance > bestDistance)) {
+                best = child;
+                bestDistance = next.distance;
+                bestKey = childKey;
+            }
+        }
+        if (best < 0 || solver->stopped) {
+            break;
+        }
+
+        //Taking the king ends the line, there is no position after it to look at
+        solver->line[ply] = moves[best];
+        if (takes_king(solver, moves[best])) {
+            solver->lineLength = ply + 1;
+            break;
+        }
+        undos[ply] = make_solver_move(solver, moves[best]);
+        key = bestKey;
+        ply++;
+    }
+    if (solver->lineLength <= ply) {
+        solver->lineLength = ply;
+    }
+
+    while (ply > 0) {
+        ply--;
+        unmake_solver_move(solver, solver->line[ply], undos[ply]);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,186 @@
+/*
+Forced mate solver.
+
+Finds the shortest forced mate for the side to move, if there is one within a number of
+moves. The game only knows is_checkmate on the position it is in; the solver proves that
+every defence still loses, with proof-number search. A position with the attacker to move
+is proven once one of its moves is, and one with the defender to move once all of its
+moves are. Every position keeps two numbers: how many more positions at least have to be
+proven to prove it (proof number) and how many have to be refuted to refute it (disproof
+number), and the solver always grows the position that would settle the root soonest.
+It looks where the moves are forcing and the replies few, and needs no evaluation.
+
+The moves are those of movegen.c, so the rules are exactly the board's, and a position
+is mate when the side to move has no moves and is_in_check says its king is attacked.
+A move that takes the king, which the rules allow when a pawn attacks a white king, wins
+too and counts as the mating move, one move later than the search scores it. Mates are
+proven in 1 move, then in 2 and so on, so the first one found is the shortest, and its
+line has the defender put off the mate as long as it can.
+
+Two ways of keeping the positions, both in memory handed over as an Arena:
+  proof number  the tree itself, one MateNode per position in a pool, the children of a
+                position side by side. Fastest, but it stops once the pool is full.
+  depth first   df-pn: the same search run depth first under thresholds, keeping the
+                numbers of positions in a fixed table (MateEntry) keyed by position and
+                moves left. Entries that did the least work are replaced when the table is
+                full, so it runs in any memory at the cost of searching some positions again;
+                the line is read back from the table the same way, and is cut short if a
+                limit stops it first.
+
+A solve can be stepped like the search, so the board can run it between frames.
+*/
+
+#ifndef MATE_H
+#define MATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "chess.h"
+#include "movegen.h"
+
+
+// Longest mate the solver looks for, in moves of the attacker
+#define MATE_MAX_MOVES 16
+
+// Longest line, a mate in MATE_MAX_MOVES takes 2 * MATE_MAX_MOVES - 1 plies
+#define MATE_MAX_PLIES (2 * MATE_MAX_MOVES)
+
+// Nodes searched between two looks at the clock
+#define MATE_CLOCK_NODES 256
+
+
+//MateMethod lists how the solver keeps the positions it searches, see above
+typedef enum MateMethod
+{
+    MATE_PROOF_NUMBER,
+    MATE_DEPTH_FIRST
+} MateMethod;
+
+
+//MateResult lists what a solve found
+typedef enum MateResult
+{
+    MATE_SOLVING,
+
+    //A mate in mateIn moves, and none shorter
+    MATE_FOUND,
+
+    //No mate in the moves of the limits or fewer, or no moves at all
+    MATE_NONE,
+
+    //Stopped by a limit or a full pool, there is no mate in fewer than mateIn moves
+    MATE_UNKNOWN
+} MateResult;
+
+
+//MateLimits holds when a solve stops, a limit of 0 does not apply except moves, which is MATE_MAX_MOVES then
+typedef struct MateLimits
+{
+    int moves;
+    long long nodes;
+    unsigned int milliseconds;
+} MateLimits;
+
+
+//MateNode holds a position of the proof-number tree, the move that reached it and its numbers
+//The root is nodes[0], its children and theirs are found through firstChild
+typedef struct MateNode
+{
+    uint32_t proof;
+    uint32_t disproof;
+
+    //Index of the first child, -1 until the position is expanded
+    int32_t firstChild;
+    uint16_t childCount;
+    Move move;
+
+    //Plies to the mate once proven
+    uint8_t distance;
+} MateNode;
+
+
+//MateEntry holds the numbers of a position with a number of plies left, for the depth first search
+typedef struct MateEntry
+{
+    uint64_t key;
+    uint32_t proof;
+    uint32_t disproof;
+
+    //Nodes searched below the position, the entry that did more stays when two want a slot
+    uint32_t work;
+
+    //Plies to the mate once proven
+    uint8_t distance;
+} MateEntry;
+
+
+//MateSolver holds a solve and the memory it keeps its positions in
+typedef struct MateSolver
+{
+    //The position solved, moves are made and taken back on it
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+
+    MateMethod method;
+    MateLimits limits;
+    unsigned int startMicroseconds;
+
+    //Mate length being proven, in moves and in plies
+    int moves;
+    int maxPly;
+
+    //Proof number: the pool of nodes, nodes[0] is the root
+    MateNode *nodes;
+    int nodeCount;
+    int nodeCapacity;
+
+    //Depth first: the table, a power of two entries, and the key of the root
+    MateEntry *entries;
+    uint32_t entryMask;
+    uint64_t rootKey;
+
+    //Outcome, and the mating line once found, the defender's replies included
+    MateResult result;
+    int mateIn;
+    Move line[MATE_MAX_PLIES];
+    int lineLength;
+
+    //Positions looked at, expansions of the tree, entries written over by another position
+    long long nodesSearched;
+    long long expansions;
+    long long replacements;
+
+    //Time the solve took, once finished
+    unsigned int microseconds;
+
+    //Stopped for good by a limit, or only until the next step by its deadline, which is looked at
+    //again once nextClock nodes have been searched
+    bool stopped;
+    bool paused;
+    unsigned int deadline;
+    long long nextClock;
+    bool finished;
+} MateSolver;
+
+
+// Function prototypes for the mate solver
+/////////////////////////////////////////////////////////////////////
+
+//Starts solving a position for the side to move, the board is copied
+//The positions are kept in all the memory arena has left, which stays in use until the solve is done with
+void mate_start(MateSolver *solver, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, MateMethod method,
+    const MateLimits *limits, Arena *arena);
+
+//Solves until the deadline (a timer_microseconds value) has passed, at least MATE_CLOCK_NODES nodes
+//Returns true once the solve has finished and result holds what it found
+bool mate_step(MateSolver *solver, unsigned int deadline);
+
+//Solves until finished or a limit is reached
+void mate_run(MateSolver *solver);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
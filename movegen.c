@@ -0,0 +1,178 @@
+/*
+Move generation for the engine.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "geometry.h"
+#include "movegen.h"
+
+
+// Function prototypes for move generation helpers
+/////////////////////////////////////////////////////////////////////
+
+//Adds a move if the rules allow it, the end square must be on the board
+//Only captures are added if capturesOnly is true
+static int add_if_valid(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, bool capturesOnly, Move *moves, int count);
+
+//Adds the moves to every square of a target mask the rules allow
+static int add_targets(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int xCoord, int yCoord, uint64_t targets, bool capturesOnly, Move *moves, int count);
+
+//Adds the moves of the piece on a square
+static int add_piece_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int xCoord, int yCoord, bool capturesOnly, Move *moves, int count);
+
+//Adds the moves of every piece of the side to move
+static int add_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, bool capturesOnly, Move *moves);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for move generation
+/////////////////////////////////////////////////////////////////////
+
+//Writes every move the rules allow the side to move into moves, which holds MAX_MOVES
+//Returns the number of moves
+int generate_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Move *moves) {
+    return add_moves(board, currentTurn, false, moves);
+}
+
+//Writes the moves that capture a piece into moves
+//Returns the number of moves
+int generate_captures(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Move *moves) {
+    return add_moves(board, currentTurn, true, moves);
+}
+
+//Makes a move the same way move_piece does
+MoveUndo make_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move) {
+
+    PackedSquare *start = &board[MOVE_Y(move.start)][MOVE_X(move.start)];
+    PackedSquare *end = &board[MOVE_Y(move.end)][MOVE_X(move.end)];
+
+    MoveUndo undo = {*end};
+    *end = *start;
+    *start = PACKED_EMPTY;
+    return undo;
+}
+
+//Takes back a move made with make_move
+void unmake_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move, MoveUndo undo) {
+
+    PackedSquare *start = &board[MOVE_Y(move.start)][MOVE_X(move.start)];
+    PackedSquare *end = &board[MOVE_Y(move.end)][MOVE_X(move.end)];
+
+    *start = *end;
+    *end = undo.captured;
+}
+
+//Checks if a move captures a piece
+bool is_capture(PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move) {
+    return PACKED_PIECE_ID(board[MOVE_Y(move.end)][MOVE_X(move.end)]) != EMPTY_SQUARE;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for move generation helpers
+/////////////////////////////////////////////////////////////////////
+
+//Adds a move if the rules allow it, the end square must be on the board
+//Only captures are added if capturesOnly is true
+static int add_if_valid(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, bool capturesOnly, Move *moves, int count) {
+
+    if (capturesOnly && PACKED_PIECE_ID(board[yCoordEnd][xCoordEnd]) == EMPTY_SQUARE) {
+        return count;
+    }
+    if (!is_valid_move_without_check(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd, currentTurn)) {
+        return count;
+    }
+
+    //The move may not leave the king in check, tested on the board itself instead of a copy
+    Move move = {MOVE_SQUARE(xCoordStart, yCoordStart), MOVE_SQUARE(xCoordEnd, yCoordEnd)};
+    MoveUndo undo = make_move(board, move);
+    bool inCheck = is_in_check(board, currentTurn);
+    unmake_move(board, move, undo);
+
+    if (!inCheck) {
+        moves[count++] = move;
+    }
+    return count;
+}
+
+//Adds the moves to every square of a target mask the rules allow
+static int add_targets(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int xCoord, int yCoord, uint64_t targets, bool capturesOnly, Move *moves, int count) {
+
+    //Takes the squares lowest first, clearing each one once it is tried
+    while (targets != 0) {
+        int square = __builtin_ctzll(targets);
+        targets &= targets - 1;
+        count = add_if_valid(board, currentTurn, xCoord, yCoord, SQUARE_FILE(square), SQUARE_RANK(square), capturesOnly, moves, count);
+    }
+    return count;
+}
+
+//Adds the moves of the piece on a square
+static int add_piece_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int xCoord, int yCoord, bool capturesOnly, Move *moves, int count) {
+
+    int square = SQUARE_INDEX(xCoord, yCoord);
+
+    switch (PACKED_PIECE_ID(board[yCoord][xCoord])) {
+
+        case PAWN: {
+            //The pawn is the side to move's, so its colour indexes the tables
+            uint64_t targets = PAWN_CAPTURE_TARGETS[currentTurn][square];
+            if (!capturesOnly) {
+                targets |= PAWN_PUSH_TARGETS[currentTurn][square];
+            }
+            return add_targets(board, currentTurn, xCoord, yCoord, targets, capturesOnly, moves, count);
+        }
+
+        case KNIGHT:
+            return add_targets(board, currentTurn, xCoord, yCoord, KNIGHT_TARGETS[square], capturesOnly, moves, count);
+
+        case KING:
+            return add_targets(board, currentTurn, xCoord, yCoord, KING_TARGETS[square], capturesOnly, moves, count);
+
+        case BISHOP:
+        case ROOK:
+        case QUEEN: {
+            PieceIdx piece = PACKED_PIECE_ID(board[yCoord][xCoord]);
+            int firstDirection = piece == ROOK ? 4 : 0;
+            int lastDirection = piece == BISHOP ? 4 : 8;
+
+            //Slides until the edge or the first piece, which may be captured
+            for (int direction = firstDirection; direction < lastDirection; direction++) {
+                int xCoordEnd = xCoord + RAY_DIRECTIONS[direction][0];
+                int yCoordEnd = yCoord + RAY_DIRECTIONS[direction][1];
+                while (xCoordEnd >= 0 && xCoordEnd < BOARD_SIZE && yCoordEnd >= 0 && yCoordEnd < BOARD_SIZE) {
+                    count = add_if_valid(board, currentTurn, xCoord, yCoord, xCoordEnd, yCoordEnd, capturesOnly, moves, count);
+                    if (PACKED_PIECE_ID(board[yCoordEnd][xCoordEnd]) != EMPTY_SQUARE) {
+                        break;
+                    }
+                    xCoordEnd += RAY_DIRECTIONS[direction][0];
+                    yCoordEnd += RAY_DIRECTIONS[direction][1];
+                }
+            }
+            return count;
+        }
+
+        default:
+            return count;
+    }
+}
+
+//Adds the moves of every piece of the side to move
+static int add_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, bool capturesOnly, Move *moves) {
+
+    int count = 0;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            if (PACKED_PIECE_ID(board[yCoord][xCoord]) != EMPTY_SQUARE && PACKED_COLOUR(board[yCoord][xCoord]) == currentTurn) {
+                count = add_piece_moves(board, currentTurn, xCoord, yCoord, capturesOnly, moves, count);
+            }
+        }
+    }
+    return count;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+/*
+Move generation for the engine.
+
+The rules in chess.c answer whether one given move is allowed; an engine needs every
+move of a position, many thousands of times a second. generate_moves only tries the
+squares a piece could reach by its pattern (a knight's eight jumps, a rook's open files
+and ranks), and leaves the final word to is_valid_move_without_check and is_in_check,
+so it produces exactly the moves is_valid_move allows.
+
+Moves are made and taken back in place with make_move and unmake_move, which is much
+cheaper than copying the board.
+*/
+
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "chess.h"
+
+
+// Most moves a position can have
+#define MAX_MOVES 256
+
+// Squares are numbered yCoord * BOARD_SIZE + xCoord, as in game records
+#define MOVE_SQUARE(xCoord, yCoord) ((yCoord) * BOARD_SIZE + (xCoord))
+#define MOVE_X(square) ((square) % BOARD_SIZE)
+#define MOVE_Y(square) ((square) / BOARD_SIZE)
+
+
+//Move holds a move from a start square to an end square
+typedef struct Move
+{
+    unsigned char start;
+    unsigned char end;
+} Move;
+
+
+//MoveUndo holds what make_move changed, to take the move back
+typedef struct MoveUndo
+{
+    PackedSquare captured;
+} MoveUndo;
+
+
+// Function prototypes for move generation
+/////////////////////////////////////////////////////////////////////
+
+//Writes every move the rules allow the side to move into moves, which holds MAX_MOVES
+//Returns the number of moves
+int generate_moves(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Move *moves);
+
+//Writes the moves that capture a piece into moves
+//Returns the number of moves
+int generate_captures(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Move *moves);
+
+//Makes a move the same way move_piece does
+MoveUndo make_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move);
+
+//Takes back a move made with make_move
+void unmake_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move, MoveUndo undo);
+
+//Checks if a move captures a piece
+bool is_capture(PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
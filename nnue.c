@@ -0,0 +1,447 @@
+/*
+Efficiently updatable neural network (NNUE) evaluation for the engine.
+*/
+
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "nnue.h"
+
+
+// The SIMD kernels take 8 (NEON, SSE2) or 16 (AVX2) values at a time
+_Static_assert(NNUE_HIDDEN % 16 == 0, "the kernels need NNUE_HIDDEN to be a multiple of 16");
+
+// Sums of clipped values times int16 weights fit an int32, so no kernel can overflow
+_Static_assert((long long) NNUE_HIDDEN * 2 * NNUE_CLIP * 32768 < 2147483647LL, "the output layer sum may overflow");
+
+
+// Function prototypes for network helpers
+/////////////////////////////////////////////////////////////////////
+
+//Reads little endian values from a file, advancing the read position
+static int16_t read_int16(const unsigned char **bytes);
+static int32_t read_int32(const unsigned char **bytes);
+
+//Writes little endian values into a file, advancing the write position
+static void write_int16(unsigned char **bytes, int16_t value);
+static void write_int32(unsigned char **bytes, int32_t value);
+
+//Kernels in plain C, the reference the others must agree with
+//Not vectorized by the compiler either, so they measure what the SIMD kernels save
+static void scalar_add(int16_t *values, const int16_t *added);
+static void scalar_remove(int16_t *values, const int16_t *removed);
+static void scalar_move(int16_t *values, const int16_t *from, const int16_t *added, const int16_t *removed);
+static int32_t scalar_output(const int16_t *us, const int16_t *them, const int16_t *weights);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Kernels in plain C
+/////////////////////////////////////////////////////////////////////
+
+//Values are added in int and stored back as int16, which wraps around like the SIMD additions
+__attribute__((optimize("no-tree-vectorize")))
+static void scalar_add(int16_t *values, const int16_t *added) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        values[index] = (int16_t) (values[index] + added[index]);
+    }
+}
+
+__attribute__((optimize("no-tree-vectorize")))
+static void scalar_remove(int16_t *values, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        values[index] = (int16_t) (values[index] - removed[index]);
+    }
+}
+
+__attribute__((optimize("no-tree-vectorize")))
+static void scalar_move(int16_t *values, const int16_t *from, const int16_t *added, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        values[index] = (int16_t) (from[index] + added[index] - removed[index]);
+    }
+}
+
+__attribute__((optimize("no-tree-vectorize")))
+static int32_t scalar_output(const int16_t *us, const int16_t *them, const int16_t *weights) {
+
+    int32_t sum = 0;
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        int clipped = us[index] < 0 ? 0 : us[index] > NNUE_CLIP ? NNUE_CLIP : us[index];
+        sum += clipped * weights[index];
+    }
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        int clipped = them[index] < 0 ? 0 : them[index] > NNUE_CLIP ? NNUE_CLIP : them[index];
+        sum += clipped * weights[NNUE_HIDDEN + index];
+    }
+    return sum;
+}
+
+static const NnueKernels SCALAR_KERNELS = {"scalar", scalar_add, scalar_remove, scalar_move, scalar_output};
+
+/////////////////////////////////////////////////////////////////////
+
+
+#if defined(__ARM_NEON)
+
+// Kernels in ARM NEON, for the Cortex-A9 (build with -mfpu=neon)
+/////////////////////////////////////////////////////////////////////
+
+static void neon_add(int16_t *values, const int16_t *added) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        vst1q_s16(values + index, vaddq_s16(vld1q_s16(values + index), vld1q_s16(added + index)));
+    }
+}
+
+static void neon_remove(int16_t *values, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        vst1q_s16(values + index, vsubq_s16(vld1q_s16(values + index), vld1q_s16(removed + index)));
+    }
+}
+
+static void neon_move(int16_t *values, const int16_t *from, const int16_t *added, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        int16x8_t sum = vaddq_s16(vld1q_s16(from + index), vld1q_s16(added + index));
+        vst1q_s16(values + index, vsubq_s16(sum, vld1q_s16(removed + index)));
+    }
+}
+
+//Multiplies 8 clipped values by their weights into the four int32 sums
+static inline int32x4_t neon_clipped_dot(int32x4_t sum, const int16_t *values, const int16_t *weights) {
+
+    int16x8_t clipped = vminq_s16(vmaxq_s16(vld1q_s16(values), vdupq_n_s16(0)), vdupq_n_s16(NNUE_CLIP));
+    int16x8_t weight = vld1q_s16(weights);
+    sum = vmlal_s16(sum, vget_low_s16(clipped), vget_low_s16(weight));
+    return vmlal_s16(sum, vget_high_s16(clipped), vget_high_s16(weight));
+}
+
+static int32_t neon_output(const int16_t *us, const int16_t *them, const int16_t *weights) {
+
+    int32x4_t sum = vdupq_n_s32(0);
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        sum = neon_clipped_dot(sum, us + index, weights + index);
+    }
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        sum = neon_clipped_dot(sum, them + index, weights + NNUE_HIDDEN + index);
+    }
+
+    //ARMv7 has no across-vector add, the four sums are added pairwise
+    int32x2_t pairs = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+    return vget_lane_s32(vpadd_s32(pairs, pairs), 0);
+}
+
+static const NnueKernels NEON_KERNELS = {"neon", neon_add, neon_remove, neon_move, neon_output};
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Kernels in SSE2 and AVX2, for a host
+// Both are built whatever the -m flags, AVX2 is only picked if the processor has it
+/////////////////////////////////////////////////////////////////////
+
+__attribute__((target("sse2")))
+static void sse2_add(int16_t *values, const int16_t *added) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        __m128i sum = _mm_add_epi16(_mm_loadu_si128((const __m128i *) (values + index)), _mm_loadu_si128((const __m128i *) (added + index)));
+        _mm_storeu_si128((__m128i *) (values + index), sum);
+    }
+}
+
+__attribute__((target("sse2")))
+static void sse2_remove(int16_t *values, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        __m128i difference = _mm_sub_epi16(_mm_loadu_si128((const __m128i *) (values + index)), _mm_loadu_si128((const __m128i *) (removed + index)));
+        _mm_storeu_si128((__m128i *) (values + index), difference);
+    }
+}
+
+__attribute__((target("sse2")))
+static void sse2_move(int16_t *values, const int16_t *from, const int16_t *added, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        __m128i sum = _mm_add_epi16(_mm_loadu_si128((const __m128i *) (from + index)), _mm_loadu_si128((const __m128i *) (added + index)));
+        sum = _mm_sub_epi16(sum, _mm_loadu_si128((const __m128i *) (removed + index)));
+        _mm_storeu_si128((__m128i *) (values + index), sum);
+    }
+}
+
+//Multiplies 8 clipped values by their weights, _mm_madd_epi16 adds neighbouring products into four int32 sums
+__attribute__((target("sse2")))
+static inline __m128i sse2_clipped_dot(__m128i sum, const int16_t *values, const int16_t *weights) {
+
+    __m128i clipped = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i *) values), _mm_setzero_si128()), _mm_set1_epi16(NNUE_CLIP));
+    return _mm_add_epi32(sum, _mm_madd_epi16(clipped, _mm_loadu_si128((const __m128i *) weights)));
+}
+
+__attribute__((target("sse2")))
+static int32_t sse2_output(const int16_t *us, const int16_t *them, const int16_t *weights) {
+
+    __m128i sum = _mm_setzero_si128();
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        sum = sse2_clipped_dot(sum, us + index, weights + index);
+    }
+    for (int index = 0; index < NNUE_HIDDEN; index += 8) {
+        sum = sse2_clipped_dot(sum, them + index, weights + NNUE_HIDDEN + index);
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+static void avx2_add(int16_t *values, const int16_t *added) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 16) {
+        __m256i sum = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *) (values + index)), _mm256_loadu_si256((const __m256i *) (added + index)));
+        _mm256_storeu_si256((__m256i *) (values + index), sum);
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2_remove(int16_t *values, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 16) {
+        __m256i difference = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i *) (values + index)), _mm256_loadu_si256((const __m256i *) (removed + index)));
+        _mm256_storeu_si256((__m256i *) (values + index), difference);
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2_move(int16_t *values, const int16_t *from, const int16_t *added, const int16_t *removed) {
+
+    for (int index = 0; index < NNUE_HIDDEN; index += 16) {
+        __m256i sum = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *) (from + index)), _mm256_loadu_si256((const __m256i *) (added + index)));
+        sum = _mm256_sub_epi16(sum, _mm256_loadu_si256((const __m256i *) (removed + index)));
+        _mm256_storeu_si256((__m256i *) (values + index), sum);
+    }
+}
+
+//Multiplies 16 clipped values by their weights into eight int32 sums
+__attribute__((target("avx2")))
+static inline __m256i avx2_clipped_dot(__m256i sum, const int16_t *values, const int16_t *weights) {
+
+    __m256i clipped = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i *) values), _mm256_setzero_si256()), _mm256_set1_epi16(NNUE_CLIP));
+    return _mm256_add_epi32(sum, _mm256_madd_epi16(clipped, _mm256_loadu_si256((const __m256i *) weights)));
+}
+
+__attribute__((target("avx2")))
+static int32_t avx2_output(const int16_t *us, const int16_t *them, const int16_t *weights) {
+
+    __m256i sum = _mm256_setzero_si256();
+    for (int index = 0; index < NNUE_HIDDEN; index += 16) {
+        sum = avx2_clipped_dot(sum, us + index, weights + index);
+    }
+    for (int index = 0; index < NNUE_HIDDEN; index += 16) {
+        sum = avx2_clipped_dot(sum, them + index, weights + NNUE_HIDDEN + index);
+    }
+
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+
+static const NnueKernels SSE2_KERNELS = {"sse2", sse2_add, sse2_remove, sse2_move, sse2_output};
+static const NnueKernels AVX2_KERNELS = {"avx2", avx2_add, avx2_remove, avx2_move, avx2_output};
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
+
+
+// Function definitions for the network
+/////////////////////////////////////////////////////////////////////
+
+//Reads a network from the bytes of its file, and picks the fastest kernels for it
+//Returns false if the bytes are not a network of this version and size
+bool nnue_load(NnueNetwork *network, const unsigned char *bytes, int size) {
+
+    if (size != NNUE_FILE_SIZE || memcmp(bytes, "CHN", 3) != 0 || bytes[3] != NNUE_VERSION) {
+        return false;
+    }
+    const unsigned char *next = bytes + 4;
+    if (read_int16(&next) != NNUE_FEATURES || read_int16(&next) != NNUE_HIDDEN) {
+        return false;
+    }
+
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        network->featureBias[index] = read_int16(&next);
+    }
+    for (int feature = 0; feature < NNUE_FEATURES; feature++) {
+        for (int index = 0; index < NNUE_HIDDEN; index++) {
+            network->featureWeights[feature][index] = read_int16(&next);
+        }
+    }
+    for (int index = 0; index < NNUE_HIDDEN * 2; index++) {
+        network->outputWeights[index] = read_int16(&next);
+    }
+    network->outputBias = read_int32(&next);
+
+    network->kernels = nnue_kernel(nnue_kernel_count() - 1);
+    return true;
+}
+
+//Writes a network in its file format into bytes, which holds NNUE_FILE_SIZE
+void nnue_write(const NnueNetwork *network, unsigned char *bytes) {
+
+    memcpy(bytes, "CHN", 3);
+    bytes[3] = NNUE_VERSION;
+    unsigned char *next = bytes + 4;
+    write_int16(&next, NNUE_FEATURES);
+    write_int16(&next, NNUE_HIDDEN);
+
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        write_int16(&next, network->featureBias[index]);
+    }
+    for (int feature = 0; feature < NNUE_FEATURES; feature++) {
+        for (int index = 0; index < NNUE_HIDDEN; index++) {
+            write_int16(&next, network->featureWeights[feature][index]);
+        }
+    }
+    for (int index = 0; index < NNUE_HIDDEN * 2; index++) {
+        write_int16(&next, network->outputWeights[index]);
+    }
+    write_int32(&next, network->outputBias);
+}
+
+//Returns the number of kernel flavours this build and processor can run
+int nnue_kernel_count() {
+
+#if defined(__ARM_NEON)
+    return 2;
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_cpu_supports("avx2") ? 3 : __builtin_cpu_supports("sse2") ? 2 : 1;
+#else
+    return 1;
+#endif
+}
+
+//Returns a kernel flavour, 0 is plain C and the last is the fastest
+const NnueKernels * nnue_kernel(int index) {
+
+#if defined(__ARM_NEON)
+    static const NnueKernels *const KERNELS[] = {&SCALAR_KERNELS, &NEON_KERNELS};
+#elif defined(__x86_64__) || defined(__i386__)
+    static const NnueKernels *const KERNELS[] = {&SCALAR_KERNELS, &SSE2_KERNELS, &AVX2_KERNELS};
+#else
+    static const NnueKernels *const KERNELS[] = {&SCALAR_KERNELS};
+#endif
+
+    return index >= 0 && index < nnue_kernel_count() ? KERNELS[index] : NULL;
+}
+
+//Returns the feature of a piece on a square, seen from the side of perspective
+//Black sees the board upside down, so both sides see their own pieces start on the last two ranks
+int nnue_feature(int perspective, Piece piece, int xCoord, int yCoord) {
+
+    int theirs = piece.colour == perspective ? 0 : 1;
+    int rank = perspective == WHITE_PIECE ? yCoord : BOARD_SIZE - 1 - yCoord;
+    return ((theirs * KING + piece.piece_ID - 1) * BOARD_SIZE + rank) * BOARD_SIZE + xCoord;
+}
+
+//Fills an accumulator from every piece on the board
+void nnue_refresh(const NnueNetwork *network, PackedSquare board[BOARD_SIZE][BOARD_SIZE], NnueAccumulator *accumulator) {
+
+    for (int perspective = 0; perspective < 2; perspective++) {
+
+        memcpy(accumulator->values[perspective], network->featureBias, sizeof(network->featureBias));
+        for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+            for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+                Piece piece = unpack_piece(board[yCoord][xCoord]);
+                if (piece.piece_ID != EMPTY_SQUARE) {
+                    network->kernels->add(accumulator->values[perspective],
+                                          network->featureWeights[nnue_feature(perspective, piece, xCoord, yCoord)]);
+                }
+            }
+        }
+    }
+}
+
+//Fills next with the accumulator after a move, from the one before it
+//Call it before the move is made, the board tells which piece moves and which is captured
+void nnue_update(const NnueNetwork *network, const NnueAccumulator *accumulator, NnueAccumulator *next,
+                 PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move) {
+
+    int xCoordStart = MOVE_X(move.start);
+    int yCoordStart = MOVE_Y(move.start);
+    int xCoordEnd = MOVE_X(move.end);
+    int yCoordEnd = MOVE_Y(move.end);
+    Piece moved = unpack_piece(board[yCoordStart][xCoordStart]);
+    Piece captured = unpack_piece(board[yCoordEnd][xCoordEnd]);
+
+    for (int perspective = 0; perspective < 2; perspective++) {
+
+        //The moving piece leaves one feature for another, a captured piece's feature is removed
+        network->kernels->move(next->values[perspective], accumulator->values[perspective],
+                               network->featureWeights[nnue_feature(perspective, moved, xCoordEnd, yCoordEnd)],
+                               network->featureWeights[nnue_feature(perspective, moved, xCoordStart, yCoordStart)]);
+        if (captured.piece_ID != EMPTY_SQUARE) {
+            network->kernels->remove(next->values[perspective],
+                                     network->featureWeights[nnue_feature(perspective, captured, xCoordEnd, yCoordEnd)]);
+        }
+    }
+}
+
+//Returns the score of a position for the side to move, in centipawns
+int nnue_evaluate(const NnueNetwork *network, const NnueAccumulator *accumulator, int currentTurn) {
+
+    int32_t sum = network->kernels->output(accumulator->values[currentTurn], accumulator->values[1 - currentTurn], network->outputWeights);
+    return (int) (((long long) sum + network->outputBias) / NNUE_OUTPUT_SCALE);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for network helpers
+/////////////////////////////////////////////////////////////////////
+
+//Reads little endian values from a file, advancing the read position
+static int16_t read_int16(const unsigned char **bytes) {
+
+    uint16_t value = (uint16_t) ((*bytes)[0] | (*bytes)[1] << 8);
+    *bytes += 2;
+    return (int16_t) value;
+}
+
+static int32_t read_int32(const unsigned char **bytes) {
+
+    uint32_t value = (uint32_t) (*bytes)[0] | (uint32_t) (*bytes)[1] << 8 | (uint32_t) (*bytes)[2] << 16 | (uint32_t) (*bytes)[3] << 24;
+    *bytes += 4;
+    return (int32_t) value;
+}
+
+//Writes little endian values into a file, advancing the write position
+static void write_int16(unsigned char **bytes, int16_t value) {
+
+    (*bytes)[0] = (unsigned char) ((uint16_t) value & 0xff);
+    (*bytes)[1] = (unsigned char) ((uint16_t) value >> 8);
+    *bytes += 2;
+}
+
+static void write_int32(unsigned char **bytes, int32_t value) {
+
+    for (int index = 0; index < 4; index++) {
+        (*bytes)[index] = (unsigned char) ((uint32_t) value >> (8 * index));
+    }
+    *bytes += 4;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,142 @@
+/*
+Efficiently updatable neural network (NNUE) evaluation for the engine.
+
+A small network scores a position from the pieces on their squares. Every (colour, piece,
+square) seen from one side is a feature, NNUE_FEATURES of them, and the first layer sums
+the int16 weights of the features present into an accumulator of NNUE_HIDDEN values, one
+accumulator from white's side of the board and one from black's. A move only adds and
+removes a few features, so the search updates the accumulator of a position from the one
+before the move instead of summing every piece again. The output layer clips both
+accumulators to 0..NNUE_CLIP, side to move first, and takes their dot product with the
+output weights:
+
+  score = (sum of clip(accumulator) * output weight + output bias) / NNUE_OUTPUT_SCALE
+
+The additions and the dot product run in one of several kernels: ARM NEON on the
+Cortex-A9, SSE2 and AVX2 on an x86 host, and plain C everywhere. Integer arithmetic gives
+the same result in every kernel, bit for bit (bench/nnue_bench.c checks it), so a network
+plays the same on the board as on the host. Accumulators wrap around like int16 in every
+kernel, and with clipped values the dot product can not overflow.
+
+A network is stored little endian in a compact file:
+
+  header          8 bytes  'C' 'H' 'N' NNUE_VERSION, NNUE_FEATURES, NNUE_HIDDEN (16 bits each)
+  feature bias    int16 * NNUE_HIDDEN
+  feature weights int16 * NNUE_FEATURES * NNUE_HIDDEN, NNUE_HIDDEN per feature
+  output weights  int16 * NNUE_HIDDEN * 2, side to move first
+  output bias     int32
+
+nnue_load reads it from memory, nnue_host.c from a file on a Linux host.
+*/
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "chess.h"
+#include "movegen.h"
+
+
+// Version of the file format
+#define NNUE_VERSION 1
+
+// Features, two colours of six pieces on 64 squares, and the accumulator size
+#define NNUE_FEATURES (2 * KING * BOARD_SIZE * BOARD_SIZE)
+#define NNUE_HIDDEN   128
+
+// Accumulator values are clipped to 0..NNUE_CLIP before the output layer
+#define NNUE_CLIP 127
+
+// Output layer sums are divided by this to give centipawns
+#define NNUE_OUTPUT_SCALE 64
+
+// Size of a network file, in bytes
+#define NNUE_HEADER_SIZE 8
+#define NNUE_FILE_SIZE (NNUE_HEADER_SIZE + (NNUE_HIDDEN + NNUE_FEATURES * NNUE_HIDDEN + NNUE_HIDDEN * 2) * 2 + 4)
+
+
+//NnueKernels holds one flavour of the loops the network runs in
+typedef struct NnueKernels
+{
+    const char *name;
+
+    //values += added and values -= removed, NNUE_HIDDEN values
+    void (*add)(int16_t *values, const int16_t *added);
+    void (*remove)(int16_t *values, const int16_t *removed);
+
+    //values = from + added - removed, a piece moving in one pass
+    void (*move)(int16_t *values, const int16_t *from, const int16_t *added, const int16_t *removed);
+
+    //Returns the dot product of the clipped accumulators, us then them, with the output weights
+    int32_t (*output)(const int16_t *us, const int16_t *them, const int16_t *weights);
+} NnueKernels;
+
+
+//NnueNetwork holds the weights of a network and the kernels it runs in
+typedef struct NnueNetwork
+{
+    int16_t featureBias[NNUE_HIDDEN] __attribute__((aligned(32)));
+    int16_t featureWeights[NNUE_FEATURES][NNUE_HIDDEN] __attribute__((aligned(32)));
+    int16_t outputWeights[NNUE_HIDDEN * 2] __attribute__((aligned(32)));
+    int32_t outputBias;
+
+    const NnueKernels *kernels;
+} NnueNetwork;
+
+
+//NnueAccumulator holds the first layer of a position, indexed by the side it is seen from
+typedef struct NnueAccumulator
+{
+    int16_t values[2][NNUE_HIDDEN] __attribute__((aligned(32)));
+} NnueAccumulator;
+
+
+// Function prototypes for the network
+/////////////////////////////////////////////////////////////////////
+
+//Reads a network from the bytes of its file, and picks the fastest kernels for it
+//Returns false if the bytes are not a network of this version and size
+bool nnue_load(NnueNetwork *network, const unsigned char *bytes, int size);
+
+//Writes a network in its file format into bytes, which holds NNUE_FILE_SIZE
+void nnue_write(const NnueNetwork *network, unsigned char *bytes);
+
+//Returns the number of kernel flavours this build and processor can run
+int nnue_kernel_count();
+
+//Returns a kernel flavour, 0 is plain C and the last is the fastest
+const NnueKernels * nnue_kernel(int index);
+
+//Returns the feature of a piece on a square, seen from the side of perspective
+int nnue_feature(int perspective, Piece piece, int xCoord, int yCoord);
+
+//Fills an accumulator from every piece on the board
+void nnue_refresh(const NnueNetwork *network, PackedSquare board[BOARD_SIZE][BOARD_SIZE], NnueAccumulator *accumulator);
+
+//Fills next with the accumulator after a move, from the one before it
+//Call it before the move is made, the board tells which piece moves and which is captured
+void nnue_update(const NnueNetwork *network, const NnueAccumulator *accumulator, NnueAccumulator *next,
+                 PackedSquare board[BOARD_SIZE][BOARD_SIZE], Move move);
+
+//Returns the score of a position for the side to move, in centipawns
+int nnue_evaluate(const NnueNetwork *network, const NnueAccumulator *accumulator, int currentTurn);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host backend (nnue_host.c)
+/////////////////////////////////////////////////////////////////////
+
+//Loads a network from a file
+//Returns false if the file can not be read or is not a network
+bool nnue_host_load(NnueNetwork *network, const char *path);
+
+//Saves a network to a file
+//Returns false if the file can not be written
+bool nnue_host_save(const NnueNetwork *network, const char *path);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
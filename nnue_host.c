@@ -0,0 +1,53 @@
+/*
+Loads and saves network files on a Linux host.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nnue.h"
+
+
+// Function definitions only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Loads a network from a file
+//Returns false if the file can not be read or is not a network
+bool nnue_host_load(NnueNetwork *network, const char *path) {
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    //One byte more than a network, so a longer file is not taken for one
+    unsigned char *bytes = malloc(NNUE_FILE_SIZE + 1);
+    int size = bytes != NULL ? (int) fread(bytes, 1, NNUE_FILE_SIZE + 1, file) : 0;
+    fclose(file);
+
+    bool loaded = bytes != NULL && nnue_load(network, bytes, size);
+    free(bytes);
+    return loaded;
+}
+
+//Saves a network to a file
+//Returns false if the file can not be written
+bool nnue_host_save(const NnueNetwork *network, const char *path) {
+
+    unsigned char *bytes = malloc(NNUE_FILE_SIZE);
+    if (bytes == NULL) {
+        return false;
+    }
+    nnue_write(network, bytes);
+
+    FILE *file = fopen(path, "wb");
+    bool saved = file != NULL && fwrite(bytes, 1, NNUE_FILE_SIZE, file) == NNUE_FILE_SIZE;
+    if (file != NULL && fclose(file) != 0) {
+        saved = false;
+    }
+
+    free(bytes);
+    return saved;
+}
+
+/////////////////////////////////////////////////////////////////////
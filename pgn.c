@@ -0,0 +1,344 @@
+/*
+Reader for Portable Game Notation (PGN) files.
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "pgn.h"
+
+
+// Function prototypes for PGN reader helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if a character separates tokens in the moves
+static bool is_separator(char character);
+
+//Checks if position is at the start of a line
+static bool at_line_start(const PgnReader *reader, const char *position);
+
+//Returns the character after the end of the line position is on
+static const char * skip_line(const char *position, const char *end);
+
+//Returns the character after a comment or variation, nested variations included
+static const char * skip_block(const char *position, const char *end);
+
+//Checks if a token is a game result
+static bool is_result(PgnSlice token);
+
+//Checks if a line starts with a tag pair, [Name "
+static bool is_tag_line(const char *position, const char *end);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the PGN reader
+/////////////////////////////////////////////////////////////////////
+
+//Starts reading the text from start up to end
+void pgn_reader_init(PgnReader *reader, const char *start, const char *end) {
+
+    reader->next = start;
+    reader->end = end;
+    reader->inMoves = false;
+    memset(&reader->game, 0, sizeof(reader->game));
+}
+
+//Reads the tags of the next game, skipping whatever is left of the moves of the last one
+//Returns NULL once there are no more games
+const PgnGame * pgn_next_game(PgnReader *reader) {
+
+    PgnSlice move;
+    while (reader->inMoves && pgn_next_move(reader, &move));
+
+    const char *position = reader->next;
+    const char *end = reader->end;
+
+    //Blank lines and anything before the first tag, such as a byte order mark
+    while (position < end && (*position == ' ' || *position == '\t' || *position == '\r' || *position == '\n')) {
+        position++;
+    }
+    if (position >= end) {
+        reader->next = end;
+        return NULL;
+    }
+
+    PgnGame *game = &reader->game;
+    game->start = position;
+    game->tags.text = position;
+    game->result.text = NULL;
+    game->result.length = 0;
+
+    //Tag lines, one tag per line
+    while (position < end && *position == '[') {
+        position = skip_line(position, end);
+        while (position < end && (*position == ' ' || *position == '\t' || *position == '\r' || *position == '\n')) {
+            position++;
+        }
+    }
+    game->tags.length = (int) (position - game->tags.text);
+
+    reader->next = position;
+    reader->inMoves = true;
+    return game;
+}
+
+//Reads the next move of the game as SAN text
+//Returns false once the game has no more moves, game.result then holds the result
+bool pgn_next_move(PgnReader *reader, PgnSlice *move) {
+
+    const char *position = reader->next;
+    const char *end = reader->end;
+
+    while (reader->inMoves) {
+
+        if (position >= end) {
+            break;
+        }
+
+        char character = *position;
+
+        //Whitespace and the dots of move numbers
+        if (character == ' ' || character == '\t' || character == '\r' || character == '\n' || character == '.') {
+            position++;
+            continue;
+        }
+
+        //A tag at the start of a line begins the next game, this one had no result
+        if (character == '[' && at_line_start(reader, position)) {
+            break;
+        }
+
+        //Comments, variations and escaped lines
+        if (character == '{' || character == '(') {
+            position = skip_block(position, end);
+            continue;
+        }
+        if (character == ';' || (character == '%' && at_line_start(reader, position))) {
+            position = skip_line(position, end);
+            continue;
+        }
+
+        //The token runs up to the next separator
+        const char *tokenEnd = position;
+        while (tokenEnd < end && !is_separator(*tokenEnd)) {
+            tokenEnd++;
+        }
+        if (tokenEnd == position) {
+            //A separator that starts nothing, such as a stray ')'
+            position++;
+            continue;
+        }
+
+        PgnSlice token = {position, (int) (tokenEnd - position)};
+        position = tokenEnd;
+
+        //Annotation glyphs
+        if (token.text[0] == '$') {
+            continue;
+        }
+
+        if (is_result(token)) {
+            reader->game.result = token;
+            reader->inMoves = false;
+            break;
+        }
+
+        //Move numbers, which may have the move glued to them: 12.e4 or 12...e5
+        const char *moveText = token.text;
+        const char *tokenLast = token.text + token.length;
+        const char *digits = moveText;
+        while (digits < tokenLast && *digits >= '0' && *digits <= '9') {
+            digits++;
+        }
+        if (digits > moveText && digits < tokenLast && *digits == '.') {
+            while (digits < tokenLast && *digits == '.') {
+                digits++;
+            }
+            moveText = digits;
+        } else if (digits == tokenLast) {
+            continue;
+        }
+        if (moveText == tokenLast) {
+            continue;
+        }
+
+        move->text = moveText;
+        move->length = (int) (tokenLast - moveText);
+        reader->next = position;
+        return true;
+    }
+
+    reader->next = position;
+    reader->inMoves = false;
+    return false;
+}
+
+//Finds the value of a tag of a game, without its quotes
+//Returns false if the game has no such tag
+bool pgn_tag(const PgnGame *game, const char *name, PgnSlice *value) {
+
+    int nameLength = (int) strlen(name);
+    const char *position = game->tags.text;
+    const char *end = game->tags.text + game->tags.length;
+
+    while (position < end) {
+
+        //[Name "value"]
+        if (*position == '[' && end - position > nameLength + 2
+            && memcmp(position + 1, name, nameLength) == 0 && position[nameLength + 1] == ' ') {
+
+            const char *quote = memchr(position, '"', end - position);
+            if (quote == NULL) {
+                return false;
+            }
+
+            //The value ends at a quote that is not escaped
+            const char *valueEnd = quote + 1;
+            while (valueEnd < end && *valueEnd != '"') {
+                valueEnd += *valueEnd == '\\' ? 2 : 1;
+            }
+            if (valueEnd >= end) {
+                return false;
+            }
+
+            value->text = quote + 1;
+            value->length = (int) (valueEnd - value->text);
+            return true;
+        }
+
+        position = skip_line(position, end);
+    }
+
+    return false;
+}
+
+//Returns the start of the first game at or after position, or end if there is none
+//A game starts at a tag line, [Name "value"], that does not follow another tag line
+//A comment in the moves can hold such a line too, but a game rarely does
+const char * pgn_sync(const char *start, const char *position, const char *end) {
+
+    //Moves to the start of a line
+    if (position > start && position[-1] != '\n') {
+        position = skip_line(position, end);
+    }
+
+    bool previousLineIsTag = false;
+    if (position > start) {
+        const char *previousLine = position - 1;
+        while (previousLine > start && previousLine[-1] != '\n') {
+            previousLine--;
+        }
+        previousLineIsTag = is_tag_line(previousLine, end);
+    }
+
+    while (position < end) {
+
+        bool lineIsTag = is_tag_line(position, end);
+        if (lineIsTag && !previousLineIsTag) {
+            return position;
+        }
+
+        //Blank lines do not separate the tags of one game
+        bool blank = *position == '\n' || *position == '\r';
+        if (!blank) {
+            previousLineIsTag = lineIsTag;
+        }
+        position = skip_line(position, end);
+    }
+
+    return end;
+}
+
+//Checks if a slice holds exactly the text
+bool pgn_slice_equals(PgnSlice slice, const char *text) {
+    return (int) strlen(text) == slice.length && memcmp(slice.text, text, slice.length) == 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for PGN reader helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if a character separates tokens in the moves
+static bool is_separator(char character) {
+
+    switch (character) {
+        case ' ': case '\t': case '\r': case '\n':
+        case '{': case '}': case '(': case ')': case ';': case '[': case ']':
+            return true;
+        default:
+            return false;
+    }
+}
+
+//Checks if position is at the start of a line
+static bool at_line_start(const PgnReader *reader, const char *position) {
+    return position == reader->game.start || position[-1] == '\n';
+}
+
+//Returns the character after the end of the line position is on
+static const char * skip_line(const char *position, const char *end) {
+
+    const char *newline = memchr(position, '\n', end - position);
+    return newline != NULL ? newline + 1 : end;
+}
+
+//Returns the character after a comment or variation, nested variations included
+static const char * skip_block(const char *position, const char *end) {
+
+    //Comments end at the first brace, nothing nests inside them
+    if (*position == '{') {
+        const char *close = memchr(position, '}', end - position);
+        return close != NULL ? close + 1 : end;
+    }
+
+    int depth = 0;
+    while (position < end) {
+
+        char character = *position;
+        if (character == '{') {
+            position = skip_block(position, end);
+            continue;
+        }
+        if (character == ';') {
+            position = skip_line(position, end);
+            continue;
+        }
+
+        position++;
+        if (character == '(') {
+            depth++;
+        } else if (character == ')' && --depth == 0) {
+            break;
+        }
+    }
+
+    return position;
+}
+
+//Checks if a token is a game result
+static bool is_result(PgnSlice token) {
+
+    return pgn_slice_equals(token, "1-0") || pgn_slice_equals(token, "0-1")
+        || pgn_slice_equals(token, "1/2-1/2") || pgn_slice_equals(token, "*");
+}
+
+//Checks if a line starts with a tag pair, [Name "
+static bool is_tag_line(const char *position, const char *end) {
+
+    if (position >= end || *position++ != '[') {
+        return false;
+    }
+
+    const char *name = position;
+    while (position < end && ((*position >= 'A' && *position <= 'Z') || (*position >= 'a' && *position <= 'z')
+        || (*position >= '0' && *position <= '9') || *position == '_')) {
+        position++;
+    }
+
+    return position > name && end - position >= 2 && position[0] == ' ' && position[1] == '"';
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,81 @@
+/*
+Reader for Portable Game Notation (PGN) files.
+
+The reader never copies or allocates: games, tags and moves are handed out as slices of
+the text they were read from, which can be a whole file mapped into memory. A game is
+read in one pass, first its tags with pgn_next_game and then its moves with
+pgn_next_move; comments, variations, move numbers and annotation glyphs are skipped.
+
+pgn_sync finds where a game starts from any point in the text, so a large file can be
+cut into pieces that are read independently, for example by several threads.
+*/
+
+#ifndef PGN_H
+#define PGN_H
+
+#include <stdbool.h>
+
+
+//PgnSlice holds a piece of the text, it is not terminated
+typedef struct PgnSlice
+{
+    const char *text;
+    int length;
+} PgnSlice;
+
+
+//PgnGame holds the parts of the game being read
+typedef struct PgnGame
+{
+    //First character of the game
+    const char *start;
+
+    //The tag section, [Name "value"] pairs
+    PgnSlice tags;
+
+    //The result ending the moves: 1-0, 0-1, 1/2-1/2 or *
+    //Set once pgn_next_move has returned every move, empty if the game has none
+    PgnSlice result;
+} PgnGame;
+
+
+//PgnReader holds the position of the reader in the text
+typedef struct PgnReader
+{
+    const char *next;
+    const char *end;
+
+    //The game being read, and if its moves are still being read
+    PgnGame game;
+    bool inMoves;
+} PgnReader;
+
+
+// Function prototypes for the PGN reader
+/////////////////////////////////////////////////////////////////////
+
+//Starts reading the text from start up to end
+void pgn_reader_init(PgnReader *reader, const char *start, const char *end);
+
+//Reads the tags of the next game, skipping whatever is left of the moves of the last one
+//Returns NULL once there are no more games
+const PgnGame * pgn_next_game(PgnReader *reader);
+
+//Reads the next move of the game as SAN text
+//Returns false once the game has no more moves, game.result then holds the result
+bool pgn_next_move(PgnReader *reader, PgnSlice *move);
+
+//Finds the value of a tag of a game, without its quotes
+//Returns false if the game has no such tag
+bool pgn_tag(const PgnGame *game, const char *name, PgnSlice *value);
+
+//Returns the start of the first game at or after position, or end if there is none
+//A game starts at a tag line, [Name "value"], that does not follow another tag line
+const char * pgn_sync(const char *start, const char *position, const char *end);
+
+//Checks if a slice holds exactly the text
+bool pgn_slice_equals(PgnSlice slice, const char *text);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
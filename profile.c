@@ -0,0 +1,170 @@
+/*
+Hot path profiler with fixed zones.
+*/
+
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include <stdio.h>
+
+#include "framebuffer.h"
+
+
+// Width of a line of the table, in characters
+#define PROFILE_LINE_WIDTH 60
+
+
+//Measurements of every zone, the names are in the order of ProfileZone
+static ProfileZoneStats zoneStats[PROFILE_ZONE_COUNT] = {
+    {"draw_board"},
+    {"draw_squares"},
+    {"draw_pieces"},
+    {"wait_for_vsync"},
+    {"is_valid_move"},
+    {"is_in_check"},
+    {"is_checkmate"},
+};
+
+
+// Function prototypes for profiler helpers
+/////////////////////////////////////////////////////////////////////
+
+//Formats the header of the table
+static void format_header(char *line, int size);
+
+//Formats the line of the table for a zone, times are in microseconds
+static void format_zone(char *line, int size, ProfileZone zone);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the profiler
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock and clears every zone
+void profile_init() {
+
+    profile_clock_init();
+    profile_reset();
+}
+
+//Clears every zone
+void profile_reset() {
+
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        zoneStats[zone].calls = 0;
+        zoneStats[zone].totalTicks = 0;
+        zoneStats[zone].minTicks = 0xFFFFFFFF;
+        zoneStats[zone].maxTicks = 0;
+    }
+}
+
+//Returns the measurements of a zone
+const ProfileZoneStats * profile_zone_stats(ProfileZone zone) {
+    return &zoneStats[zone];
+}
+
+//Writes the table of zones into the character buffer with its left top corner at column, row
+void profile_show(int column, int row) {
+
+    char line[PROFILE_LINE_WIDTH + 1];
+
+    for (int tableRow = 0; tableRow <= PROFILE_ZONE_COUNT; tableRow++) {
+
+        if (tableRow == 0) {
+            format_header(line, sizeof(line));
+        } else {
+            format_zone(line, sizeof(line), tableRow - 1);
+        }
+
+        //Pads the line with blanks so a shorter number does not leave old digits behind
+        int length = 0;
+        while (line[length] != '\0') length++;
+        for (int character = 0; character < PROFILE_LINE_WIDTH; character++) {
+            framebuffer_put_char(column + character, row + tableRow, character < length ? line[character] : ' ');
+        }
+    }
+}
+
+//Blanks the area profile_show writes to
+void profile_hide(int column, int row) {
+
+    for (int tableRow = 0; tableRow <= PROFILE_ZONE_COUNT; tableRow++) {
+        for (int character = 0; character < PROFILE_LINE_WIDTH; character++) {
+            framebuffer_put_char(column + character, row + tableRow, ' ');
+        }
+    }
+}
+
+//Writes the table of zones to the backend output (JTAG UART or stdout)
+void profile_dump() {
+
+    char line[PROFILE_LINE_WIDTH + 2];
+
+    format_header(line, sizeof(line));
+    profile_write_text(line);
+    profile_write_text("\n");
+
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        format_zone(line, sizeof(line), zone);
+        profile_write_text(line);
+        profile_write_text("\n");
+    }
+}
+
+//Starts measuring a zone, used by PROFILE_SCOPE
+ProfileScope profile_scope_begin(ProfileZone zone) {
+
+    ProfileScope scope = {zone, profile_clock_ticks()};
+    return scope;
+}
+
+//Ends a measurement, used by PROFILE_SCOPE
+void profile_scope_end(ProfileScope *scope) {
+
+    unsigned int ticks = profile_clock_ticks() - scope->startTicks;
+    ProfileZoneStats *stats = &zoneStats[scope->zone];
+
+    stats->calls++;
+    stats->totalTicks += ticks;
+    if (ticks < stats->minTicks) stats->minTicks = ticks;
+    if (ticks > stats->maxTicks) stats->maxTicks = ticks;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for profiler helpers
+/////////////////////////////////////////////////////////////////////
+
+//Formats the header of the table
+static void format_header(char *line, int size) {
+    snprintf(line, size, "%-15s %9s %10s %7s %7s %7s", "zone", "calls", "total us", "min us", "avg us", "max us");
+}
+
+//Formats the line of the table for a zone, times are in microseconds
+//min, avg and max have one decimal since the checks take well under a microsecond on a host
+static void format_zone(char *line, int size, ProfileZone zone) {
+
+    const ProfileZoneStats *stats = &zoneStats[zone];
+    unsigned long long ticksPerMicrosecond = profile_clock_ticks_per_microsecond();
+
+    //A zone that never ran has no minimum
+    if (stats->calls == 0) {
+        snprintf(line, size, "%-15s %9u %10u %7s %7s %7s", stats->name, 0u, 0u, "-", "-", "-");
+        return;
+    }
+
+    //Times in tenths of a microsecond
+    unsigned long long minTenths = stats->minTicks * 10ULL / ticksPerMicrosecond;
+    unsigned long long avgTenths = stats->totalTicks * 10 / ticksPerMicrosecond / stats->calls;
+    unsigned long long maxTenths = stats->maxTicks * 10ULL / ticksPerMicrosecond;
+
+    snprintf(line, size, "%-15s %9u %10llu %5llu.%llu %5llu.%llu %5llu.%llu", stats->name, stats->calls,
+        stats->totalTicks / ticksPerMicrosecond, minTenths / 10, minTenths % 10, avgTenths / 10, avgTenths % 10, maxTenths / 10, maxTenths % 10);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,118 @@
+/*
+Hot path profiler with fixed zones.
+
+A zone measures the time from PROFILE_SCOPE to the end of the enclosing block, however
+the block is left, and keeps the number of calls and the total, shortest and longest
+time in a fixed table. Zones nest, so a zone includes the time of the zones it calls.
+
+Two clock backends, link exactly one of them together with profile.c:
+  profile_mmio.c  - ARM Cortex-A9 PMU cycle counter, or with PROFILE_CLOCK_TIMER the
+                    microsecond clock on the second interval timer (see timer.h);
+                    the table is dumped over the JTAG UART
+  profile_host.c  - clock_gettime on a Linux host, the table is dumped on stdout
+
+Profiling only exists in builds with PROFILE defined (-DPROFILE). In every other build
+PROFILE_SCOPE expands to nothing and profile.c and both backends compile to empty files,
+so release builds carry no code or data for it.
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+
+//ProfileZone lists the measured zones
+typedef enum ProfileZone
+{
+    PROFILE_DRAW_BOARD,
+    PROFILE_DRAW_SQUARES,
+    PROFILE_DRAW_PIECES,
+    PROFILE_WAIT_FOR_VSYNC,
+    PROFILE_IS_VALID_MOVE,
+    PROFILE_IS_IN_CHECK,
+    PROFILE_IS_CHECKMATE,
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+
+#ifdef PROFILE
+
+//Measures the rest of the enclosing block as zone
+//The cleanup attribute ends the measurement on every return out of the block
+#define PROFILE_SCOPE(zone) \
+    ProfileScope profileScope __attribute__((cleanup(profile_scope_end))) = profile_scope_begin(zone)
+
+
+//ProfileScope holds a measurement that is in progress
+typedef struct ProfileScope
+{
+    ProfileZone zone;
+    unsigned int startTicks;
+} ProfileScope;
+
+
+//ProfileZoneStats holds the measurements of one zone, in clock ticks
+typedef struct ProfileZoneStats
+{
+    const char *name;
+    unsigned int calls;
+    unsigned long long totalTicks;
+    unsigned int minTicks;
+    unsigned int maxTicks;
+} ProfileZoneStats;
+
+
+// Function prototypes for the profiler
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock and clears every zone
+void profile_init();
+
+//Clears every zone
+void profile_reset();
+
+//Returns the measurements of a zone
+const ProfileZoneStats * profile_zone_stats(ProfileZone zone);
+
+//Writes the table of zones into the character buffer with its left top corner at column, row
+//The table is PROFILE_ZONE_COUNT + 1 rows high and 60 columns wide
+void profile_show(int column, int row);
+
+//Blanks the area profile_show writes to
+void profile_hide(int column, int row);
+
+//Writes the table of zones to the backend output (JTAG UART or stdout)
+void profile_dump();
+
+//Starts measuring a zone, used by PROFILE_SCOPE
+ProfileScope profile_scope_begin(ProfileZone zone);
+
+//Ends a measurement, used by PROFILE_SCOPE
+void profile_scope_end(ProfileScope *scope);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for the profiler clock backends
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock
+void profile_clock_init();
+
+//Returns the clock, it wraps around so only differences are meaningful
+unsigned int profile_clock_ticks();
+
+//Returns the number of clock ticks per microsecond
+unsigned int profile_clock_ticks_per_microsecond();
+
+//Writes text to the backend output
+void profile_write_text(const char *text);
+
+/////////////////////////////////////////////////////////////////////
+
+#else
+
+#define PROFILE_SCOPE(zone)
+
+#endif
+
+#endif
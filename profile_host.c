@@ -0,0 +1,40 @@
+/*
+Profiler clock on a Linux host, the table is dumped on stdout.
+*/
+
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include <stdio.h>
+#include <time.h>
+
+
+// Function definitions for the profiler clock
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock
+void profile_clock_init() {
+}
+
+//Returns the clock in nanoseconds, it wraps around so only differences are meaningful
+unsigned int profile_clock_ticks() {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned int) (now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+//Returns the number of clock ticks per microsecond
+unsigned int profile_clock_ticks_per_microsecond() {
+    return 1000;
+}
+
+//Writes text to stdout
+void profile_write_text(const char *text) {
+    fputs(text, stdout);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
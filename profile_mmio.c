@@ -0,0 +1,77 @@
+/*
+Profiler clock on the DE1-SoC.
+
+The Cortex-A9 performance monitor unit has a 32-bit cycle counter that counts CPU
+cycles (800 MHz on the DE1-SoC) and is read with a single coprocessor instruction.
+Building with PROFILE_CLOCK_TIMER uses the microsecond clock on the second interval
+timer instead (timer.h), for setups where the PMU is not available. The first interval
+timer (TIMER_BASE) raises the switch sampling interrupt and can not be used as a clock.
+
+The table is dumped over the JTAG UART, which the Monitor Program shows in its terminal.
+*/
+
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include "jtag_uart.h"
+#include "timer.h"
+
+
+// Cortex-A9 clock frequency in cycles per microsecond
+#define CPU_CYCLES_PER_MICROSECOND 800
+
+// Bits of the PMU control register and of the counter enable register
+#define PMU_ENABLE             0x1
+#define PMU_RESET_CYCLES       0x4
+#define PMU_CYCLE_COUNTER      0x80000000
+
+
+// Function definitions for the profiler clock
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock
+void profile_clock_init() {
+
+#ifdef PROFILE_CLOCK_TIMER
+    //The interval timer is started by timer_init
+#else
+    //Enables the counters (PMCR) with the cycle counter reset, then enables the cycle counter (PMCNTENSET)
+    unsigned int control = PMU_ENABLE | PMU_RESET_CYCLES;
+    unsigned int counters = PMU_CYCLE_COUNTER;
+    __asm__ volatile ("mcr p15, 0, %0, c9, c12, 0" : : "r" (control));
+    __asm__ volatile ("mcr p15, 0, %0, c9, c12, 1" : : "r" (counters));
+#endif
+}
+
+//Returns the clock, it wraps around so only differences are meaningful
+unsigned int profile_clock_ticks() {
+
+#ifdef PROFILE_CLOCK_TIMER
+    return timer_microseconds();
+#else
+    //Reads the cycle counter (PMCCNTR)
+    unsigned int cycles;
+    __asm__ volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (cycles));
+    return cycles;
+#endif
+}
+
+//Returns the number of clock ticks per microsecond
+unsigned int profile_clock_ticks_per_microsecond() {
+
+#ifdef PROFILE_CLOCK_TIMER
+    return 1;
+#else
+    return CPU_CYCLES_PER_MICROSECOND;
+#endif
+}
+
+//Writes text to the JTAG UART, waiting whenever its buffer is full
+void profile_write_text(const char *text) {
+    jtag_uart_write_text(text);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
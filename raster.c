@@ -0,0 +1,228 @@
+/*
+Integer rasterizer for the DE1-SoC VGA pixel buffer.
+
+All primitives end up in raster_span, which clips a single row and fills it.
+*/
+
+#include "raster.h"
+
+
+// Function definitions for the rasterizer
+/////////////////////////////////////////////////////////////////////
+
+//Fills the pixels from xStart to xEnd (inclusive) on row y with colour
+void raster_span(const RasterTarget *target, int y, int xStart, int xEnd, short int colour) {
+
+    //Discard rows outside of the buffer
+    if (y < 0 || y >= target->height) {
+        return;
+    }
+
+    //Order the end points so the span always runs left to right
+    if (xStart > xEnd) {
+        int temp = xStart;
+        xStart = xEnd;
+        xEnd = temp;
+    }
+
+    //Clip the span to the visible width
+    if (xStart < 0) xStart = 0;
+    if (xEnd >= target->width) xEnd = target->width - 1;
+    if (xStart > xEnd) {
+        return;
+    }
+
+    //Fill the contiguous run of pixels
+    short int *pixel = target->pixels + y * target->stride + xStart;
+    short int *end = target->pixels + y * target->stride + xEnd;
+    while (pixel <= end) {
+        *pixel++ = colour;
+    }
+}
+
+//Fills a rectangle with the left top corner at (x,y) with size (width,height)
+void raster_fill_rect(const RasterTarget *target, int xPixelCoord, int yPixelCoord, int width, int height, short int colour) {
+
+    //Nothing to draw for an empty rectangle
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    //Draws one span per row of the rectangle
+    for (int yCoord = yPixelCoord; yCoord < yPixelCoord + height; yCoord++) {
+        raster_span(target, yCoord, xPixelCoord, xPixelCoord + width - 1, colour);
+    }
+}
+
+//Fills a block of (width,height) pixels starting at a pixel index into the buffer, with no clipping
+void raster_fill_block(const RasterTarget *target, int offset, int width, int height, short int colour) {
+
+    //Walks the rows of the block, each one a contiguous run of pixels
+    short int *row = target->pixels + offset;
+    for (int yCoord = 0; yCoord < height; yCoord++) {
+        for (int xCoord = 0; xCoord < width; xCoord++) {
+            row[xCoord] = colour;
+        }
+        row += target->stride;
+    }
+}
+
+//Draws the outline of a circle with the center at (x,y) using the midpoint algorithm
+void raster_circle(const RasterTarget *target, int xCenter, int yCenter, int radius, short int colour) {
+
+    int xOffset = radius;
+    int yOffset = 0;
+    int decision = 1 - radius;
+
+    //Walks the first octant and mirrors every point into the other seven
+    //Each point is a one pixel span so clipping is shared with the other primitives
+    while (xOffset >= yOffset) {
+        raster_span(target, yCenter + yOffset, xCenter + xOffset, xCenter + xOffset, colour);
+        raster_span(target, yCenter + yOffset, xCenter - xOffset, xCenter - xOffset, colour);
+        raster_span(target, yCenter - yOffset, xCenter + xOffset, xCenter + xOffset, colour);
+        raster_span(target, yCenter - yOffset, xCenter - xOffset, xCenter - xOffset, colour);
+        raster_span(target, yCenter + xOffset, xCenter + yOffset, xCenter + yOffset, colour);
+        raster_span(target, yCenter + xOffset, xCenter - yOffset, xCenter - yOffset, colour);
+        raster_span(target, yCenter - xOffset, xCenter + yOffset, xCenter + yOffset, colour);
+        raster_span(target, yCenter - xOffset, xCenter - yOffset, xCenter - yOffset, colour);
+
+        yOffset++;
+        if (decision < 0) {
+            decision += 2 * yOffset + 1;
+        } else {
+            xOffset--;
+            decision += 2 * (yOffset - xOffset) + 1;
+        }
+    }
+}
+
+//Fills a disc with the center at (x,y) using the midpoint algorithm
+void raster_fill_circle(const RasterTarget *target, int xCenter, int yCenter, int radius, short int colour) {
+
+    int xOffset = radius;
+    int yOffset = 0;
+    int decision = 1 - radius;
+
+    //Every step of the octant walk gives the half width of two pairs of rows
+    //The outer rows (yCenter +- xOffset) are only filled when xOffset is about to change
+    //so that no row is filled more than once
+    while (xOffset >= yOffset) {
+        raster_span(target, yCenter + yOffset, xCenter - xOffset, xCenter + xOffset, colour);
+        if (yOffset != 0) {
+            raster_span(target, yCenter - yOffset, xCenter - xOffset, xCenter + xOffset, colour);
+        }
+
+        yOffset++;
+        if (decision < 0) {
+            decision += 2 * yOffset + 1;
+        } else {
+            if (xOffset >= yOffset) {
+                raster_span(target, yCenter + xOffset, xCenter - yOffset + 1, xCenter + yOffset - 1, colour);
+                raster_span(target, yCenter - xOffset, xCenter - yOffset + 1, xCenter + yOffset - 1, colour);
+            }
+            xOffset--;
+            decision += 2 * (yOffset - xOffset) + 1;
+        }
+    }
+}
+
+//Draws a one pixel wide line from (xStart,yStart) to (xEnd,yEnd) using Bresenham's algorithm
+void raster_line(const RasterTarget *target, int xStart, int yStart, int xEnd, int yEnd, short int colour) {
+
+    int deltaX = xEnd > xStart ? xEnd - xStart : xStart - xEnd;
+    int deltaY = yEnd > yStart ? yStart - yEnd : yEnd - yStart;
+    int stepX = xStart < xEnd ? 1 : -1;
+    int stepY = yStart < yEnd ? 1 : -1;
+    int error = deltaX + deltaY;
+    int xCoord = xStart;
+    int yCoord = yStart;
+
+    //Consecutive pixels on the same row are collected into one span
+    int spanRow = yStart;
+    int spanStart = xStart;
+    int spanEnd = xStart;
+
+    while (1) {
+
+        //Row changed, flush the pixels collected so far
+        if (yCoord != spanRow) {
+            raster_span(target, spanRow, spanStart, spanEnd, colour);
+            spanRow = yCoord;
+            spanStart = xCoord;
+        }
+        spanEnd = xCoord;
+
+        if (xCoord == xEnd && yCoord == yEnd) {
+            break;
+        }
+
+        int doubleError = 2 * error;
+        if (doubleError >= deltaY) {
+            error += deltaY;
+            xCoord += stepX;
+        }
+        if (doubleError <= deltaX) {
+            error += deltaX;
+            yCoord += stepY;
+        }
+    }
+
+    raster_span(target, spanRow, spanStart, spanEnd, colour);
+}
+
+//Fills a convex polygon given its vertices in order (clockwise or counter clockwise)
+void raster_fill_convex_polygon(const RasterTarget *target, const int *xCoords, const int *yCoords, int vertexCount, short int colour) {
+
+    if (vertexCount < 3) {
+        return;
+    }
+
+    //Finds the vertical extent of the polygon
+    int yMin = yCoords[0];
+    int yMax = yCoords[0];
+    for (int vertex = 1; vertex < vertexCount; vertex++) {
+        if (yCoords[vertex] < yMin) yMin = yCoords[vertex];
+        if (yCoords[vertex] > yMax) yMax = yCoords[vertex];
+    }
+
+    //Clip the scanlines to the buffer
+    if (yMin < 0) yMin = 0;
+    if (yMax >= target->height) yMax = target->height - 1;
+
+    //A convex polygon covers exactly one span per scanline
+    //The span runs between the leftmost and rightmost edge crossing
+    for (int yCoord = yMin; yCoord <= yMax; yCoord++) {
+        int xLeft = 0x7FFFFFFF;
+        int xRight = -0x7FFFFFFF;
+
+        for (int vertex = 0; vertex < vertexCount; vertex++) {
+            int next = vertex + 1 == vertexCount ? 0 : vertex + 1;
+            int x0 = xCoords[vertex], y0 = yCoords[vertex];
+            int x1 = xCoords[next], y1 = yCoords[next];
+
+            //Skip edges that do not cross this scanline
+            if ((yCoord < y0 && yCoord < y1) || (yCoord > y0 && yCoord > y1)) {
+                continue;
+            }
+
+            //Horizontal edges contribute both end points
+            if (y0 == y1) {
+                if (x0 < xLeft) xLeft = x0;
+                if (x0 > xRight) xRight = x0;
+                if (x1 < xLeft) xLeft = x1;
+                if (x1 > xRight) xRight = x1;
+                continue;
+            }
+
+            int xCross = x0 + (yCoord - y0) * (x1 - x0) / (y1 - y0);
+            if (xCross < xLeft) xLeft = xCross;
+            if (xCross > xRight) xRight = xCross;
+        }
+
+        if (xLeft <= xRight) {
+            raster_span(target, yCoord, xLeft, xRight, colour);
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
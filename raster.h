@@ -0,0 +1,54 @@
+/*
+Integer rasterizer for the DE1-SoC VGA pixel buffer.
+
+Every primitive is broken down into horizontal row spans, so the inner loops only
+ever walk a contiguous run of 16-bit pixels. No floating point is used anywhere.
+*/
+
+#ifndef RASTER_H
+#define RASTER_H
+
+
+//RasterTarget describes the pixel buffer the primitives are drawn into
+typedef struct RasterTarget
+{
+    //Address of the top left pixel
+    short int *pixels;
+
+    //Distance in pixels between the start of two consecutive rows
+    int stride;
+
+    //Visible size of the buffer, everything outside of it is clipped
+    int width;
+    int height;
+} RasterTarget;
+
+
+// Function prototypes for the rasterizer
+/////////////////////////////////////////////////////////////////////
+
+//Fills the pixels from xStart to xEnd (inclusive) on row y with colour
+void raster_span(const RasterTarget *target, int y, int xStart, int xEnd, short int colour);
+
+//Fills a rectangle with the left top corner at (x,y) with size (width,height)
+void raster_fill_rect(const RasterTarget *target, int xPixelCoord, int yPixelCoord, int width, int height, short int colour);
+
+//Fills a block of (width,height) pixels starting at a pixel index into the buffer, with no clipping
+//For blocks known to be on screen, such as the squares of the board (see geometry.h)
+void raster_fill_block(const RasterTarget *target, int offset, int width, int height, short int colour);
+
+//Draws the outline of a circle with the center at (x,y) using the midpoint algorithm
+void raster_circle(const RasterTarget *target, int xCenter, int yCenter, int radius, short int colour);
+
+//Fills a disc with the center at (x,y) using the midpoint algorithm
+void raster_fill_circle(const RasterTarget *target, int xCenter, int yCenter, int radius, short int colour);
+
+//Draws a one pixel wide line from (xStart,yStart) to (xEnd,yEnd) using Bresenham's algorithm
+void raster_line(const RasterTarget *target, int xStart, int yStart, int xEnd, int yEnd, short int colour);
+
+//Fills a convex polygon given its vertices in order (clockwise or counter clockwise)
+void raster_fill_convex_polygon(const RasterTarget *target, const int *xCoords, const int *yCoords, int vertexCount, short int colour);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
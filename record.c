@@ -0,0 +1,256 @@
+/*
+Compact binary record of a game, see record.h for the format.
+*/
+
+#include <string.h>
+
+#include "record.h"
+
+
+// Offsets of the header fields
+#define HEADER_VERSION    3
+#define HEADER_FLAGS      4
+#define HEADER_RESULT     5
+#define HEADER_MOVE_COUNT 6
+
+// Offsets of the fields of the start position, after the squares
+#define START_TURN        (BOARD_SIZE * BOARD_SIZE)
+#define START_MOVE_NUMBER (BOARD_SIZE * BOARD_SIZE + 1)
+
+// Bits of a square in a move
+#define SQUARE_BITS 6
+#define SQUARE_MASK 0x3F
+
+
+// Function prototypes for record helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the size of a move in the record, with its timestamp if it has one
+static int move_size(const GameRecord *record);
+
+//Returns the offset of the first move, after the start position if the record has one
+static int moves_offset(const GameRecord *record);
+
+//Checks if the start position of a record holds only empty squares and pieces of a colour, and a side to move
+static bool is_valid_start(const GameRecord *record);
+
+//Reads a little endian number of count bytes
+static unsigned int read_bytes(const unsigned char *bytes, int count);
+
+//Writes a little endian number of count bytes
+static void write_bytes(unsigned char *bytes, unsigned int value, int count);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for game records
+/////////////////////////////////////////////////////////////////////
+
+//Starts an empty record of an unfinished game, with a time for every move if timestamps is true
+void record_init(GameRecord *record, bool timestamps) {
+
+    record->bytes[0] = 'C';
+    record->bytes[1] = 'H';
+    record->bytes[2] = 'R';
+    record->bytes[HEADER_VERSION] = RECORD_VERSION;
+    record->bytes[HEADER_FLAGS] = timestamps ? RECORD_TIMESTAMPS : 0;
+    record->bytes[HEADER_RESULT] = RECORD_RESULT_UNFINISHED;
+    write_bytes(&record->bytes[HEADER_MOVE_COUNT], 0, 2);
+    record->size = RECORD_HEADER_SIZE;
+}
+
+//Stores the position the game starts from, the side to move and the number of its first move
+//Must be called before the first move, a record without it starts from the initial position with white to move
+void record_set_start(GameRecord *record, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int fullmoveNumber) {
+
+    unsigned char *start = &record->bytes[RECORD_HEADER_SIZE];
+    memcpy(start, board, BOARD_SIZE * BOARD_SIZE);
+    start[START_TURN] = (unsigned char) currentTurn;
+    write_bytes(&start[START_MOVE_NUMBER], fullmoveNumber, 2);
+
+    record->bytes[HEADER_FLAGS] |= RECORD_START_POSITION;
+    record->size = RECORD_HEADER_SIZE + RECORD_START_SIZE;
+}
+
+//Sets up the position the game started from, and gives its side to move and the number of its first move
+void record_start(const GameRecord *record, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int *currentTurn, int *fullmoveNumber) {
+
+    if ((record->bytes[HEADER_FLAGS] & RECORD_START_POSITION) == 0) {
+        init_board(board);
+        *currentTurn = WHITE_PIECE;
+        *fullmoveNumber = 1;
+        return;
+    }
+
+    const unsigned char *start = &record->bytes[RECORD_HEADER_SIZE];
+    memcpy(board, start, BOARD_SIZE * BOARD_SIZE);
+    *currentTurn = start[START_TURN];
+    *fullmoveNumber = (int) read_bytes(&start[START_MOVE_NUMBER], 2);
+}
+
+//Appends a move, milliseconds is ignored in records without timestamps
+//Returns false if the record is full
+bool record_add_move(GameRecord *record, int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, unsigned int milliseconds) {
+
+    int moveCount = record_move_count(record);
+    if (moveCount >= RECORD_MAX_MOVES) {
+        return false;
+    }
+
+    int startSquare = yCoordStart * BOARD_SIZE + xCoordStart;
+    int endSquare = yCoordEnd * BOARD_SIZE + xCoordEnd;
+    unsigned char *move = &record->bytes[record->size];
+
+    write_bytes(move, startSquare | (endSquare << SQUARE_BITS), RECORD_MOVE_SIZE);
+    if (record_has_timestamps(record)) {
+        write_bytes(move + RECORD_MOVE_SIZE, milliseconds, RECORD_TIMESTAMP_SIZE);
+    }
+
+    record->size += move_size(record);
+    write_bytes(&record->bytes[HEADER_MOVE_COUNT], moveCount + 1, 2);
+    return true;
+}
+
+//Stores the result of the game: WHITE_PIECE, BLACK_PIECE or STALEMATE
+void record_set_result(GameRecord *record, int winner) {
+    record->bytes[HEADER_RESULT] = winner == STALEMATE ? RECORD_RESULT_STALEMATE : winner;
+}
+
+//Returns the result of the game: WHITE_PIECE, BLACK_PIECE, RECORD_RESULT_STALEMATE or RECORD_RESULT_UNFINISHED
+int record_result(const GameRecord *record) {
+    return record->bytes[HEADER_RESULT];
+}
+
+//Checks if the record has a time for every move
+bool record_has_timestamps(const GameRecord *record) {
+    return (record->bytes[HEADER_FLAGS] & RECORD_TIMESTAMPS) != 0;
+}
+
+//Returns the number of moves in the record
+int record_move_count(const GameRecord *record) {
+    return (int) read_bytes(&record->bytes[HEADER_MOVE_COUNT], 2);
+}
+
+//Reads back the move at index, counted from the first move of the game
+RecordMove record_move(const GameRecord *record, int index) {
+
+    const unsigned char *bytes = &record->bytes[moves_offset(record) + index * move_size(record)];
+    unsigned int squares = read_bytes(bytes, RECORD_MOVE_SIZE);
+    int startSquare = squares & SQUARE_MASK;
+    int endSquare = (squares >> SQUARE_BITS) & SQUARE_MASK;
+
+    RecordMove move = {
+        startSquare % BOARD_SIZE, startSquare / BOARD_SIZE,
+        endSquare % BOARD_SIZE, endSquare / BOARD_SIZE,
+        record_has_timestamps(record) ? read_bytes(bytes + RECORD_MOVE_SIZE, RECORD_TIMESTAMP_SIZE) : 0
+    };
+    return move;
+}
+
+//Copies a saved record into record, checking its header and size, version 1 records have no start position
+//Returns false if the bytes are not a record this version can read
+bool record_load(GameRecord *record, const unsigned char *bytes, int size) {
+
+    if (size < RECORD_HEADER_SIZE || size > RECORD_MAX_SIZE) {
+        return false;
+    }
+    if (bytes[0] != 'C' || bytes[1] != 'H' || bytes[2] != 'R' || bytes[HEADER_VERSION] < 1 || bytes[HEADER_VERSION] > RECORD_VERSION) {
+        return false;
+    }
+    if (bytes[HEADER_VERSION] == 1 && (bytes[HEADER_FLAGS] & RECORD_START_POSITION) != 0) {
+        return false;
+    }
+
+    memcpy(record->bytes, bytes, size);
+    record->size = size;
+
+    //The moves must fill the record exactly, and a start position must be one the board can hold
+    int moveCount = record_move_count(record);
+    if (moveCount > RECORD_MAX_MOVES || size != moves_offset(record) + moveCount * move_size(record)) {
+        return false;
+    }
+    return moves_offset(record) == RECORD_HEADER_SIZE || is_valid_start(record);
+}
+
+//Plays the moves of a record from the position it starts from as fast as possible, checking each
+//with the rules and then whether the game is over, the same work the game does every turn
+//Returns the number of moves played, it stops at the first move the rules do not allow
+int record_replay(const GameRecord *record, PackedSquare board[BOARD_SIZE][BOARD_SIZE]) {
+
+    int currentTurn;
+    int fullmoveNumber;
+    int moveCount = record_move_count(record);
+
+    record_start(record, board, &currentTurn, &fullmoveNumber);
+
+    for (int index = 0; index < moveCount; index++) {
+
+        RecordMove move = record_move(record, index);
+        if (!is_valid_move(board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd, currentTurn)) {
+            return index;
+        }
+
+        move_piece(board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd);
+        switch_turns(&currentTurn);
+
+        //The checks begin_turn makes before the next turn
+        if (is_game_over(board, currentTurn)) {
+            return index + 1;
+        }
+        is_in_check(board, currentTurn);
+    }
+
+    return moveCount;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for record helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the size of a move in the record, with its timestamp if it has one
+static int move_size(const GameRecord *record) {
+    return RECORD_MOVE_SIZE + (record_has_timestamps(record) ? RECORD_TIMESTAMP_SIZE : 0);
+}
+
+//Returns the offset of the first move, after the start position if the record has one
+static int moves_offset(const GameRecord *record) {
+    return RECORD_HEADER_SIZE + ((record->bytes[HEADER_FLAGS] & RECORD_START_POSITION) != 0 ? RECORD_START_SIZE : 0);
+}
+
+//Checks if the start position of a record holds only empty squares and pieces of a colour, and a side to move
+static bool is_valid_start(const GameRecord *record) {
+
+    const unsigned char *start = &record->bytes[RECORD_HEADER_SIZE];
+    for (int square = 0; square < BOARD_SIZE * BOARD_SIZE; square++) {
+
+        //The squares are used to index piece tables, a piece ID past KING or a third colour would read past them
+        PackedSquare packed = start[square];
+        int colourBits = packed >> PACKED_COLOUR_SHIFT;
+        if (packed != PACKED_EMPTY && (PACKED_PIECE_ID(packed) < PAWN || PACKED_PIECE_ID(packed) > KING || colourBits < 1 || colourBits > 2)) {
+            return false;
+        }
+    }
+    return start[START_TURN] == WHITE_PIECE || start[START_TURN] == BLACK_PIECE;
+}
+
+//Reads a little endian number of count bytes
+static unsigned int read_bytes(const unsigned char *bytes, int count) {
+
+    unsigned int value = 0;
+    for (int byte = count - 1; byte >= 0; byte--) {
+        value = (value << 8) | bytes[byte];
+    }
+    return value;
+}
+
+//Writes a little endian number of count bytes
+static void write_bytes(unsigned char *bytes, unsigned int value, int count) {
+
+    for (int byte = 0; byte < count; byte++) {
+        bytes[byte] = (unsigned char) (value >> (8 * byte));
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,139 @@
+/*
+Compact binary record of a game.
+
+Every move played is appended to a record as it is made, so a finished game can be
+saved and played back later, for example to reproduce a slow turn, from the position
+the game started from. The record is kept
+in its file format, saving it is a single write of record_bytes:
+
+  header  8 bytes   'C' 'H' 'R' RECORD_VERSION, flags, result, move count (16 bits, little endian)
+  start   67 bytes  only with RECORD_START_POSITION, a game that did not start from the
+                    initial position: its PackedSquares in the order of the squares, the
+                    side to move and the number of the first move (16 bits, little endian)
+  move    2 bytes   start square | end square << 6, squares are yCoord * 8 + xCoord
+                    (16 bits, little endian, the top 4 bits are 0)
+  time    4 bytes   only with RECORD_TIMESTAMPS, milliseconds from the start of the game
+                    until the move was confirmed (little endian), follows its move
+
+Two backends save a record, link exactly one of them together with record.c:
+  record_mmio.c  - sends it as hex text over the JTAG UART
+  record_host.c  - writes it to a file on a Linux host, and loads saved records
+*/
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdbool.h>
+
+#include "chess.h"
+
+
+// Version of the file format
+#define RECORD_VERSION 2
+
+// Most moves a record holds, moves after that are not recorded
+#define RECORD_MAX_MOVES 1024
+
+// Sizes of the parts of a record, in bytes
+#define RECORD_HEADER_SIZE    8
+#define RECORD_START_SIZE     (BOARD_SIZE * BOARD_SIZE + 3)
+#define RECORD_MOVE_SIZE      2
+#define RECORD_TIMESTAMP_SIZE 4
+#define RECORD_MAX_SIZE (RECORD_HEADER_SIZE + RECORD_START_SIZE + RECORD_MAX_MOVES * (RECORD_MOVE_SIZE + RECORD_TIMESTAMP_SIZE))
+
+// Header flags
+#define RECORD_TIMESTAMPS     0x1
+#define RECORD_START_POSITION 0x2
+
+// Results kept in the header, the other values are WHITE_PIECE and BLACK_PIECE
+#define RECORD_RESULT_STALEMATE  2
+#define RECORD_RESULT_UNFINISHED 3
+
+
+//RecordMove holds a move read back from a record
+typedef struct RecordMove
+{
+    int xCoordStart;
+    int yCoordStart;
+    int xCoordEnd;
+    int yCoordEnd;
+
+    //Milliseconds from the start of the game, 0 in records without timestamps
+    unsigned int milliseconds;
+} RecordMove;
+
+
+//GameRecord holds the moves of one game in the file format
+typedef struct GameRecord
+{
+    unsigned char bytes[RECORD_MAX_SIZE];
+    int size;
+} GameRecord;
+
+
+// Function prototypes for game records
+/////////////////////////////////////////////////////////////////////
+
+//Starts an empty record of an unfinished game, with a time for every move if timestamps is true
+void record_init(GameRecord *record, bool timestamps);
+
+//Stores the position the game starts from, the side to move and the number of its first move
+//Must be called before the first move, a record without it starts from the initial position with white to move
+void record_set_start(GameRecord *record, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, int fullmoveNumber);
+
+//Sets up the position the game started from, and gives its side to move and the number of its first move
+void record_start(const GameRecord *record, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int *currentTurn, int *fullmoveNumber);
+
+//Appends a move, milliseconds is ignored in records without timestamps
+//Returns false if the record is full
+bool record_add_move(GameRecord *record, int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd, unsigned int milliseconds);
+
+//Stores the result of the game: WHITE_PIECE, BLACK_PIECE or STALEMATE
+void record_set_result(GameRecord *record, int winner);
+
+//Returns the result of the game: WHITE_PIECE, BLACK_PIECE, RECORD_RESULT_STALEMATE or RECORD_RESULT_UNFINISHED
+int record_result(const GameRecord *record);
+
+//Checks if the record has a time for every move
+bool record_has_timestamps(const GameRecord *record);
+
+//Returns the number of moves in the record
+int record_move_count(const GameRecord *record);
+
+//Reads back the move at index, counted from the first move of the game
+RecordMove record_move(const GameRecord *record, int index);
+
+//Copies a saved record into record, checking its header and size, version 1 records have no start position
+//Returns false if the bytes are not a record this version can read
+bool record_load(GameRecord *record, const unsigned char *bytes, int size);
+
+//Plays the moves of a record from the position it starts from as fast as possible, checking each
+//with the rules and then whether the game is over, the same work the game does every turn
+//Returns the number of moves played, it stops at the first move the rules do not allow
+int record_replay(const GameRecord *record, PackedSquare board[BOARD_SIZE][BOARD_SIZE]);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for the record backends
+/////////////////////////////////////////////////////////////////////
+
+//Saves a record: over the JTAG UART on the board, to the file set with record_host_set_path on the host
+void record_save(const GameRecord *record);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Sets the file record_save writes to, NULL (the default) saves nothing
+void record_host_set_path(const char *path);
+
+//Loads a record from a file holding either the binary record or the hex text the board sends
+//Returns false if the file can not be read or holds no record
+bool record_host_load(GameRecord *record, const char *path);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
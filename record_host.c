@@ -0,0 +1,112 @@
+/*
+Saves and loads game records on a Linux host.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "record.h"
+
+
+//File record_save writes to, nothing is saved while it is NULL
+static const char *savePath = NULL;
+
+
+// Function prototypes for host record helpers
+/////////////////////////////////////////////////////////////////////
+
+//Reads the "record <hex>" lines the board sends, anything else in the text is skipped
+//Returns the number of bytes read into bytes
+static int read_hex_lines(FILE *file, unsigned char *bytes, int maxSize);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the record backend
+/////////////////////////////////////////////////////////////////////
+
+//Writes a record to the file set with record_host_set_path
+void record_save(const GameRecord *record) {
+
+    if (savePath == NULL) {
+        return;
+    }
+
+    FILE *file = fopen(savePath, "wb");
+    if (file == NULL) {
+        perror(savePath);
+        return;
+    }
+
+    if (fwrite(record->bytes, 1, record->size, file) != (size_t) record->size) {
+        perror(savePath);
+    }
+    fclose(file);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Sets the file record_save writes to, NULL saves nothing
+void record_host_set_path(const char *path) {
+    savePath = path;
+}
+
+//Loads a record from a file holding either the binary record or the hex text the board sends
+//Returns false if the file can not be read or holds no record
+bool record_host_load(GameRecord *record, const char *path) {
+
+    static unsigned char bytes[RECORD_MAX_SIZE + 1];
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    //A binary record starts with its magic, anything else is taken for text from the board
+    int size = (int) fread(bytes, 1, sizeof(bytes), file);
+    if (size < 3 || memcmp(bytes, "CHR", 3) != 0) {
+        rewind(file);
+        size = read_hex_lines(file, bytes, sizeof(bytes));
+    }
+    fclose(file);
+
+    return record_load(record, bytes, size);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for host record helpers
+/////////////////////////////////////////////////////////////////////
+
+//Reads the "record <hex>" lines the board sends, anything else in the text is skipped
+//Returns the number of bytes read into bytes
+static int read_hex_lines(FILE *file, unsigned char *bytes, int maxSize) {
+
+    char line[256];
+    int size = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+
+        //The terminal may put text in front of a line
+        char *digits = strstr(line, "record ");
+        if (digits == NULL) {
+            continue;
+        }
+        digits += strlen("record ");
+
+        unsigned int byte;
+        while (size < maxSize && sscanf(digits, "%2x", &byte) == 1) {
+            bytes[size++] = (unsigned char) byte;
+            digits += 2;
+        }
+    }
+
+    return size;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,37 @@
+/*
+Saves game records over the JTAG UART of the DE1-SoC.
+
+The board has no file system, so the record is sent as lines of hex text that the
+Monitor Program terminal shows and that can be copied into a file:
+  record 43485201000108000c1c...
+Each line holds up to RECORD_LINE_BYTES bytes, record_host_load reads the lines back.
+*/
+
+#include "jtag_uart.h"
+#include "record.h"
+
+
+// Bytes of the record on each line of text
+#define RECORD_LINE_BYTES 32
+
+
+// Function definitions for the record backend
+/////////////////////////////////////////////////////////////////////
+
+//Sends a record over the JTAG UART as lines of hex text
+void record_save(const GameRecord *record) {
+
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    for (int lineStart = 0; lineStart < record->size; lineStart += RECORD_LINE_BYTES) {
+
+        jtag_uart_write_text("record ");
+        for (int byte = lineStart; byte < record->size && byte < lineStart + RECORD_LINE_BYTES; byte++) {
+            jtag_uart_write_char(HEX_DIGITS[record->bytes[byte] >> 4]);
+            jtag_uart_write_char(HEX_DIGITS[record->bytes[byte] & 0xF]);
+        }
+        jtag_uart_write_char('\n');
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,336 @@
+/*
+Referee for many games at once, behind the game server (tools/server.c).
+*/
+
+#include <stdlib.h>
+
+#include "referee.h"
+
+
+// The game, its legal moves and its history are allocated one after another from the arena
+#define REFEREE_ALIGNED(size) (((size) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT)
+_Static_assert(REFEREE_ALIGNED(sizeof(RefereeGame)) + REFEREE_ALIGNED(MAX_MOVES * sizeof(Move)) + REFEREE_ALIGNED(REFEREE_MAX_PLIES * sizeof(Move))
+               <= REFEREE_GAME_ARENA_SIZE, "a game does not fit in its arena");
+
+
+// Function prototypes for referee helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the slot of a game id, locked, or NULL if the id is not a game being played
+static RefereeSlot * lock_game(Referee *referee, uint32_t gameId);
+
+//Returns the id of the game in a slot
+static uint32_t game_id(Referee *referee, RefereeSlot *slot);
+
+//Starts a game from the initial position in a free arena
+//Returns the slot, locked, or NULL if every arena holds a game
+static RefereeSlot * start_game(Referee *referee);
+
+//Gives the arena of a locked slot back, which unlocks it
+static void end_game(Referee *referee, RefereeSlot *slot);
+
+//Generates the legal moves of the side to move and works out the state of the game
+static void begin_turn(RefereeGame *game);
+
+//Plays a move if it is one of the legal moves
+//Returns the status of the request
+static RefereeStatus play_move(RefereeGame *game, int start, int end);
+
+//Fills a reply with the state of a game
+static void describe_game(RefereeReply *reply, RefereeGame *game, uint32_t gameId);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the referee
+/////////////////////////////////////////////////////////////////////
+
+//Allocates the arenas of up to maxGames games at once
+//Returns false if maxGames is out of range or the memory can not be allocated
+bool referee_init(Referee *referee, int maxGames) {
+
+    if (maxGames < 1 || maxGames > REFEREE_MAX_GAMES) {
+        return false;
+    }
+
+    referee->slots = calloc(maxGames, sizeof(RefereeSlot));
+    referee->freeSlots = malloc(maxGames * sizeof(int));
+    referee->memory = malloc((size_t) maxGames * REFEREE_GAME_ARENA_SIZE);
+    if (referee->slots == NULL || referee->freeSlots == NULL || referee->memory == NULL) {
+        free(referee->slots);
+        free(referee->freeSlots);
+        free(referee->memory);
+        return false;
+    }
+
+    referee->slotCount = maxGames;
+    pthread_mutex_init(&referee->freeLock, NULL);
+
+    //Pushed last to first, so the first games take the arenas at the start of the block
+    referee->freeCount = 0;
+    for (int index = maxGames - 1; index >= 0; index--) {
+        RefereeSlot *slot = &referee->slots[index];
+        pthread_mutex_init(&slot->lock, NULL);
+        arena_init(&slot->arena, referee->memory + (size_t) index * REFEREE_GAME_ARENA_SIZE, REFEREE_GAME_ARENA_SIZE);
+        referee->freeSlots[referee->freeCount++] = index;
+    }
+
+    return true;
+}
+
+//Frees the arenas, no game can be played afterwards
+void referee_free(Referee *referee) {
+
+    for (int index = 0; index < referee->slotCount; index++) {
+        pthread_mutex_destroy(&referee->slots[index].lock);
+    }
+    pthread_mutex_destroy(&referee->freeLock);
+
+    free(referee->slots);
+    free(referee->freeSlots);
+    free(referee->memory);
+    referee->slots = NULL;
+    referee->slotCount = 0;
+}
+
+//Answers a request, writing the reply into reply
+void referee_handle(Referee *referee, const unsigned char request[REFEREE_MESSAGE_SIZE], unsigned char reply[REFEREE_MESSAGE_SIZE]) {
+
+    RefereeRequest parsed = referee_read_request(request);
+    RefereeReply answer = {REFEREE_OK, REFEREE_PLAYING, WHITE_PIECE, 0, parsed.game};
+
+    if (parsed.type == REFEREE_NEW_GAME) {
+        RefereeSlot *slot = start_game(referee);
+        if (slot == NULL) {
+            answer.status = REFEREE_FULL;
+        } else {
+            describe_game(&answer, slot->game, game_id(referee, slot));
+            pthread_mutex_unlock(&slot->lock);
+        }
+        referee_write_reply(&answer, reply);
+        return;
+    }
+
+    if (parsed.type < REFEREE_MOVE || parsed.type > REFEREE_END_GAME) {
+        answer.status = REFEREE_BAD_REQUEST;
+        referee_write_reply(&answer, reply);
+        return;
+    }
+
+    RefereeSlot *slot = lock_game(referee, parsed.game);
+    if (slot == NULL) {
+        answer.status = REFEREE_NO_GAME;
+        referee_write_reply(&answer, reply);
+        return;
+    }
+
+    if (parsed.type == REFEREE_MOVE) {
+        answer.status = play_move(slot->game, parsed.start, parsed.end);
+    }
+
+    //The reply describes the game as the request left it, an ended game as it was last
+    describe_game(&answer, slot->game, parsed.game);
+
+    if (parsed.type == REFEREE_END_GAME) {
+        end_game(referee, slot);
+    } else {
+        pthread_mutex_unlock(&slot->lock);
+    }
+    referee_write_reply(&answer, reply);
+}
+
+//Returns the number of games holding an arena
+int referee_game_count(Referee *referee) {
+
+    pthread_mutex_lock(&referee->freeLock);
+    int count = referee->slotCount - referee->freeCount;
+    pthread_mutex_unlock(&referee->freeLock);
+    return count;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for messages
+/////////////////////////////////////////////////////////////////////
+
+//Writes a request as bytes
+void referee_write_request(const RefereeRequest *request, unsigned char bytes[REFEREE_MESSAGE_SIZE]) {
+
+    bytes[0] = (unsigned char) request->type;
+    bytes[1] = (unsigned char) request->start;
+    bytes[2] = (unsigned char) request->end;
+    bytes[3] = 0;
+    for (int index = 0; index < 4; index++) {
+        bytes[4 + index] = (unsigned char) (request->game >> (8 * index));
+    }
+}
+
+//Reads a request from bytes
+RefereeRequest referee_read_request(const unsigned char bytes[REFEREE_MESSAGE_SIZE]) {
+
+    RefereeRequest request;
+    request.type = bytes[0];
+    request.start = bytes[1];
+    request.end = bytes[2];
+    request.game = 0;
+    for (int index = 0; index < 4; index++) {
+        request.game |= (uint32_t) bytes[4 + index] << (8 * index);
+    }
+    return request;
+}
+
+//Writes a reply as bytes
+void referee_write_reply(const RefereeReply *reply, unsigned char bytes[REFEREE_MESSAGE_SIZE]) {
+
+    bytes[0] = (unsigned char) reply->status;
+    bytes[1] = (unsigned char) reply->state;
+    bytes[2] = (unsigned char) reply->currentTurn;
+    bytes[3] = (unsigned char) reply->moveCount;
+    for (int index = 0; index < 4; index++) {
+        bytes[4 + index] = (unsigned char) (reply->game >> (8 * index));
+    }
+}
+
+//Reads a reply from bytes
+RefereeReply referee_read_reply(const unsigned char bytes[REFEREE_MESSAGE_SIZE]) {
+
+    RefereeReply reply;
+    reply.status = bytes[0];
+    reply.state = bytes[1];
+    reply.currentTurn = bytes[2];
+    reply.moveCount = bytes[3];
+    reply.game = 0;
+    for (int index = 0; index < 4; index++) {
+        reply.game |= (uint32_t) bytes[4 + index] << (8 * index);
+    }
+    return reply;
+}
+
+//Checks if a game state is one of the ends of a game
+bool referee_is_over(int state) {
+    return state == REFEREE_WHITE_WON || state == REFEREE_BLACK_WON || state == REFEREE_STALEMATE;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for referee helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the slot of a game id, locked, or NULL if the id is not a game being played
+static RefereeSlot * lock_game(Referee *referee, uint32_t gameId) {
+
+    uint32_t index = gameId & (REFEREE_MAX_GAMES - 1);
+    if (index >= (uint32_t) referee->slotCount) {
+        return NULL;
+    }
+
+    RefereeSlot *slot = &referee->slots[index];
+    pthread_mutex_lock(&slot->lock);
+    if (slot->game == NULL || game_id(referee, slot) != gameId) {
+        pthread_mutex_unlock(&slot->lock);
+        return NULL;
+    }
+    return slot;
+}
+
+//Returns the id of the game in a slot
+static uint32_t game_id(Referee *referee, RefereeSlot *slot) {
+    return (uint32_t) (slot - referee->slots) | slot->generation << REFEREE_SLOT_BITS;
+}
+
+//Starts a game from the initial position in a free arena
+//Returns the slot, locked, or NULL if every arena holds a game
+static RefereeSlot * start_game(Referee *referee) {
+
+    pthread_mutex_lock(&referee->freeLock);
+    int index = referee->freeCount > 0 ? referee->freeSlots[--referee->freeCount] : -1;
+    pthread_mutex_unlock(&referee->freeLock);
+    if (index < 0) {
+        return NULL;
+    }
+
+    RefereeSlot *slot = &referee->slots[index];
+    pthread_mutex_lock(&slot->lock);
+
+    //The arena is sized for all three, so none of them can fail
+    arena_reset(&slot->arena);
+    RefereeGame *game = arena_alloc(&slot->arena, sizeof(RefereeGame));
+    game->legalMoves = arena_alloc(&slot->arena, MAX_MOVES * sizeof(Move));
+    game->history = arena_alloc(&slot->arena, REFEREE_MAX_PLIES * sizeof(Move));
+
+    init_board(game->board);
+    game->currentTurn = WHITE_PIECE;
+    game->plies = 0;
+    begin_turn(game);
+
+    slot->generation = (slot->generation + 1) & ((1u << (32 - REFEREE_SLOT_BITS)) - 1);
+    slot->game = game;
+    return slot;
+}
+
+//Gives the arena of a locked slot back, which unlocks it
+static void end_game(Referee *referee, RefereeSlot *slot) {
+
+    slot->game = NULL;
+    pthread_mutex_unlock(&slot->lock);
+
+    pthread_mutex_lock(&referee->freeLock);
+    referee->freeSlots[referee->freeCount++] = (int) (slot - referee->slots);
+    pthread_mutex_unlock(&referee->freeLock);
+}
+
+//Generates the legal moves of the side to move and works out the state of the game
+static void begin_turn(RefereeGame *game) {
+
+    game->legalMoveCount = generate_moves(game->board, game->currentTurn, game->legalMoves);
+
+    //Decided the same way the board decides it at the start of a turn
+    if (is_game_over(game->board, game->currentTurn)) {
+        int winner = get_winner(game->board, game->currentTurn);
+        if      (winner == WHITE_PIECE) game->state = REFEREE_WHITE_WON;
+        else if (winner == BLACK_PIECE) game->state = REFEREE_BLACK_WON;
+        else                            game->state = REFEREE_STALEMATE;
+    } else if (game->plies == REFEREE_MAX_PLIES) {
+        game->state = REFEREE_STALEMATE;
+    } else {
+        game->state = is_in_check(game->board, game->currentTurn) ? REFEREE_CHECK : REFEREE_PLAYING;
+    }
+}
+
+//Plays a move if it is one of the legal moves
+//Returns the status of the request
+static RefereeStatus play_move(RefereeGame *game, int start, int end) {
+
+    if (start >= BOARD_SIZE * BOARD_SIZE || end >= BOARD_SIZE * BOARD_SIZE) {
+        return REFEREE_BAD_REQUEST;
+    }
+    if (referee_is_over(game->state)) {
+        return REFEREE_GAME_OVER;
+    }
+
+    for (int index = 0; index < game->legalMoveCount; index++) {
+        Move move = game->legalMoves[index];
+        if (move.start == start && move.end == end) {
+            make_move(game->board, move);
+            game->history[game->plies++] = move;
+            switch_turns(&game->currentTurn);
+            begin_turn(game);
+            return REFEREE_OK;
+        }
+    }
+
+    return REFEREE_ILLEGAL_MOVE;
+}
+
+//Fills a reply with the state of a game
+static void describe_game(RefereeReply *reply, RefereeGame *game, uint32_t gameId) {
+
+    reply->state = game->state;
+    reply->currentTurn = game->currentTurn;
+    reply->moveCount = game->legalMoveCount;
+    reply->game = gameId;
+}
+
+/////////////////////////////////////////////////////////////////////
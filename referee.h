@@ -0,0 +1,214 @@
+/*
+Referee for many games at once, behind the game server (tools/server.c).
+
+Every game lives in its own fixed size arena of REFEREE_GAME_ARENA_SIZE bytes, cut from
+one block allocated when the referee starts, so games are created and played without
+touching the heap and a finished game's arena is handed to the next one. The arena holds
+the position, the moves played and the legal moves of the side to move. The legal moves
+are generated once per move with generate_moves, which gives exactly the moves
+is_valid_move allows, and a move request is checked against them. Whether a game is over
+and who won is decided by is_game_over and get_winner, as on the board.
+
+Requests and replies are REFEREE_MESSAGE_SIZE bytes each, game ids are little endian:
+
+  request  type, start square, end square, 0, game id (32 bits)
+  reply    status, game state, side to move, legal moves of the side to move, game id (32 bits)
+
+Squares are yCoord * 8 + xCoord, as in game records. A new game's id comes back in the
+reply to REFEREE_NEW_GAME; the id of an ended game is not valid again until its arena
+has held 4096 more games. Every reply carries the state of the game as it is after the
+request, so a client never has to ask twice.
+
+A game keeps its arena after it is over, so its result can still be asked for, until
+REFEREE_END_GAME gives it back. The history has room for REFEREE_MAX_PLIES moves; the
+rules have no draws, so a game that fills it ends as a stalemate, as tournament games do
+at their ply limit.
+
+Every game has its own lock, so any number of threads can call referee_handle at once.
+Uses pthreads and is built on the host only.
+*/
+
+#ifndef REFEREE_H
+#define REFEREE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "chess.h"
+#include "movegen.h"
+
+
+// Size of every request and reply, in bytes
+#define REFEREE_MESSAGE_SIZE 8
+
+// Memory of one game: the position, the legal moves and the history
+#define REFEREE_GAME_ARENA_SIZE 2048
+
+// Moves the history of a game has room for
+#define REFEREE_MAX_PLIES 640
+
+// Most games a referee holds, game ids keep the arena's index in this many low bits
+#define REFEREE_SLOT_BITS 20
+#define REFEREE_MAX_GAMES (1 << REFEREE_SLOT_BITS)
+
+
+//RefereeRequestType lists what a request asks for
+typedef enum RefereeRequestType
+{
+    //Starts a game from the initial position, the game id of the request is ignored
+    REFEREE_NEW_GAME = 1,
+
+    //Plays a move for the side to move
+    REFEREE_MOVE = 2,
+
+    //Only asks for the state of the game
+    REFEREE_QUERY = 3,
+
+    //Ends the game and gives its arena back
+    REFEREE_END_GAME = 4
+} RefereeRequestType;
+
+
+//RefereeStatus lists the answers to a request
+typedef enum RefereeStatus
+{
+    REFEREE_OK = 0,
+
+    //The move is not one the rules allow, nothing changed
+    REFEREE_ILLEGAL_MOVE = 1,
+
+    //The game id is not a game that is being played
+    REFEREE_NO_GAME = 2,
+
+    //The game is over, the move was not played
+    REFEREE_GAME_OVER = 3,
+
+    //Every arena holds a game, no new game was started
+    REFEREE_FULL = 4,
+
+    //The request type or a square is out of range
+    REFEREE_BAD_REQUEST = 5
+} RefereeStatus;
+
+
+//RefereeState lists the states a game can be in
+typedef enum RefereeState
+{
+    REFEREE_PLAYING = 0,
+    REFEREE_CHECK = 1,
+    REFEREE_WHITE_WON = 2,
+    REFEREE_BLACK_WON = 3,
+    REFEREE_STALEMATE = 4
+} RefereeState;
+
+
+//RefereeRequest holds a request, read from or written to its bytes
+typedef struct RefereeRequest
+{
+    int type;
+    int start;
+    int end;
+    uint32_t game;
+} RefereeRequest;
+
+
+//RefereeReply holds a reply, read from or written to its bytes
+typedef struct RefereeReply
+{
+    int status;
+    int state;
+    int currentTurn;
+    int moveCount;
+    uint32_t game;
+} RefereeReply;
+
+
+//RefereeGame holds a game, at the start of its arena
+typedef struct RefereeGame
+{
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+    RefereeState state;
+
+    //Moves the side to move can play, generated once per move
+    Move *legalMoves;
+    int legalMoveCount;
+
+    //Moves played from the initial position
+    Move *history;
+    int plies;
+} RefereeGame;
+
+
+//RefereeSlot holds one arena and the game in it
+typedef struct RefereeSlot
+{
+    pthread_mutex_t lock;
+
+    //Counts the games the arena held, so the id of an ended game is not taken for the next ones
+    uint32_t generation;
+
+    //NULL while the arena is free
+    RefereeGame *game;
+    Arena arena;
+} RefereeSlot;
+
+
+//Referee holds every game slot and the slots that are free
+typedef struct Referee
+{
+    RefereeSlot *slots;
+    int slotCount;
+
+    //One block for every arena
+    unsigned char *memory;
+
+    //Stack of free slot indexes, the last freed arena is the first reused while it is still in cache
+    pthread_mutex_t freeLock;
+    int *freeSlots;
+    int freeCount;
+} Referee;
+
+
+// Function prototypes for the referee
+/////////////////////////////////////////////////////////////////////
+
+//Allocates the arenas of up to maxGames games at once
+//Returns false if maxGames is out of range or the memory can not be allocated
+bool referee_init(Referee *referee, int maxGames);
+
+//Frees the arenas, no game can be played afterwards
+void referee_free(Referee *referee);
+
+//Answers a request, writing the reply into reply
+void referee_handle(Referee *referee, const unsigned char request[REFEREE_MESSAGE_SIZE], unsigned char reply[REFEREE_MESSAGE_SIZE]);
+
+//Returns the number of games holding an arena
+int referee_game_count(Referee *referee);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for messages, shared with clients
+/////////////////////////////////////////////////////////////////////
+
+//Writes a request as bytes
+void referee_write_request(const RefereeRequest *request, unsigned char bytes[REFEREE_MESSAGE_SIZE]);
+
+//Reads a request from bytes
+RefereeRequest referee_read_request(const unsigned char bytes[REFEREE_MESSAGE_SIZE]);
+
+//Writes a reply as bytes
+void referee_write_reply(const RefereeReply *reply, unsigned char bytes[REFEREE_MESSAGE_SIZE]);
+
+//Reads a reply from bytes
+RefereeReply referee_read_reply(const unsigned char bytes[REFEREE_MESSAGE_SIZE]);
+
+//Checks if a game state is one of the ends of a game
+bool referee_is_over(int state);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,106 @@
+/*
+Plays a game record back through the game.
+*/
+
+#include "fen.h"
+#include "replay.h"
+#include "timer.h"
+
+
+// Function prototypes for the replay engine
+/////////////////////////////////////////////////////////////////////
+
+//Nothing to prepare, the next recorded move is the answer
+static void replay_start(void *context, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Arena *arena);
+
+//Returns the next recorded move once its time has come
+static bool replay_think(void *context, unsigned int deadline, GameMove *move);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for replays
+/////////////////////////////////////////////////////////////////////
+
+//Starts playing back a record from its first move
+void replay_init(Replay *replay, const GameRecord *record, bool paced) {
+
+    replay->record = record;
+    replay->nextMove = 0;
+    replay->paced = paced && record_has_timestamps(record);
+    replay->startMicroseconds = timer_microseconds();
+
+    replay->engine.start = replay_start;
+    replay->engine.think = replay_think;
+    replay->engine.context = replay;
+}
+
+//Sets up a new game from the position the record starts from, in place of game_init
+void replay_init_game(const Replay *replay, Game *game) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    FenState state;
+    int currentTurn;
+    int fullmoveNumber;
+
+    record_start(replay->record, board, &currentTurn, &fullmoveNumber);
+    fen_state_init(&state, currentTurn);
+    state.fullmoveNumber = fullmoveNumber;
+    game_init_position(game, board, &state);
+}
+
+//Lets the replay play both sides of a game that has just been set up with replay_init_game
+void replay_attach(Replay *replay, Game *game) {
+
+    replay->startMicroseconds = game->startMicroseconds;
+    game_set_engine(game, WHITE_PIECE, &replay->engine);
+    game_set_engine(game, BLACK_PIECE, &replay->engine);
+}
+
+//Checks if every recorded move has been played
+bool replay_finished(const Replay *replay) {
+    return replay->nextMove >= record_move_count(replay->record);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the replay engine
+/////////////////////////////////////////////////////////////////////
+
+//Nothing to prepare, the next recorded move is the answer
+static void replay_start(void *context, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, Arena *arena) {
+
+    (void) context;
+    (void) board;
+    (void) currentTurn;
+    (void) arena;
+}
+
+//Returns the next recorded move once its time has come
+static bool replay_think(void *context, unsigned int deadline, GameMove *move) {
+
+    Replay *replay = context;
+    (void) deadline;
+
+    //With no moves left the engine answers with a move that goes nowhere, which the
+    //rules reject, so the game hands the turn to the player
+    if (replay_finished(replay)) {
+        GameMove noMove = {0, 0, 0, 0};
+        *move = noMove;
+        return true;
+    }
+
+    RecordMove recorded = record_move(replay->record, replay->nextMove);
+
+    if (replay->paced && (int) (timer_microseconds() - replay->startMicroseconds - recorded.milliseconds * 1000) < 0) {
+        return false;
+    }
+
+    GameMove next = {recorded.xCoordStart, recorded.yCoordStart, recorded.xCoordEnd, recorded.yCoordEnd};
+    *move = next;
+    replay->nextMove++;
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////
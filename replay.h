@@ -0,0 +1,55 @@
+/*
+Plays a game record back through the game.
+
+A replay is an engine for both sides that returns the recorded moves, so the moves go
+through the same legality checks, animations and turn handling as when they were played.
+Paced, every move is played at the time it was confirmed in the recorded game, which
+reproduces the timing of a slow turn; otherwise every move is played as soon as its
+turn starts. A move the rules do not allow, or running out of moves, hands the turn to
+the player (see game_update).
+
+record_replay in record.h plays a record without the game, as fast as possible.
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+
+#include "game.h"
+#include "record.h"
+
+
+//Replay holds the state of a record being played back
+typedef struct Replay
+{
+    const GameRecord *record;
+    int nextMove;
+    bool paced;
+
+    //Start of the game the record is played into, recorded times count from it
+    unsigned int startMicroseconds;
+
+    GameEngine engine;
+} Replay;
+
+
+// Function prototypes for replays
+/////////////////////////////////////////////////////////////////////
+
+//Starts playing back a record from its first move
+//paced plays every move at its recorded time, records without timestamps are never paced
+void replay_init(Replay *replay, const GameRecord *record, bool paced);
+
+//Sets up a new game from the position the record starts from, in place of game_init
+void replay_init_game(const Replay *replay, Game *game);
+
+//Lets the replay play both sides of a game that has just been set up with replay_init_game
+void replay_attach(Replay *replay, Game *game);
+
+//Checks if every recorded move has been played
+bool replay_finished(const Replay *replay);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
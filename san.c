@@ -0,0 +1,172 @@
+/*
+Standard Algebraic Notation (SAN) moves.
+*/
+
+#include <stdbool.h>
+
+#include "san.h"
+
+
+//Letters of the pieces indexed by piece ID, pawns have none
+static const char PIECE_LETTERS[] = "  NBRQK";
+
+
+// Function prototypes for SAN helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the piece ID for a SAN piece letter, EMPTY_SQUARE if it is not one
+static PieceIdx piece_for_letter(char letter);
+
+//Checks if a character is a file, a-h
+static bool is_file(char character);
+
+//Checks if a character is a rank, 1-8
+static bool is_rank(char character);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for SAN
+/////////////////////////////////////////////////////////////////////
+
+//Finds the move the side to move makes for the SAN text of length characters
+//Check, mate and annotation marks at the end (+ # ! ?) are ignored
+SanStatus san_resolve(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, const char *text, int length, SanMove *move) {
+
+    //Drops the marks at the end
+    while (length > 0 && (text[length - 1] == '+' || text[length - 1] == '#' || text[length - 1] == '!' || text[length - 1] == '?')) {
+        length--;
+    }
+    if (length < 2) {
+        return SAN_SYNTAX;
+    }
+
+    //Castling, also written with zeros
+    if (text[0] == 'O' || text[0] == '0') {
+        return SAN_UNSUPPORTED;
+    }
+
+    //Promotion: e8=Q, or e8Q in older files
+    if (text[length - 2] == '=' || (length >= 3 && piece_for_letter(text[length - 1]) != EMPTY_SQUARE && is_rank(text[length - 2]))) {
+        return SAN_UNSUPPORTED;
+    }
+
+    //The piece, a pawn if there is no letter
+    int position = 0;
+    PieceIdx piece = piece_for_letter(text[0]);
+    if (piece == EMPTY_SQUARE) {
+        piece = PAWN;
+    } else {
+        position++;
+    }
+
+    //The end square is always the last two characters
+    if (!is_file(text[length - 2]) || !is_rank(text[length - 1])) {
+        return SAN_SYNTAX;
+    }
+    int xCoordEnd = text[length - 2] - 'a';
+    int yCoordEnd = '8' - text[length - 1];
+
+    //Whatever is between the piece and the end square tells the start square apart
+    int xCoordFrom = -1;
+    int yCoordFrom = -1;
+    for (; position < length - 2; position++) {
+        char character = text[position];
+        if (is_file(character)) {
+            xCoordFrom = character - 'a';
+        } else if (is_rank(character)) {
+            yCoordFrom = '8' - character;
+        } else if (character != 'x' && character != ':' && character != '-') {
+            return SAN_SYNTAX;
+        }
+    }
+
+    //Pawns that do not capture stay on their file
+    if (piece == PAWN && xCoordFrom < 0) {
+        xCoordFrom = xCoordEnd;
+    }
+
+    //Every piece of that kind and colour that the rules let go to the end square
+    int matches = 0;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+
+        if (yCoordFrom >= 0 && yCoord != yCoordFrom) {
+            continue;
+        }
+
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+
+            if (xCoordFrom >= 0 && xCoord != xCoordFrom) {
+                continue;
+            }
+
+            //The side to move's piece of that type packs to one value
+            if (board[yCoord][xCoord] != PACK_PIECE(piece, currentTurn)) {
+                continue;
+            }
+
+            //The cheap check first, is_valid_move copies the board to test for check
+            if (!is_valid_move_without_check(board, xCoord, yCoord, xCoordEnd, yCoordEnd, currentTurn)
+                || !is_valid_move(board, xCoord, yCoord, xCoordEnd, yCoordEnd, currentTurn)) {
+                continue;
+            }
+
+            move->xCoordStart = xCoord;
+            move->yCoordStart = yCoord;
+            matches++;
+        }
+    }
+
+    if (matches == 0) {
+        return SAN_ILLEGAL;
+    }
+    if (matches > 1) {
+        return SAN_AMBIGUOUS;
+    }
+
+    move->xCoordEnd = xCoordEnd;
+    move->yCoordEnd = yCoordEnd;
+    return SAN_OK;
+}
+
+//Returns a short description of a status, e.g. "illegal"
+const char * san_status_name(SanStatus status) {
+
+    switch (status) {
+        case SAN_OK:          return "ok";
+        case SAN_SYNTAX:      return "not a move";
+        case SAN_ILLEGAL:     return "illegal";
+        case SAN_AMBIGUOUS:   return "ambiguous";
+        case SAN_UNSUPPORTED: return "castling or promotion";
+        default:              return "unknown";
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for SAN helpers
+/////////////////////////////////////////////////////////////////////
+
+//Returns the piece ID for a SAN piece letter, EMPTY_SQUARE if it is not one
+static PieceIdx piece_for_letter(char letter) {
+
+    for (PieceIdx piece = KNIGHT; piece <= KING; piece++) {
+        if (PIECE_LETTERS[piece] == letter) {
+            return piece;
+        }
+    }
+    return EMPTY_SQUARE;
+}
+
+//Checks if a character is a file, a-h
+static bool is_file(char character) {
+    return character >= 'a' && character <= 'h';
+}
+
+//Checks if a character is a rank, 1-8
+static bool is_rank(char character) {
+    return character >= '1' && character <= '8';
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,58 @@
+/*
+Standard Algebraic Notation (SAN) moves, as written in PGN files: e4, Nbd7, exd5, R1e2+.
+
+A SAN move names the piece and the end square, and only as much of the start square as
+it takes to tell apart two pieces that could both go there. san_resolve finds the start
+square with the rules in chess.c, so a move is only accepted if the board would allow it.
+The rules do not castle or promote, so O-O, O-O-O and promotions are reported as such
+rather than as illegal moves.
+*/
+
+#ifndef SAN_H
+#define SAN_H
+
+#include "chess.h"
+
+
+//SanStatus lists the results of resolving a move
+typedef enum SanStatus
+{
+    SAN_OK,
+
+    //Not SAN at all
+    SAN_SYNTAX,
+
+    //No piece of the side to move can make the move
+    SAN_ILLEGAL,
+
+    //More than one piece matches, the move needed more of its start square
+    SAN_AMBIGUOUS,
+
+    //Castling and promotion, which the rules do not have
+    SAN_UNSUPPORTED
+} SanStatus;
+
+
+//SanMove holds a resolved move
+typedef struct SanMove
+{
+    int xCoordStart;
+    int yCoordStart;
+    int xCoordEnd;
+    int yCoordEnd;
+} SanMove;
+
+
+// Function prototypes for SAN
+/////////////////////////////////////////////////////////////////////
+
+//Finds the move the side to move makes for the SAN text of length characters
+//Check, mate and annotation marks at the end (+ # ! ?) are ignored
+SanStatus san_resolve(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, const char *text, int length, SanMove *move);
+
+//Returns a short description of a status, e.g. "illegal"
+const char * san_status_name(SanStatus status);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,111 @@
+/*
+Cooperative scheduler that shares the single core between the game tasks.
+*/
+
+#include <stddef.h>
+
+#include "scheduler.h"
+#include "timer.h"
+
+
+//TaskSlot holds a task and its time accounting
+typedef struct TaskSlot
+{
+    SchedulerTask task;
+    void *context;
+    SchedulerTaskStats stats;
+} TaskSlot;
+
+
+static TaskSlot tasks[SCHEDULER_MAX_TASKS];
+static int taskCount = 0;
+
+
+// Function definitions for the scheduler
+/////////////////////////////////////////////////////////////////////
+
+//Removes all tasks
+void scheduler_init() {
+    taskCount = 0;
+}
+
+//Adds a task that runs once per tick, in the order the tasks were added
+//Returns the index of the task, or -1 if there is no room for it
+int scheduler_add_task(const char *name, SchedulerTask task, void *context, unsigned int budgetMicroseconds) {
+
+    if (taskCount == SCHEDULER_MAX_TASKS) {
+        return -1;
+    }
+
+    TaskSlot *slot = &tasks[taskCount];
+    slot->task = task;
+    slot->context = context;
+
+    SchedulerTaskStats stats = {name, budgetMicroseconds, 0, 0, 0, 0};
+    slot->stats = stats;
+
+    return taskCount++;
+}
+
+//Runs every task once
+//Returns true if any task has more work to do, false if all of them are idle
+bool scheduler_tick() {
+
+    bool busy = false;
+
+    for (int index = 0; index < taskCount; index++) {
+
+        TaskSlot *slot = &tasks[index];
+        unsigned int start = timer_microseconds();
+
+        if (slot->task(slot->context, start + slot->stats.budgetMicroseconds)) {
+            busy = true;
+        }
+
+        unsigned int elapsed = timer_microseconds() - start;
+        slot->stats.runs++;
+        slot->stats.totalMicroseconds += elapsed;
+        if (elapsed > slot->stats.maxMicroseconds) {
+            slot->stats.maxMicroseconds = elapsed;
+        }
+        if (elapsed > slot->stats.budgetMicroseconds) {
+            slot->stats.overruns++;
+        }
+    }
+
+    return busy;
+}
+
+//Checks if a deadline given to a task has passed
+//The difference is taken as signed so the check works across the wrap of the clock
+bool scheduler_deadline_passed(unsigned int deadline) {
+    return (int) (timer_microseconds() - deadline) >= 0;
+}
+
+//Returns the number of tasks added
+int scheduler_task_count() {
+    return taskCount;
+}
+
+//Returns the time accounting of a task
+const SchedulerTaskStats * scheduler_task_stats(int task) {
+
+    if (task < 0 || task >= taskCount) {
+        return NULL;
+    }
+
+    return &tasks[task].stats;
+}
+
+//Clears the time accounting of every task
+void scheduler_reset_stats() {
+
+    for (int index = 0; index < taskCount; index++) {
+        tasks[index].stats.runs = 0;
+        tasks[index].stats.overruns = 0;
+        tasks[index].stats.totalMicroseconds = 0;
+        tasks[index].stats.maxMicroseconds = 0;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,73 @@
+/*
+Cooperative scheduler that shares the single core between the game tasks.
+
+Every tick runs each task once. A task gets a deadline (its time budget from the start
+of its turn) and must return by then; nothing preempts it, so a task that needs more
+time keeps its state and continues on the next tick. The time each task actually used
+is recorded so budget overruns can be found on the board.
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+
+
+// Largest number of tasks that can be added
+#define SCHEDULER_MAX_TASKS 8
+
+
+//SchedulerTask is the function called for a task once per tick
+//deadline is a timer_microseconds value, the task should return once scheduler_deadline_passed says so
+//Returns true if the task has more work to do right away, false if it is idle until something changes
+typedef bool (*SchedulerTask)(void *context, unsigned int deadline);
+
+
+//SchedulerTaskStats holds the time accounting of one task
+typedef struct SchedulerTaskStats
+{
+    //Name of the task, for printing the statistics
+    const char *name;
+
+    //Time the task may use per tick, in microseconds
+    unsigned int budgetMicroseconds;
+
+    //Number of times the task ran and how many of those went over the budget
+    int runs;
+    int overruns;
+
+    //Time spent in the task, in microseconds
+    unsigned int totalMicroseconds;
+    unsigned int maxMicroseconds;
+} SchedulerTaskStats;
+
+
+// Function prototypes for the scheduler
+/////////////////////////////////////////////////////////////////////
+
+//Removes all tasks
+void scheduler_init();
+
+//Adds a task that runs once per tick, in the order the tasks were added
+//Returns the index of the task, or -1 if there is no room for it
+int scheduler_add_task(const char *name, SchedulerTask task, void *context, unsigned int budgetMicroseconds);
+
+//Runs every task once
+//Returns true if any task has more work to do, false if all of them are idle
+bool scheduler_tick();
+
+//Checks if a deadline given to a task has passed
+bool scheduler_deadline_passed(unsigned int deadline);
+
+//Returns the number of tasks added
+int scheduler_task_count();
+
+//Returns the time accounting of a task
+const SchedulerTaskStats * scheduler_task_stats(int task);
+
+//Clears the time accounting of every task
+void scheduler_reset_stats();
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
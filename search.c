@@ -0,0 +1,768 @@
+/*
+Game tree search for the engine.
+*/
+
+#include <string.h>
+
+#include "search.h"
+#include "eval.h"
+#include "nnue.h"
+#include "timer.h"
+
+
+// Move ordering: captures first, most valuable victim and least valuable attacker ahead,
+// then the killer moves, then quiet moves by their history
+#define ORDER_CAPTURE 1000000
+#define ORDER_KILLER  900000
+#define ORDER_HISTORY_MAX (ORDER_KILLER - 1)
+
+// Null move: the search after passing is NULL_MOVE_REDUCTION plies shallower, a ply more from NULL_MOVE_DEEP_DEPTH on
+// A side with NULL_MOVE_VERIFY_PIECES pieces or fewer besides its king and pawns has its pass confirmed
+#define NULL_MOVE_MIN_DEPTH     3
+#define NULL_MOVE_REDUCTION     2
+#define NULL_MOVE_DEEP_DEPTH    7
+#define NULL_MOVE_VERIFY_PIECES 2
+
+// Late move reductions: from REDUCTION_MIN_DEPTH on, quiet moves after the first REDUCTION_MIN_MOVES lose a ply,
+// and two once both the depth and the move number reach the deep values
+#define REDUCTION_MIN_DEPTH  3
+#define REDUCTION_MIN_MOVES  3
+#define REDUCTION_DEEP_DEPTH 6
+#define REDUCTION_DEEP_MOVES 8
+
+// Futility pruning applies up to FUTILITY_DEPTH plies from the horizon, with a margin in centipawns for each
+// Reverse futility up to REVERSE_FUTILITY_DEPTH, with a margin per ply
+#define FUTILITY_DEPTH          2
+#define REVERSE_FUTILITY_DEPTH  3
+#define REVERSE_FUTILITY_MARGIN 120
+static const int FUTILITY_MARGINS[FUTILITY_DEPTH + 1] = {0, 200, 500};
+
+
+// Function prototypes for search helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if a limit has been reached, looking at the clock every SEARCH_CLOCK_NODES nodes
+static bool reached_limit(Search *search);
+
+//Checks if a move takes the king, which the rules allow when a pawn attacks a white king
+static bool takes_king(const Search *search, Move move);
+
+//Checks if positions are scored with the network
+static bool uses_network(const Search *search);
+
+//Checks if a score is a mate for either side
+static bool is_mate_score(int score);
+
+//Counts the pieces of a colour besides its king and pawns
+static int count_pieces(const Search *search, int colour);
+
+//Returns the score of the position at ply for the side to move
+static int evaluate_position(Search *search, int ply);
+
+//Makes a move from the position at ply and hands the turn over, the network's accumulator follows
+static MoveUndo make_search_move(Search *search, Move move, int ply);
+
+//Takes back a move made with make_search_move
+static void unmake_search_move(Search *search, Move move, MoveUndo undo);
+
+//Checks if the side to move is in check, the side that just moved gave it
+static bool is_checked(Search *search);
+
+//Passes the turn, for the null move, the network's accumulator is the same as at ply
+static void make_null_move(Search *search, int ply);
+
+//Searches the position with the turn passed, and with few pieces again without passing
+//Returns true and sets score if the side to move is still at beta or above
+static bool null_move_cuts(Search *search, int depth, int ply, int beta, int *score);
+
+//Gives every move a score to order them by
+static void score_moves(const Search *search, const Move *moves, int *scores, int count, int ply);
+
+//Swaps the move with the highest score into place index
+static void pick_move(Move *moves, int *scores, int count, int index);
+
+//Remembers a quiet move that caused a cutoff
+static void update_quiet_cutoff(Search *search, Move move, int depth, int ply);
+
+//Makes the line at ply the move followed by the line found below it
+static void update_pv(Search *search, Move move, int ply);
+
+//Searches captures until the position is quiet
+static int quiescence(Search *search, int ply, int alpha, int beta);
+
+//Searches a position to depth, returns its score for the side to move
+//nullAllowed is false right after a null move, so a side never passes twice in a row
+static int alpha_beta(Search *search, int depth, int ply, int alpha, int beta, bool nullAllowed);
+
+//Returns the number of lines the root keeps
+static int wanted_lines(const Search *search);
+
+//Moves a root move to the front of the root moves
+static void move_to_front(Search *search, Move move);
+
+//Adds a root move whose line was just found to the best lines of the current depth, in order of score
+static void insert_line(Search *search, Move move, int score);
+
+//Makes the best lines of the current depth the result of the search
+static void take_iteration(Search *search);
+
+//Adds sign times the counts of stats to total
+static void add_stats(SearchStats *total, const SearchStats *stats, int sign);
+
+//Keeps the finished depth with its counts, and starts counting the next one
+static void record_iteration(Search *search);
+
+//Searches the next root move of the current depth
+static void search_root_move(Search *search);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the search
+/////////////////////////////////////////////////////////////////////
+
+//Fills options with every part of the search turned on
+void search_options_init(SearchOptions *options) {
+
+    options->quiescence = true;
+    options->killers = true;
+    options->history = true;
+    options->nullMove = true;
+    options->reductions = true;
+    options->futility = true;
+    options->reverseFutility = true;
+    options->checkExtensions = true;
+    options->nnue = false;
+    options->lines = 1;
+}
+
+//Sets up a search with empty tables and no network
+void search_init(Search *search, const SearchOptions *options) {
+
+    memset(search, 0, sizeof(*search));
+    search->options = *options;
+    search->finished = true;
+}
+
+//Sets the network the nnue option scores with, NULL for none
+void search_set_network(Search *search, const NnueNetwork *network) {
+    search->network = network;
+}
+
+//Starts searching a position, the board is copied
+void search_start(Search *search, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, const SearchLimits *limits) {
+
+    copy_board(board, search->board);
+    search->currentTurn = currentTurn;
+    search->limits = *limits;
+    search->startMicroseconds = timer_microseconds();
+
+    search->rootCount = generate_moves(search->board, currentTurn, search->rootMoves);
+    search->rootIndex = 0;
+    search->depth = 1;
+
+    Move noMove = {0, 0};
+    search->bestMove = search->rootCount > 0 ? search->rootMoves[0] : noMove;
+    search->bestScore = 0;
+    search->completedDepth = 0;
+    search->pv[0] = search->bestMove;
+    search->pvLength = search->rootCount > 0 ? 1 : 0;
+    search->lines[0].pv[0] = search->bestMove;
+    search->lines[0].pvLength = search->pvLength;
+    search->lines[0].score = 0;
+    search->lineCount = search->pvLength;
+    memset(&search->stats, 0, sizeof(search->stats));
+    search->depthStats = search->stats;
+    search->stopped = false;
+    __atomic_store_n(&search->stopRequested, false, __ATOMIC_RELAXED);
+
+    //The accumulator of the root is summed once, every other one is updated from its parent
+    if (uses_network(search)) {
+        nnue_refresh(search->network, search->board, &search->accumulators[0]);
+    }
+
+    //With one move or none there is nothing to choose
+    search->finished = search->rootCount <= 1;
+
+    //Killers belong to a position, history only fades
+    memset(search->killers, 0, sizeof(search->killers));
+    for (int start = 0; start < BOARD_SIZE * BOARD_SIZE; start++) {
+        for (int end = 0; end < BOARD_SIZE * BOARD_SIZE; end++) {
+            search->history[start][end] /= 2;
+        }
+    }
+}
+
+//Searches root moves until the deadline (a timer_microseconds value) has passed, at least one
+//Returns true once the search has finished and bestMove holds the move to play
+bool search_step(Search *search, unsigned int deadline) {
+
+    while (!search->finished) {
+
+        search_root_move(search);
+
+        if ((int) (timer_microseconds() - deadline) >= 0) {
+            break;
+        }
+    }
+
+    return search->finished;
+}
+
+//Searches until a limit is reached
+void search_run(Search *search) {
+
+    while (!search_step(search, timer_microseconds()));
+}
+
+//Makes the search finish as soon as it can, safe to call from another thread than the one searching
+void search_stop(Search *search) {
+    __atomic_store_n(&search->stopRequested, true, __ATOMIC_RELAXED);
+}
+
+//Returns the time since search_start, in microseconds
+unsigned int search_elapsed(const Search *search) {
+    return timer_microseconds() - search->startMicroseconds;
+}
+
+//Adds the counts of stats to total, for tools that run searches on several threads
+void search_stats_add(SearchStats *total, const SearchStats *stats) {
+    add_stats(total, stats, 1);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for search helpers
+/////////////////////////////////////////////////////////////////////
+
+//Checks if a limit has been reached, looking at the clock every SEARCH_CLOCK_NODES nodes
+static bool reached_limit(Search *search) {
+
+    if (search->stopped) {
+        return true;
+    }
+
+    if (search->limits.nodes > 0 && search->stats.nodes >= search->limits.nodes) {
+        search->stopped = true;
+    } else if (search->stats.nodes % SEARCH_CLOCK_NODES == 0) {
+        search->stopped = __atomic_load_n(&search->stopRequested, __ATOMIC_RELAXED)
+            || (search->limits.milliseconds > 0 && search_elapsed(search) >= search->limits.milliseconds * 1000u);
+    }
+
+    return search->stopped;
+}
+
+//Checks if a move takes the king, which the rules allow when a pawn attacks a white king
+static bool takes_king(const Search *search, Move move) {
+    return PACKED_PIECE_ID(search->board[MOVE_Y(move.end)][MOVE_X(move.end)]) == KING;
+}
+
+//Checks if positions are scored with the network
+static bool uses_network(const Search *search) {
+    return search->options.nnue && search->network != NULL;
+}
+
+//Checks if a score is a mate for either side
+static bool is_mate_score(int score) {
+    return score > SEARCH_MATE - SEARCH_MAX_DEPTH || score < -(SEARCH_MATE - SEARCH_MAX_DEPTH);
+}
+
+//Counts the pieces of a colour besides its king and pawns
+static int count_pieces(const Search *search, int colour) {
+
+    int count = 0;
+    for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+        for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+            PackedSquare square = search->board[yCoord][xCoord];
+            PieceIdx piece = PACKED_PIECE_ID(square);
+            count += piece != EMPTY_SQUARE && piece != PAWN && piece != KING && PACKED_COLOUR(square) == colour;
+        }
+    }
+    return count;
+}
+
+//Returns the score of the position at ply for the side to move
+static int evaluate_position(Search *search, int ply) {
+
+    if (uses_network(search)) {
+        return nnue_evaluate(search->network, &search->accumulators[ply], search->currentTurn);
+    }
+    return evaluate(search->board, search->currentTurn);
+}
+
+//Makes a move from the position at ply and hands the turn over, the network's accumulator follows
+static MoveUndo make_search_move(Search *search, Move move, int ply) {
+
+    //The update reads the moving and captured pieces, so it comes before the move
+    if (uses_network(search)) {
+        nnue_update(search->network, &search->accumulators[ply], &search->accumulators[ply + 1], search->board, move);
+    }
+
+    MoveUndo undo = make_move(search->board, move);
+    switch_turns(&search->currentTurn);
+    return undo;
+}
+
+//Takes back a move made with make_search_move
+static void unmake_search_move(Search *search, Move move, MoveUndo undo) {
+
+    switch_turns(&search->currentTurn);
+    unmake_move(search->board, move, undo);
+}
+
+//Checks if the side to move is in check, the side that just moved gave it
+static bool is_checked(Search *search) {
+    return is_in_check(search->board, search->currentTurn);
+}
+
+//Passes the turn, for the null move, the network's accumulator is the same as at ply
+//Passing again takes it back
+static void make_null_move(Search *search, int ply) {
+
+    if (uses_network(search)) {
+        search->accumulators[ply + 1] = search->accumulators[ply];
+    }
+    switch_turns(&search->currentTurn);
+}
+
+//Searches the position with the turn passed, and with few pieces again without passing
+//Returns true and sets score if the side to move is still at beta or above
+static bool null_move_cuts(Search *search, int depth, int ply, int beta, int *score) {
+
+    int pieces = count_pieces(search, search->currentTurn);
+    int reduction = NULL_MOVE_REDUCTION + (depth >= NULL_MOVE_DEEP_DEPTH);
+
+    //With only pawns left passing is often the best move there is, which the rules do not allow
+    if (pieces == 0) {
+        return false;
+    }
+
+    make_null_move(search, ply);
+    int passed = -alpha_beta(search, depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+    make_null_move(search, ply);
+
+    if (search->stopped || passed < beta) {
+        return false;
+    }
+
+    //A mate found after passing is not a mate the side can force
+    if (is_mate_score(passed)) {
+        passed = beta;
+    }
+
+    //With few pieces zugzwang is still likely, so the same reduced depth has to hold without passing
+    if (pieces <= NULL_MOVE_VERIFY_PIECES) {
+        int verified = alpha_beta(search, depth - 1 - reduction, ply, beta - 1, beta, false);
+        search->pvTableLength[ply] = 0;
+        if (search->stopped || verified < beta) {
+            return false;
+        }
+    }
+
+    *score = passed;
+    return true;
+}
+
+//Gives every move a score to order them by
+static void score_moves(const Search *search, const Move *moves, int *scores, int count, int ply) {
+
+    for (int index = 0; index < count; index++) {
+
+        Move move = moves[index];
+        PieceIdx victim = PACKED_PIECE_ID(search->board[MOVE_Y(move.end)][MOVE_X(move.end)]);
+
+        if (victim != EMPTY_SQUARE) {
+            PieceIdx attacker = PACKED_PIECE_ID(search->board[MOVE_Y(move.start)][MOVE_X(move.start)]);
+            scores[index] = ORDER_CAPTURE + victim * 16 - attacker;
+        } else if (search->options.killers && ply < SEARCH_MAX_DEPTH
+            && move.start == search->killers[ply][0].start && move.end == search->killers[ply][0].end) {
+            scores[index] = ORDER_KILLER + 1;
+        } else if (search->options.killers && ply < SEARCH_MAX_DEPTH
+            && move.start == search->killers[ply][1].start && move.end == search->killers[ply][1].end) {
+            scores[index] = ORDER_KILLER;
+        } else if (search->options.history) {
+            int history = search->history[move.start][move.end];
+            scores[index] = history < ORDER_HISTORY_MAX ? history : ORDER_HISTORY_MAX;
+        } else {
+            scores[index] = 0;
+        }
+    }
+}
+
+//Swaps the move with the highest score into place index
+static void pick_move(Move *moves, int *scores, int count, int index) {
+
+    int best = index;
+    for (int other = index + 1; other < count; other++) {
+        if (scores[other] > scores[best]) {
+            best = other;
+        }
+    }
+
+    Move move = moves[index];
+    moves[index] = moves[best];
+    moves[best] = move;
+
+    int score = scores[index];
+    scores[index] = scores[best];
+    scores[best] = score;
+}
+
+//Remembers a quiet move that caused a cutoff
+static void update_quiet_cutoff(Search *search, Move move, int depth, int ply) {
+
+    if (search->options.killers && ply < SEARCH_MAX_DEPTH
+        && (move.start != search->killers[ply][0].start || move.end != search->killers[ply][0].end)) {
+        search->killers[ply][1] = search->killers[ply][0];
+        search->killers[ply][0] = move;
+    }
+
+    if (search->options.history) {
+        search->history[move.start][move.end] += depth * depth;
+    }
+}
+
+//Makes the line at ply the move followed by the line found below it
+static void update_pv(Search *search, Move move, int ply) {
+
+    int childLength = ply + 1 < SEARCH_MAX_DEPTH ? search->pvTableLength[ply + 1] : 0;
+    search->pvTable[ply][0] = move;
+    memcpy(&search->pvTable[ply][1], search->pvTable[ply + 1], childLength * sizeof(Move));
+    search->pvTableLength[ply] = childLength + 1;
+}
+
+//Searches captures until the position is quiet
+static int quiescence(Search *search, int ply, int alpha, int beta) {
+
+    //Captures are not part of the principal variation
+    search->pvTableLength[ply] = 0;
+
+    search->stats.nodes++;
+    search->stats.quiescenceNodes++;
+    if (reached_limit(search)) {
+        return 0;
+    }
+
+    //Standing pat: the side to move does not have to capture
+    int standPat = evaluate_position(search, ply);
+    if (standPat >= beta || ply >= SEARCH_MAX_DEPTH - 1) {
+        return standPat;
+    }
+    if (standPat > alpha) {
+        alpha = standPat;
+    }
+
+    Move moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    int count = generate_captures(search->board, search->currentTurn, moves);
+    score_moves(search, moves, scores, count, ply);
+
+    for (int index = 0; index < count; index++) {
+
+        pick_move(moves, scores, count, index);
+        Move move = moves[index];
+        if (takes_king(search, move)) {
+            return SEARCH_MATE - ply;
+        }
+
+        MoveUndo undo = make_search_move(search, move, ply);
+        int score = -quiescence(search, ply + 1, -beta, -alpha);
+        unmake_search_move(search, move, undo);
+
+        if (search->stopped) {
+            return 0;
+        }
+        if (score >= beta) {
+            return score;
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+    }
+
+    return alpha;
+}
+
+//Searches a position to depth, returns its score for the side to move
+//nullAllowed is false right after a null move, so a side never passes twice in a row
+static int alpha_beta(Search *search, int depth, int ply, int alpha, int beta, bool nullAllowed) {
+
+    search->pvTableLength[ply] = 0;
+
+    //A check is only looked for when a part of the search that depends on it is on, at the horizon only the extension does
+    const SearchOptions *options = &search->options;
+    bool selective = options->nullMove || options->reductions || options->futility || options->reverseFutility;
+    bool checkNeeded = options->checkExtensions || (selective && depth > 0);
+    bool inCheck = checkNeeded && ply < SEARCH_MAX_DEPTH - 1 && is_checked(search);
+
+    //A check at the horizon is answered before the position is scored, as long as the line is not twice the depth
+    if (inCheck && options->checkExtensions && ply < 2 * search->depth) {
+        search->stats.checkExtensions++;
+        depth++;
+    }
+
+    if (depth <= 0) {
+        if (options->quiescence) {
+            return quiescence(search, ply, alpha, beta);
+        }
+        search->stats.nodes++;
+        return evaluate_position(search, ply);
+    }
+
+    search->stats.nodes++;
+    if (reached_limit(search)) {
+        return 0;
+    }
+    if (ply >= SEARCH_MAX_DEPTH - 1) {
+        return evaluate_position(search, ply);
+    }
+
+    //The position is only scored here for the pruning that compares it with alpha or beta
+    bool frontier = depth <= FUTILITY_DEPTH || depth <= REVERSE_FUTILITY_DEPTH;
+    bool scored = !inCheck && (options->nullMove || (frontier && (options->futility || options->reverseFutility)));
+    int staticScore = scored ? evaluate_position(search, ply) : 0;
+
+    //Reverse futility: so far above beta near the horizon that no reply is expected to bring it down
+    if (scored && options->reverseFutility && depth <= REVERSE_FUTILITY_DEPTH && !is_mate_score(beta)
+        && staticScore - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+        search->stats.reverseFutilityCutoffs++;
+        return staticScore - REVERSE_FUTILITY_MARGIN * depth;
+    }
+
+    //Null move: still at beta after giving the other side a free move
+    int nullScore;
+    if (scored && options->nullMove && nullAllowed && depth >= NULL_MOVE_MIN_DEPTH && staticScore >= beta && !is_mate_score(beta)
+        && null_move_cuts(search, depth, ply, beta, &nullScore)) {
+        search->stats.nullMoveCutoffs++;
+        return nullScore;
+    }
+    if (search->stopped) {
+        return 0;
+    }
+
+    Move moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    int count = generate_moves(search->board, search->currentTurn, moves);
+
+    //No moves is checkmate or stalemate, as the rules decide in is_game_over
+    if (count == 0) {
+        return is_in_check(search->board, search->currentTurn) ? -(SEARCH_MATE - ply) : 0;
+    }
+
+    score_moves(search, moves, scores, count, ply);
+
+    //Futility: near the horizon and so far below alpha that only a capture is expected to help
+    bool futile = scored && options->futility && depth <= FUTILITY_DEPTH && !is_mate_score(alpha)
+        && staticScore + FUTILITY_MARGINS[depth] <= alpha;
+
+    int bestScore = -SEARCH_INFINITE;
+    int searched = 0;
+    for (int index = 0; index < count; index++) {
+
+        pick_move(moves, scores, count, index);
+        Move move = moves[index];
+        if (takes_king(search, move)) {
+            return SEARCH_MATE - ply;
+        }
+
+        //A futile quiet move is skipped before it is made, looking for the few that give check costs more than it keeps
+        bool quiet = !is_capture(search->board, move);
+        if (futile && quiet) {
+            search->stats.futilityPrunes++;
+            if (staticScore + FUTILITY_MARGINS[depth] > bestScore) {
+                bestScore = staticScore + FUTILITY_MARGINS[depth];
+            }
+            continue;
+        }
+
+        bool late = quiet && scores[index] < ORDER_KILLER && !inCheck;
+        bool reducible = late && options->reductions && depth >= REDUCTION_MIN_DEPTH && index >= REDUCTION_MIN_MOVES;
+        MoveUndo undo = make_search_move(search, move, ply);
+
+        //A move that gives check is never reduced
+        bool givesCheck = reducible && is_checked(search);
+
+        //A late move is searched shallower with a null window, and again in full only if it beats alpha
+        int score;
+        int reduction = reducible && !givesCheck ? 1 + (depth >= REDUCTION_DEEP_DEPTH && index >= REDUCTION_DEEP_MOVES) : 0;
+        if (reduction > 0) {
+            search->stats.reductions++;
+            score = -alpha_beta(search, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha, true);
+            if (score > alpha && !search->stopped) {
+                search->stats.reSearches++;
+                score = -alpha_beta(search, depth - 1, ply + 1, -beta, -alpha, true);
+            }
+        } else {
+            score = -alpha_beta(search, depth - 1, ply + 1, -beta, -alpha, true);
+        }
+        unmake_search_move(search, move, undo);
+        searched++;
+
+        if (search->stopped) {
+            return 0;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+        }
+        if (score > alpha) {
+            alpha = score;
+            update_pv(search, move, ply);
+        }
+        if (alpha >= beta) {
+            search->stats.cutoffs++;
+            search->stats.firstMoveCutoffs += searched == 1;
+            if (quiet) {
+                update_quiet_cutoff(search, move, depth, ply);
+            }
+            break;
+        }
+    }
+
+    return bestScore;
+}
+
+//Returns the number of lines the root keeps
+static int wanted_lines(const Search *search) {
+
+    int lines = search->options.lines;
+    return lines < 1 ? 1 : lines > SEARCH_MAX_LINES ? SEARCH_MAX_LINES : lines;
+}
+
+//Moves a root move to the front of the root moves
+static void move_to_front(Search *search, Move move) {
+
+    for (int index = 0; index < search->rootCount; index++) {
+        if (search->rootMoves[index].start == move.start && search->rootMoves[index].end == move.end) {
+            memmove(&search->rootMoves[1], &search->rootMoves[0], index * sizeof(Move));
+            search->rootMoves[0] = move;
+            return;
+        }
+    }
+}
+
+//Adds a root move whose line was just found to the best lines of the current depth, in order of score
+//A line scoring the same as one already kept goes after it, the last line drops out once all are taken
+static void insert_line(Search *search, Move move, int score) {
+
+    int wanted = wanted_lines(search);
+    int place = search->iterationLineCount;
+    while (place > 0 && search->iterationLines[place - 1].score < score) {
+        place--;
+    }
+
+    int count = search->iterationLineCount < wanted ? search->iterationLineCount + 1 : wanted;
+    memmove(&search->iterationLines[place + 1], &search->iterationLines[place], (count - 1 - place) * sizeof(SearchLine));
+    search->iterationLineCount = count;
+
+    update_pv(search, move, 0);
+    SearchLine *line = &search->iterationLines[place];
+    memcpy(line->pv, search->pvTable[0], search->pvTableLength[0] * sizeof(Move));
+    line->pvLength = search->pvTableLength[0];
+    line->score = score;
+}
+
+//Makes the best lines of the current depth the result of the search
+static void take_iteration(Search *search) {
+
+    memcpy(search->lines, search->iterationLines, search->iterationLineCount * sizeof(SearchLine));
+    search->lineCount = search->iterationLineCount;
+
+    const SearchLine *best = &search->lines[0];
+    search->bestMove = best->pv[0];
+    search->bestScore = best->score;
+    memcpy(search->pv, best->pv, best->pvLength * sizeof(Move));
+    search->pvLength = best->pvLength;
+}
+
+//Adds sign times the counts of stats to total
+static void add_stats(SearchStats *total, const SearchStats *stats, int sign) {
+
+    total->nodes += sign * stats->nodes;
+    total->quiescenceNodes += sign * stats->quiescenceNodes;
+    total->cutoffs += sign * stats->cutoffs;
+    total->firstMoveCutoffs += sign * stats->firstMoveCutoffs;
+    total->nullMoveCutoffs += sign * stats->nullMoveCutoffs;
+    total->reverseFutilityCutoffs += sign * stats->reverseFutilityCutoffs;
+    total->futilityPrunes += sign * stats->futilityPrunes;
+    total->reductions += sign * stats->reductions;
+    total->reSearches += sign * stats->reSearches;
+    total->checkExtensions += sign * stats->checkExtensions;
+}
+
+//Keeps the finished depth with its counts, and starts counting the next one
+static void record_iteration(Search *search) {
+
+    SearchIteration *iteration = &search->iterations[search->depth - 1];
+    iteration->depth = search->depth;
+    iteration->score = search->bestScore;
+    iteration->microseconds = search_elapsed(search);
+    memcpy(iteration->pv, search->pv, search->pvLength * sizeof(Move));
+    iteration->pvLength = search->pvLength;
+
+    iteration->stats = search->stats;
+    add_stats(&iteration->stats, &search->depthStats, -1);
+    search->depthStats = search->stats;
+}
+
+//Searches the next root move of the current depth
+static void search_root_move(Search *search) {
+
+    //A new depth starts with the best lines of the last one, in their order
+    if (search->rootIndex == 0) {
+        search->iterationLineCount = 0;
+        for (int line = search->lineCount - 1; line >= 0; line--) {
+            move_to_front(search, search->lines[line].pv[0]);
+        }
+    }
+
+    //A move only has to be searched exactly if it can take the place of the last line kept
+    int wanted = wanted_lines(search);
+    int alpha = search->iterationLineCount < wanted ? -SEARCH_INFINITE : search->iterationLines[wanted - 1].score;
+
+    Move move = search->rootMoves[search->rootIndex];
+    int score;
+    search->pvTableLength[1] = 0;
+    if (takes_king(search, move)) {
+        score = SEARCH_MATE;
+    } else {
+        MoveUndo undo = make_search_move(search, move, 0);
+        score = -alpha_beta(search, search->depth - 1, 1, -SEARCH_INFINITE, -alpha, true);
+        unmake_search_move(search, move, undo);
+    }
+
+    //A depth cut short still improves on the last one once its first move, the last best, is searched
+    //Only the moves searched so far have lines then
+    if (search->stopped) {
+        if (search->rootIndex > 0) {
+            take_iteration(search);
+        }
+        search->finished = true;
+        return;
+    }
+
+    if (score > alpha) {
+        insert_line(search, move, score);
+    }
+
+    if (++search->rootIndex < search->rootCount) {
+        return;
+    }
+
+    take_iteration(search);
+    record_iteration(search);
+    search->completedDepth = search->depth;
+    search->rootIndex = 0;
+    search->depth++;
+
+    //A forced mate does not get any better deeper down
+    bool mateFound = is_mate_score(search->bestScore);
+    if ((search->limits.depth > 0 && search->depth > search->limits.depth) || search->depth >= SEARCH_MAX_DEPTH || mateFound) {
+        search->finished = true;
+    }
+    if (search->limits.milliseconds > 0 && search_elapsed(search) >= search->limits.milliseconds * 1000u) {
+        search->finished = true;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,250 @@
+/*
+Game tree search for the engine.
+
+Alpha-beta search with iterative deepening: the position is searched one ply deeper at a
+time, each depth starting with the best move of the last, until a limit on depth, nodes
+or time is reached. Captures are searched on past the last ply (quiescence) so a line is
+never scored in the middle of an exchange, and quiet moves that caused a cutoff before
+(killer moves and the history table) are tried early.
+
+A full width search only gets a few plies deep on the A9, so the search is selective,
+each part behind its own option so it can be measured on its own (bench/search_bench.c):
+  null move          a side that is still above beta after passing is not searched on;
+                     without pieces other than pawns it may be in zugzwang and never
+                     passes, and with few pieces a reduced search has to confirm the pass
+  reductions         quiet moves late in the ordering are searched a ply or two less,
+                     and again to full depth only if they turn out better than alpha
+  futility           a ply or two from the horizon, quiet moves that can not bring the
+                     score up to alpha by a margin are not searched
+  reverse futility   a ply or three from the horizon, a position whose score beats beta
+                     by a margin is not searched
+  check extensions   a side in check is searched a ply deeper, so the horizon never falls
+                     in the middle of a check
+
+With the lines option above 1 the root keeps that many best moves with exact scores
+(multi-PV): a root move only has to beat the last of the lines kept so far, and every
+depth starts with the lines of the last one in order, so the deeper search of the same
+candidates mostly confirms what it already knows.
+
+Positions are scored with eval.c, or with a network (nnue.h) once one is set with
+search_set_network and the nnue option is on. The search then keeps an accumulator for
+every ply and updates it as it makes each move.
+
+Everything a search touches lives in its Search struct, the board included, so several
+searches can run at once on different threads. A search can be stepped, finishing at
+least one root move per call to search_step, which lets the board run it between frames;
+search_run runs it to the end in one go.
+
+While it runs the search counts what it does (SearchStats): nodes, quiescence nodes,
+cutoffs and how many came from the first move, and what each selective part pruned.
+Every finished depth is kept with its score, time, counts and principal variation
+(SearchIteration), so the branching factor from one depth to the next can be read off
+between steps. The counters belong to the Search and so to the thread running it, with
+no locks or atomics; a tool running searches on several threads adds them up once the
+threads are done (search_stats_add). search_stats.h formats them for the host and the board.
+*/
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdbool.h>
+
+#include "chess.h"
+#include "movegen.h"
+#include "nnue.h"
+
+
+// Deepest search, in plies, quiescence included
+#define SEARCH_MAX_DEPTH 64
+
+// Score of a checkmate at the root, mates further away score less
+// Anything above SEARCH_MATE - SEARCH_MAX_DEPTH is a mate
+#define SEARCH_MATE     30000
+#define SEARCH_INFINITE 32000
+
+// Nodes searched between two looks at the clock
+#define SEARCH_CLOCK_NODES 1024
+
+// Most lines the root keeps with exact scores
+#define SEARCH_MAX_LINES 8
+
+
+//SearchLimits holds when a search stops, a limit of 0 does not apply
+typedef struct SearchLimits
+{
+    int depth;
+    long long nodes;
+    unsigned int milliseconds;
+} SearchLimits;
+
+
+//SearchOptions holds which parts of the search are used, so their worth can be measured
+typedef struct SearchOptions
+{
+    bool quiescence;
+    bool killers;
+    bool history;
+
+    //Selective search, see above
+    bool nullMove;
+    bool reductions;
+    bool futility;
+    bool reverseFutility;
+    bool checkExtensions;
+
+    //Scores positions with the network instead of eval.c, if the search has one
+    bool nnue;
+
+    //Best root moves searched with exact scores, 1 for the best only, at most SEARCH_MAX_LINES
+    int lines;
+} SearchOptions;
+
+
+//SearchStats counts what a search did, every Search has its own so threads never share a counter
+typedef struct SearchStats
+{
+    //Nodes searched, quiescence included, and those searched in quiescence
+    long long nodes;
+    long long quiescenceNodes;
+
+    //Nodes before the horizon where a move reached beta, and those where it was the first move searched
+    long long cutoffs;
+    long long firstMoveCutoffs;
+
+    //Selective search: nodes cut by a null move or by reverse futility, quiet moves skipped by futility,
+    //moves reduced and those among them searched again at full depth, and checks extended
+    long long nullMoveCutoffs;
+    long long reverseFutilityCutoffs;
+    long long futilityPrunes;
+    long long reductions;
+    long long reSearches;
+    long long checkExtensions;
+} SearchStats;
+
+
+//SearchIteration holds what a finished depth found and what it took
+typedef struct SearchIteration
+{
+    int depth;
+    int score;
+
+    //Time since search_start when the depth finished, in microseconds
+    unsigned int microseconds;
+
+    //Counted during this depth alone
+    SearchStats stats;
+
+    //Principal variation of the depth, its best move first
+    Move pv[SEARCH_MAX_DEPTH];
+    int pvLength;
+} SearchIteration;
+
+
+//SearchLine holds a root move with its score and the line expected to follow it
+typedef struct SearchLine
+{
+    Move pv[SEARCH_MAX_DEPTH];
+    int pvLength;
+    int score;
+} SearchLine;
+
+
+//Search holds a search and the tables it keeps between moves
+typedef struct Search
+{
+    //The position searched, moves are made and taken back on it
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+
+    SearchLimits limits;
+    SearchOptions options;
+    unsigned int startMicroseconds;
+
+    //Moves of the root and how far the current depth has got through them
+    Move rootMoves[MAX_MOVES];
+    int rootCount;
+    int rootIndex;
+    int depth;
+
+    //Best lines of the current depth so far, best first
+    SearchLine iterationLines[SEARCH_MAX_LINES];
+    int iterationLineCount;
+
+    //Best move of the deepest finished depth, or of a depth cut short once it found a better one
+    Move bestMove;
+    int bestScore;
+    int completedDepth;
+
+    //Principal variation, the line both sides are expected to play from the root, bestMove first
+    Move pv[SEARCH_MAX_DEPTH];
+    int pvLength;
+
+    //Best lines of the deepest finished depth, best first, as many as the lines option asks for and the root has
+    SearchLine lines[SEARCH_MAX_LINES];
+    int lineCount;
+
+    //Counts of the whole search so far, and as they were when the current depth started
+    SearchStats stats;
+    SearchStats depthStats;
+
+    //Every finished depth, iterations[depth - 1] for depth 1 to completedDepth
+    SearchIteration iterations[SEARCH_MAX_DEPTH];
+
+    bool stopped;
+    bool finished;
+
+    //Set by search_stop, possibly from another thread
+    bool stopRequested;
+
+    //Lines found below each ply of the current depth, pvTable[ply] starts with the move made at ply
+    //It is the triangular table: the line at ply holds at most SEARCH_MAX_DEPTH - ply moves
+    Move pvTable[SEARCH_MAX_DEPTH][SEARCH_MAX_DEPTH];
+    int pvTableLength[SEARCH_MAX_DEPTH];
+
+    //Quiet moves that caused a cutoff, two per ply
+    Move killers[SEARCH_MAX_DEPTH][2];
+
+    //How often a quiet move caused a cutoff, weighted by depth, indexed by start then end square
+    int history[BOARD_SIZE * BOARD_SIZE][BOARD_SIZE * BOARD_SIZE];
+
+    //Network the nnue option scores with, shared and not changed by the search, and the accumulator of every ply
+    const NnueNetwork *network;
+    NnueAccumulator accumulators[SEARCH_MAX_DEPTH];
+} Search;
+
+
+// Function prototypes for the search
+/////////////////////////////////////////////////////////////////////
+
+//Fills options with every part of the search turned on, except the network which needs one loaded, and one line
+void search_options_init(SearchOptions *options);
+
+//Sets up a search with empty tables and no network
+void search_init(Search *search, const SearchOptions *options);
+
+//Sets the network the nnue option scores with, NULL for none
+void search_set_network(Search *search, const NnueNetwork *network);
+
+//Starts searching a position, the board is copied
+void search_start(Search *search, PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn, const SearchLimits *limits);
+
+//Searches root moves until the deadline (a timer_microseconds value) has passed, at least one
+//Returns true once the search has finished and bestMove holds the move to play
+bool search_step(Search *search, unsigned int deadline);
+
+//Searches until a limit is reached
+void search_run(Search *search);
+
+//Makes the search finish as soon as it can, safe to call from another thread than the one searching
+void search_stop(Search *search);
+
+//Returns the time since search_start, in microseconds
+unsigned int search_elapsed(const Search *search);
+
+//Adds the counts of stats to total, for tools that run searches on several threads
+//Every thread keeps its own total and they are added up once the threads are done, with no locks
+void search_stats_add(SearchStats *total, const SearchStats *stats);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,170 @@
+/*
+Formats what a search counted, for the host tools and for the text strip beside the board.
+*/
+
+#include <stdio.h>
+
+#include "search_stats.h"
+
+
+// Function prototypes for search statistics helpers
+/////////////////////////////////////////////////////////////////////
+
+//Formats a score in centipawns with its sign, or a mate as #moves, negative when the side to move is mated
+static void format_score(int score, char *text, int size);
+
+//Formats part as a percentage of whole with one decimal, a dash if whole is 0
+static void format_rate(long long part, long long whole, char *text, int size);
+
+//Formats the nodes of a depth over those of the depth before with two decimals, a dash for the first depth
+static void format_branching(const Search *search, int depth, char *text, int size);
+
+//Appends the moves of a line in coordinates (e2e4) to text, as many as fit whole
+static void append_pv(const Move *pv, int length, char *text, int size);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the search statistics
+/////////////////////////////////////////////////////////////////////
+
+//Formats the column headings of the table search_stats_format_iteration writes the lines of
+void search_stats_format_header(char *line, int size) {
+    snprintf(line, size, "%5s %6s %9s %10s %7s %7s %5s  %s", "depth", "score", "ms", "nodes", "qnodes", "cut1st", "bf", "pv");
+}
+
+//Formats the line of the table for a finished depth, from 1 to the search's completedDepth
+void search_stats_format_iteration(const Search *search, int depth, char *line, int size) {
+
+    const SearchIteration *iteration = &search->iterations[depth - 1];
+    const SearchStats *stats = &iteration->stats;
+
+    char score[24];
+    char quiescence[24];
+    char firstMove[24];
+    char branching[24];
+    format_score(iteration->score, score, sizeof(score));
+    format_rate(stats->quiescenceNodes, stats->nodes, quiescence, sizeof(quiescence));
+    format_rate(stats->firstMoveCutoffs, stats->cutoffs, firstMove, sizeof(firstMove));
+    format_branching(search, depth, branching, sizeof(branching));
+
+    snprintf(line, size, "%5d %6s %5u.%03u %10lld %7s %7s %5s ", depth, score, iteration->microseconds / 1000,
+        iteration->microseconds % 1000, stats->nodes, quiescence, firstMove, branching);
+    append_pv(iteration->pv, iteration->pvLength, line, size);
+}
+
+//Formats counts as one line: nodes, the share in quiescence, the cutoffs on the first move and what the selective parts did
+void search_stats_format_totals(const SearchStats *stats, char *line, int size) {
+
+    char quiescence[24];
+    char firstMove[24];
+    format_rate(stats->quiescenceNodes, stats->nodes, quiescence, sizeof(quiescence));
+    format_rate(stats->firstMoveCutoffs, stats->cutoffs, firstMove, sizeof(firstMove));
+
+    snprintf(line, size, "%lld nodes, %s in quiescence, %lld cutoffs, %s on the first move, null move %lld, "
+        "reverse futility %lld, futility %lld, reduced %lld, searched again %lld, check extensions %lld",
+        stats->nodes, quiescence, stats->cutoffs, firstMove, stats->nullMoveCutoffs, stats->reverseFutilityCutoffs,
+        stats->futilityPrunes, stats->reductions, stats->reSearches, stats->checkExtensions);
+}
+
+//Formats a line about the deepest finished depth short enough for the strip beside the board
+void search_stats_format_brief(const Search *search, int line, char *text, int size) {
+
+    int depth = search->completedDepth;
+    if (depth == 0) {
+        snprintf(text, size, "%s", line == 0 ? "thinking" : "");
+        return;
+    }
+
+    const SearchIteration *iteration = &search->iterations[depth - 1];
+    char first[24];
+    char second[24];
+
+    if (line == 0) {
+        format_score(iteration->score, first, sizeof(first));
+        snprintf(text, size, "depth %d score %s", depth, first);
+    } else if (line == 1) {
+        snprintf(text, size, "nodes %lld", search->stats.nodes);
+    } else if (line == 2) {
+        format_branching(search, depth, first, sizeof(first));
+        format_rate(iteration->stats.firstMoveCutoffs, iteration->stats.cutoffs, second, sizeof(second));
+        snprintf(text, size, "bf %s cut1 %s", first, second);
+    } else {
+        int width = size < SEARCH_STATS_BRIEF_WIDTH + 1 ? size : SEARCH_STATS_BRIEF_WIDTH + 1;
+        text[0] = '\0';
+        append_pv(iteration->pv, iteration->pvLength, text, width);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for search statistics helpers
+/////////////////////////////////////////////////////////////////////
+
+//Formats a score in centipawns with its sign, or a mate as #moves, negative when the side to move is mated
+static void format_score(int score, char *text, int size) {
+
+    if (score > SEARCH_MATE - SEARCH_MAX_DEPTH) {
+        snprintf(text, size, "#%d", (SEARCH_MATE - score + 1) / 2);
+    } else if (score < -(SEARCH_MATE - SEARCH_MAX_DEPTH)) {
+        snprintf(text, size, "-#%d", (SEARCH_MATE + score) / 2);
+    } else {
+        snprintf(text, size, "%+d", score);
+    }
+}
+
+//Formats part as a percentage of whole with one decimal, a dash if whole is 0
+static void format_rate(long long part, long long whole, char *text, int size) {
+
+    if (whole == 0) {
+        snprintf(text, size, "-");
+        return;
+    }
+
+    long long perMille = part * 1000 / whole;
+    snprintf(text, size, "%lld.%lld%%", perMille / 10, perMille % 10);
+}
+
+//Formats the nodes of a depth over those of the depth before with two decimals, a dash for the first depth
+static void format_branching(const Search *search, int depth, char *text, int size) {
+
+    long long previous = depth > 1 ? search->iterations[depth - 2].stats.nodes : 0;
+    if (previous == 0) {
+        snprintf(text, size, "-");
+        return;
+    }
+
+    long long hundredths = search->iterations[depth - 1].stats.nodes * 100 / previous;
+    snprintf(text, size, "%lld.%02lld", hundredths / 100, hundredths % 100);
+}
+
+//Appends the moves of a line in coordinates (e2e4) to text, as many as fit whole
+static void append_pv(const Move *pv, int length, char *text, int size) {
+
+    int used = 0;
+    while (used < size && text[used] != '\0') {
+        used++;
+    }
+
+    for (int ply = 0; ply < length; ply++) {
+
+        //A space before every move but a first one at the start of the text, and the terminator after
+        int needed = (used > 0) + 4 + 1;
+        if (used + needed > size) {
+            return;
+        }
+
+        Move move = pv[ply];
+        if (used > 0) {
+            text[used++] = ' ';
+        }
+        text[used++] = (char) ('a' + MOVE_X(move.start));
+        text[used++] = (char) ('8' - MOVE_Y(move.start));
+        text[used++] = (char) ('a' + MOVE_X(move.end));
+        text[used++] = (char) ('8' - MOVE_Y(move.end));
+        text[used] = '\0';
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,44 @@
+/*
+Formats what a search counted, for the host tools and for the text strip beside the board.
+
+The counts themselves are kept by the search (SearchStats and SearchIteration in search.h),
+this only turns them into text: a table with a line for every finished depth, a line of
+totals, and a few short lines about the deepest depth for the board. Nothing here
+allocates or prints, so the same text can go to stdout on the host, to a UCI GUI as an
+info string, or into the character buffer.
+
+Rates are given in percent with one decimal and the branching factor with two, from
+integers, so the board needs no floating point to show them.
+*/
+
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include "search.h"
+
+
+// Lines search_stats_format_brief writes, and their width, the text strip beside the board
+#define SEARCH_STATS_BRIEF_LINES 4
+#define SEARCH_STATS_BRIEF_WIDTH 20
+
+
+// Function prototypes for the search statistics
+/////////////////////////////////////////////////////////////////////
+
+//Formats the column headings of the table search_stats_format_iteration writes the lines of
+void search_stats_format_header(char *line, int size);
+
+//Formats the line of the table for a finished depth, from 1 to the search's completedDepth
+//The branching factor is the nodes of the depth over those of the depth before
+void search_stats_format_iteration(const Search *search, int depth, char *line, int size);
+
+//Formats counts as one line: nodes, the share in quiescence, the cutoffs on the first move and what the selective parts did
+void search_stats_format_totals(const SearchStats *stats, char *line, int size);
+
+//Formats a line about the deepest finished depth short enough for the strip beside the board
+//line is between 0 and SEARCH_STATS_BRIEF_LINES-1: depth and score, nodes, branching factor and first move cutoffs, the moves expected
+void search_stats_format_brief(const Search *search, int line, char *text, int size);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
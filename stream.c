@@ -0,0 +1,438 @@
+/*
+Frame stream: the frames put on screen as a compact stream of changed tiles.
+*/
+
+#include <string.h>
+
+#include "stream.h"
+
+
+// Checks and sets the bit of a tile
+#define STREAM_TILE_HOLDS(tiles, column, row) ((((tiles)->rows[row]) >> (column)) & 1)
+#define STREAM_TILE_ADD(tiles, column, row) ((tiles)->rows[row] |= (uint16_t) (1u << (column)))
+
+
+// Function prototypes for stream helpers
+/////////////////////////////////////////////////////////////////////
+
+//Writes a number of bytes of value, little endian
+static void write_number(unsigned char *bytes, unsigned int value, int size);
+
+//Reads a number of bytes, little endian
+static unsigned int read_number(const unsigned char *bytes, int size);
+
+//Returns the width and height of a tile, the last column and row are cut off by the screen
+static int tile_width(int column);
+static int tile_height(int row);
+
+//Checks if a tile of a frame is as the viewer has it
+static bool is_same_tile(const StreamEncoder *encoder, const short int *pixels, int column, int row);
+
+//Encodes the pixels of a tile as runs, without STREAM_SKIP for a keyframe, and stores the tile as the viewer's
+//Returns the number of bytes written
+static int encode_tile(StreamEncoder *encoder, const short int *pixels, int column, int row, bool keyframe, unsigned char *bytes);
+
+//Returns the longest run that starts at a pixel of a tile, up to limit pixels, and its kind in kind
+static int longest_run(const short int *tile, const short int *before, int width, int index, int limit, bool keyframe, int *kind);
+
+//Writes the byte or two that start a run
+//Returns the number of bytes written
+static int write_run(unsigned char *bytes, int kind, int count);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the frame stream
+/////////////////////////////////////////////////////////////////////
+
+//Starts a stream, its first frame is a keyframe with the stream header in front of it
+void stream_encoder_init(StreamEncoder *encoder) {
+
+    memset(encoder->previous, 0, sizeof(encoder->previous));
+    memset(&encoder->changed, 0, sizeof(encoder->changed));
+    encoder->synced = false;
+    encoder->headerSent = false;
+    encoder->lastHadHeader = false;
+    encoder->lastFrameNumber = 0;
+    encoder->firstMicroseconds = 0;
+    encoder->frames = 0;
+    encoder->keyframes = 0;
+    encoder->dropped = 0;
+    encoder->bytes = 0;
+}
+
+//Encodes a frame into encoder->output, comparing with the last one only the tiles in candidates
+//and the tiles that changed in the last frame; NULL candidates compares every tile
+//Returns the number of bytes written, 0 if nothing changed and nothing has to be sent
+int stream_encode_frame(StreamEncoder *encoder, const short int *pixels, const StreamTiles *candidates, unsigned int milliseconds) {
+
+    unsigned char *bytes = encoder->output;
+    int size = 0;
+    bool keyframe = !encoder->synced;
+
+    encoder->lastHadHeader = !encoder->headerSent;
+    if (!encoder->headerSent) {
+        bytes[0] = 'C';
+        bytes[1] = 'H';
+        bytes[2] = 'V';
+        bytes[3] = STREAM_VERSION;
+        write_number(bytes + 4, FRAMEBUFFER_WIDTH, 2);
+        write_number(bytes + 6, FRAMEBUFFER_HEIGHT, 2);
+        size = STREAM_HEADER_SIZE;
+        encoder->headerSent = true;
+    }
+
+    int frameStart = size;
+    size += STREAM_FRAME_HEADER_SIZE;
+    int tileCount = 0;
+    StreamTiles changed;
+    memset(&changed, 0, sizeof(changed));
+
+    for (int row = 0; row < STREAM_TILE_ROWS; row++) {
+        for (int column = 0; column < STREAM_TILE_COLUMNS; column++) {
+
+            //A tile nobody drew into, that did not change last frame either, is as the viewer has it
+            bool candidate = keyframe || candidates == NULL || STREAM_TILE_HOLDS(candidates, column, row) || STREAM_TILE_HOLDS(&encoder->changed, column, row);
+            if (!candidate || (!keyframe && is_same_tile(encoder, pixels, column, row))) {
+                continue;
+            }
+
+            bytes[size++] = (unsigned char) (row * STREAM_TILE_COLUMNS + column);
+            size += encode_tile(encoder, pixels, column, row, keyframe, bytes + size);
+            STREAM_TILE_ADD(&changed, column, row);
+            tileCount++;
+        }
+    }
+
+    //What changed in the frame before a keyframe is not known, so the next frame compares every tile
+    if (keyframe) {
+        for (int row = 0; row < STREAM_TILE_ROWS; row++) {
+            changed.rows[row] = (uint16_t) ((1u << STREAM_TILE_COLUMNS) - 1);
+        }
+    }
+    encoder->changed = changed;
+
+    if (tileCount == 0) {
+        return 0;
+    }
+
+    write_number(bytes + frameStart, size - frameStart - 4, 4);
+    write_number(bytes + frameStart + 4, milliseconds, 4);
+    bytes[frameStart + 8] = keyframe ? STREAM_KEYFRAME : 0;
+    bytes[frameStart + 9] = (unsigned char) tileCount;
+
+    encoder->synced = true;
+    encoder->frames++;
+    encoder->keyframes += keyframe;
+    encoder->bytes += size;
+    return size;
+}
+
+//Makes the next frame a keyframe, after the backend could not take the last one
+void stream_encoder_resync(StreamEncoder *encoder) {
+
+    encoder->synced = false;
+    if (encoder->lastHadHeader) {
+        encoder->headerSent = false;
+    }
+}
+
+//Encodes the last frame the animation presented, if it was not encoded yet, and sends it
+//Returns true while the backend has bytes left to send
+bool stream_show_frame(void *context, const PresentedFrame *frame) {
+
+    StreamEncoder *encoder = context;
+
+    if (frame->number != encoder->lastFrameNumber) {
+
+        //Only the squares drawn for the frame can differ from the frame before it, unless the buffer
+        //was drawn into some other way or a frame went by without being encoded
+        StreamTiles repainted;
+        const StreamTiles *candidates = NULL;
+        if (!frame->redrawn && frame->number == encoder->lastFrameNumber + 1) {
+            memset(&repainted, 0, sizeof(repainted));
+            for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+                for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+                    if (frame->repainted[yCoord][xCoord]) {
+                        STREAM_TILE_ADD(&repainted, xCoord, yCoord);
+                    }
+                }
+            }
+            candidates = &repainted;
+        }
+
+        if (!encoder->headerSent) {
+            encoder->firstMicroseconds = frame->microseconds;
+        }
+        unsigned int milliseconds = (frame->microseconds - encoder->firstMicroseconds) / 1000;
+
+        int size = stream_encode_frame(encoder, frame->pixels, candidates, milliseconds);
+        if (size > 0 && !stream_write(encoder->output, size)) {
+            stream_encoder_resync(encoder);
+            encoder->dropped++;
+        }
+        encoder->lastFrameNumber = frame->number;
+    }
+
+    return stream_flush();
+}
+
+//Starts a decoder with a black frame
+void stream_decoder_init(StreamDecoder *decoder) {
+
+    memset(decoder->pixels, 0, sizeof(decoder->pixels));
+    decoder->milliseconds = 0;
+    decoder->frames = 0;
+    decoder->synced = false;
+}
+
+//Checks a stream header
+//Returns false if it is not a stream this version can read, or not of the screen size
+bool stream_read_header(const unsigned char bytes[STREAM_HEADER_SIZE]) {
+
+    return bytes[0] == 'C' && bytes[1] == 'H' && bytes[2] == 'V' && bytes[3] == STREAM_VERSION &&
+           read_number(bytes + 4, 2) == FRAMEBUFFER_WIDTH && read_number(bytes + 6, 2) == FRAMEBUFFER_HEIGHT;
+}
+
+//Reads the size of a frame from the first 4 bytes of its header, the size of what follows them
+unsigned int stream_frame_size(const unsigned char bytes[4]) {
+    return read_number(bytes, 4);
+}
+
+//Applies a frame, bytes being the frame after its size field
+//Returns false, leaving the frame partly applied, if the frame is not well formed
+bool stream_decode_frame(StreamDecoder *decoder, const unsigned char *bytes, int size) {
+
+    if (size < STREAM_FRAME_HEADER_SIZE - 4) {
+        return false;
+    }
+
+    unsigned int milliseconds = read_number(bytes, 4);
+    bool keyframe = (bytes[4] & STREAM_KEYFRAME) != 0;
+    int tileCount = bytes[5];
+    int position = STREAM_FRAME_HEADER_SIZE - 4;
+
+    for (int tile = 0; tile < tileCount; tile++) {
+
+        if (position >= size || bytes[position] >= STREAM_TILE_COUNT) {
+            return false;
+        }
+        int column = bytes[position] % STREAM_TILE_COLUMNS;
+        int row = bytes[position] / STREAM_TILE_COLUMNS;
+        position++;
+
+        int width = tile_width(column);
+        int pixelCount = width * tile_height(row);
+        int xPixel = column * STREAM_TILE_SIZE;
+        int yPixel = row * STREAM_TILE_SIZE;
+
+        for (int index = 0; index < pixelCount; ) {
+
+            if (position >= size) {
+                return false;
+            }
+            int kind = bytes[position] >> 6;
+            int count = (bytes[position] & 63) + 1;
+            position++;
+            if (count == 64) {
+                if (position >= size) {
+                    return false;
+                }
+                count += bytes[position++];
+            }
+
+            if (index + count > pixelCount || (kind == STREAM_ABOVE && index < width) ||
+                (kind == STREAM_FILL && position + 2 > size) || (kind == STREAM_COPY && position + 2 * count > size)) {
+                return false;
+            }
+
+            short int colour = kind == STREAM_FILL ? (short int) read_number(bytes + position, 2) : 0;
+            position += kind == STREAM_FILL ? 2 : 0;
+
+            for (int end = index + count; index < end; index++) {
+                short int *pixel = &decoder->pixels[yPixel + index / width][xPixel + index % width];
+                if (kind == STREAM_ABOVE) {
+                    *pixel = *(pixel - FRAMEBUFFER_WIDTH);
+                } else if (kind == STREAM_FILL) {
+                    *pixel = colour;
+                } else if (kind == STREAM_COPY) {
+                    *pixel = (short int) read_number(bytes + position, 2);
+                    position += 2;
+                }
+            }
+        }
+    }
+
+    if (position != size) {
+        return false;
+    }
+
+    decoder->milliseconds = milliseconds;
+    decoder->frames++;
+    decoder->synced |= keyframe;
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for stream helpers
+/////////////////////////////////////////////////////////////////////
+
+//Writes a number of bytes of value, little endian
+static void write_number(unsigned char *bytes, unsigned int value, int size) {
+
+    for (int index = 0; index < size; index++) {
+        bytes[index] = (unsigned char) (value >> (8 * index));
+    }
+}
+
+//Reads a number of bytes, little endian
+static unsigned int read_number(const unsigned char *bytes, int size) {
+
+    unsigned int value = 0;
+    for (int index = 0; index < size; index++) {
+        value |= (unsigned int) bytes[index] << (8 * index);
+    }
+    return value;
+}
+
+//Returns the width of a tile, the last column is cut off by the screen
+static int tile_width(int column) {
+
+    int left = column * STREAM_TILE_SIZE;
+    return FRAMEBUFFER_WIDTH - left < STREAM_TILE_SIZE ? FRAMEBUFFER_WIDTH - left : STREAM_TILE_SIZE;
+}
+
+//Returns the height of a tile, the last row is cut off by the screen
+static int tile_height(int row) {
+
+    int top = row * STREAM_TILE_SIZE;
+    return FRAMEBUFFER_HEIGHT - top < STREAM_TILE_SIZE ? FRAMEBUFFER_HEIGHT - top : STREAM_TILE_SIZE;
+}
+
+//Checks if a tile of a frame is as the viewer has it
+static bool is_same_tile(const StreamEncoder *encoder, const short int *pixels, int column, int row) {
+
+    int xPixel = column * STREAM_TILE_SIZE;
+    int yPixel = row * STREAM_TILE_SIZE;
+    int width = tile_width(column);
+    int height = tile_height(row);
+
+    for (int line = yPixel; line < yPixel + height; line++) {
+        if (memcmp(pixels + line * FRAMEBUFFER_STRIDE + xPixel, &encoder->previous[line][xPixel], width * sizeof(short int)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Encodes the pixels of a tile as runs, without STREAM_SKIP for a keyframe, and stores the tile as the viewer's
+//Returns the number of bytes written
+static int encode_tile(StreamEncoder *encoder, const short int *pixels, int column, int row, bool keyframe, unsigned char *bytes) {
+
+    short int tile[STREAM_TILE_SIZE * STREAM_TILE_SIZE];
+    short int before[STREAM_TILE_SIZE * STREAM_TILE_SIZE];
+    int xPixel = column * STREAM_TILE_SIZE;
+    int yPixel = row * STREAM_TILE_SIZE;
+    int width = tile_width(column);
+    int height = tile_height(row);
+    int pixelCount = width * height;
+
+    //The frame is read once, on the board the pixel buffers are slower than the stack
+    for (int line = 0; line < height; line++) {
+        memcpy(tile + line * width, pixels + (yPixel + line) * FRAMEBUFFER_STRIDE + xPixel, width * sizeof(short int));
+        memcpy(before + line * width, &encoder->previous[yPixel + line][xPixel], width * sizeof(short int));
+    }
+
+    int size = 0;
+    for (int index = 0; index < pixelCount; ) {
+
+        //A run is taken if it is shorter than the pixels themselves: any STREAM_SKIP or STREAM_ABOVE, a fill of two or more
+        int kind;
+        int count = longest_run(tile, before, width, index, pixelCount - index, keyframe, &kind);
+        if (kind != STREAM_FILL || count >= 2) {
+            size += write_run(bytes + size, kind, count);
+            if (kind == STREAM_FILL) {
+                write_number(bytes + size, (unsigned short) tile[index], 2);
+                size += 2;
+            }
+            index += count;
+            continue;
+        }
+
+        //Otherwise the colours are copied until a run starts that saves more than starting a new copy costs
+        int start = index;
+        for (index++; index < pixelCount && index - start < STREAM_MAX_RUN; index++) {
+            count = longest_run(tile, before, width, index, pixelCount - index < 3 ? pixelCount - index : 3, keyframe, &kind);
+            if (count >= (kind == STREAM_FILL ? 3 : 2)) {
+                break;
+            }
+        }
+        size += write_run(bytes + size, STREAM_COPY, index - start);
+        for (int copied = start; copied < index; copied++) {
+            write_number(bytes + size, (unsigned short) tile[copied], 2);
+            size += 2;
+        }
+    }
+
+    for (int line = 0; line < height; line++) {
+        memcpy(&encoder->previous[yPixel + line][xPixel], tile + line * width, width * sizeof(short int));
+    }
+    return size;
+}
+
+//Returns the longest run that starts at a pixel of a tile, up to limit pixels, and its kind in kind
+//Ties go to the kind that takes fewer bytes
+static int longest_run(const short int *tile, const short int *before, int width, int index, int limit, bool keyframe, int *kind) {
+
+    if (limit > STREAM_MAX_RUN) {
+        limit = STREAM_MAX_RUN;
+    }
+
+    int skip = 0;
+    if (!keyframe) {
+        while (skip < limit && tile[index + skip] == before[index + skip]) {
+            skip++;
+        }
+    }
+
+    int above = 0;
+    if (index >= width) {
+        while (above < limit && tile[index + above] == tile[index + above - width]) {
+            above++;
+        }
+    }
+
+    int fill = 1;
+    while (fill < limit && tile[index + fill] == tile[index]) {
+        fill++;
+    }
+
+    if (skip >= above && skip >= fill) {
+        *kind = STREAM_SKIP;
+        return skip;
+    }
+    if (above >= fill) {
+        *kind = STREAM_ABOVE;
+        return above;
+    }
+    *kind = STREAM_FILL;
+    return fill;
+}
+
+//Writes the byte or two that start a run
+//Returns the number of bytes written
+static int write_run(unsigned char *bytes, int kind, int count) {
+
+    if (count < 64) {
+        bytes[0] = (unsigned char) (kind << 6 | (count - 1));
+        return 1;
+    }
+
+    bytes[0] = (unsigned char) (kind << 6 | 63);
+    bytes[1] = (unsigned char) (count - 64);
+    return 2;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,198 @@
+/*
+Frame stream: the frames put on screen as a compact stream of changed tiles, for watching
+and recording a game without a capture card.
+
+The screen is cut into tiles the size of a board square, so every square drawn by
+draw_square is exactly one tile, and the strip right of the board is cut the same way.
+Every presented frame is compared with the one before it, but only in the tiles the
+animation drew for it (see animation_presented_frame) and the tiles that changed in the
+frame before, the others can not differ. Only tiles that did change are sent, each as runs
+of pixels left to right and top to bottom:
+
+  header  8 bytes   'C' 'H' 'V' STREAM_VERSION, width, height (16 bits each)
+  frame   10 bytes  size (32 bits, bytes of the frame after this field), milliseconds since
+                    the first frame (32 bits), flags, number of tiles
+  tile    1 byte    row * STREAM_TILE_COLUMNS + column, then runs covering all its pixels
+  run     1 byte    kind << 6 | count - 1 for up to 63 pixels, for more the low bits are 63
+                    and a second byte holds count - 64
+          STREAM_SKIP   the pixels are as in the previous frame
+          STREAM_ABOVE  each pixel is as the pixel above it in the tile
+          STREAM_FILL   one RGB565 colour follows (16 bits)
+          STREAM_COPY   count RGB565 colours follow (16 bits each)
+
+Numbers are little endian. A square that changes its colour is a few runs of STREAM_FILL
+and STREAM_ABOVE, a piece sliding over a square is mostly STREAM_SKIP, so a typical frame
+is a few hundred bytes. A keyframe (STREAM_KEYFRAME) holds every tile without
+STREAM_SKIP; the first frame is one, and so is the frame after one the backend could not
+take, so a viewer joining late or a stream that lost bytes recovers on its own.
+
+Two backends send the stream, link exactly one of them together with stream.c:
+  stream_mmio.c  - queues it and sends it as hex text over the JTAG UART as time allows
+  stream_host.c  - writes it to a file or a TCP socket on a Linux host
+tools/stream_decode.c rebuilds the video from either.
+*/
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "animation.h"
+#include "framebuffer.h"
+#include "geometry.h"
+
+
+// Version of the stream format
+#define STREAM_VERSION 1
+
+// Tiles are the size of a board square, the last column and row may be cut off by the screen
+#define STREAM_TILE_SIZE    SQUARE_SIZE
+#define STREAM_TILE_COLUMNS ((FRAMEBUFFER_WIDTH + STREAM_TILE_SIZE - 1) / STREAM_TILE_SIZE)
+#define STREAM_TILE_ROWS    ((FRAMEBUFFER_HEIGHT + STREAM_TILE_SIZE - 1) / STREAM_TILE_SIZE)
+#define STREAM_TILE_COUNT   (STREAM_TILE_COLUMNS * STREAM_TILE_ROWS)
+
+// Kinds of runs
+#define STREAM_SKIP  0
+#define STREAM_ABOVE 1
+#define STREAM_FILL  2
+#define STREAM_COPY  3
+
+// Pixels one run covers at most
+#define STREAM_MAX_RUN (64 + 255)
+
+// Frame flags
+#define STREAM_KEYFRAME 0x1
+
+// Sizes of the parts of a stream, in bytes
+#define STREAM_HEADER_SIZE       8
+#define STREAM_FRAME_HEADER_SIZE 10
+#define STREAM_MAX_TILE_SIZE \
+    (1 + 2 * ((STREAM_TILE_SIZE * STREAM_TILE_SIZE + STREAM_MAX_RUN - 1) / STREAM_MAX_RUN) + 2 * STREAM_TILE_SIZE * STREAM_TILE_SIZE)
+#define STREAM_MAX_FRAME_SIZE (STREAM_HEADER_SIZE + STREAM_FRAME_HEADER_SIZE + STREAM_TILE_COUNT * STREAM_MAX_TILE_SIZE)
+
+// Tile numbers are one byte
+_Static_assert(STREAM_TILE_COUNT <= 256, "the tiles of a frame do not fit in a byte");
+
+// Tiles of a stream row are bits of one StreamTiles row
+_Static_assert(STREAM_TILE_COLUMNS <= 16, "a row of tiles does not fit in 16 bits");
+
+
+//StreamTiles holds one bit per tile, bit column of rows[row]
+typedef struct StreamTiles
+{
+    uint16_t rows[STREAM_TILE_ROWS];
+} StreamTiles;
+
+
+//StreamEncoder holds what the viewer of a stream has on screen
+typedef struct StreamEncoder
+{
+    //The frame as the viewer has it, from the frames encoded so far
+    short int previous[FRAMEBUFFER_HEIGHT][FRAMEBUFFER_WIDTH];
+
+    //Tiles that changed in the last frame encoded, they are compared again in the next one
+    StreamTiles changed;
+
+    //Cleared until the viewer has a whole frame, the next frame is a keyframe then
+    bool synced;
+
+    //Set once the stream header went out in front of a frame, and if the last frame carried it
+    bool headerSent;
+    bool lastHadHeader;
+
+    //Number of the last frame from animation_presented_frame that was encoded
+    unsigned int lastFrameNumber;
+
+    //Time of the first frame, the frames carry their time from it
+    unsigned int firstMicroseconds;
+
+    //Frames and bytes sent, and frames the backend could not take
+    unsigned int frames;
+    unsigned int keyframes;
+    unsigned int dropped;
+    unsigned long bytes;
+
+    //The last frame encoded, with the stream header in front of the first one
+    unsigned char output[STREAM_MAX_FRAME_SIZE];
+} StreamEncoder;
+
+
+//StreamDecoder holds the frame a stream has built so far
+typedef struct StreamDecoder
+{
+    short int pixels[FRAMEBUFFER_HEIGHT][FRAMEBUFFER_WIDTH];
+
+    //Time of the last frame decoded, in milliseconds since the first one
+    unsigned int milliseconds;
+
+    //Frames decoded, and if a keyframe was among them so every pixel is known
+    unsigned int frames;
+    bool synced;
+} StreamDecoder;
+
+
+// Function prototypes for the frame stream
+/////////////////////////////////////////////////////////////////////
+
+//Starts a stream, its first frame is a keyframe with the stream header in front of it
+void stream_encoder_init(StreamEncoder *encoder);
+
+//Encodes a frame into encoder->output, comparing with the last one only the tiles in candidates
+//and the tiles that changed in the last frame; NULL candidates compares every tile
+//Returns the number of bytes written, 0 if nothing changed and nothing has to be sent
+int stream_encode_frame(StreamEncoder *encoder, const short int *pixels, const StreamTiles *candidates, unsigned int milliseconds);
+
+//Makes the next frame a keyframe, after the backend could not take the last one
+void stream_encoder_resync(StreamEncoder *encoder);
+
+//Encodes the last frame the animation presented, if it was not encoded yet, and sends it
+//Has the signature of GameViewer.show, the context is the StreamEncoder
+//Returns true while the backend has bytes left to send
+bool stream_show_frame(void *context, const PresentedFrame *frame);
+
+//Starts a decoder with a black frame
+void stream_decoder_init(StreamDecoder *decoder);
+
+//Checks a stream header
+//Returns false if it is not a stream this version can read, or not of the screen size
+bool stream_read_header(const unsigned char bytes[STREAM_HEADER_SIZE]);
+
+//Reads the size of a frame from the first 4 bytes of its header, the size of what follows them
+unsigned int stream_frame_size(const unsigned char bytes[4]);
+
+//Applies a frame, bytes being the frame after its size field
+//Returns false, leaving the frame partly applied, if the frame is not well formed
+bool stream_decode_frame(StreamDecoder *decoder, const unsigned char *bytes, int size);
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes for the stream backends
+/////////////////////////////////////////////////////////////////////
+
+//Sends bytes of the stream: queued for the JTAG UART on the board, to the file or socket
+//opened with stream_host_open on the host
+//Returns false if the bytes can not be taken whole, then none of them are sent
+bool stream_write(const unsigned char *bytes, int size);
+
+//Sends queued bytes without waiting, every tick
+//Returns true while bytes are left
+bool stream_flush();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Sends the stream to a file, or to a TCP socket for host:port
+//Returns false if it can not be opened
+bool stream_host_open(const char *address);
+
+//Closes the file or socket, nothing is sent afterwards
+void stream_host_close();
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
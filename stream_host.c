@@ -0,0 +1,108 @@
+/*
+Sends the frame stream to a file or a TCP socket on a Linux host.
+
+Bytes are written straight away, a write only returns once the file or the socket took
+all of them, so no frame is ever dropped.
+*/
+
+#include <netdb.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "stream.h"
+
+
+//File the stream goes to, nothing is sent while it is NULL
+static FILE *streamFile = NULL;
+
+
+// Function definitions for the stream backend
+/////////////////////////////////////////////////////////////////////
+
+//Writes bytes of the stream to the file or socket opened with stream_host_open
+//Returns false if they could not be written, nothing is open counts as written
+bool stream_write(const unsigned char *bytes, int size) {
+
+    if (streamFile == NULL) {
+        return true;
+    }
+    return fwrite(bytes, 1, size, streamFile) == (size_t) size && fflush(streamFile) == 0;
+}
+
+//Nothing is queued on the host
+bool stream_flush() {
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions only provided by the host backend
+/////////////////////////////////////////////////////////////////////
+
+//Sends the stream to a file, or to a TCP socket for host:port
+//Returns false if it can not be opened
+bool stream_host_open(const char *address) {
+
+    stream_host_close();
+
+    const char *colon = strrchr(address, ':');
+    if (colon == NULL) {
+        streamFile = fopen(address, "wb");
+        if (streamFile == NULL) {
+            perror(address);
+        }
+        return streamFile != NULL;
+    }
+
+    char host[256];
+    int hostLength = (int) (colon - address);
+    if (hostLength == 0 || hostLength >= (int) sizeof(host)) {
+        fprintf(stderr, "%s: bad host name\n", address);
+        return false;
+    }
+    memcpy(host, address, hostLength);
+    host[hostLength] = '\0';
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *addresses;
+    int error = getaddrinfo(host, colon + 1, &hints, &addresses);
+    if (error != 0) {
+        fprintf(stderr, "%s: %s\n", address, gai_strerror(error));
+        return false;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *candidate = addresses; candidate != NULL && fd < 0; candidate = candidate->ai_next) {
+        fd = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (fd >= 0 && connect(fd, candidate->ai_addr, candidate->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (fd < 0) {
+        perror(address);
+        return false;
+    }
+
+    streamFile = fdopen(fd, "wb");
+    return streamFile != NULL;
+}
+
+//Closes the file or socket, nothing is sent afterwards
+void stream_host_close() {
+
+    if (streamFile != NULL) {
+        fclose(streamFile);
+        streamFile = NULL;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
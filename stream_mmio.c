@@ -0,0 +1,87 @@
+/*
+Sends the frame stream over the JTAG UART of the DE1-SoC.
+
+The board has no network, so the stream goes out as lines of hex text like the game
+record, which the Monitor Program terminal shows and tools/stream_decode.c reads back:
+  stream 434856010140...
+The UART is far slower than the frames come, so stream_write only queues the bytes and
+stream_flush sends what fits in the UART's buffer without ever waiting for it. A frame
+that does not fit in the queue is not taken; the stream then carries on with a keyframe
+once the queue has room, so a viewer sees fewer frames but never a broken one.
+*/
+
+#include "jtag_uart.h"
+#include "stream.h"
+
+
+// Bytes of the stream on each line of text
+#define STREAM_LINE_BYTES 32
+
+// Bytes the queue holds, enough for a keyframe of the whole board
+#define STREAM_QUEUE_SIZE (32 * 1024)
+
+// Characters a byte may take: the line prefix, two hex digits and the end of the line
+#define STREAM_MAX_BYTE_CHARS 10
+
+
+//Bytes waiting for the UART, as a ring
+static unsigned char queue[STREAM_QUEUE_SIZE];
+static int queueStart = 0;
+static int queueCount = 0;
+
+//Bytes already on the line being sent
+static int lineBytes = 0;
+
+
+// Function definitions for the stream backend
+/////////////////////////////////////////////////////////////////////
+
+//Queues bytes of the stream for the JTAG UART
+//Returns false if the queue does not have room for all of them
+bool stream_write(const unsigned char *bytes, int size) {
+
+    if (size > STREAM_QUEUE_SIZE - queueCount) {
+        return false;
+    }
+
+    for (int index = 0; index < size; index++) {
+        queue[(queueStart + queueCount + index) % STREAM_QUEUE_SIZE] = bytes[index];
+    }
+    queueCount += size;
+    return true;
+}
+
+//Sends queued bytes as hex text while the UART has space, ending the line once the queue is empty
+//Returns true while bytes are left
+bool stream_flush() {
+
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    //Only what fits is written, so the writes below never wait
+    int space = jtag_uart_write_space();
+    while (queueCount > 0 && space >= STREAM_MAX_BYTE_CHARS) {
+
+        if (lineBytes == 0) {
+            jtag_uart_write_text("stream ");
+        }
+
+        unsigned char byte = queue[queueStart];
+        queueStart = (queueStart + 1) % STREAM_QUEUE_SIZE;
+        queueCount--;
+        jtag_uart_write_char(HEX_DIGITS[byte >> 4]);
+        jtag_uart_write_char(HEX_DIGITS[byte & 0xF]);
+        lineBytes++;
+
+        //A line ends when it is full or nothing is left, so the record can follow the stream
+        if (lineBytes == STREAM_LINE_BYTES || queueCount == 0) {
+            jtag_uart_write_char('\n');
+            lineBytes = 0;
+        }
+
+        space -= STREAM_MAX_BYTE_CHARS;
+    }
+
+    return queueCount > 0;
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,204 @@
+/*
+Text overlay drawn into the DE1-SoC character buffer.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "text_overlay.h"
+#include "framebuffer.h"
+
+
+// Rows of the strip used by each part of the overlay
+#define TITLE_ROW        0
+#define TURN_ROW         2
+#define STATUS_ROW       3
+#define MOVES_TITLE_ROW  5
+#define MOVES_FIRST_ROW  6
+#define MOVES_LAST_ROW   (INFO_FIRST_ROW - 2)
+#define MOVES_ROWS       (MOVES_LAST_ROW - MOVES_FIRST_ROW + 1)
+#define INFO_FIRST_ROW   (TEXT_OVERLAY_HEIGHT - TEXT_OVERLAY_INFO_LINES)
+
+// Longest move text, e.g. "Qd1xd8"
+#define MOVE_TEXT_SIZE 8
+
+// Only the moves that fit on screen are kept, two per row plus the row being filled
+#define MOVE_HISTORY_SIZE (MOVES_ROWS * 2 + 2)
+
+
+//Text that should be on screen and text that is on screen
+static char pendingCells[TEXT_OVERLAY_HEIGHT][TEXT_OVERLAY_WIDTH];
+static char shownCells[TEXT_OVERLAY_HEIGHT][TEXT_OVERLAY_WIDTH];
+
+//Most recent moves, indexed by ply number modulo MOVE_HISTORY_SIZE
+static char moveHistory[MOVE_HISTORY_SIZE][MOVE_TEXT_SIZE];
+static int plyCount = 0;
+
+//Side that plays the first move of the list and the number of that move
+static int firstTurn = WHITE_PIECE;
+static int firstMoveNumber = 1;
+
+
+// Function prototypes for text overlay helpers
+/////////////////////////////////////////////////////////////////////
+
+//Writes text on a row of the pending strip, the rest of the row is blanked
+static void set_row(int row, const char *text);
+
+//Rebuilds the move list rows from the move history
+static void layout_moves();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for the text overlay
+/////////////////////////////////////////////////////////////////////
+
+//Clears the character buffer and the move list
+void text_overlay_init() {
+
+    //Blank the whole character buffer, including the part over the board
+    for (int row = 0; row < CHARBUFFER_HEIGHT; row++) {
+        for (int column = 0; column < CHARBUFFER_WIDTH; column++) {
+            framebuffer_put_char(column, row, ' ');
+        }
+    }
+
+    memset(pendingCells, ' ', sizeof(pendingCells));
+    memset(shownCells, ' ', sizeof(shownCells));
+    plyCount = 0;
+    firstTurn = WHITE_PIECE;
+    firstMoveNumber = 1;
+
+    set_row(TITLE_ROW, "DE1-SoC Chess");
+    set_row(MOVES_TITLE_ROW, "Moves");
+}
+
+//Clears the move list and starts it at a move of a side, as a game set up from a FEN does
+void text_overlay_start_moves(int currentTurn, int fullmoveNumber) {
+
+    plyCount = 0;
+    firstTurn = currentTurn;
+    firstMoveNumber = fullmoveNumber;
+    layout_moves();
+}
+
+//Adds a move to the move list, must be called before the move is made on the board
+void text_overlay_add_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd) {
+
+    static const char PIECE_LETTERS[] = " PNBRQK";
+
+    char *text = moveHistory[plyCount % MOVE_HISTORY_SIZE];
+    int length = 0;
+
+    //Pawns are written without a letter
+    PieceIdx piece = PACKED_PIECE_ID(board[yCoordStart][xCoordStart]);
+    if (piece != PAWN && piece != EMPTY_SQUARE) {
+        text[length++] = PIECE_LETTERS[piece];
+    }
+
+    //Board row 0 is rank 8
+    text[length++] = 'a' + xCoordStart;
+    text[length++] = '0' + BOARD_SIZE - yCoordStart;
+    if (PACKED_PIECE_ID(board[yCoordEnd][xCoordEnd]) != EMPTY_SQUARE) {
+        text[length++] = 'x';
+    }
+    text[length++] = 'a' + xCoordEnd;
+    text[length++] = '0' + BOARD_SIZE - yCoordEnd;
+    text[length] = '\0';
+
+    plyCount++;
+    layout_moves();
+}
+
+//Shows which side is to move
+void text_overlay_set_turn(int currentTurn) {
+    set_row(TURN_ROW, currentTurn == WHITE_PIECE ? "White to move" : "Black to move");
+}
+
+//Shows the game status (check, checkmate, ...), an empty string clears it
+void text_overlay_set_status(const char *status) {
+    set_row(STATUS_ROW, status);
+}
+
+//Shows a line of engine information, line is between 0 and TEXT_OVERLAY_INFO_LINES-1
+void text_overlay_set_info(int line, const char *text) {
+
+    if (line < 0 || line >= TEXT_OVERLAY_INFO_LINES) {
+        return;
+    }
+
+    set_row(INFO_FIRST_ROW + line, text);
+}
+
+//Writes every cell that changed since the last update to the character buffer
+//Returns the number of cells written
+int text_overlay_update() {
+
+    int written = 0;
+
+    for (int row = 0; row < TEXT_OVERLAY_HEIGHT; row++) {
+
+        //Most rows do not change between updates
+        if (memcmp(pendingCells[row], shownCells[row], TEXT_OVERLAY_WIDTH) == 0) {
+            continue;
+        }
+
+        for (int column = 0; column < TEXT_OVERLAY_WIDTH; column++) {
+            if (pendingCells[row][column] != shownCells[row][column]) {
+                framebuffer_put_char(TEXT_OVERLAY_COLUMN + column, row, pendingCells[row][column]);
+                shownCells[row][column] = pendingCells[row][column];
+                written++;
+            }
+        }
+    }
+
+    return written;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions for text overlay helpers
+/////////////////////////////////////////////////////////////////////
+
+//Writes text on a row of the pending strip, the rest of the row is blanked
+static void set_row(int row, const char *text) {
+
+    int column = 0;
+    while (column < TEXT_OVERLAY_WIDTH && text[column] != '\0') {
+        pendingCells[row][column] = text[column];
+        column++;
+    }
+
+    while (column < TEXT_OVERLAY_WIDTH) {
+        pendingCells[row][column++] = ' ';
+    }
+}
+
+//Rebuilds the move list rows from the move history
+static void layout_moves() {
+
+    //A list that starts with black's move has "..." in white's place on its first row
+    int skipped = firstTurn == BLACK_PIECE ? 1 : 0;
+
+    //Scroll so the latest move is always on the last visible row
+    int moveRows = (plyCount + skipped + 1) / 2;
+    int firstMove = moveRows > MOVES_ROWS ? moveRows - MOVES_ROWS : 0;
+
+    for (int row = 0; row < MOVES_ROWS; row++) {
+
+        int whitePly = (firstMove + row) * 2 - skipped;
+        char line[32] = "";
+
+        if (whitePly + 1 < plyCount || (whitePly >= 0 && whitePly < plyCount)) {
+            const char *whiteMove = whitePly >= 0 ? moveHistory[whitePly % MOVE_HISTORY_SIZE] : "...";
+            const char *blackMove = whitePly + 1 < plyCount ? moveHistory[(whitePly + 1) % MOVE_HISTORY_SIZE] : "";
+            snprintf(line, sizeof(line), "%3d. %-6s %s", firstMoveNumber + firstMove + row, whiteMove, blackMove);
+        }
+
+        set_row(MOVES_FIRST_ROW + row, line);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,55 @@
+/*
+Text overlay drawn into the DE1-SoC character buffer.
+
+The character buffer is 80 by 60 characters and is mixed over the VGA pixel output, so
+text costs nothing in the pixel buffer. The board covers the left 60 columns, the overlay
+uses the 20 column strip to the right of it for the side to move, the game status, the
+move list and a few lines of engine information.
+
+All setters only change a pending copy of the strip, text_overlay_update writes the cells
+that differ from what is already on screen.
+*/
+
+#ifndef TEXT_OVERLAY_H
+#define TEXT_OVERLAY_H
+
+#include "chess.h"
+
+
+// Size and position of the text strip in the character buffer
+#define TEXT_OVERLAY_COLUMN  60
+#define TEXT_OVERLAY_WIDTH   20
+#define TEXT_OVERLAY_HEIGHT  60
+
+// Number of lines reserved for engine information at the bottom of the strip
+#define TEXT_OVERLAY_INFO_LINES 4
+
+
+// Function prototypes for the text overlay
+/////////////////////////////////////////////////////////////////////
+
+//Clears the character buffer and the move list
+void text_overlay_init();
+
+//Clears the move list and starts it at a move of a side, as a game set up from a FEN does
+void text_overlay_start_moves(int currentTurn, int fullmoveNumber);
+
+//Adds a move to the move list, must be called before the move is made on the board
+void text_overlay_add_move(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int xCoordStart, int yCoordStart, int xCoordEnd, int yCoordEnd);
+
+//Shows which side is to move
+void text_overlay_set_turn(int currentTurn);
+
+//Shows the game status (check, checkmate, ...), an empty string clears it
+void text_overlay_set_status(const char *status);
+
+//Shows a line of engine information, line is between 0 and TEXT_OVERLAY_INFO_LINES-1
+void text_overlay_set_info(int line, const char *text);
+
+//Writes every cell that changed since the last update to the character buffer
+//Returns the number of cells written
+int text_overlay_update();
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
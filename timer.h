@@ -0,0 +1,45 @@
+/*
+Free running microsecond clock.
+
+Two implementations, link exactly one of them:
+  timer_mmio.c  - second DE1-SoC interval timer, counting down at 100 MHz
+  timer_host.c  - clock_gettime on a Linux host
+
+The value wraps around, so only differences between two readings are meaningful.
+Unsigned subtraction gives the right difference across the wrap.
+*/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdbool.h>
+
+
+// Function prototypes for the timer
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock
+void timer_init();
+
+//Returns the time in microseconds since timer_init
+unsigned int timer_microseconds();
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function prototypes only provided by the host timer
+/////////////////////////////////////////////////////////////////////
+
+//Switches the clock to simulated time, which only moves forward with timer_host_advance
+//A simulated game then runs as fast as the host can compute it, without waiting for anything
+void timer_host_set_simulated(bool isSimulated);
+
+//Checks if the clock runs on simulated time
+bool timer_host_is_simulated();
+
+//Moves simulated time forward, does nothing on the real clock
+void timer_host_advance(unsigned int microseconds);
+
+/////////////////////////////////////////////////////////////////////
+
+#endif
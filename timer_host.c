@@ -0,0 +1,75 @@
+/*
+Free running microsecond clock on a Linux host.
+
+The clock normally follows CLOCK_MONOTONIC. In simulated mode it only moves when the
+simulator advances it (the emulated vsync and scripted input waits do), so a whole game
+runs at the speed of the host without changing what the game sees.
+*/
+
+#include <time.h>
+
+#include "timer.h"
+
+
+//Time of timer_init
+static struct timespec startTime;
+
+//Simulated time, used instead of the real clock when simulated is set
+static bool simulated = false;
+static unsigned int simulatedMicroseconds = 0;
+
+
+// Function definitions for the timer
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock
+void timer_init() {
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    simulatedMicroseconds = 0;
+}
+
+//Returns the time in microseconds since timer_init
+unsigned int timer_microseconds() {
+
+    if (simulated) {
+        return simulatedMicroseconds;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    long long microseconds = (now.tv_sec - startTime.tv_sec) * 1000000LL + (now.tv_nsec - startTime.tv_nsec) / 1000;
+    return (unsigned int) microseconds;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+
+// Function definitions only provided by the host timer
+/////////////////////////////////////////////////////////////////////
+
+//Switches the clock to simulated time, which only moves forward with timer_host_advance
+void timer_host_set_simulated(bool isSimulated) {
+
+    //Simulated time carries on from the real clock so it never jumps backwards
+    if (isSimulated && !simulated) {
+        simulatedMicroseconds = timer_microseconds();
+    }
+    simulated = isSimulated;
+}
+
+//Checks if the clock runs on simulated time
+bool timer_host_is_simulated() {
+    return simulated;
+}
+
+//Moves simulated time forward, does nothing on the real clock
+void timer_host_advance(unsigned int microseconds) {
+
+    if (simulated) {
+        simulatedMicroseconds += microseconds;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,71 @@
+/*
+Free running microsecond clock on the second DE1-SoC interval timer.
+
+The first interval timer raises the switch sampling interrupt (see input_mmio.c).
+This one is set to its longest period and left running continuously. A reading takes
+a snapshot of the counter and adds the ticks since the previous reading, so the clock
+stays correct as long as it is read at least once per period (about 42 seconds).
+*/
+
+#include "timer.h"
+
+
+// DE1-SOC second interval timer base address
+int* TIMER2_BASE           = (int*)0xFF202020;
+
+// Interval timer clock frequency in ticks per microsecond
+#define TIMER_TICKS_PER_MICROSECOND 100
+
+// Word offsets of the interval timer registers
+#define TIMER_CONTROL   1
+#define TIMER_PERIOD_LO 2
+#define TIMER_PERIOD_HI 3
+#define TIMER_SNAP_LO   4
+#define TIMER_SNAP_HI   5
+
+// Control register bits
+#define TIMER_CONTINUOUS 0x2
+#define TIMER_START      0x4
+
+
+//Counter value at the previous reading
+static unsigned int lastCount = 0xFFFFFFFF;
+
+//Ticks counted since timer_init
+static unsigned long long elapsedTicks = 0;
+
+
+// Function definitions for the timer
+/////////////////////////////////////////////////////////////////////
+
+//Starts the clock
+void timer_init() {
+
+    volatile int *timer = TIMER2_BASE;
+
+    //Count down from the largest period and reload when reaching zero
+    *(timer + TIMER_PERIOD_LO) = 0xFFFF;
+    *(timer + TIMER_PERIOD_HI) = 0xFFFF;
+    *(timer + TIMER_CONTROL)   = TIMER_CONTINUOUS | TIMER_START;
+
+    lastCount = 0xFFFFFFFF;
+    elapsedTicks = 0;
+}
+
+//Returns the time in microseconds since timer_init
+unsigned int timer_microseconds() {
+
+    volatile int *timer = TIMER2_BASE;
+
+    //Writing the snapshot register latches the counter
+    *(timer + TIMER_SNAP_LO) = 0;
+    unsigned int count = ((*(timer + TIMER_SNAP_HI) & 0xFFFF) << 16) | (*(timer + TIMER_SNAP_LO) & 0xFFFF);
+
+    //The counter counts down, unsigned subtraction handles the reload
+    elapsedTicks += lastCount - count;
+    lastCount = count;
+
+    return (unsigned int) (elapsedTicks / TIMER_TICKS_PER_MICROSECOND);
+}
+
+/////////////////////////////////////////////////////////////////////
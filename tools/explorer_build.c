@@ -0,0 +1,804 @@
+/*
+Builds an explorer file (explorer.h) from archives of PGN games.
+
+Every move of the first plies of every game is resolved with the rules of the board
+(san.c) and counted under the key of the position it was played from, with the result of
+the game. The archive can be far larger than memory, so the moves are sorted as an
+external sort, in two parallel passes:
+
+  runs   the files are mapped and cut into chunks that worker threads take in turn (as in
+         pgn_check). A worker collects the moves of its games until its share of the
+         memory is full, sorts them by key and move, adds up the games of every move and
+         writes them out as a sorted run to a temporary file.
+  merge  the runs are mapped and the keys cut into one range per thread. Keys are hashes,
+         so the ranges hold about as many positions each. A thread finds where its range
+         starts in every run, merges those parts of the runs, adds up each move over the
+         runs and writes blocks of records with their index entries. The blocks of the
+         ranges are then put one after the other behind the header, and the index after them.
+
+Games that set up a position with a FEN tag start from it. A game stops counting at its
+first move the rules do not allow.
+
+Build: gcc -O2 -pthread -I. tools/explorer_build.c explorer.c pgn.c san.c fen.c chess.c -o explorer_build
+Usage: explorer_build [-j threads] [-p plies] [-M megabytes] -o explorer.db games.pgn [games.pgn ...]
+  -j  number of worker threads, all cores by default
+  -p  plies of every game that are counted, 40 by default
+  -M  megabytes of moves the workers sort in memory at once, shared between them, 256 by default
+  -o  the explorer file written
+*/
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chess.h"
+#include "explorer.h"
+#include "fen.h"
+#include "pgn.h"
+#include "san.h"
+
+
+// Bytes of a file a worker takes at a time
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+// Most worker threads and most input files
+#define MAX_THREADS 256
+#define MAX_FILES   256
+
+// Results of a game, the order of the counts of a record after the games
+#define RESULT_WHITE 0
+#define RESULT_DRAW  1
+#define RESULT_BLACK 2
+#define RESULT_NONE  3
+
+// Records written to a run file at a time
+#define RUN_WRITE_RECORDS 4096
+
+// Bytes copied at a time when the blocks of the ranges are put together
+#define COPY_SIZE (1024 * 1024)
+
+
+//PlyEntry holds a move played in a game, before the games of the move are added up
+//The move is its start square times 256 plus its end square, so keys and moves sort together
+typedef struct PlyEntry
+{
+    uint64_t key;
+    uint16_t move;
+    uint8_t result;
+} PlyEntry;
+
+
+//RunRecord holds a move with the games of it added up, as a sorted run keeps it
+typedef struct RunRecord
+{
+    uint64_t key;
+    uint32_t move;
+
+    //Games, white wins, draws and black wins
+    uint32_t counts[4];
+} RunRecord;
+
+
+//Run holds a sorted run, in its temporary file and once mapped
+typedef struct Run
+{
+    FILE *file;
+    const RunRecord *records;
+    long long count;
+} Run;
+
+
+//InputFile holds a mapped PGN file
+typedef struct InputFile
+{
+    const char *start;
+    const char *end;
+} InputFile;
+
+
+//Chunk holds a piece of an input file a worker takes
+typedef struct Chunk
+{
+    int file;
+    long long offset;
+} Chunk;
+
+
+//RunMerge holds where the merge of a key range is in every run, and a binary heap of the runs by their next record
+typedef struct RunMerge
+{
+    long long *next;
+    long long *end;
+    int *heap;
+    int heapSize;
+} RunMerge;
+
+
+//BlockWriter holds the block being filled and the moves of the position being gathered
+typedef struct BlockWriter
+{
+    unsigned char block[EXPLORER_BLOCK_SIZE + MAX_MOVES * EXPLORER_MAX_RECORD_SIZE];
+    int blockLength;
+    uint64_t blockLastKey;
+
+    uint64_t key;
+    ExplorerMove moves[MAX_MOVES];
+    int moveCount;
+    unsigned char group[MAX_MOVES * EXPLORER_MAX_RECORD_SIZE];
+} BlockWriter;
+
+
+//Worker holds what a thread does in both passes
+typedef struct Worker
+{
+    pthread_t thread;
+    int number;
+
+    //Runs: the moves collected so far, and the games read
+    PlyEntry *entries;
+    long long entryCount;
+    long long entryCapacity;
+    long long games;
+    long long invalidGames;
+    long long plies;
+
+    //Merge: the blocks of the key range, their index entries as offsets within the blocks, and the totals
+    FILE *blocks;
+    long long blocksSize;
+    uint64_t *indexKeys;
+    long long *indexOffsets;
+    long long blockCount;
+    long long indexCapacity;
+    long long positions;
+    long long records;
+} Worker;
+
+
+//The input files and the chunks they are cut into
+static InputFile inputs[MAX_FILES];
+static int inputCount = 0;
+static Chunk *chunks;
+static int chunkCount = 0;
+static int nextChunk = 0;
+
+//Sorted runs, added to while holding runLock
+static Run *runs;
+static int runCount = 0;
+static int runCapacity = 0;
+static pthread_mutex_t runLock = PTHREAD_MUTEX_INITIALIZER;
+
+//Settings, and the key ranges of the merge
+static int threadCount;
+static int maxPlies = 40;
+static uint64_t rangeStarts[MAX_THREADS + 1];
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Maps a PGN file and cuts it into chunks
+//Returns false if the file can not be read
+static bool add_input(const char *path) {
+
+    int file = open(path, O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) < 0 || inputCount == MAX_FILES) {
+        perror(path);
+        return false;
+    }
+
+    //An empty file can not be mapped and holds no games
+    size_t size = (size_t) status.st_size;
+    const char *text = "";
+    if (size > 0) {
+        text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (text == MAP_FAILED) {
+            perror(path);
+            close(file);
+            return false;
+        }
+        madvise((void *) text, size, MADV_SEQUENTIAL);
+    }
+    close(file);
+
+    inputs[inputCount].start = text;
+    inputs[inputCount].end = text + size;
+
+    int count = (int) ((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    chunks = realloc(chunks, (chunkCount + count + 1) * sizeof(Chunk));
+    if (chunks == NULL) {
+        perror("realloc");
+        exit(2);
+    }
+    for (int index = 0; index < count; index++) {
+        chunks[chunkCount].file = inputCount;
+        chunks[chunkCount].offset = (long long) index * CHUNK_SIZE;
+        chunkCount++;
+    }
+
+    inputCount++;
+    return true;
+}
+
+//Returns the result of a game from its result text
+static int game_result(const PgnGame *game) {
+
+    if (pgn_slice_equals(game->result, "1-0")) return RESULT_WHITE;
+    if (pgn_slice_equals(game->result, "0-1")) return RESULT_BLACK;
+    if (pgn_slice_equals(game->result, "1/2-1/2")) return RESULT_DRAW;
+    return RESULT_NONE;
+}
+
+//Orders moves played by key then move
+static int compare_entries(const void *first, const void *second) {
+
+    const PlyEntry *one = first;
+    const PlyEntry *other = second;
+    if (one->key != other->key) {
+        return one->key < other->key ? -1 : 1;
+    }
+    return (int) one->move - (int) other->move;
+}
+
+//Sorts the moves collected, adds up their games and writes them to a new run
+static void write_run(Worker *worker) {
+
+    if (worker->entryCount == 0) {
+        return;
+    }
+
+    qsort(worker->entries, worker->entryCount, sizeof(PlyEntry), compare_entries);
+
+    FILE *file = tmpfile();
+    if (file == NULL) {
+        perror("tmpfile");
+        exit(2);
+    }
+
+    static __thread RunRecord records[RUN_WRITE_RECORDS];
+    int buffered = 0;
+    long long count = 0;
+
+    for (long long index = 0; index < worker->entryCount; ) {
+
+        //Every entry of the same key and move is one game of the same record
+        RunRecord *record = &records[buffered];
+        memset(record, 0, sizeof(*record));
+        record->key = worker->entries[index].key;
+        record->move = worker->entries[index].move;
+        while (index < worker->entryCount && worker->entries[index].key == record->key && worker->entries[index].move == record->move) {
+            record->counts[0]++;
+            if (worker->entries[index].result != RESULT_NONE) {
+                record->counts[1 + worker->entries[index].result]++;
+            }
+            index++;
+        }
+
+        count++;
+        if (++buffered == RUN_WRITE_RECORDS || index == worker->entryCount) {
+            if (fwrite(records, sizeof(RunRecord), buffered, file) != (size_t) buffered) {
+                perror("run");
+                exit(2);
+            }
+            buffered = 0;
+        }
+    }
+    fflush(file);
+    worker->entryCount = 0;
+
+    pthread_mutex_lock(&runLock);
+    if (runCount == runCapacity) {
+        runCapacity = runCapacity ? runCapacity * 2 : 64;
+        runs = realloc(runs, runCapacity * sizeof(Run));
+        if (runs == NULL) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+    runs[runCount].file = file;
+    runs[runCount].records = NULL;
+    runs[runCount].count = count;
+    runCount++;
+    pthread_mutex_unlock(&runLock);
+}
+
+//Collects the moves of a game, the reader is at its moves
+//The result is only known once every move is read, so it is filled in afterwards
+static void collect_game(Worker *worker, PgnReader *reader, const PgnGame *game) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn = WHITE_PIECE;
+    bool valid = true;
+
+    //A game may start from a set up position, the tag is copied to terminate it
+    PgnSlice fenTag;
+    FenState state;
+    char fen[FEN_MAX_SIZE * 2];
+    if (pgn_tag(game, "FEN", &fenTag) && fenTag.length < (int) sizeof(fen)) {
+        memcpy(fen, fenTag.text, fenTag.length);
+        fen[fenTag.length] = '\0';
+        valid = fen_load(fen, board, &state);
+        currentTurn = state.currentTurn;
+    } else {
+        init_board(board);
+    }
+
+    long long first = worker->entryCount;
+    uint64_t key = explorer_key(board, currentTurn);
+    int plies = 0;
+    PgnSlice text;
+    while (pgn_next_move(reader, &text)) {
+
+        //The rest of the moves are only read past, to reach the result
+        if (!valid || plies >= maxPlies) {
+            continue;
+        }
+
+        SanMove move;
+        if (san_resolve(board, currentTurn, text.text, text.length, &move) != SAN_OK) {
+            valid = false;
+            continue;
+        }
+
+        Move played = {MOVE_SQUARE(move.xCoordStart, move.yCoordStart), MOVE_SQUARE(move.xCoordEnd, move.yCoordEnd)};
+        PlyEntry *entry = &worker->entries[worker->entryCount++];
+        entry->key = key;
+        entry->move = (uint16_t) (played.start << 8 | played.end);
+
+        //The key follows the game move by move, the whole board is only hashed at the start
+        key = explorer_key_after(key, board, played);
+        move_piece(board, move.xCoordStart, move.yCoordStart, move.xCoordEnd, move.yCoordEnd);
+        switch_turns(&currentTurn);
+        plies++;
+    }
+
+    int result = game_result(game);
+    for (long long index = first; index < worker->entryCount; index++) {
+        worker->entries[index].result = (uint8_t) result;
+    }
+
+    worker->games++;
+    worker->invalidGames += !valid;
+    worker->plies += plies;
+}
+
+//Collects the moves of every game that starts in a chunk
+static void collect_chunk(Worker *worker, int index) {
+
+    const InputFile *input = &inputs[chunks[index].file];
+    const char *chunkStart = input->start + chunks[index].offset;
+    const char *chunkEnd = chunkStart + CHUNK_SIZE < input->end ? chunkStart + CHUNK_SIZE : input->end;
+
+    //The last game of the chunk may run on into the next chunk, the reader goes to the end of the file
+    PgnReader reader;
+    pgn_reader_init(&reader, pgn_sync(input->start, chunkStart, input->end), input->end);
+
+    const PgnGame *game;
+    while ((game = pgn_next_game(&reader)) != NULL && game->start < chunkEnd) {
+
+        //Room is made for a whole game first, so a game is never split between runs
+        if (worker->entryCount + maxPlies > worker->entryCapacity) {
+            write_run(worker);
+        }
+        collect_game(worker, &reader, game);
+    }
+}
+
+//Takes chunks until there are none left, writing runs as the memory fills, first pass
+static void * collect_main(void *argument) {
+
+    Worker *worker = argument;
+
+    while (true) {
+        int index = __atomic_fetch_add(&nextChunk, 1, __ATOMIC_RELAXED);
+        if (index >= chunkCount) {
+            break;
+        }
+        collect_chunk(worker, index);
+    }
+
+    write_run(worker);
+    free(worker->entries);
+    worker->entries = NULL;
+    return NULL;
+}
+
+//Returns the first record of a run with a key at or above key
+static long long run_lower_bound(const Run *run, uint64_t key) {
+
+    long long low = 0;
+    long long high = run->count;
+    while (low < high) {
+        long long middle = low + (high - low) / 2;
+        if (run->records[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+//Checks if a record comes before another, by key then move
+static bool record_before(const RunRecord *first, const RunRecord *second) {
+    return first->key < second->key || (first->key == second->key && first->move < second->move);
+}
+
+//Adds an index entry for a block starting at offset within the range's blocks
+static void add_index_entry(Worker *worker, uint64_t key, long long offset) {
+
+    if (worker->blockCount == worker->indexCapacity) {
+        worker->indexCapacity = worker->indexCapacity ? worker->indexCapacity * 2 : 1024;
+        worker->indexKeys = realloc(worker->indexKeys, worker->indexCapacity * sizeof(uint64_t));
+        worker->indexOffsets = realloc(worker->indexOffsets, worker->indexCapacity * sizeof(long long));
+        if (worker->indexKeys == NULL || worker->indexOffsets == NULL) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+
+    worker->indexKeys[worker->blockCount] = key;
+    worker->indexOffsets[worker->blockCount] = offset;
+    worker->blockCount++;
+}
+
+//Returns the next record of a run in the merge
+static const RunRecord * merge_head(const RunMerge *merge, int run) {
+    return &runs[run].records[merge->next[run]];
+}
+
+//Adds a run to the heap of the merge, it must have records left in the range
+static void merge_push(RunMerge *merge, int run) {
+
+    int place = merge->heapSize++;
+    while (place > 0 && record_before(merge_head(merge, run), merge_head(merge, merge->heap[(place - 1) / 2]))) {
+        merge->heap[place] = merge->heap[(place - 1) / 2];
+        place = (place - 1) / 2;
+    }
+    merge->heap[place] = run;
+}
+
+//Takes the smallest next record of the runs and moves its run on
+//Returns NULL once every run is done with the range
+static const RunRecord * merge_pop(RunMerge *merge) {
+
+    if (merge->heapSize == 0) {
+        return NULL;
+    }
+
+    int run = merge->heap[0];
+    const RunRecord *record = &runs[run].records[merge->next[run]++];
+
+    //The run goes back in at the top with its next record, or the last run of the heap takes its place
+    int moved = run;
+    if (merge->next[run] == merge->end[run]) {
+        moved = merge->heap[--merge->heapSize];
+        if (merge->heapSize == 0) {
+            return record;
+        }
+    }
+
+    int place = 0;
+    while (2 * place + 1 < merge->heapSize) {
+        int child = 2 * place + 1;
+        if (child + 1 < merge->heapSize && record_before(merge_head(merge, merge->heap[child + 1]), merge_head(merge, merge->heap[child]))) {
+            child++;
+        }
+        if (!record_before(merge_head(merge, merge->heap[child]), merge_head(merge, moved))) {
+            break;
+        }
+        merge->heap[place] = merge->heap[child];
+        place = child;
+    }
+    merge->heap[place] = moved;
+    return record;
+}
+
+//Writes the block being filled to the range's blocks
+static void flush_block(Worker *worker, BlockWriter *writer) {
+
+    if (writer->blockLength == 0) {
+        return;
+    }
+    if (fwrite(writer->block, 1, writer->blockLength, worker->blocks) != (size_t) writer->blockLength) {
+        perror("blocks");
+        exit(2);
+    }
+    worker->blocksSize += writer->blockLength;
+    writer->blockLength = 0;
+}
+
+//Writes the moves of a position into the block, or into a new block if they do not fit
+//Every move of a position goes in the same block, so a lookup reads one block
+static void close_position(Worker *worker, BlockWriter *writer) {
+
+    if (writer->moveCount == 0) {
+        return;
+    }
+
+    //The first record is written against the key before it in the block, which a new block changes
+    for (int attempt = 0; attempt < 2; attempt++) {
+
+        uint64_t previousKey = writer->blockLength > 0 ? writer->blockLastKey : writer->key;
+        int length = 0;
+        for (int index = 0; index < writer->moveCount; index++) {
+            length += explorer_write_record(&writer->group[length], index == 0 ? previousKey : writer->key, writer->key, &writer->moves[index]);
+        }
+
+        if (writer->blockLength > 0 && writer->blockLength + length > EXPLORER_BLOCK_SIZE) {
+            flush_block(worker, writer);
+            continue;
+        }
+
+        if (writer->blockLength == 0) {
+            add_index_entry(worker, writer->key, worker->blocksSize);
+        }
+        memcpy(&writer->block[writer->blockLength], writer->group, length);
+        writer->blockLength += length;
+        writer->blockLastKey = writer->key;
+        break;
+    }
+
+    worker->positions++;
+    worker->records += writer->moveCount;
+    writer->moveCount = 0;
+}
+
+//Adds a merged move, closing the position before it if it is the first move of a new one
+static void add_move(Worker *worker, BlockWriter *writer, const RunRecord *record) {
+
+    if (writer->moveCount > 0 && record->key != writer->key) {
+        close_position(worker, writer);
+    }
+
+    //Only a key shared by two positions could have more moves than one position, the rest are dropped
+    if (writer->moveCount == MAX_MOVES) {
+        return;
+    }
+
+    ExplorerMove *move = &writer->moves[writer->moveCount++];
+    writer->key = record->key;
+    move->move.start = (unsigned char) (record->move >> 8);
+    move->move.end = (unsigned char) (record->move & 0xff);
+    move->games = record->counts[0];
+    move->whiteWins = record->counts[1 + RESULT_WHITE];
+    move->draws = record->counts[1 + RESULT_DRAW];
+    move->blackWins = record->counts[1 + RESULT_BLACK];
+}
+
+//Merges the parts of the runs in the worker's key range into blocks, second pass
+static void * merge_main(void *argument) {
+
+    Worker *worker = argument;
+    bool lastRange = worker->number == threadCount - 1;
+
+    RunMerge merge;
+    merge.next = malloc(runCount * sizeof(long long));
+    merge.end = malloc(runCount * sizeof(long long));
+    merge.heap = malloc(runCount * sizeof(int));
+    merge.heapSize = 0;
+    BlockWriter *writer = calloc(1, sizeof(BlockWriter));
+    worker->blocks = tmpfile();
+    if (merge.next == NULL || merge.end == NULL || merge.heap == NULL || writer == NULL || worker->blocks == NULL) {
+        perror("merge");
+        exit(2);
+    }
+
+    for (int run = 0; run < runCount; run++) {
+        merge.next[run] = run_lower_bound(&runs[run], rangeStarts[worker->number]);
+        merge.end[run] = lastRange ? runs[run].count : run_lower_bound(&runs[run], rangeStarts[worker->number + 1]);
+        if (merge.next[run] < merge.end[run]) {
+            merge_push(&merge, run);
+        }
+    }
+
+    //The same move from several runs is added up before it is written
+    RunRecord merged;
+    bool haveRecord = false;
+    const RunRecord *record;
+    while ((record = merge_pop(&merge)) != NULL) {
+
+        if (haveRecord && record->key == merged.key && record->move == merged.move) {
+            for (int index = 0; index < 4; index++) {
+                merged.counts[index] += record->counts[index];
+            }
+            continue;
+        }
+
+        if (haveRecord) {
+            add_move(worker, writer, &merged);
+        }
+        merged = *record;
+        haveRecord = true;
+    }
+    if (haveRecord) {
+        add_move(worker, writer, &merged);
+    }
+    close_position(worker, writer);
+    flush_block(worker, writer);
+
+    free(merge.next);
+    free(merge.end);
+    free(merge.heap);
+    free(writer);
+    return NULL;
+}
+
+//Copies the whole of a temporary file to the end of another
+//Returns false if it can not be read or written
+static bool copy_file(FILE *from, FILE *to) {
+
+    static char buffer[COPY_SIZE];
+    rewind(from);
+
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), from)) > 0) {
+        if (fwrite(buffer, 1, length, to) != length) {
+            return false;
+        }
+    }
+    return !ferror(from);
+}
+
+//Writes the header, the blocks of every range and the index into the explorer file
+//Returns false if it can not be written
+static bool write_explorer(const char *path, Worker *workers, long long games, ExplorerHeader *header) {
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    memset(header, 0, sizeof(*header));
+    header->gameCount = games;
+    header->indexOffset = EXPLORER_HEADER_SIZE;
+    for (int thread = 0; thread < threadCount; thread++) {
+        header->blockCount += workers[thread].blockCount;
+        header->positionCount += workers[thread].positions;
+        header->recordCount += workers[thread].records;
+        header->indexOffset += workers[thread].blocksSize;
+    }
+
+    unsigned char bytes[EXPLORER_HEADER_SIZE];
+    explorer_write_header(bytes, header);
+    bool written = fwrite(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+
+    for (int thread = 0; thread < threadCount && written; thread++) {
+        written = copy_file(workers[thread].blocks, file);
+        fclose(workers[thread].blocks);
+    }
+
+    //An index entry's offset is within its range's blocks until the ranges before it are added
+    long long rangeOffset = EXPLORER_HEADER_SIZE;
+    for (int thread = 0; thread < threadCount && written; thread++) {
+        for (long long block = 0; block < workers[thread].blockCount && written; block++) {
+            unsigned char entry[EXPLORER_INDEX_ENTRY_SIZE];
+            explorer_write_index_entry(entry, workers[thread].indexKeys[block], rangeOffset + workers[thread].indexOffsets[block]);
+            written = fwrite(entry, 1, sizeof(entry), file) == sizeof(entry);
+        }
+        rangeOffset += workers[thread].blocksSize;
+    }
+
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    return written;
+}
+
+int main(int argc, char **argv) {
+
+    threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    long long megabytes = 256;
+    const char *outputPath = NULL;
+    bool usage = false;
+
+    int argument = 1;
+    for (; argument < argc && argv[argument][0] == '-'; argument++) {
+        if (argument + 1 >= argc) {
+            usage = true;
+        } else if (strcmp(argv[argument], "-j") == 0) {
+            threadCount = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-p") == 0) {
+            maxPlies = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-M") == 0) {
+            megabytes = atoll(argv[++argument]);
+        } else if (strcmp(argv[argument], "-o") == 0) {
+            outputPath = argv[++argument];
+        } else {
+            usage = true;
+        }
+    }
+    if (usage || outputPath == NULL || argument == argc || maxPlies < 1 || megabytes < 1) {
+        fprintf(stderr, "usage: explorer_build [-j threads] [-p plies] [-M megabytes] -o explorer.db games.pgn [games.pgn ...]\n");
+        return 2;
+    }
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+
+    long long inputSize = 0;
+    for (; argument < argc; argument++) {
+        if (!add_input(argv[argument])) {
+            return 2;
+        }
+        inputSize += inputs[inputCount - 1].end - inputs[inputCount - 1].start;
+    }
+
+    //Runs: every worker gets an equal share of the memory for the moves it sorts, at least one game's worth
+    static Worker workers[MAX_THREADS];
+    long long capacity = megabytes * 1024 * 1024 / threadCount / (long long) sizeof(PlyEntry);
+    if (capacity < maxPlies) capacity = maxPlies;
+
+    double start = now_seconds();
+    for (int thread = 0; thread < threadCount; thread++) {
+        workers[thread].number = thread;
+        workers[thread].entryCapacity = capacity;
+        workers[thread].entries = malloc(capacity * sizeof(PlyEntry));
+        if (workers[thread].entries == NULL) {
+            perror("malloc");
+            return 2;
+        }
+        pthread_create(&workers[thread].thread, NULL, collect_main, &workers[thread]);
+    }
+
+    long long games = 0;
+    long long invalidGames = 0;
+    long long plies = 0;
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_join(workers[thread].thread, NULL);
+        games += workers[thread].games;
+        invalidGames += workers[thread].invalidGames;
+        plies += workers[thread].plies;
+    }
+    double runsDone = now_seconds();
+
+    //Merge: the runs are read in place, and the keys cut into equal ranges, one for each worker
+    long long runRecords = 0;
+    for (int run = 0; run < runCount; run++) {
+        size_t size = runs[run].count * sizeof(RunRecord);
+        runs[run].records = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(runs[run].file), 0);
+        if (runs[run].records == MAP_FAILED) {
+            perror("run");
+            return 2;
+        }
+        runRecords += runs[run].count;
+    }
+    for (int thread = 0; thread <= threadCount; thread++) {
+        rangeStarts[thread] = thread == 0 ? 0 : UINT64_MAX / threadCount * thread;
+    }
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_create(&workers[thread].thread, NULL, merge_main, &workers[thread]);
+    }
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_join(workers[thread].thread, NULL);
+    }
+
+    ExplorerHeader header;
+    if (!write_explorer(outputPath, workers, games, &header)) {
+        perror(outputPath);
+        return 2;
+    }
+    double end = now_seconds();
+
+    long long size = (long long) header.indexOffset + (long long) header.blockCount * EXPLORER_INDEX_ENTRY_SIZE;
+    printf("%lld games, %lld stopped at a move the rules do not allow, %lld plies counted, from %.1f MB\n", games, invalidGames,
+        plies, inputSize / 1e6);
+    printf("%d runs of %lld records in %.3f s, merged in %.3f s on %d threads: %.0f games/s, %.1f MB/s\n", runCount, runRecords,
+        runsDone - start, end - runsDone, threadCount, games / (end - start), inputSize / (end - start) / 1e6);
+    printf("%s: %llu positions, %llu moves, %u blocks, %lld bytes, %.1f bytes per move\n", outputPath,
+        (unsigned long long) header.positionCount, (unsigned long long) header.recordCount, header.blockCount, size,
+        header.recordCount > 0 ? (double) (header.indexOffset - EXPLORER_HEADER_SIZE) / header.recordCount : 0.0);
+
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+Solves forced mates with mate.c, for a position given as a FEN or every position of a puzzle file.
+
+Each position is solved for the side to move with proof-number search, the depth first
+variant or both, and its line printed in coordinates with what the solve took. A puzzle
+file has a FEN or EPD position a line; an EPD "dm <n>;" operation gives the mate it is
+known to have, and a solve that finds another length or none is counted as wrong. The
+summary gives the positions solved, the solve times and the nodes per second of each
+method over the whole file.
+
+Build: gcc -O2 -I. tools/mate.c mate.c arena.c movegen.c fen.c chess.c timer_host.c -o mate
+Usage: mate [-a pns|dfpn|both] [-m moves] [-n nodes] [-t ms] [-M megabytes] [-q] fen | puzzles.epd
+  -a  proof-number search (pns, the default), its depth first variant (dfpn) or both one after the other
+  -m  longest mate looked for, in moves, 8 by default and at most MATE_MAX_MOVES
+  -n  most nodes a solve may search, none by default
+  -t  most milliseconds a solve may take, 10000 by default
+  -M  megabytes of the node pool or table, 64 by default
+  -q  prints the summary only
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "chess.h"
+#include "fen.h"
+#include "mate.h"
+#include "timer.h"
+
+
+// Most positions read from a file
+#define MAX_POSITIONS 4096
+
+// Defaults of the options
+#define DEFAULT_MOVES 8
+#define DEFAULT_MILLISECONDS 10000
+#define DEFAULT_MEGABYTES 64
+
+
+//Position holds a position to solve and the mate it is known to have, 0 if not known
+typedef struct Position
+{
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+    int expectedMate;
+    int line;
+} Position;
+
+
+//Totals of a method over every position
+typedef struct MethodTotals
+{
+    int solved;
+    int none;
+    int unknown;
+    int wrong;
+    long long nodes;
+    double seconds;
+    double maxSeconds;
+} MethodTotals;
+
+
+static Position positions[MAX_POSITIONS];
+static int positionCount = 0;
+
+
+//Reads the mate an EPD line says it has from its "dm <n>;" operation
+//Returns 0 if it has none
+static int read_expected_mate(const char *line) {
+
+    const char *operation = strstr(line, " dm ");
+    return operation != NULL ? atoi(operation + 4) : 0;
+}
+
+//Adds a position from a FEN or an EPD line
+//Returns false if it is not one
+static bool add_position(const char *text, int line) {
+
+    if (positionCount >= MAX_POSITIONS) {
+        return false;
+    }
+
+    FenState state;
+    Position *position = &positions[positionCount];
+    if (!fen_load(text, position->board, &state)) {
+        return false;
+    }
+    position->currentTurn = state.currentTurn;
+    position->expectedMate = read_expected_mate(text);
+    position->line = line;
+    positionCount++;
+    return true;
+}
+
+//Reads every position of a puzzle file, blank lines and lines starting with # are skipped
+//Returns false if a line is not a position
+static bool load_positions(FILE *file, const char *path) {
+
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+
+        if (!add_position(line, lineNumber)) {
+            fprintf(stderr, "%s:%d: not a FEN, or more than %d positions\n", path, lineNumber, MAX_POSITIONS);
+            return false;
+        }
+    }
+    return positionCount > 0;
+}
+
+//Formats the line of a solve in coordinates (e2e4), as many moves as fit
+static void format_line(const MateSolver *solver, char *text, int size) {
+
+    int used = 0;
+    text[0] = '\0';
+    for (int ply = 0; ply < solver->lineLength && used + 6 <= size; ply++) {
+        Move move = solver->line[ply];
+        used += snprintf(&text[used], size - used, "%s%c%c%c%c", ply > 0 ? " " : "", 'a' + MOVE_X(move.start), '8' - MOVE_Y(move.start),
+            'a' + MOVE_X(move.end), '8' - MOVE_Y(move.end));
+    }
+}
+
+//Solves a position with a method, prints what it found unless quiet and adds it to the totals
+static void solve(Position *position, MateMethod method, const MateLimits *limits, Arena *arena, bool quiet, MethodTotals *totals) {
+
+    static MateSolver solver;
+    arena_reset(arena);
+    mate_start(&solver, position->board, position->currentTurn, method, limits, arena);
+    mate_run(&solver);
+
+    double seconds = solver.microseconds / 1e6;
+    totals->nodes += solver.nodesSearched;
+    totals->seconds += seconds;
+    totals->maxSeconds = seconds > totals->maxSeconds ? seconds : totals->maxSeconds;
+
+    //A known mate has to be found at its length, a position known to have none must not get one
+    bool wrong = position->expectedMate > 0 && (solver.result != MATE_FOUND || solver.mateIn != position->expectedMate);
+    totals->solved += solver.result == MATE_FOUND;
+    totals->none += solver.result == MATE_NONE;
+    totals->unknown += solver.result == MATE_UNKNOWN;
+    totals->wrong += wrong;
+
+    if (quiet) {
+        return;
+    }
+
+    char result[32];
+    if (solver.result == MATE_FOUND) {
+        snprintf(result, sizeof(result), "mate in %d", solver.mateIn);
+    } else if (solver.result == MATE_NONE) {
+        snprintf(result, sizeof(result), "no mate in %d", solver.mateIn);
+    } else {
+        snprintf(result, sizeof(result), "none in %d, stopped", solver.mateIn - 1);
+    }
+
+    char line[MATE_MAX_PLIES * 5 + 1];
+    format_line(&solver, line, sizeof(line));
+    printf("%5d %-5s %-20s %10.3f %10lld %10.0f  %s%s\n", position->line, method == MATE_PROOF_NUMBER ? "pns" : "dfpn", result,
+        seconds * 1e3, solver.nodesSearched, seconds > 0 ? solver.nodesSearched / seconds : 0.0, line, wrong ? "  WRONG" : "");
+}
+
+//Prints the totals of a method
+static void print_totals(const char *name, const MethodTotals *totals) {
+
+    printf("%-5s %6d %6d %6d %6d %12lld %10.3f %10.3f %10.3f %12.0f\n", name, totals->solved, totals->none, totals->unknown, totals->wrong,
+        totals->nodes, totals->seconds, positionCount > 0 ? totals->seconds * 1e3 / positionCount : 0.0, totals->maxSeconds * 1e3,
+        totals->seconds > 0 ? totals->nodes / totals->seconds : 0.0);
+}
+
+int main(int argc, char **argv) {
+
+    bool useProofNumber = true;
+    bool useDepthFirst = false;
+    MateLimits limits = {DEFAULT_MOVES, 0, DEFAULT_MILLISECONDS};
+    long megabytes = DEFAULT_MEGABYTES;
+    bool quiet = false;
+    const char *source = NULL;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-a") == 0 && argument + 1 < argc) {
+            const char *method = argv[++argument];
+            useProofNumber = strcmp(method, "pns") == 0 || strcmp(method, "both") == 0;
+            useDepthFirst = strcmp(method, "dfpn") == 0 || strcmp(method, "both") == 0;
+        } else if (strcmp(argv[argument], "-m") == 0 && argument + 1 < argc) {
+            limits.moves = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-n") == 0 && argument + 1 < argc) {
+            limits.nodes = atoll(argv[++argument]);
+        } else if (strcmp(argv[argument], "-t") == 0 && argument + 1 < argc) {
+            limits.milliseconds = (unsigned int) atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-M") == 0 && argument + 1 < argc) {
+            megabytes = atol(argv[++argument]);
+        } else if (strcmp(argv[argument], "-q") == 0) {
+            quiet = true;
+        } else if (argv[argument][0] != '-' && source == NULL) {
+            source = argv[argument];
+        } else {
+            source = NULL;
+            break;
+        }
+    }
+    if (source == NULL || (!useProofNumber && !useDepthFirst) || megabytes < 1) {
+        fprintf(stderr, "usage: mate [-a pns|dfpn|both] [-m moves] [-n nodes] [-t ms] [-M megabytes] [-q] fen | puzzles.epd\n");
+        return 2;
+    }
+
+    //A file holds puzzles, anything else is taken for a FEN
+    FILE *file = fopen(source, "r");
+    if (file != NULL) {
+        bool loaded = load_positions(file, source);
+        fclose(file);
+        if (!loaded) {
+            return 2;
+        }
+    } else if (!add_position(source, 1)) {
+        fprintf(stderr, "%s: neither a puzzle file nor a FEN\n", source);
+        return 2;
+    }
+
+    //The pool or table of every solve, the arena is emptied before each one
+    size_t size = (size_t) megabytes << 20;
+    void *memory = malloc(size);
+    if (memory == NULL) {
+        fprintf(stderr, "can not allocate %ld MB\n", megabytes);
+        return 2;
+    }
+    Arena arena;
+    arena_init(&arena, memory, size);
+
+    timer_init();
+    if (!quiet) {
+        printf("%5s %-5s %-20s %10s %10s %10s  %s\n", "line", "with", "result", "ms", "nodes", "nodes/s", "line");
+    }
+
+    MethodTotals proofNumber = {0};
+    MethodTotals depthFirst = {0};
+    for (int index = 0; index < positionCount; index++) {
+        if (useProofNumber) {
+            solve(&positions[index], MATE_PROOF_NUMBER, &limits, &arena, quiet, &proofNumber);
+        }
+        if (useDepthFirst) {
+            solve(&positions[index], MATE_DEPTH_FIRST, &limits, &arena, quiet, &depthFirst);
+        }
+    }
+
+    printf("\n%d positions, mates up to %d moves, %ld MB\n", positionCount, limits.moves, megabytes);
+    printf("%-5s %6s %6s %6s %6s %12s %10s %10s %10s %12s\n", "with", "mates", "none", "stop", "wrong", "nodes", "total s", "avg ms", "max ms", "nodes/s");
+    if (useProofNumber) {
+        print_totals("pns", &proofNumber);
+    }
+    if (useDepthFirst) {
+        print_totals("dfpn", &depthFirst);
+    }
+
+    free(memory);
+    return proofNumber.wrong + depthFirst.wrong > 0 ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+Writes a network file for the nnue evaluation (see nnue.h).
+
+By default the network plays like eval.c: one accumulator value per colour and piece
+type holds the material and square bonus of those pieces, in steps small enough for the
+largest sum to stay under NNUE_CLIP, a second one holds what rounding to the steps left
+over, and the output layer adds the values of the side to move and takes away the other
+side's. Its scores are the same as evaluate(). It is a starting point for a trained
+network and lets the nnue option be played and measured against eval.c.
+
+With -r the weights are random instead, which exercises every path of the kernels,
+clipping and int16 wrap around included.
+
+Build: gcc -O2 -I. tools/nnue_make.c nnue.c nnue_host.c eval.c chess.c -o nnue_make
+Usage: nnue_make [-r seed] network.nnue
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chess.h"
+#include "eval.h"
+#include "nnue.h"
+
+
+// Most pieces of each type a side has, there is no promotion, indexed by PieceIdx
+static const int MOST_PIECES[KING + 1] = {0, 8, 2, 2, 2, 1, 1};
+
+// The king is worth nothing and its square bonus may be below 0, its value starts here
+#define KING_BIAS 64
+
+// What rounding leaves over may be below 0 as well
+#define REMAINDER_BIAS 64
+
+// The remainders are kept after the twelve values of the pieces
+#define REMAINDER_NEURONS (2 * KING)
+
+
+//The network is too big for the stack
+static NnueNetwork network;
+
+
+//Returns the score eval.c gives a lone piece, from white's side
+static int lone_piece_score(Piece piece, int xCoord, int yCoord) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    memset(board, PACKED_EMPTY, sizeof(board));
+    board[yCoord][xCoord] = pack_piece(piece);
+    return evaluate(board, WHITE_PIECE);
+}
+
+//Fills the network with the material and square bonuses of eval.c
+static void make_from_evaluation() {
+
+    memset(&network, 0, sizeof(network));
+
+    //Features are the same from both sides, so white's side gives every weight
+    for (int theirs = 0; theirs < 2; theirs++) {
+        for (PieceIdx pieceId = PAWN; pieceId <= KING; pieceId++) {
+
+            Piece piece;
+            piece.colour = (short int) (theirs ? BLACK_PIECE : WHITE_PIECE);
+            piece.piece_ID = pieceId;
+            int value[BOARD_SIZE * BOARD_SIZE];
+            int largest = 1;
+            for (int square = 0; square < BOARD_SIZE * BOARD_SIZE; square++) {
+                int score = lone_piece_score(piece, square % BOARD_SIZE, square / BOARD_SIZE);
+                value[square] = theirs ? -score : score;
+                if (abs(value[square]) > largest) {
+                    largest = abs(value[square]);
+                }
+            }
+
+            //The step is as small as lets every piece of the type together fit under NNUE_CLIP
+            int neuron = theirs * KING + pieceId - 1;
+            int bias = pieceId == KING ? KING_BIAS : 0;
+            int step = (MOST_PIECES[pieceId] * largest + NNUE_CLIP - bias - 1) / (NNUE_CLIP - bias);
+
+            int remainder = REMAINDER_NEURONS + neuron;
+            network.featureBias[neuron] = (int16_t) bias;
+            network.featureBias[remainder] = REMAINDER_BIAS;
+            for (int square = 0; square < BOARD_SIZE * BOARD_SIZE; square++) {
+                int feature = nnue_feature(WHITE_PIECE, piece, square % BOARD_SIZE, square / BOARD_SIZE);
+                int rounded = value[square] >= 0 ? (value[square] + step / 2) / step : -((-value[square] + step / 2) / step);
+                network.featureWeights[feature][neuron] = (int16_t) rounded;
+                network.featureWeights[feature][remainder] = (int16_t) (value[square] - rounded * step);
+            }
+
+            //The other side's accumulator is not needed, the side to move's sees both sides
+            //Both sides' biases are the same, so they cancel out
+            network.outputWeights[neuron] = (int16_t) ((theirs ? -step : step) * NNUE_OUTPUT_SCALE);
+            network.outputWeights[remainder] = (int16_t) (theirs ? -NNUE_OUTPUT_SCALE : NNUE_OUTPUT_SCALE);
+        }
+    }
+}
+
+//Fills the network with random weights
+static void make_random(unsigned int seed) {
+
+    srand(seed);
+    for (int index = 0; index < NNUE_HIDDEN; index++) {
+        network.featureBias[index] = (int16_t) (rand() % 257 - 128);
+    }
+    for (int feature = 0; feature < NNUE_FEATURES; feature++) {
+        for (int index = 0; index < NNUE_HIDDEN; index++) {
+            network.featureWeights[feature][index] = (int16_t) (rand() % 129 - 64);
+        }
+    }
+    for (int index = 0; index < NNUE_HIDDEN * 2; index++) {
+        network.outputWeights[index] = (int16_t) (rand() % 513 - 256);
+    }
+    network.outputBias = rand() % 2001 - 1000;
+}
+
+int main(int argc, char **argv) {
+
+    const char *path = NULL;
+    bool random = false;
+    unsigned int seed = 1;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-r") == 0 && argument + 1 < argc) {
+            random = true;
+            seed = (unsigned int) atoi(argv[++argument]);
+        } else if (path == NULL && argv[argument][0] != '-') {
+            path = argv[argument];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "usage: nnue_make [-r seed] network.nnue\n");
+        return 2;
+    }
+
+    if (random) {
+        make_random(seed);
+    } else {
+        make_from_evaluation();
+    }
+
+    if (!nnue_host_save(&network, path)) {
+        perror(path);
+        return 1;
+    }
+    printf("%s: %d bytes, %d features, %d hidden\n", path, NNUE_FILE_SIZE, NNUE_FEATURES, NNUE_HIDDEN);
+    return 0;
+}
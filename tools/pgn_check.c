@@ -0,0 +1,330 @@
+/*
+Checks archives of PGN games against the rules of the game.
+
+Every move of every game is resolved from its SAN with the same rules the board plays
+by (chess.c), so a game is valid only if the board would have accepted all of its moves.
+Games that set up a position with a FEN tag start from it. For each game the tool prints
+whether it is valid, the first move that is not and why, the result the file gives and
+what the rules make of the final position.
+
+The file is mapped into memory and read in place, nothing is copied. It is cut into
+chunks that worker threads take in turn; a worker checks every game that starts in its
+chunk (see pgn_sync), and the results are printed in file order.
+
+Build: gcc -O2 -pthread -I. tools/pgn_check.c pgn.c san.c fen.c chess.c -o pgn_check
+Usage: pgn_check [-j threads] [-q] games.pgn
+  -j  number of worker threads, all cores by default
+  -q  prints only invalid games and the summary
+Exits with status 1 if any game is invalid.
+*/
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chess.h"
+#include "fen.h"
+#include "pgn.h"
+#include "san.h"
+
+
+// Bytes of the file a worker takes at a time
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+// Most worker threads
+#define MAX_THREADS 256
+
+// What the rules make of the final position
+#define FINAL_PLAYING   0
+#define FINAL_CHECKMATE 1
+#define FINAL_STALEMATE 2
+
+
+//GameCheck holds the outcome of checking one game
+typedef struct GameCheck
+{
+    //Offset of the game in the file
+    long long offset;
+
+    //Moves played before the end or the first bad move
+    int plies;
+
+    //SAN_OK if every move is valid, otherwise why the first bad one is not
+    SanStatus status;
+    PgnSlice badMove;
+
+    //Result given in the file, and what the rules make of the final position
+    PgnSlice result;
+    int final;
+    int winner;
+} GameCheck;
+
+
+//ChunkChecks holds the games that start in one chunk of the file
+typedef struct ChunkChecks
+{
+    GameCheck *games;
+    int count;
+    int capacity;
+    long long moves;
+    bool done;
+} ChunkChecks;
+
+
+//The mapped file and the chunks it is cut into
+static const char *fileStart;
+static const char *fileEnd;
+static ChunkChecks *chunks;
+static int chunkCount;
+
+//Next chunk a worker takes
+static int nextChunk = 0;
+
+//Chunks are printed in order as soon as every chunk before them is done
+static pthread_mutex_t printLock = PTHREAD_MUTEX_INITIALIZER;
+static int nextPrinted = 0;
+static long long gamesPrinted = 0;
+
+//Totals, only changed while holding printLock
+static long long totalMoves = 0;
+static long long invalidGames = 0;
+static long long statusCounts[SAN_UNSUPPORTED + 1];
+
+static bool quiet = false;
+
+
+//Checks one game, the reader is at its moves
+static void check_game(PgnReader *reader, const PgnGame *game, GameCheck *check) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn = WHITE_PIECE;
+
+    check->offset = game->start - fileStart;
+    check->plies = 0;
+    check->status = SAN_OK;
+    check->final = FINAL_PLAYING;
+    check->winner = STALEMATE;
+
+    //A game may start from a set up position, the tag is copied to terminate it
+    PgnSlice fenTag;
+    FenState state;
+    char fen[FEN_MAX_SIZE * 2];
+    if (pgn_tag(game, "FEN", &fenTag) && fenTag.length < (int) sizeof(fen)) {
+        memcpy(fen, fenTag.text, fenTag.length);
+        fen[fenTag.length] = '\0';
+        if (fen_load(fen, board, &state)) {
+            currentTurn = state.currentTurn;
+        } else {
+            init_board(board);
+            check->status = SAN_SYNTAX;
+            check->badMove = fenTag;
+        }
+    } else {
+        init_board(board);
+    }
+
+    PgnSlice move;
+    while (pgn_next_move(reader, &move)) {
+
+        //The rest of the moves of an invalid game are only skipped
+        if (check->status != SAN_OK) {
+            continue;
+        }
+
+        SanMove resolved;
+        check->status = san_resolve(board, currentTurn, move.text, move.length, &resolved);
+        if (check->status != SAN_OK) {
+            check->badMove = move;
+            continue;
+        }
+
+        move_piece(board, resolved.xCoordStart, resolved.yCoordStart, resolved.xCoordEnd, resolved.yCoordEnd);
+        switch_turns(&currentTurn);
+        check->plies++;
+    }
+
+    check->result = game->result;
+
+    if (check->status == SAN_OK && is_game_over(board, currentTurn)) {
+        check->winner = get_winner(board, currentTurn);
+        check->final = check->winner == STALEMATE ? FINAL_STALEMATE : FINAL_CHECKMATE;
+    }
+}
+
+//Checks the games that start in a chunk
+static void check_chunk(int index) {
+
+    ChunkChecks *chunk = &chunks[index];
+    const char *chunkStart = fileStart + (long long) index * CHUNK_SIZE;
+    const char *chunkEnd = chunkStart + CHUNK_SIZE < fileEnd ? chunkStart + CHUNK_SIZE : fileEnd;
+
+    //The last game of the chunk may run on into the next chunk, the reader goes to the end of the file
+    PgnReader reader;
+    pgn_reader_init(&reader, pgn_sync(fileStart, chunkStart, fileEnd), fileEnd);
+
+    const PgnGame *game;
+    while ((game = pgn_next_game(&reader)) != NULL && game->start < chunkEnd) {
+
+        if (chunk->count == chunk->capacity) {
+            chunk->capacity = chunk->capacity ? chunk->capacity * 2 : 256;
+            chunk->games = realloc(chunk->games, chunk->capacity * sizeof(GameCheck));
+            if (chunk->games == NULL) {
+                perror("realloc");
+                exit(2);
+            }
+        }
+
+        GameCheck *check = &chunk->games[chunk->count++];
+        check_game(&reader, game, check);
+        chunk->moves += check->plies;
+    }
+}
+
+//Prints the check of a game
+static void print_game(long long number, const GameCheck *check) {
+
+    static const char *FINAL_NAMES[] = {"", ", checkmate", ", stalemate"};
+
+    int resultLength = check->result.length ? check->result.length : 1;
+    const char *result = check->result.length ? check->result.text : "-";
+
+    if (check->status == SAN_OK) {
+        if (!quiet) {
+            printf("game %lld @%lld: valid, %d plies, %.*s%s\n", number, check->offset, check->plies, resultLength, result, FINAL_NAMES[check->final]);
+        }
+        return;
+    }
+
+    printf("game %lld @%lld: invalid at ply %d \"%.*s\" (%s), %.*s\n", number, check->offset, check->plies + 1,
+        check->badMove.length, check->badMove.text, san_status_name(check->status), resultLength, result);
+}
+
+//Prints every finished chunk that has no unfinished chunk before it, must hold printLock
+static void print_finished_chunks() {
+
+    while (nextPrinted < chunkCount && chunks[nextPrinted].done) {
+
+        ChunkChecks *chunk = &chunks[nextPrinted];
+        for (int game = 0; game < chunk->count; game++) {
+            print_game(++gamesPrinted, &chunk->games[game]);
+            if (chunk->games[game].status != SAN_OK) {
+                invalidGames++;
+                statusCounts[chunk->games[game].status]++;
+            }
+        }
+        totalMoves += chunk->moves;
+
+        free(chunk->games);
+        chunk->games = NULL;
+        nextPrinted++;
+    }
+}
+
+//Takes chunks until there are none left
+static void * worker(void *argument) {
+
+    (void) argument;
+
+    while (true) {
+
+        int index = __atomic_fetch_add(&nextChunk, 1, __ATOMIC_RELAXED);
+        if (index >= chunkCount) {
+            return NULL;
+        }
+
+        check_chunk(index);
+
+        pthread_mutex_lock(&printLock);
+        chunks[index].done = true;
+        print_finished_chunks();
+        pthread_mutex_unlock(&printLock);
+    }
+}
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+
+    int threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    const char *path = NULL;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-j") == 0 && argument + 1 < argc) {
+            threadCount = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-q") == 0) {
+            quiet = true;
+        } else if (path == NULL) {
+            path = argv[argument];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "usage: pgn_check [-j threads] [-q] games.pgn\n");
+        return 2;
+    }
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+
+    int file = open(path, O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) < 0) {
+        perror(path);
+        return 2;
+    }
+
+    //An empty file can not be mapped and holds no games
+    size_t size = (size_t) status.st_size;
+    const char *text = "";
+    if (size > 0) {
+        text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (text == MAP_FAILED) {
+            perror(path);
+            return 2;
+        }
+        madvise((void *) text, size, MADV_SEQUENTIAL);
+    }
+    close(file);
+
+    fileStart = text;
+    fileEnd = text + size;
+    chunkCount = (int) ((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    chunks = calloc(chunkCount > 0 ? chunkCount : 1, sizeof(ChunkChecks));
+
+    double start = now_seconds();
+
+    pthread_t threads[MAX_THREADS];
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_create(&threads[thread], NULL, worker, NULL);
+    }
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_join(threads[thread], NULL);
+    }
+
+    double elapsed = now_seconds() - start;
+    if (elapsed <= 0) elapsed = 1e-9;
+
+    printf("%lld games, %lld valid, %lld invalid", gamesPrinted, gamesPrinted - invalidGames, invalidGames);
+    for (SanStatus reason = SAN_SYNTAX; reason <= SAN_UNSUPPORTED; reason++) {
+        if (statusCounts[reason] > 0) {
+            printf(", %lld %s", statusCounts[reason], san_status_name(reason));
+        }
+    }
+    printf("\n%lld moves in %.3f s on %d threads: %.0f games/s, %.0f moves/s, %.1f MB/s\n", totalMoves, elapsed, threadCount,
+        gamesPrinted / elapsed, totalMoves / elapsed, size / elapsed / 1e6);
+
+    return invalidGames > 0 ? 1 : 0;
+}
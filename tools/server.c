@@ -0,0 +1,395 @@
+/*
+Referees many games at once, for lab stations and online play through a local relay.
+
+Listens on a Unix socket, or on TCP when the address is host:port, and answers the fixed
+size binary requests described in referee.h: start a game, play a move, ask for the
+state of a game, end it. Every game lives in its own fixed size arena, all of them
+allocated when the server starts (-g sets how many), and every move is checked with the
+rules the board plays by.
+
+The worker threads share one epoll instance. Every socket is registered with
+EPOLLONESHOT, so a ready connection is served by exactly one worker at a time: it writes
+out replies still waiting, or reads what the client sent, answers every whole request in
+order and writes the replies, then arms the connection again. Level triggered arming
+brings a connection with more input straight back, so one busy client can not hold a
+worker. Requests on one connection are answered in the order they were sent; requests
+for one game from several connections take turns on the game's lock.
+
+Runs until interrupted, then prints the requests answered per second and the games still
+held. bench/server_bench.c measures requests per second and latency against it.
+
+Build: gcc -O2 -pthread -I. tools/server.c referee.c movegen.c chess.c arena.c -o server
+Usage: server [-j threads] [-g games] path | host:port
+  -j  number of worker threads, all cores by default
+  -g  most games held at once, 16384 by default (REFEREE_GAME_ARENA_SIZE bytes each)
+*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "referee.h"
+
+
+// Most worker threads
+#define MAX_THREADS 256
+
+// Games held when not given
+#define DEFAULT_GAMES 16384
+
+// Bytes a connection reads at once, and the replies to them
+// A read is only made once every earlier reply is written, so the replies always fit
+#define CONNECTION_BUFFER_SIZE (512 * REFEREE_MESSAGE_SIZE)
+
+// Ready sockets a worker takes from epoll at once
+#define MAX_EVENTS 16
+
+// How often the workers look for an interrupt, in milliseconds
+#define STOP_POLL_MS 200
+
+
+//Connection holds a client socket and the bytes read from and to be written to it
+typedef struct Connection
+{
+    int fd;
+
+    //The listening socket is registered the same way, its ready events are new clients
+    bool listening;
+
+    //Bytes read that do not make a whole request yet
+    unsigned char input[CONNECTION_BUFFER_SIZE];
+    int inputUsed;
+
+    //Replies not written yet
+    unsigned char output[CONNECTION_BUFFER_SIZE];
+    int outputStart;
+    int outputEnd;
+} Connection;
+
+
+//Worker holds a thread and what it has answered
+typedef struct Worker
+{
+    pthread_t thread;
+    long requests;
+} Worker;
+
+
+static Referee referee;
+static int epollFd;
+static bool tcp = false;
+
+//Set by SIGINT and SIGTERM
+static volatile sig_atomic_t stopping = 0;
+
+
+//Sets stopping, the workers see it within STOP_POLL_MS
+static void handle_stop_signal(int signalNumber) {
+    (void) signalNumber;
+    stopping = 1;
+}
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Registers a socket with epoll for one event, or arms it again for the next
+//Returns false if epoll turns it down
+static bool arm_connection(Connection *connection, int operation, bool writing) {
+
+    struct epoll_event event;
+    event.events = EPOLLONESHOT | EPOLLRDHUP | (writing ? EPOLLOUT : EPOLLIN);
+    event.data.ptr = connection;
+    return epoll_ctl(epollFd, operation, connection->fd, &event) == 0;
+}
+
+//Stops watching a client socket, closes it and frees the connection
+static void close_connection(Connection *connection) {
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+    close(connection->fd);
+    free(connection);
+}
+
+//Takes every client waiting on the listening socket
+static void accept_clients(Connection *listener) {
+
+    while (true) {
+        int fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            break;
+        }
+
+        //Replies are small and answer a client that waits for them
+        if (tcp) {
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+
+        Connection *connection = malloc(sizeof(Connection));
+        if (connection == NULL) {
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        connection->listening = false;
+        connection->inputUsed = 0;
+        connection->outputStart = 0;
+        connection->outputEnd = 0;
+        if (!arm_connection(connection, EPOLL_CTL_ADD, false)) {
+            close(fd);
+            free(connection);
+        }
+    }
+
+    arm_connection(listener, EPOLL_CTL_MOD, false);
+}
+
+//Writes as much of the waiting replies as the socket takes
+//Returns false if the client is gone
+static bool flush_replies(Connection *connection) {
+
+    while (connection->outputStart < connection->outputEnd) {
+        ssize_t written = send(connection->fd, connection->output + connection->outputStart,
+                               connection->outputEnd - connection->outputStart, MSG_NOSIGNAL);
+        if (written < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        connection->outputStart += (int) written;
+    }
+
+    connection->outputStart = 0;
+    connection->outputEnd = 0;
+    return true;
+}
+
+//Reads once from a client and answers every whole request
+//Returns false if the client is gone
+static bool answer_requests(Worker *worker, Connection *connection) {
+
+    ssize_t received = recv(connection->fd, connection->input + connection->inputUsed,
+                            CONNECTION_BUFFER_SIZE - connection->inputUsed, 0);
+    if (received == 0) {
+        return false;
+    }
+    if (received < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    connection->inputUsed += (int) received;
+
+    //Every request has a reply of the same size, and the output is empty, so they all fit
+    int offset = 0;
+    while (connection->inputUsed - offset >= REFEREE_MESSAGE_SIZE) {
+        referee_handle(&referee, connection->input + offset, connection->output + connection->outputEnd);
+        connection->outputEnd += REFEREE_MESSAGE_SIZE;
+        offset += REFEREE_MESSAGE_SIZE;
+        worker->requests++;
+    }
+
+    //A partial request waits at the start of the buffer for the rest of it
+    memmove(connection->input, connection->input + offset, connection->inputUsed - offset);
+    connection->inputUsed -= offset;
+    return true;
+}
+
+//Serves a ready client: writes waiting replies, or answers what it sent, then arms it again
+static void serve_client(Worker *worker, Connection *connection) {
+
+    bool open = flush_replies(connection);
+    if (open && connection->outputEnd == 0) {
+        open = answer_requests(worker, connection) && flush_replies(connection);
+    }
+
+    //Replies the socket did not take are written once it can take more, before anything is read
+    if (!open || !arm_connection(connection, EPOLL_CTL_MOD, connection->outputEnd > 0)) {
+        close_connection(connection);
+    }
+}
+
+//Serves ready sockets until interrupted
+static void * worker_main(void *argument) {
+
+    Worker *worker = argument;
+    struct epoll_event events[MAX_EVENTS];
+
+    while (!stopping) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, STOP_POLL_MS);
+        for (int index = 0; index < count; index++) {
+            Connection *connection = events[index].data.ptr;
+            if (connection->listening) {
+                accept_clients(connection);
+            } else {
+                serve_client(worker, connection);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+//Opens a listening socket on a Unix socket path, or on TCP for host:port
+//Returns the socket, or -1 with the reason printed
+static int open_listener(const char *address) {
+
+    const char *colon = strrchr(address, ':');
+    if (colon == NULL) {
+
+        struct sockaddr_un unixAddress;
+        if (strlen(address) >= sizeof(unixAddress.sun_path)) {
+            fprintf(stderr, "%s: socket path too long\n", address);
+            return -1;
+        }
+        memset(&unixAddress, 0, sizeof(unixAddress));
+        unixAddress.sun_family = AF_UNIX;
+        strcpy(unixAddress.sun_path, address);
+
+        //A socket left behind by an earlier run is taken over, any other file is not
+        struct stat status;
+        if (stat(address, &status) == 0 && S_ISSOCK(status.st_mode)) {
+            unlink(address);
+        }
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr *) &unixAddress, sizeof(unixAddress)) != 0 || listen(fd, SOMAXCONN) != 0) {
+            perror(address);
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+        return fd;
+    }
+
+    char host[256];
+    int hostLength = (int) (colon - address);
+    if (hostLength >= (int) sizeof(host)) {
+        fprintf(stderr, "%s: host name too long\n", address);
+        return -1;
+    }
+    memcpy(host, address, hostLength);
+    host[hostLength] = '\0';
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo *addresses;
+    int error = getaddrinfo(hostLength > 0 ? host : NULL, colon + 1, &hints, &addresses);
+    if (error != 0) {
+        fprintf(stderr, "%s: %s\n", address, gai_strerror(error));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *candidate = addresses; candidate != NULL && fd < 0; candidate = candidate->ai_next) {
+        fd = socket(candidate->ai_family, candidate->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, candidate->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(fd, candidate->ai_addr, candidate->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (fd < 0) {
+        perror(address);
+        return -1;
+    }
+    tcp = true;
+    return fd;
+}
+
+int main(int argc, char **argv) {
+
+    int threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int maxGames = DEFAULT_GAMES;
+    const char *address = NULL;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-j") == 0 && argument + 1 < argc) {
+            threadCount = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-g") == 0 && argument + 1 < argc) {
+            maxGames = atoi(argv[++argument]);
+        } else if (address == NULL && argv[argument][0] != '-') {
+            address = argv[argument];
+        } else {
+            address = NULL;
+            break;
+        }
+    }
+    if (address == NULL || threadCount < 1 || threadCount > MAX_THREADS) {
+        fprintf(stderr, "usage: server [-j threads] [-g games] path | host:port\n");
+        return 2;
+    }
+
+    if (!referee_init(&referee, maxGames)) {
+        fprintf(stderr, "can not hold %d games\n", maxGames);
+        return 1;
+    }
+
+    static Connection listener;
+    listener.fd = open_listener(address);
+    listener.listening = true;
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (listener.fd < 0 || epollFd < 0 || !arm_connection(&listener, EPOLL_CTL_ADD, false)) {
+        if (epollFd < 0) {
+            perror("epoll");
+        }
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("referee on %s: %d threads, %d games of %d bytes\n", address, threadCount, maxGames, REFEREE_GAME_ARENA_SIZE);
+    fflush(stdout);
+
+    static Worker workers[MAX_THREADS];
+    double start = now_seconds();
+    for (int thread = 0; thread < threadCount; thread++) {
+        workers[thread].requests = 0;
+        pthread_create(&workers[thread].thread, NULL, worker_main, &workers[thread]);
+    }
+
+    long requests = 0;
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_join(workers[thread].thread, NULL);
+        requests += workers[thread].requests;
+    }
+    double seconds = now_seconds() - start;
+
+    printf("%ld requests in %.1f s, %.0f requests/s, %d games held\n", requests, seconds, requests / seconds, referee_game_count(&referee));
+
+    close(listener.fd);
+    if (!tcp) {
+        unlink(address);
+    }
+    referee_free(&referee);
+    return 0;
+}
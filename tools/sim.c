@@ -0,0 +1,536 @@
+/*
+Headless simulator: runs the board program on a Linux host.
+
+The game runs through the same start up, scheduler tasks and main loop as on the board,
+with the host backends standing in for the devices:
+  input_host.c        replays a script of switch and key changes, optionally timed
+  timer_host.c        simulated clock, so the game runs as fast as the host can compute it
+  framebuffer_host.c  pixel buffers with an emulated 60 Hz vsync
+  leds_host.c         records every LED and HEX display change
+  record_host.c       saves the record of the game and loads records to replay
+  stream_host.c       writes the frame stream to a file or socket
+With -e the engine (engine.c) plays one or both sides, as built into the board with
+-DGAME_ENGINE_COLOUR, and with -a the analysis (analysis.c) shows its best moves while
+switch 7 is on in the script, as built with -DGAME_ANALYSIS. With -x the most played moves
+of the position, from an explorer file (explorer.h, tools/explorer_build.c), are shown beside
+the board on every player's turn, and with -m the shortest forced mate of the position
+(mate.h) is solved and its line shown there instead.
+
+It reports the winner, the LED and HEX changes, the time each scheduler task used, and
+the turn latency: the host time from confirming a move until the next player can pick a
+piece, which covers the move, the animation frames and the game over checks.
+
+Build: gcc -O2 -I. tools/sim.c game.c scheduler.c arena.c chess.c draw.c raster.c text_overlay.c animation.c framebuffer_host.c timer_host.c input.c input_host.c leds_host.c record.c record_host.c replay.c fen.c engine.c analysis.c search.c search_stats.c movegen.c eval.c nnue.c stream.c stream_host.c explorer.c explorer_host.c mate.c -o sim
+Usage: sim [-r] [-v] [-o last_frame.ppm] [-l max_average_turn_us] [-w game.rec] [-s fen | -g game.rec [-f]] [-e w|b|wb] [-a lines] [-x explorer.db | -m moves] [-V stream] [script]
+  -r  real time: waits for the emulated vsync and the times in the script
+  -v  prints every LED and HEX change
+  -l  exits with status 1 if the average turn latency is higher, to catch slowdowns
+  -s  starts the game from a position given as a FEN string
+  -w  saves the record of the game
+  -g  replays a saved record (binary, or the hex text the board sends) at its recorded pace, from the position it started from
+  -f  replays the record as fast as the game allows instead
+  -e  lets the engine play white, black or both
+  -a  adds the analysis task, showing that many moves while switch 7 is on
+  -x  shows the most played moves of every position a player moves from, with how their games went
+  -m  solves every position a player moves from for a forced mate of that many moves or fewer, and shows its line
+  -V  streams every frame to a file, or to host:port over TCP, for tools/stream_decode.c
+A script is only needed without -g or -e, with them the script plays whatever they do not.
+Exits with status 2 if the input ends before the game is over.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "analysis.h"
+#include "draw.h"
+#include "engine.h"
+#include "explorer.h"
+#include "framebuffer.h"
+#include "game.h"
+#include "input.h"
+#include "leds.h"
+#include "mate.h"
+#include "record.h"
+#include "replay.h"
+#include "scheduler.h"
+#include "stream.h"
+#include "text_overlay.h"
+#include "timer.h"
+
+
+// Most turns whose latency is kept
+#define MAX_TURNS 1024
+
+// LEDs shown while the player picks a move, see display_state in game.c
+#define LEDS_MOVING 2
+
+// Time a clock tick moves the simulated clock on while a paced replay waits for its next move
+#define REPLAY_CLOCK_STEP_US 1000
+
+// Memory of the mate solver's node pool, which limits how far it looks
+#define MATE_VIEW_MEMORY_SIZE (16 << 20)
+
+// Time the mate task may use per tick, in microseconds
+#define MATE_VIEW_TASK_BUDGET_US 4000
+
+// Sentinel for no position shown by the explorer yet, no position has the key of an empty board with black to move
+#define EXPLORER_NO_KEY 0
+
+
+//Latency of every turn in host microseconds
+static double turnLatencies[MAX_TURNS];
+static int turnCount = 0;
+
+//State of the turn being timed
+static int lastLeds = 0;
+static bool turnStarted = false;
+static double turnStart = 0;
+
+
+//Returns the host time in microseconds
+static double wall_microseconds() {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+//Times turns from the LEDs: a turn starts when the player leaves picking a move
+//and ends when the LEDs show anything again (the next pick or the winner)
+static void time_turns(LedChange change) {
+
+    if (change.device != LEDS_RED) {
+        return;
+    }
+
+    double now = wall_microseconds();
+
+    if (lastLeds == LEDS_MOVING && change.value != LEDS_MOVING) {
+        turnStarted = true;
+        turnStart = now;
+    } else if (turnStarted && change.value != 0) {
+        if (turnCount < MAX_TURNS) {
+            turnLatencies[turnCount++] = now - turnStart;
+        }
+        turnStarted = false;
+    }
+
+    lastLeds = change.value;
+}
+
+//Orders latencies for qsort
+static int compare_latencies(const void *first, const void *second) {
+
+    double difference = *(const double *) first - *(const double *) second;
+    return (difference > 0) - (difference < 0);
+}
+
+//Moves the simulated clock on while the game waits for a paced replay, nothing else would
+//Only added to the scheduler on simulated time
+static bool replay_clock_task(void *context, unsigned int deadline) {
+
+    Game *game = context;
+    (void) deadline;
+
+    if (game->state == GAME_THINKING) {
+        timer_host_advance(REPLAY_CLOCK_STEP_US);
+    }
+    return false;
+}
+
+//Explorer file the explorer task shows moves from, with the key of the position shown
+//and the time its lookups took
+typedef struct ExplorerView
+{
+    Game *game;
+    Explorer explorer;
+    uint64_t shownKey;
+    int lookups;
+    double lookupMicroseconds;
+    double maxLookupMicroseconds;
+} ExplorerView;
+
+//Shows the most played moves of the position beside the board when a player's turn starts, one a line:
+//the move, its games and the share of them white won, drew and black won, e.g. "e2e4 512 38/30/32"
+static bool explorer_task(void *context, unsigned int deadline) {
+
+    ExplorerView *view = context;
+    Game *game = view->game;
+    (void) deadline;
+
+    if (game->state != GAME_SELECTING) {
+        return false;
+    }
+    uint64_t key = explorer_key(game->board, game->currentTurn);
+    if (key == view->shownKey) {
+        return false;
+    }
+    view->shownKey = key;
+
+    double start = wall_microseconds();
+    ExplorerMove moves[TEXT_OVERLAY_INFO_LINES];
+    int count = explorer_lookup(&view->explorer, key, moves, TEXT_OVERLAY_INFO_LINES);
+    double elapsed = wall_microseconds() - start;
+    view->lookups++;
+    view->lookupMicroseconds += elapsed;
+    view->maxLookupMicroseconds = elapsed > view->maxLookupMicroseconds ? elapsed : view->maxLookupMicroseconds;
+
+    for (int line = 0; line < TEXT_OVERLAY_INFO_LINES; line++) {
+
+        char text[32] = "";
+        if (line < count) {
+            const ExplorerMove *move = &moves[line];
+            unsigned int games = move->games > 0 ? move->games : 1;
+            snprintf(text, sizeof(text), "%c%c%c%c %u %u/%u/%u", 'a' + MOVE_X(move->move.start), '8' - MOVE_Y(move->move.start),
+                'a' + MOVE_X(move->move.end), '8' - MOVE_Y(move->move.end), move->games, move->whiteWins * 100 / games,
+                move->draws * 100 / games, move->blackWins * 100 / games);
+        } else if (line == 0) {
+            snprintf(text, sizeof(text), "not in the book");
+        }
+        text_overlay_set_info(line, text);
+    }
+    return false;
+}
+
+//Mate solver the mate task runs on the position a player moves from, with the position it solves
+typedef struct MateView
+{
+    Game *game;
+    MateSolver solver;
+    Arena arena;
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+    bool solving;
+    int moves;
+
+    //Solves started and the mates found, and the host time they took
+    int solves;
+    int mates;
+    double solveMicroseconds;
+} MateView;
+
+//Shows what a finished solve found beside the board: the result, then its line four moves a line
+static void show_mate(const MateSolver *solver) {
+
+    for (int line = 0; line < TEXT_OVERLAY_INFO_LINES; line++) {
+
+        char text[32] = "";
+        if (line == 0 && solver->result == MATE_FOUND) {
+            snprintf(text, sizeof(text), "mate in %d", solver->mateIn);
+        } else if (line == 0) {
+            snprintf(text, sizeof(text), "no mate in %d%s", solver->result == MATE_NONE ? solver->mateIn : solver->mateIn - 1,
+                solver->result == MATE_NONE ? "" : " or less");
+        } else {
+            int used = 0;
+            for (int ply = (line - 1) * 4; ply < line * 4 && ply < solver->lineLength; ply++) {
+                Move move = solver->line[ply];
+                used += snprintf(&text[used], sizeof(text) - used, "%s%c%c%c%c", used > 0 ? " " : "", 'a' + MOVE_X(move.start),
+                    '8' - MOVE_Y(move.start), 'a' + MOVE_X(move.end), '8' - MOVE_Y(move.end));
+            }
+        }
+        text_overlay_set_info(line, text);
+    }
+}
+
+//Solves the position a player moves from for a forced mate a step a tick, and shows it once solved
+//Returns true while the solve has work left
+static bool mate_task(void *context, unsigned int deadline) {
+
+    MateView *view = context;
+    Game *game = view->game;
+
+    if (game->state != GAME_SELECTING) {
+        return false;
+    }
+
+    //A new position drops the solve of the last one, its pool goes back to the arena
+    if (game->currentTurn != view->currentTurn || memcmp(game->board, view->board, sizeof(view->board)) != 0) {
+        copy_board(game->board, view->board);
+        view->currentTurn = game->currentTurn;
+
+        MateLimits limits = {view->moves, 0, 0};
+        arena_reset(&view->arena);
+        mate_start(&view->solver, view->board, view->currentTurn, MATE_PROOF_NUMBER, &limits, &view->arena);
+        view->solving = true;
+        view->solves++;
+        text_overlay_set_info(0, "solving");
+        for (int line = 1; line < TEXT_OVERLAY_INFO_LINES; line++) {
+            text_overlay_set_info(line, "");
+        }
+    }
+    if (!view->solving) {
+        return false;
+    }
+
+    double start = wall_microseconds();
+    bool finished = mate_step(&view->solver, deadline);
+    view->solveMicroseconds += wall_microseconds() - start;
+    if (!finished) {
+        return true;
+    }
+
+    view->solving = false;
+    view->mates += view->solver.result == MATE_FOUND;
+    show_mate(&view->solver);
+    return false;
+}
+
+//Prints the usage
+static void print_usage() {
+    fprintf(stderr, "usage: sim [-r] [-v] [-o last_frame.ppm] [-l max_average_turn_us] [-w game.rec] [-s fen | -g game.rec [-f]] [-e w|b|wb] [-a lines] [-x explorer.db | -m moves] [-V stream] [script]\n");
+}
+
+int main(int argc, char **argv) {
+
+    static Game game;
+    bool realTime = false;
+    bool verbose = false;
+    const char *framePath = NULL;
+    double maxAverageLatency = 0;
+    const char *scriptPath = NULL;
+    const char *recordPath = NULL;
+    const char *startFen = NULL;
+    const char *replayPath = NULL;
+    bool paced = true;
+    const char *engineColours = "";
+    const char *streamAddress = NULL;
+    int analysisLines = 0;
+    const char *explorerPath = NULL;
+    int mateMoves = 0;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-r") == 0) {
+            realTime = true;
+        } else if (strcmp(argv[argument], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[argument], "-o") == 0 && argument + 1 < argc) {
+            framePath = argv[++argument];
+        } else if (strcmp(argv[argument], "-l") == 0 && argument + 1 < argc) {
+            maxAverageLatency = atof(argv[++argument]);
+        } else if (strcmp(argv[argument], "-s") == 0 && argument + 1 < argc) {
+            startFen = argv[++argument];
+        } else if (strcmp(argv[argument], "-w") == 0 && argument + 1 < argc) {
+            recordPath = argv[++argument];
+        } else if (strcmp(argv[argument], "-g") == 0 && argument + 1 < argc) {
+            replayPath = argv[++argument];
+        } else if (strcmp(argv[argument], "-f") == 0) {
+            paced = false;
+        } else if (strcmp(argv[argument], "-e") == 0 && argument + 1 < argc) {
+            engineColours = argv[++argument];
+        } else if (strcmp(argv[argument], "-a") == 0 && argument + 1 < argc) {
+            analysisLines = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-x") == 0 && argument + 1 < argc) {
+            explorerPath = argv[++argument];
+        } else if (strcmp(argv[argument], "-m") == 0 && argument + 1 < argc) {
+            mateMoves = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-V") == 0 && argument + 1 < argc) {
+            streamAddress = argv[++argument];
+        } else if (argv[argument][0] != '-' && scriptPath == NULL) {
+            scriptPath = argv[argument];
+        } else {
+            print_usage();
+            return 2;
+        }
+    }
+    if ((scriptPath == NULL && replayPath == NULL && engineColours[0] == '\0') || (explorerPath != NULL && mateMoves > 0)
+        || (replayPath != NULL && startFen != NULL)) {
+        print_usage();
+        return 2;
+    }
+
+    static GameRecord replayRecord;
+    if (replayPath != NULL && !record_host_load(&replayRecord, replayPath)) {
+        fprintf(stderr, "%s: not a game record\n", replayPath);
+        return 2;
+    }
+
+    //A replay or engine game without a script gets no input at all
+    FILE *script = scriptPath != NULL ? fopen(scriptPath, "r") : tmpfile();
+    if (script == NULL) {
+        perror(scriptPath != NULL ? scriptPath : "tmpfile");
+        return 2;
+    }
+
+    //Host devices: scripted input, simulated clock unless real time, emulated vsync
+    input_host_set_source(script);
+    framebuffer_host_set_vsync(true);
+    leds_host_set_listener(time_turns);
+
+    //The same start up as main.c
+    timer_init();
+    timer_host_set_simulated(!realTime);
+    input_init();
+    set_pixel_buffer_addresses();
+    text_overlay_init();
+
+    //A replay starts from the position its record starts from
+    static Replay replay;
+    if (replayPath != NULL) {
+        replay_init(&replay, &replayRecord, paced);
+        replay_init_game(&replay, &game);
+    } else if (startFen == NULL) {
+        game_init(&game);
+    } else if (!game_init_fen(&game, startFen)) {
+        fprintf(stderr, "not a valid FEN: %s\n", startFen);
+        return 2;
+    }
+
+    scheduler_init();
+    game_add_tasks(&game);
+
+    if (replayPath != NULL) {
+        replay_attach(&replay, &game);
+        if (replay.paced && !realTime) {
+            scheduler_add_task("clock", replay_clock_task, &game, GAME_INPUT_TASK_BUDGET_US);
+        }
+    }
+
+    //The engine with the limits it has on the board
+    static Engine engine;
+    SearchOptions engineOptions;
+    SearchLimits engineLimits = {ENGINE_MAX_DEPTH, 0, ENGINE_MOVE_MILLISECONDS};
+    search_options_init(&engineOptions);
+    engine_init(&engine, &engineOptions, &engineLimits);
+    if (strchr(engineColours, 'w') != NULL) {
+        game_set_engine(&game, WHITE_PIECE, &engine.engine);
+    }
+    if (strchr(engineColours, 'b') != NULL) {
+        game_set_engine(&game, BLACK_PIECE, &engine.engine);
+    }
+
+    //The analysis as the board runs it with -DGAME_ANALYSIS
+    static Analysis analysis;
+    if (analysisLines > 0) {
+        SearchOptions analysisOptions;
+        search_options_init(&analysisOptions);
+        analysisOptions.lines = analysisLines;
+        analysis_init(&analysis, &game, &analysisOptions);
+        analysis_add_task(&analysis);
+    }
+
+    //The explorer beside the board, host only as the file is mapped from disk
+    static ExplorerView explorerView = {.shownKey = EXPLORER_NO_KEY};
+    if (explorerPath != NULL) {
+        if (!explorer_host_map(&explorerView.explorer, explorerPath)) {
+            fprintf(stderr, "%s: not an explorer file\n", explorerPath);
+            return 2;
+        }
+        explorerView.game = &game;
+        scheduler_add_task("explorer", explorer_task, &explorerView, GAME_INPUT_TASK_BUDGET_US);
+    }
+
+    //The mate solver beside the board, its pool in a block of its own
+    static MateView mateView;
+    static unsigned char mateMemory[MATE_VIEW_MEMORY_SIZE] __attribute__((aligned(ARENA_ALIGNMENT)));
+    if (mateMoves > 0) {
+        mateView.game = &game;
+        mateView.moves = mateMoves;
+        mateView.currentTurn = -1;
+        arena_init(&mateView.arena, mateMemory, sizeof(mateMemory));
+        scheduler_add_task("mate", mate_task, &mateView, MATE_VIEW_TASK_BUDGET_US);
+    }
+
+    //The frame stream as the board sends it with -DGAME_STREAM
+    static StreamEncoder stream;
+    GameViewer streamViewer = {stream_show_frame, &stream};
+    if (streamAddress != NULL) {
+        if (!stream_host_open(streamAddress)) {
+            return 2;
+        }
+        stream_encoder_init(&stream);
+        game_set_viewer(&game, &streamViewer);
+    }
+
+    double start = wall_microseconds();
+    bool finished = game_run(&game);
+    double elapsed = wall_microseconds() - start;
+
+    //Result and the time it took
+    if (replayPath != NULL) {
+        printf("replayed %d of %d recorded moves%s\n", replay.nextMove, record_move_count(&replayRecord), replay.paced ? " at the recorded pace" : "");
+    }
+    if (!finished) {
+        printf("result: input ended before the game was over\n");
+    } else if (game.winner == WHITE_PIECE) {
+        printf("result: white wins\n");
+    } else if (game.winner == BLACK_PIECE) {
+        printf("result: black wins\n");
+    } else {
+        printf("result: stalemate\n");
+    }
+    printf("game time %.3f s, host time %.3f s, %d frames, %d input events dropped\n",
+        timer_microseconds() / 1e6, elapsed / 1e6, framebuffer_frame_count(), input_dropped_events());
+    printf("LEDR 0x%03x  HEX3-0 0x%08x  HEX5-4 0x%04x  (%d changes)\n",
+        leds_host_value(LEDS_RED), leds_host_value(LEDS_HEX_LOW), leds_host_value(LEDS_HEX_HIGH), leds_host_change_count());
+
+    if (verbose) {
+        static const char *DEVICE_NAMES[] = {"LEDR", "HEX3-0", "HEX5-4"};
+        for (int index = 0; leds_host_change(index) != NULL; index++) {
+            const LedChange *change = leds_host_change(index);
+            printf("  %10.3f ms  %-6s 0x%x\n", change->time / 1e3, DEVICE_NAMES[change->device], change->value);
+        }
+    }
+
+    //Time used by each scheduler task
+    //In simulated time a frame swap jumps the clock to the next vsync inside the render task, so
+    //only a real time run (-r) shows if the tasks fit their budgets
+    if (!realTime) {
+        printf("\ntask times are in game time, the render task includes the vsync wait\n");
+    }
+    printf("\n%-8s %10s %12s %10s %10s %9s\n", "task", "runs", "total us", "avg us", "max us", "overruns");
+    for (int task = 0; task < scheduler_task_count(); task++) {
+        const SchedulerTaskStats *stats = scheduler_task_stats(task);
+        printf("%-8s %10d %12u %10.1f %10u %9d\n", stats->name, stats->runs, stats->totalMicroseconds,
+            stats->runs ? (double) stats->totalMicroseconds / stats->runs : 0.0, stats->maxMicroseconds, stats->overruns);
+    }
+
+    //Turn latency distribution
+    double average = 0;
+    if (turnCount > 0) {
+        for (int turn = 0; turn < turnCount; turn++) {
+            average += turnLatencies[turn];
+        }
+        average /= turnCount;
+
+        qsort(turnLatencies, turnCount, sizeof(turnLatencies[0]), compare_latencies);
+        printf("\nturn latency over %d turns: min %.1f us, avg %.1f us, p95 %.1f us, max %.1f us\n", turnCount,
+            turnLatencies[0], average, turnLatencies[(turnCount * 95) / 100 < turnCount ? (turnCount * 95) / 100 : turnCount - 1], turnLatencies[turnCount - 1]);
+    }
+
+    if (analysisLines > 0) {
+        printf("\nanalysis: %d searches, hints changed %d times\n", analysis.searches, analysis.updates);
+    }
+
+    if (explorerPath != NULL) {
+        printf("\nexplorer: %d lookups, avg %.1f us, max %.1f us\n", explorerView.lookups,
+            explorerView.lookups ? explorerView.lookupMicroseconds / explorerView.lookups : 0.0, explorerView.maxLookupMicroseconds);
+        explorer_host_unmap(&explorerView.explorer);
+    }
+
+    if (mateMoves > 0) {
+        printf("\nmate: %d solves, %d mates found, avg %.1f us host time\n", mateView.solves, mateView.mates,
+            mateView.solves ? mateView.solveMicroseconds / mateView.solves : 0.0);
+    }
+
+    if (streamAddress != NULL) {
+        stream_host_close();
+        printf("\nstream: %u frames (%u keyframes, %u dropped), %lu bytes, %.1f bytes per frame\n", stream.frames, stream.keyframes,
+            stream.dropped, stream.bytes, stream.frames ? (double) stream.bytes / stream.frames : 0.0);
+    }
+
+    if (framePath != NULL && !framebuffer_write_ppm(framePath)) {
+        perror(framePath);
+    }
+
+    record_host_set_path(recordPath);
+    record_save(&game.record);
+
+    if (maxAverageLatency > 0 && average > maxAverageLatency) {
+        printf("FAIL: average turn latency %.1f us is over %.1f us\n", average, maxAverageLatency);
+        return 1;
+    }
+
+    return finished ? 0 : 2;
+}
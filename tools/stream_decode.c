@@ -0,0 +1,373 @@
+/*
+Rebuilds the video of a frame stream (stream.h) from the board or the simulator.
+
+Reads the stream from a file, from standard input for -, or from the first client to
+connect when the source is host:port, which is where the simulator's -V host:port sends
+it. Besides the binary stream it reads the hex text the board sends over the JTAG UART,
+also as a terminal log with other lines in it.
+
+Checks every frame and prints the frames, keyframes and bytes per frame. -o writes the
+video as raw RGB565 frames at a fixed rate, each frame repeated until the time of the
+next one, which ffmpeg turns into a video file with
+  ffmpeg -f rawvideo -pixel_format rgb565le -video_size 320x240 -framerate 60 -i video.rgb565 video.mp4
+-p writes every decoded frame as a PPM image, -l only the last one.
+The text overlay is in the character buffer of the VGA controller, not in the pixels, so
+it is not part of the stream.
+
+Build: gcc -O2 -I. tools/stream_decode.c stream.c stream_host.c -o stream_decode
+Usage: stream_decode [-o video.rgb565] [-r fps] [-p frame_prefix] [-l last_frame.ppm] stream | - | host:port
+*/
+
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "stream.h"
+
+
+// Video frame rate when not given
+#define DEFAULT_FPS 60
+
+// Longest line of hex text read
+#define MAX_LINE 1024
+
+
+//StreamSource reads the bytes of a stream, binary or as the board's hex text
+typedef struct StreamSource
+{
+    FILE *file;
+    bool hex;
+
+    //Characters read to tell binary from text, they start the first line of text
+    char carry[3];
+    int carryStart;
+    int carryCount;
+
+    //Bytes read but not taken yet
+    unsigned char pending[MAX_LINE];
+    int pendingStart;
+    int pendingCount;
+} StreamSource;
+
+
+//Opens a source and finds out if it is binary or hex text
+//Returns false if nothing could be read
+static bool open_source(StreamSource *source, FILE *file) {
+
+    source->file = file;
+    source->carryStart = 0;
+    source->carryCount = 0;
+    source->pendingStart = 0;
+    source->pendingCount = 0;
+
+    //A binary stream starts with its magic, anything else is taken for text from the board
+    unsigned char start[3];
+    if (fread(start, 1, sizeof(start), file) != sizeof(start)) {
+        return false;
+    }
+    source->hex = memcmp(start, "CHV", 3) != 0;
+    if (source->hex) {
+        memcpy(source->carry, start, 3);
+        source->carryCount = 3;
+    } else {
+        memcpy(source->pending, start, 3);
+        source->pendingCount = 3;
+    }
+    return true;
+}
+
+//Reads a line of text, the characters taken by open_source first
+//Returns false at the end of the text
+static bool read_line(StreamSource *source, char *line, int size) {
+
+    int length = 0;
+    while (length < size - 1) {
+        int character;
+        if (source->carryCount > 0) {
+            character = (unsigned char) source->carry[source->carryStart++];
+            source->carryCount--;
+        } else {
+            character = fgetc(source->file);
+        }
+        if (character == EOF) {
+            break;
+        }
+        line[length++] = (char) character;
+        if (character == '\n') {
+            break;
+        }
+    }
+
+    line[length] = '\0';
+    return length > 0;
+}
+
+//Reads the hex digits of a "stream <hex>" line into the pending bytes, other lines are skipped
+static void read_hex_line(StreamSource *source, const char *line) {
+
+    //The terminal may put text in front of a line
+    const char *digits = strstr(line, "stream ");
+    if (digits == NULL) {
+        return;
+    }
+    digits += strlen("stream ");
+
+    unsigned int byte;
+    while (source->pendingCount < MAX_LINE && sscanf(digits, "%2x", &byte) == 1) {
+        source->pending[source->pendingCount++] = (unsigned char) byte;
+        digits += 2;
+    }
+}
+
+//Reads size bytes of the stream
+//Returns false if the stream ends first
+static bool read_source(StreamSource *source, unsigned char *bytes, int size) {
+
+    while (size > 0) {
+
+        if (source->pendingCount > 0) {
+            int taken = size < source->pendingCount ? size : source->pendingCount;
+            memcpy(bytes, source->pending + source->pendingStart, taken);
+            source->pendingStart += taken;
+            source->pendingCount -= taken;
+            bytes += taken;
+            size -= taken;
+            continue;
+        }
+        source->pendingStart = 0;
+
+        if (!source->hex) {
+            return fread(bytes, 1, size, source->file) == (size_t) size;
+        }
+
+        char line[MAX_LINE];
+        if (!read_line(source, line, sizeof(line))) {
+            return false;
+        }
+        read_hex_line(source, line);
+    }
+
+    return true;
+}
+
+//Waits for one client on host:port and returns its socket as a file, or NULL with the reason printed
+static FILE * accept_client(const char *address) {
+
+    const char *colon = strrchr(address, ':');
+    char host[256];
+    int hostLength = (int) (colon - address);
+    if (hostLength >= (int) sizeof(host)) {
+        fprintf(stderr, "%s: host name too long\n", address);
+        return NULL;
+    }
+    memcpy(host, address, hostLength);
+    host[hostLength] = '\0';
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo *addresses;
+    int error = getaddrinfo(hostLength > 0 ? host : NULL, colon + 1, &hints, &addresses);
+    if (error != 0) {
+        fprintf(stderr, "%s: %s\n", address, gai_strerror(error));
+        return NULL;
+    }
+
+    int listener = -1;
+    for (struct addrinfo *candidate = addresses; candidate != NULL && listener < 0; candidate = candidate->ai_next) {
+        listener = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (listener < 0) {
+            continue;
+        }
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(listener, candidate->ai_addr, candidate->ai_addrlen) != 0 || listen(listener, 1) != 0) {
+            close(listener);
+            listener = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    int client = listener >= 0 ? accept(listener, NULL, NULL) : -1;
+    if (client < 0) {
+        perror(address);
+        return NULL;
+    }
+    close(listener);
+    return fdopen(client, "rb");
+}
+
+//Writes a frame as a binary PPM image
+//Returns false if it could not be written
+static bool write_ppm(const StreamDecoder *decoder, const char *path) {
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+
+    //Expand every RGB565 pixel to 8 bits per channel, as framebuffer_write_ppm does
+    unsigned char row[FRAMEBUFFER_WIDTH * 3];
+    for (int yCoord = 0; yCoord < FRAMEBUFFER_HEIGHT; yCoord++) {
+        for (int xCoord = 0; xCoord < FRAMEBUFFER_WIDTH; xCoord++) {
+            unsigned short pixel = (unsigned short) decoder->pixels[yCoord][xCoord];
+            int red   = (pixel >> 11) & 0x1F;
+            int green = (pixel >> 5) & 0x3F;
+            int blue  = pixel & 0x1F;
+            row[xCoord * 3 + 0] = (unsigned char) ((red << 3) | (red >> 2));
+            row[xCoord * 3 + 1] = (unsigned char) ((green << 2) | (green >> 4));
+            row[xCoord * 3 + 2] = (unsigned char) ((blue << 3) | (blue >> 2));
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+
+    bool written = !ferror(file);
+    fclose(file);
+    return written;
+}
+
+//Writes a frame as raw little endian RGB565
+static void write_video_frame(const StreamDecoder *decoder, FILE *video) {
+
+    unsigned char row[FRAMEBUFFER_WIDTH * 2];
+    for (int yCoord = 0; yCoord < FRAMEBUFFER_HEIGHT; yCoord++) {
+        for (int xCoord = 0; xCoord < FRAMEBUFFER_WIDTH; xCoord++) {
+            unsigned short pixel = (unsigned short) decoder->pixels[yCoord][xCoord];
+            row[xCoord * 2 + 0] = (unsigned char) pixel;
+            row[xCoord * 2 + 1] = (unsigned char) (pixel >> 8);
+        }
+        fwrite(row, 1, sizeof(row), video);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    const char *videoPath = NULL;
+    const char *framePrefix = NULL;
+    const char *lastFramePath = NULL;
+    const char *sourcePath = NULL;
+    int fps = DEFAULT_FPS;
+
+    for (int argument = 1; argument < argc; argument++) {
+        if (strcmp(argv[argument], "-o") == 0 && argument + 1 < argc) {
+            videoPath = argv[++argument];
+        } else if (strcmp(argv[argument], "-r") == 0 && argument + 1 < argc) {
+            fps = atoi(argv[++argument]);
+        } else if (strcmp(argv[argument], "-p") == 0 && argument + 1 < argc) {
+            framePrefix = argv[++argument];
+        } else if (strcmp(argv[argument], "-l") == 0 && argument + 1 < argc) {
+            lastFramePath = argv[++argument];
+        } else if (sourcePath == NULL && (argv[argument][0] != '-' || argv[argument][1] == '\0')) {
+            sourcePath = argv[argument];
+        } else {
+            sourcePath = NULL;
+            break;
+        }
+    }
+    if (sourcePath == NULL || fps < 1) {
+        fprintf(stderr, "usage: stream_decode [-o video.rgb565] [-r fps] [-p frame_prefix] [-l last_frame.ppm] stream | - | host:port\n");
+        return 2;
+    }
+
+    FILE *file;
+    if (strcmp(sourcePath, "-") == 0) {
+        file = stdin;
+    } else if (strchr(sourcePath, ':') != NULL) {
+        file = accept_client(sourcePath);
+    } else {
+        file = fopen(sourcePath, "rb");
+        if (file == NULL) {
+            perror(sourcePath);
+        }
+    }
+    if (file == NULL) {
+        return 1;
+    }
+
+    FILE *video = NULL;
+    if (videoPath != NULL && (video = fopen(videoPath, "wb")) == NULL) {
+        perror(videoPath);
+        return 1;
+    }
+
+    static StreamSource source;
+    static StreamDecoder decoder;
+    unsigned char header[STREAM_HEADER_SIZE];
+    if (!open_source(&source, file) || !read_source(&source, header, STREAM_HEADER_SIZE) || !stream_read_header(header)) {
+        fprintf(stderr, "%s: not a %dx%d frame stream\n", sourcePath, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+        return 1;
+    }
+    stream_decoder_init(&decoder);
+
+    static unsigned char frame[STREAM_MAX_FRAME_SIZE];
+    unsigned int keyframes = 0;
+    unsigned int largest = 0;
+    unsigned long bytes = STREAM_HEADER_SIZE;
+    unsigned long videoFrames = 0;
+    bool broken = false;
+
+    while (true) {
+
+        unsigned char sizeBytes[4];
+        if (!read_source(&source, sizeBytes, 4)) {
+            break;
+        }
+        unsigned int size = stream_frame_size(sizeBytes);
+        if (size > STREAM_MAX_FRAME_SIZE || !read_source(&source, frame, (int) size)) {
+            broken = true;
+            break;
+        }
+
+        //The frame on screen until now fills the video up to the time of this one
+        unsigned int milliseconds = size >= 4 ? frame[0] | frame[1] << 8 | frame[2] << 16 | (unsigned int) frame[3] << 24 : 0;
+        while (video != NULL && decoder.frames > 0 && videoFrames * 1000 / fps < milliseconds) {
+            write_video_frame(&decoder, video);
+            videoFrames++;
+        }
+
+        if (!stream_decode_frame(&decoder, frame, (int) size)) {
+            broken = true;
+            break;
+        }
+        keyframes += (frame[4] & STREAM_KEYFRAME) != 0;
+        largest = size + 4 > largest ? size + 4 : largest;
+        bytes += size + 4;
+
+        if (framePrefix != NULL) {
+            char path[1024];
+            snprintf(path, sizeof(path), "%s%05u.ppm", framePrefix, decoder.frames);
+            if (!write_ppm(&decoder, path)) {
+                perror(path);
+                return 1;
+            }
+        }
+    }
+
+    if (video != NULL && decoder.frames > 0) {
+        write_video_frame(&decoder, video);
+        videoFrames++;
+        fclose(video);
+    }
+    if (lastFramePath != NULL && !write_ppm(&decoder, lastFramePath)) {
+        perror(lastFramePath);
+        return 1;
+    }
+
+    printf("%u frames (%u keyframes) over %.2f s, %lu bytes, %.1f bytes per frame, largest %u\n", decoder.frames, keyframes,
+        decoder.milliseconds / 1000.0, bytes, decoder.frames ? (double) bytes / decoder.frames : 0.0, largest);
+    if (video != NULL) {
+        printf("%lu video frames at %d fps in %s\n", videoFrames, fps, videoPath);
+    }
+    if (broken) {
+        printf("the stream breaks off after frame %u\n", decoder.frames);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,626 @@
+/*
+Plays the engine against itself to measure whether a change makes it stronger.
+
+Two engines, A and B, play each other from a set of openings, every opening twice so
+each engine has both colours. A and B run the same search with different options (see
+SearchOptions), so a new part of the search is measured by turning it off for B. Every
+worker thread plays one game at a time with its own copy of the position and its own
+search tables, and takes the next game once it is done, so all cores are kept busy.
+
+Openings come from an EPD file (one FEN per line) or a PGN file (the first plies of
+every game), or are made up of random moves when no file is given. Each move is searched
+to a fixed time, node count or depth. The rules have no repetition or fifty move draw,
+so the tool declares a draw on the third repetition of a position and after a maximum
+number of plies.
+
+With -s the sequential probability ratio test (SPRT) stops the match as soon as the
+results show, with the given error rates, whether A is elo0 or elo1 stronger than B.
+
+With -N both engines can score with a network (nnue.h), turned on per engine with nnue=1,
+so a network is measured against eval.c by giving -A nnue=1 alone.
+
+The summary ends with what each engine's searches counted (search_stats.h): nodes, the
+share in quiescence, cutoffs on the first move and what the selective parts pruned. Each
+worker adds up the counts of its own searches, and they are only added together once the
+workers are done, so counting costs the threads no locks.
+
+Build: gcc -O2 -pthread -I. tools/tournament.c search.c search_stats.c movegen.c eval.c nnue.c nnue_host.c fen.c pgn.c san.c chess.c timer_host.c -lm -o tournament
+Usage: tournament [-j threads] [-g games] [-o openings.epd|pgn] [-p plies] [-t ms | -n nodes | -d depth]
+                  [-m max plies] [-A options] [-B options] [-N network] [-s elo0,elo1[,alpha,beta]] [-r seed] [-q]
+  -j  number of worker threads, all cores by default
+  -g  most games to play, 200 by default
+  -o  file of openings, random openings by default
+  -p  plies of each PGN game, or random plies, an opening takes, 8 by default
+  -t  milliseconds per move, -n nodes per move, -d depth per move, 10000 nodes by default
+  -m  plies after which a game is a draw, 300 by default
+  -A  options of engine A, -B options of engine B, such as quiescence=0,killers=0,history=0,nnue=1,
+      nullmove=0,reductions=0,futility=0,reversefutility=0,checkextensions=0
+  -N  network file the nnue option scores with
+  -s  SPRT bounds in Elo and error rates, alpha and beta are 0.05 by default
+  -r  seed of the random openings
+  -q  prints only the summary
+*/
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chess.h"
+#include "fen.h"
+#include "pgn.h"
+#include "san.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "search.h"
+#include "search_stats.h"
+#include "timer.h"
+
+
+// Most worker threads
+#define MAX_THREADS 256
+
+// Longest game, in plies, the repetition history has room for
+#define MAX_GAME_PLIES 2048
+
+// Ways a game ends
+#define END_CHECKMATE  0
+#define END_STALEMATE  1
+#define END_KING_TAKEN 2
+#define END_REPETITION 3
+#define END_MAX_PLIES  4
+
+
+//Opening holds a position games start from
+typedef struct Opening
+{
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn;
+} Opening;
+
+
+//PositionKey holds what makes two positions the same, to find repetitions
+typedef struct PositionKey
+{
+    PackedSquare squares[BOARD_SIZE * BOARD_SIZE];
+} PositionKey;
+
+
+//Worker holds the searches of one thread and what they have cost
+typedef struct Worker
+{
+    pthread_t thread;
+
+    //Indexed by engine, 0 for A and 1 for B
+    Search searches[2];
+
+    //Counts of every search each engine made, indexed the same way
+    SearchStats stats[2];
+    double searchSeconds;
+} Worker;
+
+
+//Openings and engines, set before the workers start
+static Opening *openings;
+static int openingCount;
+static SearchOptions engineOptions[2];
+static NnueNetwork *network = NULL;
+static SearchLimits limits;
+static int maxPlies = 300;
+static int gameCount = 200;
+static bool quiet = false;
+
+//SPRT bounds, used when sprtEnabled is set
+static bool sprtEnabled = false;
+static double elo0 = 0, elo1 = 10, sprtAlpha = 0.05, sprtBeta = 0.05;
+
+//Next game a worker takes
+static int nextGame = 0;
+
+//Results for engine A, only changed while holding resultLock
+static pthread_mutex_t resultLock = PTHREAD_MUTEX_INITIALIZER;
+static int wins = 0, draws = 0, losses = 0;
+static long long totalPlies = 0;
+static int endCounts[END_MAX_PLIES + 1];
+static bool stopped = false;
+static const char *sprtVerdict = NULL;
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Adds an opening to the list
+static void add_opening(PackedSquare board[BOARD_SIZE][BOARD_SIZE], int currentTurn) {
+
+    static int capacity = 0;
+    if (openingCount == capacity) {
+        capacity = capacity ? capacity * 2 : 64;
+        openings = realloc(openings, capacity * sizeof(Opening));
+        if (openings == NULL) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+
+    copy_board(board, openings[openingCount].board);
+    openings[openingCount].currentTurn = currentTurn;
+    openingCount++;
+}
+
+//Reads the openings of a PGN file, the position after the first plies of every game
+static void load_pgn_openings(const char *text, int length, int plies) {
+
+    PgnReader reader;
+    pgn_reader_init(&reader, text, text + length);
+
+    const PgnGame *game;
+    while ((game = pgn_next_game(&reader)) != NULL) {
+
+        PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+        int currentTurn = WHITE_PIECE;
+
+        //A game may start from a set up position, the tag is copied to terminate it
+        PgnSlice fenTag;
+        FenState state;
+        char fen[FEN_MAX_SIZE * 2];
+        init_board(board);
+        if (pgn_tag(game, "FEN", &fenTag) && fenTag.length < (int) sizeof(fen)) {
+            memcpy(fen, fenTag.text, fenTag.length);
+            fen[fenTag.length] = '\0';
+            if (!fen_load(fen, board, &state)) {
+                continue;
+            }
+            currentTurn = state.currentTurn;
+        }
+
+        //The opening stops early at a move the rules do not allow
+        PgnSlice move;
+        int played = 0;
+        while (played < plies && pgn_next_move(&reader, &move)) {
+            SanMove resolved;
+            if (san_resolve(board, currentTurn, move.text, move.length, &resolved) != SAN_OK) {
+                break;
+            }
+            move_piece(board, resolved.xCoordStart, resolved.yCoordStart, resolved.xCoordEnd, resolved.yCoordEnd);
+            switch_turns(&currentTurn);
+            played++;
+        }
+
+        if (!is_game_over(board, currentTurn)) {
+            add_opening(board, currentTurn);
+        }
+    }
+}
+
+//Reads the openings of an EPD file, one position per line
+static void load_epd_openings(char *text) {
+
+    for (char *line = strtok(text, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+
+        PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+        FenState state;
+        if (fen_load(line, board, &state) && !is_game_over(board, state.currentTurn)) {
+            add_opening(board, state.currentTurn);
+        }
+    }
+}
+
+//Reads the openings of a file, PGN if it has a tag line and EPD otherwise
+static bool load_openings(const char *path, int plies) {
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc(length + 1);
+    if (text == NULL || fread(text, 1, length, file) != (size_t) length) {
+        perror(path);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    text[length] = '\0';
+
+    if (pgn_sync(text, text, text + length) < text + length) {
+        load_pgn_openings(text, (int) length, plies);
+    } else {
+        load_epd_openings(text);
+    }
+
+    //Openings hold copies of the boards, the text is not needed any more
+    free(text);
+    return true;
+}
+
+//Makes up openings of random moves from the initial position
+static void make_random_openings(int count, int plies, unsigned int seed) {
+
+    while (openingCount < count) {
+
+        PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+        int currentTurn = WHITE_PIECE;
+        init_board(board);
+
+        int played = 0;
+        for (; played < plies; played++) {
+            Move moves[MAX_MOVES];
+            int moveCount = generate_moves(board, currentTurn, moves);
+            if (moveCount == 0) {
+                break;
+            }
+            make_move(board, moves[rand_r(&seed) % moveCount]);
+            switch_turns(&currentTurn);
+        }
+
+        if (played == plies && !is_game_over(board, currentTurn)) {
+            add_opening(board, currentTurn);
+        }
+    }
+}
+
+//Sets a search option from name=value text
+static bool parse_options(char *text, SearchOptions *options) {
+
+    for (char *option = strtok(text, ","); option != NULL; option = strtok(NULL, ",")) {
+
+        char *equals = strchr(option, '=');
+        if (equals == NULL) {
+            return false;
+        }
+        *equals = '\0';
+        bool value = atoi(equals + 1) != 0;
+
+        if (strcmp(option, "quiescence") == 0) {
+            options->quiescence = value;
+        } else if (strcmp(option, "killers") == 0) {
+            options->killers = value;
+        } else if (strcmp(option, "history") == 0) {
+            options->history = value;
+        } else if (strcmp(option, "nullmove") == 0) {
+            options->nullMove = value;
+        } else if (strcmp(option, "reductions") == 0) {
+            options->reductions = value;
+        } else if (strcmp(option, "futility") == 0) {
+            options->futility = value;
+        } else if (strcmp(option, "reversefutility") == 0) {
+            options->reverseFutility = value;
+        } else if (strcmp(option, "checkextensions") == 0) {
+            options->checkExtensions = value;
+        } else if (strcmp(option, "nnue") == 0) {
+            options->nnue = value;
+        } else {
+            fprintf(stderr, "unknown search option %s\n", option);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Fills key with the position
+//A packed board already has one value per piece and colour, so it is the key as it is
+static void position_key(PackedSquare board[BOARD_SIZE][BOARD_SIZE], PositionKey *key) {
+    memcpy(key->squares, board, sizeof(key->squares));
+}
+
+//Plays one game from an opening
+//Returns the winner, WHITE_PIECE, BLACK_PIECE or STALEMATE for a draw, and sets how it ended
+static int play_game(Worker *worker, Opening *opening, bool engineAIsWhite, int *end, int *plies) {
+
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+    int currentTurn = opening->currentTurn;
+    copy_board(opening->board, board);
+
+    //Positions after every ply, the same side is to move every second one
+    static __thread PositionKey history[MAX_GAME_PLIES + 1];
+    position_key(board, &history[0]);
+
+    for (*plies = 0; *plies < maxPlies; (*plies)++) {
+
+        //A white king can walk into a pawn and be taken, the rules then play on without it
+        if (get_king_position(board, currentTurn).xCoord < 0) {
+            *end = END_KING_TAKEN;
+            return !currentTurn;
+        }
+        if (is_game_over(board, currentTurn)) {
+            int winner = get_winner(board, currentTurn);
+            *end = winner == STALEMATE ? END_STALEMATE : END_CHECKMATE;
+            return winner;
+        }
+
+        bool engineA = (currentTurn == WHITE_PIECE) == engineAIsWhite;
+        Search *search = &worker->searches[engineA ? 0 : 1];
+        search_start(search, board, currentTurn, &limits);
+        search_run(search);
+        search_stats_add(&worker->stats[engineA ? 0 : 1], &search->stats);
+        worker->searchSeconds += search_elapsed(search) * 1e-6;
+
+        Move move = search->bestMove;
+        move_piece(board, MOVE_X(move.start), MOVE_Y(move.start), MOVE_X(move.end), MOVE_Y(move.end));
+        switch_turns(&currentTurn);
+
+        //Third time the same position comes up with the same side to move
+        position_key(board, &history[*plies + 1]);
+        int repetitions = 1;
+        for (int earlier = *plies - 1; earlier >= 0; earlier -= 2) {
+            if (memcmp(&history[earlier], &history[*plies + 1], sizeof(PositionKey)) == 0) {
+                repetitions++;
+            }
+        }
+        if (repetitions >= 3) {
+            (*plies)++;
+            *end = END_REPETITION;
+            return STALEMATE;
+        }
+    }
+
+    *end = END_MAX_PLIES;
+    return STALEMATE;
+}
+
+//Returns the expected score of an engine that is elo stronger
+static double expected_score(double elo) {
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+//Returns the Elo difference that gives an expected score
+static double score_elo(double score) {
+
+    if (score <= 0) return -INFINITY;
+    if (score >= 1) return INFINITY;
+    return -400 * log10(1 / score - 1);
+}
+
+//Returns the mean score of engine A and the variance of the score of one game
+static double score_statistics(double *variance) {
+
+    int games = wins + draws + losses;
+    double score = (wins + draws * 0.5) / games;
+    *variance = (wins * (1 - score) * (1 - score) + draws * (0.5 - score) * (0.5 - score) + losses * score * score) / games;
+    return score;
+}
+
+//Returns the log likelihood ratio of elo1 against elo0, the normal approximation of the generalized SPRT
+static double sprt_llr() {
+
+    int games = wins + draws + losses;
+    if (games == 0) {
+        return 0;
+    }
+
+    double variance;
+    double score = score_statistics(&variance);
+    if (variance <= 0) {
+        return 0;
+    }
+
+    double score0 = expected_score(elo0);
+    double score1 = expected_score(elo1);
+    return (score1 - score0) * (2 * score - score0 - score1) * games / (2 * variance);
+}
+
+//Counts a finished game and checks if the SPRT has decided, must hold resultLock
+static void add_result(int game, bool engineAIsWhite, int winner, int end, int plies) {
+
+    static const char *END_NAMES[] = {"checkmate", "stalemate", "king taken", "repetition", "max plies"};
+
+    if (winner == STALEMATE) {
+        draws++;
+    } else if ((winner == WHITE_PIECE) == engineAIsWhite) {
+        wins++;
+    } else {
+        losses++;
+    }
+    totalPlies += plies;
+    endCounts[end]++;
+
+    if (!quiet) {
+        const char *result = winner == STALEMATE ? "1/2-1/2" : winner == WHITE_PIECE ? "1-0" : "0-1";
+        printf("game %d: %s vs %s %s (%s, %d plies)  +%d =%d -%d\n", game + 1, engineAIsWhite ? "A" : "B", engineAIsWhite ? "B" : "A",
+            result, END_NAMES[end], plies, wins, draws, losses);
+    }
+
+    if (sprtEnabled && sprtVerdict == NULL) {
+        double llr = sprt_llr();
+        if (llr >= log((1 - sprtBeta) / sprtAlpha)) {
+            sprtVerdict = "H1 accepted, A is stronger";
+            stopped = true;
+        } else if (llr <= log(sprtBeta / (1 - sprtAlpha))) {
+            sprtVerdict = "H0 accepted, A is not stronger";
+            stopped = true;
+        }
+    }
+}
+
+//Takes games until there are none left or the SPRT has decided
+static void * worker_main(void *argument) {
+
+    Worker *worker = argument;
+
+    while (true) {
+
+        int game = __atomic_fetch_add(&nextGame, 1, __ATOMIC_RELAXED);
+        if (game >= gameCount || __atomic_load_n(&stopped, __ATOMIC_RELAXED)) {
+            return NULL;
+        }
+
+        //Both games of an opening are played with the colours swapped
+        Opening *opening = &openings[(game / 2) % openingCount];
+        bool engineAIsWhite = game % 2 == 0;
+
+        int end;
+        int plies;
+        int winner = play_game(worker, opening, engineAIsWhite, &end, &plies);
+
+        pthread_mutex_lock(&resultLock);
+        if (!stopped) {
+            add_result(game, engineAIsWhite, winner, end, plies);
+        }
+        pthread_mutex_unlock(&resultLock);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    int threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    const char *openingPath = NULL;
+    int openingPlies = 8;
+    unsigned int seed = 1;
+
+    search_options_init(&engineOptions[0]);
+    search_options_init(&engineOptions[1]);
+    limits.nodes = 10000;
+
+    bool usage = false;
+    for (int argument = 1; argument < argc && !usage; argument++) {
+
+        const char *flag = argv[argument];
+        char *value = argument + 1 < argc ? argv[argument + 1] : NULL;
+        bool takesValue = strcmp(flag, "-q") != 0;
+        if (takesValue && value == NULL) {
+            usage = true;
+            break;
+        }
+
+        if (strcmp(flag, "-j") == 0) {
+            threadCount = atoi(value);
+        } else if (strcmp(flag, "-g") == 0) {
+            gameCount = atoi(value);
+        } else if (strcmp(flag, "-o") == 0) {
+            openingPath = value;
+        } else if (strcmp(flag, "-p") == 0) {
+            openingPlies = atoi(value);
+        } else if (strcmp(flag, "-t") == 0) {
+            SearchLimits timed = {0, 0, (unsigned int) atoi(value)};
+            limits = timed;
+        } else if (strcmp(flag, "-n") == 0) {
+            SearchLimits counted = {0, atoll(value), 0};
+            limits = counted;
+        } else if (strcmp(flag, "-d") == 0) {
+            SearchLimits deep = {atoi(value), 0, 0};
+            limits = deep;
+        } else if (strcmp(flag, "-m") == 0) {
+            maxPlies = atoi(value);
+        } else if (strcmp(flag, "-A") == 0) {
+            usage = !parse_options(value, &engineOptions[0]);
+        } else if (strcmp(flag, "-B") == 0) {
+            usage = !parse_options(value, &engineOptions[1]);
+        } else if (strcmp(flag, "-N") == 0) {
+            network = malloc(sizeof(NnueNetwork));
+            if (network == NULL || !nnue_host_load(network, value)) {
+                fprintf(stderr, "%s: not a network\n", value);
+                return 2;
+            }
+        } else if (strcmp(flag, "-s") == 0) {
+            sprtEnabled = sscanf(value, "%lf,%lf,%lf,%lf", &elo0, &elo1, &sprtAlpha, &sprtBeta) >= 2;
+            usage = !sprtEnabled;
+        } else if (strcmp(flag, "-r") == 0) {
+            seed = (unsigned int) atoi(value);
+        } else if (strcmp(flag, "-q") == 0) {
+            quiet = true;
+        } else {
+            usage = true;
+        }
+        if (takesValue) {
+            argument++;
+        }
+    }
+    if (usage || gameCount < 1 || maxPlies < 1 || maxPlies > MAX_GAME_PLIES) {
+        fprintf(stderr, "usage: tournament [-j threads] [-g games] [-o openings.epd|pgn] [-p plies] [-t ms | -n nodes | -d depth]\n"
+                        "                  [-m max plies] [-A options] [-B options] [-N network] [-s elo0,elo1[,alpha,beta]] [-r seed] [-q]\n");
+        return 2;
+    }
+    if ((engineOptions[0].nnue || engineOptions[1].nnue) && network == NULL) {
+        fprintf(stderr, "nnue=1 needs a network, given with -N\n");
+        return 2;
+    }
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+
+    if (openingPath != NULL) {
+        if (!load_openings(openingPath, openingPlies)) {
+            return 2;
+        }
+        if (openingCount == 0) {
+            fprintf(stderr, "%s: no openings\n", openingPath);
+            return 2;
+        }
+    } else {
+        make_random_openings((gameCount + 1) / 2, openingPlies, seed);
+    }
+
+    timer_init();
+
+    Worker *workers = calloc(threadCount, sizeof(Worker));
+    if (workers == NULL) {
+        perror("calloc");
+        return 2;
+    }
+
+    double start = now_seconds();
+
+    for (int thread = 0; thread < threadCount; thread++) {
+        search_init(&workers[thread].searches[0], &engineOptions[0]);
+        search_init(&workers[thread].searches[1], &engineOptions[1]);
+        search_set_network(&workers[thread].searches[0], network);
+        search_set_network(&workers[thread].searches[1], network);
+        pthread_create(&workers[thread].thread, NULL, worker_main, &workers[thread]);
+    }
+
+    SearchStats stats[2];
+    memset(stats, 0, sizeof(stats));
+    double searchSeconds = 0;
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_join(workers[thread].thread, NULL);
+        search_stats_add(&stats[0], &workers[thread].stats[0]);
+        search_stats_add(&stats[1], &workers[thread].stats[1]);
+        searchSeconds += workers[thread].searchSeconds;
+    }
+    long long nodes = stats[0].nodes + stats[1].nodes;
+
+    double elapsed = now_seconds() - start;
+    if (elapsed <= 0) elapsed = 1e-9;
+    if (searchSeconds <= 0) searchSeconds = 1e-9;
+
+    int games = wins + draws + losses;
+    printf("%d games from %d openings on %d threads: A +%d =%d -%d\n", games, openingCount, threadCount, wins, draws, losses);
+    printf("endings: %d checkmate, %d stalemate, %d king taken, %d repetition, %d max plies\n", endCounts[END_CHECKMATE],
+        endCounts[END_STALEMATE], endCounts[END_KING_TAKEN], endCounts[END_REPETITION], endCounts[END_MAX_PLIES]);
+
+    if (games > 0) {
+        //95% interval of the mean score, as Elo
+        double variance;
+        double score = score_statistics(&variance);
+        double margin = 1.96 * sqrt(variance / games);
+        double elo = score_elo(score);
+        printf("score %.3f, Elo %+.1f (%+.1f .. %+.1f)\n", score, elo, score_elo(score - margin), score_elo(score + margin));
+    }
+    if (sprtEnabled) {
+        printf("SPRT elo0 %.1f elo1 %.1f alpha %.3f beta %.3f: LLR %.2f (%.2f, %.2f), %s\n", elo0, elo1, sprtAlpha, sprtBeta, sprt_llr(),
+            log(sprtBeta / (1 - sprtAlpha)), log((1 - sprtBeta) / sprtAlpha), sprtVerdict != NULL ? sprtVerdict : "no decision");
+    }
+    printf("%.3f s: %.2f games/s, %.1f plies/game, %lld nodes, %.0f nodes/s per thread, %.0f nodes/s in total\n", elapsed,
+        games / elapsed, games > 0 ? (double) totalPlies / games : 0.0, nodes, nodes / searchSeconds, nodes / elapsed);
+
+    char line[256];
+    search_stats_format_totals(&stats[0], line, sizeof(line));
+    printf("A: %s\n", line);
+    search_stats_format_totals(&stats[1], line, sizeof(line));
+    printf("B: %s\n", line);
+
+    return 0;
+}
@@ -0,0 +1,468 @@
+/*
+Tunes the evaluation parameters against positions with known results (the Texel method).
+
+Every position of an EPD file comes with the result of the game it was taken from. The
+evaluation of eval.c turned into an expected result by a sigmoid,
+
+  expected = 1 / (1 + 10^(-scale * score / 400)),   score from white's side in centipawns
+
+should match the results, and the mean squared difference is the loss. The evaluation
+is a sum of piece values and square bonuses, so the gradient of the loss with respect to
+each of them comes straight out of the pieces on the board, and the parameters follow it
+downhill (with Adam steps) for a number of epochs. The king's value is left alone, both
+sides always have one.
+
+The file is read once into a packed array, every piece two bytes: its square as eval.c
+reads the tables (upside down for black), its PieceIdx and its colour. Each epoch cuts
+the array into one slice per worker thread, the workers add up the loss and gradient of
+their slice, and the slices are summed.
+
+The scale is fitted to the starting parameters unless given. The tuned values are written
+as a header in the form of eval_params.h; copying it over eval_params.h builds them into
+the board and every tool.
+
+Results are read from the line after the position: c9 "1-0"; "1/2-1/2" "0-1" or [1.0]
+[0.5] [0.0], all from white's side.
+
+Build: gcc -O2 -pthread -I. tools/tune.c fen.c chess.c -lm -o tune
+Usage: tune [-j threads] [-e epochs] [-l rate] [-k scale] [-o header] positions.epd
+  -j  number of worker threads, all cores by default
+  -e  epochs, passes over every position, 300 by default
+  -l  learning rate, the largest step of a parameter per epoch in centipawns, 1 by default
+  -k  scale of the sigmoid, fitted to the starting parameters by default
+  -o  header to write the tuned values to, eval_params_tuned.h by default
+*/
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chess.h"
+#include "eval_params.h"
+#include "fen.h"
+
+
+// Most worker threads
+#define MAX_THREADS 256
+
+// Steps of Adam
+#define ADAM_BETA1   0.9
+#define ADAM_BETA2   0.999
+#define ADAM_EPSILON 1e-8
+
+// Range and steps of the search for the scale
+#define SCALE_LOW   0.01
+#define SCALE_HIGH  5.0
+#define SCALE_STEPS 40
+
+// A piece of a packed position
+#define TUNE_PIECE(square, pieceId, black) ((uint16_t) ((square) | (pieceId) << 6 | (black) << 9))
+#define TUNE_PIECE_SQUARE(piece) ((piece) & 63)
+#define TUNE_PIECE_ID(piece) (((piece) >> 6) & 7)
+#define TUNE_PIECE_BLACK(piece) ((piece) >> 9)
+
+
+//EvalParams holds every parameter, or the gradient of the loss with respect to each of them
+typedef struct EvalParams
+{
+    double values[KING + 1];
+    double bonus[KING + 1][BOARD_SIZE * BOARD_SIZE];
+} EvalParams;
+
+
+//PackedPosition holds where the pieces of a position start in the piece array and its result
+typedef struct PackedPosition
+{
+    unsigned int firstPiece;
+    unsigned char pieceCount;
+
+    //White's result in halves: 0 lost, 1 drawn, 2 won
+    unsigned char result;
+} PackedPosition;
+
+
+//Worker holds a slice of the positions and what they add to the loss and gradient
+typedef struct Worker
+{
+    pthread_t thread;
+    int first;
+    int last;
+    double loss;
+    EvalParams gradient;
+} Worker;
+
+
+//Positions, read once
+static PackedPosition *positions;
+static uint16_t *pieces;
+static int positionCount = 0;
+
+//Parameters of the pass the workers run, set before they start
+static EvalParams params;
+static double scale = 0;
+static bool wantGradient = false;
+
+static Worker workers[MAX_THREADS];
+static int threadCount;
+
+
+//Returns a monotonic timestamp in seconds
+static double now_seconds() {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Reads the result after a position, in halves from white's side
+//Returns -1 if the line has none
+static int parse_result(const char *line) {
+
+    if (strstr(line, "1/2-1/2") != NULL || strstr(line, "[0.5]") != NULL) return 1;
+    if (strstr(line, "1-0") != NULL || strstr(line, "[1.0]") != NULL || strstr(line, "[1]") != NULL) return 2;
+    if (strstr(line, "0-1") != NULL || strstr(line, "[0.0]") != NULL || strstr(line, "[0]") != NULL) return 0;
+    return -1;
+}
+
+//Reads every position of a file into the packed array
+//Returns false if the file can not be read
+static bool load_positions(const char *path) {
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    int capacity = 0;
+    int pieceCapacity = 0;
+    int skipped = 0;
+    unsigned int pieceTotal = 0;
+    char line[512];
+    PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+
+        int result = parse_result(line);
+        if (result < 0 || !fen_load(line, board, NULL)) {
+            skipped += line[0] != '\n' && line[0] != '\0';
+            continue;
+        }
+
+        //The arrays grow by half again, a corpus is read once
+        if (positionCount == capacity) {
+            capacity = capacity > 0 ? capacity + capacity / 2 : 65536;
+            positions = realloc(positions, capacity * sizeof(PackedPosition));
+        }
+        if ((int) pieceTotal + BOARD_SIZE * BOARD_SIZE > pieceCapacity) {
+            pieceCapacity = pieceCapacity > 0 ? pieceCapacity + pieceCapacity / 2 : 65536 * 32;
+            pieces = realloc(pieces, pieceCapacity * sizeof(uint16_t));
+        }
+        if (positions == NULL || pieces == NULL) {
+            fprintf(stderr, "out of memory\n");
+            fclose(file);
+            return false;
+        }
+
+        PackedPosition *position = &positions[positionCount++];
+        position->firstPiece = pieceTotal;
+        position->pieceCount = 0;
+        position->result = (unsigned char) result;
+
+        for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+            for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+                PackedSquare square = board[yCoord][xCoord];
+                if (PACKED_PIECE_ID(square) == EMPTY_SQUARE) {
+                    continue;
+                }
+                int black = PACKED_COLOUR(square) == BLACK_PIECE;
+                int rank = black ? BOARD_SIZE - 1 - yCoord : yCoord;
+                pieces[pieceTotal++] = TUNE_PIECE(rank * BOARD_SIZE + xCoord, PACKED_PIECE_ID(square), black);
+                position->pieceCount++;
+            }
+        }
+    }
+
+    fclose(file);
+    if (skipped > 0) {
+        fprintf(stderr, "%s: skipped %d lines without a position and a result\n", path, skipped);
+    }
+    return true;
+}
+
+//Returns the score of a packed position from white's side with the parameters
+static double packed_score(const PackedPosition *position) {
+
+    double score = 0;
+    for (unsigned int index = position->firstPiece; index < position->firstPiece + position->pieceCount; index++) {
+        uint16_t piece = pieces[index];
+        double value = params.values[TUNE_PIECE_ID(piece)] + params.bonus[TUNE_PIECE_ID(piece)][TUNE_PIECE_SQUARE(piece)];
+        score += TUNE_PIECE_BLACK(piece) ? -value : value;
+    }
+    return score;
+}
+
+//Adds up the loss, and the gradient if wanted, of a worker's slice
+static void * worker_main(void *argument) {
+
+    Worker *worker = argument;
+    worker->loss = 0;
+    memset(&worker->gradient, 0, sizeof(worker->gradient));
+
+    //The slope of the sigmoid is expected * (1 - expected) times this
+    double slope = scale * log(10.0) / 400.0;
+
+    for (int index = worker->first; index < worker->last; index++) {
+
+        const PackedPosition *position = &positions[index];
+        double expected = 1.0 / (1.0 + pow(10.0, -scale * packed_score(position) / 400.0));
+        double error = position->result * 0.5 - expected;
+        worker->loss += error * error;
+        if (!wantGradient) {
+            continue;
+        }
+
+        //Every piece moves the score by one centipawn per centipawn of its value and bonus
+        double step = -2.0 * error * expected * (1.0 - expected) * slope;
+        for (unsigned int piece = position->firstPiece; piece < position->firstPiece + position->pieceCount; piece++) {
+            double signedStep = TUNE_PIECE_BLACK(pieces[piece]) ? -step : step;
+            worker->gradient.values[TUNE_PIECE_ID(pieces[piece])] += signedStep;
+            worker->gradient.bonus[TUNE_PIECE_ID(pieces[piece])][TUNE_PIECE_SQUARE(pieces[piece])] += signedStep;
+        }
+    }
+
+    return NULL;
+}
+
+//Runs the workers over every position
+//Returns the mean loss, and fills gradient with the mean gradient if it is not NULL
+static double run_pass(EvalParams *gradient) {
+
+    wantGradient = gradient != NULL;
+    for (int thread = 0; thread < threadCount; thread++) {
+        workers[thread].first = (int) ((long long) positionCount * thread / threadCount);
+        workers[thread].last = (int) ((long long) positionCount * (thread + 1) / threadCount);
+        pthread_create(&workers[thread].thread, NULL, worker_main, &workers[thread]);
+    }
+
+    double loss = 0;
+    if (gradient != NULL) {
+        memset(gradient, 0, sizeof(*gradient));
+    }
+    for (int thread = 0; thread < threadCount; thread++) {
+        pthread_join(workers[thread].thread, NULL);
+        loss += workers[thread].loss;
+        if (gradient == NULL) {
+            continue;
+        }
+        for (int pieceId = 0; pieceId <= KING; pieceId++) {
+            gradient->values[pieceId] += workers[thread].gradient.values[pieceId] / positionCount;
+            for (int square = 0; square < BOARD_SIZE * BOARD_SIZE; square++) {
+                gradient->bonus[pieceId][square] += workers[thread].gradient.bonus[pieceId][square] / positionCount;
+            }
+        }
+    }
+
+    return loss / positionCount;
+}
+
+//Finds the scale with the lowest loss for the parameters, by golden section search
+static double fit_scale() {
+
+    double ratio = (sqrt(5.0) - 1) / 2;
+    double low = SCALE_LOW;
+    double high = SCALE_HIGH;
+
+    for (int step = 0; step < SCALE_STEPS; step++) {
+        double lower = high - ratio * (high - low);
+        double upper = low + ratio * (high - low);
+        scale = lower;
+        double lowerLoss = run_pass(NULL);
+        scale = upper;
+        double upperLoss = run_pass(NULL);
+        if (lowerLoss < upperLoss) {
+            high = upper;
+        } else {
+            low = lower;
+        }
+    }
+
+    return (low + high) / 2;
+}
+
+//Moves every parameter but the king's value one Adam step against its gradient
+static void adam_step(const EvalParams *gradient, EvalParams *mean, EvalParams *variance, int epoch, double rate) {
+
+    double *value = (double *) &params;
+    const double *slope = (const double *) gradient;
+    double *means = (double *) mean;
+    double *variances = (double *) variance;
+    double meanCorrection = 1 - pow(ADAM_BETA1, epoch);
+    double varianceCorrection = 1 - pow(ADAM_BETA2, epoch);
+
+    for (size_t index = 0; index < sizeof(EvalParams) / sizeof(double); index++) {
+        if (&value[index] == &params.values[KING]) {
+            continue;
+        }
+        means[index] = ADAM_BETA1 * means[index] + (1 - ADAM_BETA1) * slope[index];
+        variances[index] = ADAM_BETA2 * variances[index] + (1 - ADAM_BETA2) * slope[index] * slope[index];
+        value[index] -= rate * (means[index] / meanCorrection) / (sqrt(variances[index] / varianceCorrection) + ADAM_EPSILON);
+    }
+}
+
+//Writes the parameters as a header in the form of eval_params.h
+//Returns false if the file can not be written
+static bool write_header(const char *path, const char *corpusPath, int epochs, double loss) {
+
+    static const char *PIECE_NAMES[KING + 1] = {"", "Pawn", "Knight", "Bishop", "Rook", "Queen", "King"};
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    fprintf(file, "/*\n"
+                  "Evaluation parameters, the material of every piece and its bonus on every square.\n"
+                  "\n"
+                  "Included by eval.c, and by tools/tune.c, which starts from these values, tunes them\n"
+                  "against a file of positions with known results and writes this file again in the same\n"
+                  "form, so a tuned set is built into the board by replacing it. The tables are written for\n"
+                  "white, yCoord 0 being the far rank.\n"
+                  "\n"
+                  "Tuned on %s, %d positions, %d epochs, loss %.6f at scale %.4f.\n"
+                  "*/\n"
+                  "\n"
+                  "#ifndef EVAL_PARAMS_H\n"
+                  "#define EVAL_PARAMS_H\n"
+                  "\n"
+                  "#include \"chess.h\"\n"
+                  "\n"
+                  "\n"
+                  "//Material of each piece, indexed by PieceIdx\n"
+                  "//The king is never traded, so it is worth nothing here\n"
+                  "static const int PIECE_VALUES[KING + 1] = {", corpusPath, positionCount, epochs, loss, scale);
+    for (int pieceId = 0; pieceId <= KING; pieceId++) {
+        fprintf(file, "%s%ld", pieceId > 0 ? ", " : "", lround(params.values[pieceId]));
+    }
+    fprintf(file, "};\n"
+                  "\n"
+                  "//Bonus of each piece on each square for white, indexed by PieceIdx then yCoord * BOARD_SIZE + xCoord\n"
+                  "static const int SQUARE_BONUS[KING + 1][BOARD_SIZE * BOARD_SIZE] = {\n"
+                  "    {0},\n");
+    for (int pieceId = PAWN; pieceId <= KING; pieceId++) {
+        fprintf(file, "    //%s\n    {\n", PIECE_NAMES[pieceId]);
+        for (int yCoord = 0; yCoord < BOARD_SIZE; yCoord++) {
+            fprintf(file, "       ");
+            for (int xCoord = 0; xCoord < BOARD_SIZE; xCoord++) {
+                fprintf(file, " %3ld%s", lround(params.bonus[pieceId][yCoord * BOARD_SIZE + xCoord]),
+                        xCoord < BOARD_SIZE - 1 || yCoord < BOARD_SIZE - 1 ? "," : "");
+            }
+            fprintf(file, "\n");
+        }
+        fprintf(file, "    }%s\n", pieceId < KING ? "," : "");
+    }
+    fprintf(file, "};\n\n#endif\n");
+
+    return fclose(file) == 0;
+}
+
+int main(int argc, char **argv) {
+
+    threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int epochs = 300;
+    double rate = 1.0;
+    const char *outputPath = "eval_params_tuned.h";
+    const char *corpusPath = NULL;
+
+    bool usage = false;
+    for (int argument = 1; argument < argc && !usage; argument++) {
+
+        const char *flag = argv[argument];
+        const char *value = argument + 1 < argc ? argv[argument + 1] : NULL;
+        if (flag[0] != '-') {
+            usage = corpusPath != NULL;
+            corpusPath = flag;
+            continue;
+        }
+        if (value == NULL) {
+            usage = true;
+            break;
+        }
+
+        if (strcmp(flag, "-j") == 0) {
+            threadCount = atoi(value);
+        } else if (strcmp(flag, "-e") == 0) {
+            epochs = atoi(value);
+        } else if (strcmp(flag, "-l") == 0) {
+            rate = atof(value);
+        } else if (strcmp(flag, "-k") == 0) {
+            scale = atof(value);
+        } else if (strcmp(flag, "-o") == 0) {
+            outputPath = value;
+        } else {
+            usage = true;
+        }
+        argument++;
+    }
+    if (usage || corpusPath == NULL || epochs < 0 || rate <= 0) {
+        fprintf(stderr, "usage: tune [-j threads] [-e epochs] [-l rate] [-k scale] [-o header] positions.epd\n");
+        return 2;
+    }
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+
+    //Tuning starts from the values the build uses
+    for (int pieceId = 0; pieceId <= KING; pieceId++) {
+        params.values[pieceId] = PIECE_VALUES[pieceId];
+        for (int square = 0; square < BOARD_SIZE * BOARD_SIZE; square++) {
+            params.bonus[pieceId][square] = SQUARE_BONUS[pieceId][square];
+        }
+    }
+
+    double start = now_seconds();
+    if (!load_positions(corpusPath)) {
+        return 1;
+    }
+    if (positionCount == 0) {
+        fprintf(stderr, "%s: no positions with a result\n", corpusPath);
+        return 1;
+    }
+    printf("%d positions, %d pieces, %.1f MB packed, read in %.2f s\n", positionCount, positions[positionCount - 1].firstPiece + positions[positionCount - 1].pieceCount,
+           (positionCount * sizeof(PackedPosition) + (positions[positionCount - 1].firstPiece + positions[positionCount - 1].pieceCount) * sizeof(uint16_t)) / 1e6,
+           now_seconds() - start);
+
+    if (scale <= 0) {
+        scale = fit_scale();
+        printf("scale %.4f fitted to the starting values\n", scale);
+    }
+
+    static EvalParams gradient, mean, variance;
+    double loss = run_pass(NULL);
+    printf("epoch    0  loss %.6f\n", loss);
+
+    double tuneStart = now_seconds();
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        double epochStart = now_seconds();
+        loss = run_pass(&gradient);
+        adam_step(&gradient, &mean, &variance, epoch, rate);
+        printf("epoch %4d  loss %.6f  %.1f ms\n", epoch, loss, (now_seconds() - epochStart) * 1000);
+    }
+
+    //The loss of the last step's parameters, which are the ones written
+    loss = run_pass(NULL);
+    double tuneSeconds = now_seconds() - tuneStart;
+    printf("final loss %.6f, %d epochs on %d threads in %.2f s, %.0f positions/s\n", loss, epochs, threadCount, tuneSeconds,
+           tuneSeconds > 0 ? (double) positionCount * epochs / tuneSeconds : 0);
+
+    if (!write_header(outputPath, corpusPath, epochs, loss)) {
+        return 1;
+    }
+    printf("wrote %s\n", outputPath);
+    return 0;
+}
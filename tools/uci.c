@@ -0,0 +1,410 @@
+/*
+Universal Chess Interface (UCI) front end for the engine.
+
+Speaks UCI on stdin and stdout, so chess GUIs and match tools can play and benchmark the
+engine with no board in the loop. The search is the one the board runs (search.c), on
+the same rules (chess.c); positions are set up with fen.c. Moves are in coordinate
+notation, e2e4, and the rules have no castling, promotion or en passant.
+
+The search runs on its own thread so stop and isready are answered while it thinks.
+Every finished depth is reported as an info line with the depth, score, nodes, nps,
+time and principal variation. The MultiPV option reports that many best moves, one info
+line each, numbered from the best.
+
+The EvalFile option loads a network (nnue.h) and the NNUE option scores with it instead
+of eval.c. With the Stats option on, every finished depth is also reported as an info
+string with its quiescence nodes, first move cutoffs and branching factor, and the search
+ends with one with its totals (search_stats.h).
+
+Build: gcc -O2 -pthread -I. tools/uci.c search.c search_stats.c movegen.c eval.c nnue.c nnue_host.c fen.c chess.c timer_host.c -o uci
+Commands: uci, isready, setoption, ucinewgame, position startpos|fen <fen> [moves ...],
+          go [depth n] [nodes n] [movetime ms] [wtime ms] [btime ms] [winc ms] [binc ms] [movestogo n] [infinite],
+          stop, quit
+*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "chess.h"
+#include "fen.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "search.h"
+#include "search_stats.h"
+#include "timer.h"
+
+
+// Moves assumed left in the game when the GUI does not say, to share out the clock
+#define DEFAULT_MOVES_TO_GO 30
+
+// Time kept back from the clock for the GUI and the pipe, in milliseconds
+#define MOVE_OVERHEAD_MS 50
+
+
+//The position set up by the last position command
+static PackedSquare board[BOARD_SIZE][BOARD_SIZE];
+static int currentTurn;
+
+//The search, and the thread running it while searching is set
+static Search search;
+static SearchOptions options;
+
+//Network loaded with EvalFile, the search scores with it once NNUE is on
+static NnueNetwork network;
+static bool networkLoaded = false;
+static pthread_t searchThread;
+static bool searching = false;
+static bool infinite = false;
+
+//Set by the Stats option, every depth and the end of the search report their counts as info strings
+static bool showStats = false;
+
+//Output from the search thread and the main thread is not interleaved
+static pthread_mutex_t outputLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+//Prints a line, holding outputLock so the threads do not mix their lines
+static void print_line(const char *format, ...) __attribute__((format(printf, 1, 2)));
+static void print_line(const char *format, ...) {
+
+    va_list arguments;
+    va_start(arguments, format);
+    pthread_mutex_lock(&outputLock);
+    vprintf(format, arguments);
+    putchar('\n');
+    fflush(stdout);
+    pthread_mutex_unlock(&outputLock);
+    va_end(arguments);
+}
+
+//Writes a move in coordinate notation, yCoord 0 is the eighth rank
+static void move_text(Move move, char text[5]) {
+
+    text[0] = (char) ('a' + MOVE_X(move.start));
+    text[1] = (char) ('8' - MOVE_Y(move.start));
+    text[2] = (char) ('a' + MOVE_X(move.end));
+    text[3] = (char) ('8' - MOVE_Y(move.end));
+    text[4] = '\0';
+}
+
+//Reads a move in coordinate notation
+//Returns false if it is not a move the rules allow in the position
+static bool parse_move(const char *text, Move *move) {
+
+    if (strlen(text) != 4 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8'
+        || text[2] < 'a' || text[2] > 'h' || text[3] < '1' || text[3] > '8') {
+        return false;
+    }
+
+    int xCoordStart = text[0] - 'a';
+    int yCoordStart = '8' - text[1];
+    int xCoordEnd = text[2] - 'a';
+    int yCoordEnd = '8' - text[3];
+    if (!is_valid_move(board, xCoordStart, yCoordStart, xCoordEnd, yCoordEnd, currentTurn)) {
+        return false;
+    }
+
+    move->start = MOVE_SQUARE(xCoordStart, yCoordStart);
+    move->end = MOVE_SQUARE(xCoordEnd, yCoordEnd);
+    return true;
+}
+
+//Prints what the search has found so far at a depth, one line for each of the best moves kept
+static void print_info(int depth) {
+
+    for (int index = 0; index < search.lineCount; index++) {
+
+        const SearchLine *found = &search.lines[index];
+        char line[96 + SEARCH_MAX_DEPTH * 5];
+        int length = 0;
+
+        //The line number is only given when more than one is asked for, as GUIs expect
+        if (options.lines > 1) {
+            length += snprintf(line, sizeof(line), "multipv %d ", index + 1);
+        }
+
+        //Mates are given in moves, negative when the engine is the one mated
+        int score = found->score;
+        if (score > SEARCH_MATE - SEARCH_MAX_DEPTH) {
+            length += snprintf(line + length, sizeof(line) - length, "score mate %d", (SEARCH_MATE - score + 1) / 2);
+        } else if (score < -(SEARCH_MATE - SEARCH_MAX_DEPTH)) {
+            length += snprintf(line + length, sizeof(line) - length, "score mate %d", -(SEARCH_MATE + score) / 2);
+        } else {
+            length += snprintf(line + length, sizeof(line) - length, "score cp %d", score);
+        }
+
+        unsigned int milliseconds = search_elapsed(&search) / 1000;
+        long long nps = search.stats.nodes * 1000 / (milliseconds > 0 ? milliseconds : 1);
+        length += snprintf(line + length, sizeof(line) - length, " nodes %lld nps %lld time %u pv", search.stats.nodes, nps, milliseconds);
+
+        for (int ply = 0; ply < found->pvLength; ply++) {
+            char move[5];
+            move_text(found->pv[ply], move);
+            length += snprintf(line + length, sizeof(line) - length, " %s", move);
+        }
+
+        print_line("info depth %d %s", depth, line);
+    }
+}
+
+//Prints the counts of the finished depths from first to last as info strings, under the headings for depth 1
+static void print_stats(int first, int last) {
+
+    char line[256];
+    if (first == 1) {
+        search_stats_format_header(line, sizeof(line));
+        print_line("info string %s", line);
+    }
+
+    for (int depth = first; depth <= last; depth++) {
+        search_stats_format_iteration(&search, depth, line, sizeof(line));
+        print_line("info string %s", line);
+    }
+}
+
+//Runs the search, reporting every finished depth, and prints the best move
+static void * search_main(void *argument) {
+
+    (void) argument;
+    int reportedDepth = 0;
+
+    bool finished = false;
+    while (!finished) {
+        finished = search_step(&search, timer_microseconds());
+        if (search.completedDepth > reportedDepth) {
+            print_info(search.completedDepth);
+            if (showStats) {
+                print_stats(reportedDepth + 1, search.completedDepth);
+            }
+            reportedDepth = search.completedDepth;
+        }
+    }
+
+    //A depth cut short reports the line it settled on
+    if (search.completedDepth == reportedDepth && search.rootIndex > 0) {
+        print_info(search.depth);
+    }
+
+    //go infinite only answers once told to stop
+    while (infinite && !__atomic_load_n(&search.stopRequested, __ATOMIC_RELAXED)) {
+        usleep(1000);
+    }
+
+    if (showStats) {
+        char line[256];
+        search_stats_format_totals(&search.stats, line, sizeof(line));
+        print_line("info string %s", line);
+    }
+
+    char move[5] = "0000";
+    if (search.rootCount > 0) {
+        move_text(search.bestMove, move);
+    }
+    print_line("bestmove %s", move);
+    return NULL;
+}
+
+//Stops a running search and waits for its best move to be printed
+static void stop_search() {
+
+    if (searching) {
+        search_stop(&search);
+        pthread_join(searchThread, NULL);
+        searching = false;
+    }
+}
+
+//Handles position startpos|fen <fen> [moves ...]
+static void handle_position(char *arguments) {
+
+    char *movesText = strstr(arguments, " moves");
+    if (movesText != NULL) {
+        *movesText = '\0';
+        movesText += strlen(" moves");
+    }
+
+    FenState state;
+    const char *fen = FEN_INITIAL_POSITION;
+    if (strncmp(arguments, "fen ", 4) == 0) {
+        fen = arguments + 4;
+    } else if (strncmp(arguments, "startpos", 8) != 0) {
+        print_line("info string unknown position %s", arguments);
+        return;
+    }
+    if (!fen_load(fen, board, &state)) {
+        print_line("info string invalid fen %s", fen);
+        fen_load(FEN_INITIAL_POSITION, board, &state);
+    }
+    currentTurn = state.currentTurn;
+
+    if (movesText == NULL) {
+        return;
+    }
+
+    char *next;
+    for (char *text = strtok_r(movesText, " \t", &next); text != NULL; text = strtok_r(NULL, " \t", &next)) {
+
+        Move move;
+        if (!parse_move(text, &move)) {
+            print_line("info string illegal move %s", text);
+            return;
+        }
+        make_move(board, move);
+        switch_turns(&currentTurn);
+    }
+}
+
+//Handles go with its limits and starts the search thread
+static void handle_go(char *arguments) {
+
+    SearchLimits limits = {0, 0, 0};
+    long long clockTime[2] = {-1, -1};
+    long long increment[2] = {0, 0};
+    long long movesToGo = DEFAULT_MOVES_TO_GO;
+    infinite = false;
+
+    char *next;
+    for (char *name = strtok_r(arguments, " \t", &next); name != NULL; name = strtok_r(NULL, " \t", &next)) {
+
+        if (strcmp(name, "infinite") == 0) {
+            infinite = true;
+            continue;
+        }
+
+        char *value = strtok_r(NULL, " \t", &next);
+        if (value == NULL) {
+            break;
+        }
+        long long number = atoll(value);
+
+        if (strcmp(name, "depth") == 0) limits.depth = (int) number;
+        else if (strcmp(name, "nodes") == 0) limits.nodes = number;
+        else if (strcmp(name, "movetime") == 0) limits.milliseconds = (unsigned int) number;
+        else if (strcmp(name, "wtime") == 0) clockTime[WHITE_PIECE] = number;
+        else if (strcmp(name, "btime") == 0) clockTime[BLACK_PIECE] = number;
+        else if (strcmp(name, "winc") == 0) increment[WHITE_PIECE] = number;
+        else if (strcmp(name, "binc") == 0) increment[BLACK_PIECE] = number;
+        else if (strcmp(name, "movestogo") == 0 && number > 0) movesToGo = number;
+    }
+
+    //A clock gives the move its share of the time left, keeping some back
+    if (limits.milliseconds == 0 && clockTime[currentTurn] >= 0 && !infinite) {
+        long long share = clockTime[currentTurn] / movesToGo + increment[currentTurn] * 3 / 4;
+        long long most = clockTime[currentTurn] - MOVE_OVERHEAD_MS;
+        if (share > most) share = most;
+        limits.milliseconds = share > 1 ? (unsigned int) share : 1;
+    }
+
+    //The stop flag is cleared here, before the thread starts, so a quick stop is not lost
+    search_start(&search, board, currentTurn, &limits);
+    searching = pthread_create(&searchThread, NULL, search_main, NULL) == 0;
+}
+
+//Handles setoption name <name> value <value>, the options turn parts of the search on and off or set the number of lines
+//The value is the rest of the line, a file name may have spaces
+static void handle_setoption(char *arguments) {
+
+    char name[32];
+    int valueStart = 0;
+    if (sscanf(arguments, "name %31s value %n", name, &valueStart) != 1 || valueStart == 0) {
+        return;
+    }
+    const char *value = arguments + valueStart;
+
+    bool on = strcasecmp(value, "true") == 0;
+    int number = atoi(value);
+    if (strcasecmp(name, "Quiescence") == 0) options.quiescence = on;
+    else if (strcasecmp(name, "Killers") == 0) options.killers = on;
+    else if (strcasecmp(name, "History") == 0) options.history = on;
+    else if (strcasecmp(name, "NullMove") == 0) options.nullMove = on;
+    else if (strcasecmp(name, "Reductions") == 0) options.reductions = on;
+    else if (strcasecmp(name, "Futility") == 0) options.futility = on;
+    else if (strcasecmp(name, "ReverseFutility") == 0) options.reverseFutility = on;
+    else if (strcasecmp(name, "CheckExtensions") == 0) options.checkExtensions = on;
+    else if (strcasecmp(name, "NNUE") == 0) options.nnue = on;
+    else if (strcasecmp(name, "Stats") == 0) showStats = on;
+    else if (strcasecmp(name, "MultiPV") == 0) options.lines = number < 1 ? 1 : number > SEARCH_MAX_LINES ? SEARCH_MAX_LINES : number;
+    else if (strcasecmp(name, "EvalFile") == 0) {
+        networkLoaded = nnue_host_load(&network, value);
+        if (!networkLoaded) print_line("info string %s is not a network", value);
+        search_set_network(&search, networkLoaded ? &network : NULL);
+    }
+    else print_line("info string unknown option %s", name);
+
+    if (options.nnue && !networkLoaded) {
+        print_line("info string NNUE scores with eval.c until EvalFile loads a network");
+    }
+    search.options = options;
+}
+
+int main(void) {
+
+    timer_init();
+    search_options_init(&options);
+    search_init(&search, &options);
+    char startPosition[] = "startpos";
+    handle_position(startPosition);
+
+    char *line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, stdin) >= 0) {
+
+        line[strcspn(line, "\r\n")] = '\0';
+        char *arguments = strchr(line, ' ');
+        if (arguments != NULL) {
+            *arguments++ = '\0';
+        } else {
+            arguments = line + strlen(line);
+        }
+
+        if (strcmp(line, "uci") == 0) {
+            print_line("id name DE1-SoC Chess");
+            print_line("id author DE1-SoC Chess authors");
+            print_line("option name Quiescence type check default true");
+            print_line("option name Killers type check default true");
+            print_line("option name History type check default true");
+            print_line("option name NullMove type check default true");
+            print_line("option name Reductions type check default true");
+            print_line("option name Futility type check default true");
+            print_line("option name ReverseFutility type check default true");
+            print_line("option name CheckExtensions type check default true");
+            print_line("option name NNUE type check default false");
+            print_line("option name MultiPV type spin default 1 min 1 max %d", SEARCH_MAX_LINES);
+            print_line("option name EvalFile type string default <empty>");
+            print_line("option name Stats type check default false");
+            print_line("uciok");
+        } else if (strcmp(line, "isready") == 0) {
+            print_line("readyok");
+        } else if (strcmp(line, "setoption") == 0) {
+            stop_search();
+            handle_setoption(arguments);
+        } else if (strcmp(line, "ucinewgame") == 0) {
+            stop_search();
+            search_init(&search, &options);
+            search_set_network(&search, networkLoaded ? &network : NULL);
+        } else if (strcmp(line, "position") == 0) {
+            stop_search();
+            handle_position(arguments);
+        } else if (strcmp(line, "go") == 0) {
+            stop_search();
+            handle_go(arguments);
+        } else if (strcmp(line, "stop") == 0) {
+            stop_search();
+        } else if (strcmp(line, "quit") == 0) {
+            break;
+        } else if (line[0] != '\0') {
+            print_line("info string unknown command %s", line);
+        }
+    }
+
+    stop_search();
+    free(line);
+    return 0;
+}